@@ -0,0 +1,194 @@
+/**
+ * @file bench-json-decode.cpp
+ * @brief Decoding cost of the high-rate streaming frames
+ *
+ * Decodes synthetic TTS "chunk" and STT "transcript" frames through:
+ * - the nlohmann DOM path (the public fromJson() entry points)
+ * - the frame decoder used by the streaming clients, which is the simdjson on-demand
+ *   backend when the library is configured with -DCARTESIAPP_USE_SIMDJSON=ON, both into
+ *   owning responses and into the reusable-buffer views handed to listeners
+ *
+ * and reports per-frame latency distributions and throughput for both. The base64 audio payload
+ * alone is also decoded with the scalar reference and with the kernel selected for this CPU.
+ *
+ * Options (all optional):
+ *   --iterations=N        Frames decoded per measurement (default 20000)
+ *   --chunk-bytes=N       Decoded audio bytes per TTS chunk (default 3840, 40 ms of 48 kHz s16le)
+ *   --words=N             Words per STT transcript (default 40)
+ */
+
+#include <cartesiapp/cartesiapp_response.hpp>
+
+#include "bench_common.hpp"
+#include "impl/base64_decoder.hpp"
+#include "impl/frame_decoder.hpp"
+
+#include <functional>
+
+#include <nlohmann/json.hpp>
+
+namespace {
+    std::string encodeBase64(const std::string& bytes) {
+        static const char* alphabet = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+        std::string out;
+        out.reserve((bytes.size() + 2) / 3 * 4);
+        size_t i = 0;
+        for (; i + 2 < bytes.size(); i += 3) {
+            uint32_t n = (uint32_t(uint8_t(bytes[i])) << 16) | (uint32_t(uint8_t(bytes[i + 1])) << 8) | uint8_t(bytes[i + 2]);
+            out += alphabet[(n >> 18) & 63];
+            out += alphabet[(n >> 12) & 63];
+            out += alphabet[(n >> 6) & 63];
+            out += alphabet[n & 63];
+        }
+        if (i < bytes.size()) {
+            uint32_t n = uint32_t(uint8_t(bytes[i])) << 16;
+            if (i + 1 < bytes.size()) {
+                n |= uint32_t(uint8_t(bytes[i + 1])) << 8;
+            }
+            out += alphabet[(n >> 18) & 63];
+            out += alphabet[(n >> 12) & 63];
+            out += i + 1 < bytes.size() ? alphabet[(n >> 6) & 63] : '=';
+            out += '=';
+        }
+        return out;
+    }
+
+    std::string makeAudioPayload(size_t audioBytes) {
+        std::string audio(audioBytes, '\0');
+        for (size_t i = 0; i < audio.size(); ++i) {
+            audio[i] = static_cast<char>((i * 31) & 0xFF);
+        }
+        return encodeBase64(audio);
+    }
+
+    /**
+     * @brief Straightforward table-driven decoder, the reference the vector kernels are compared against.
+     */
+    std::string decodeBase64Scalar(const std::string& encoded) {
+        static const std::vector<int> table = []() {
+            std::vector<int> values(256, -1);
+            const std::string alphabet = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+            for (size_t i = 0; i < alphabet.size(); ++i) {
+                values[static_cast<uint8_t>(alphabet[i])] = static_cast<int>(i);
+            }
+            return values;
+            }();
+        std::string out;
+        out.reserve(encoded.size() / 4 * 3);
+        uint32_t bits = 0;
+        int bitCount = 0;
+        for (char c : encoded) {
+            if (c == '=') {
+                break;
+            }
+            bits = (bits << 6) | static_cast<uint32_t>(table[static_cast<uint8_t>(c)]);
+            bitCount += 6;
+            if (bitCount >= 8) {
+                bitCount -= 8;
+                out += static_cast<char>((bits >> bitCount) & 0xFF);
+            }
+        }
+        return out;
+    }
+
+    std::string makeChunkFrame(const std::string& payload) {
+        nlohmann::json frame = {
+            { "type", "chunk" },
+            { "data", payload },
+            { "done", false },
+            { "status_code", 206 },
+            { "step_time", 12.5 },
+            { "context_id", "bench-context-0001" }
+        };
+        return frame.dump();
+    }
+
+    std::string makeTranscriptFrame(int wordCount) {
+        nlohmann::json words = nlohmann::json::array();
+        std::string text;
+        for (int i = 0; i < wordCount; ++i) {
+            std::string word = "word" + std::to_string(i);
+            text += (i ? " " : "") + word;
+            words.push_back({ { "word", word }, { "start", i * 0.25 }, { "end", i * 0.25 + 0.2 } });
+        }
+        nlohmann::json frame = {
+            { "type", "transcript" },
+            { "text", text },
+            { "is_final", true },
+            { "duration", wordCount * 0.25 },
+            { "language", "en" },
+            { "request_id", "bench-request-0001" },
+            { "words", words }
+        };
+        return frame.dump();
+    }
+
+    /**
+     * @brief Decodes the frame `iterations` times, timing each decode, and prints the distribution and throughput.
+     */
+    void measure(const std::string& title, const std::string& frame, long long iterations, const std::function<size_t()>& decode) {
+        // warm up caches, allocators and the branch predictor
+        size_t checksum = 0;
+        for (long long i = 0; i < iterations / 10 + 1; ++i) {
+            checksum += decode();
+        }
+        bench::LatencyHistogram histogram;
+        uint64_t begin = bench::nowNs();
+        for (long long i = 0; i < iterations; ++i) {
+            uint64_t start = bench::nowNs();
+            checksum += decode();
+            histogram.record(bench::nowNs() - start);
+        }
+        double seconds = static_cast<double>(bench::nowNs() - begin) / 1e9;
+        histogram.print(title, 1.0, "ns");
+        std::printf("  %.0f frames/s, %.1f MiB/s of JSON (checksum %zu)\n",
+            static_cast<double>(iterations) / seconds,
+            static_cast<double>(frame.size()) * static_cast<double>(iterations) / seconds / (1024.0 * 1024.0),
+            checksum);
+    }
+}
+
+int main(int ac, char** av) {
+    bench::Options options(ac, av);
+    long long iterations = options.getInt("iterations", 20000);
+    std::string payload = makeAudioPayload(static_cast<size_t>(options.getInt("chunk-bytes", 3840)));
+    std::string chunkFrame = makeChunkFrame(payload);
+    std::string transcriptFrame = makeTranscriptFrame(static_cast<int>(options.getInt("words", 40)));
+
+    const char* backend = cartesiapp::FrameDecoder::usesSimdjson() ? "simdjson on-demand" : "nlohmann (simdjson disabled)";
+    std::printf("Frame decoder backend: %s\n", backend);
+    std::printf("Chunk frame: %zu bytes, transcript frame: %zu bytes\n", chunkFrame.size(), transcriptFrame.size());
+
+    cartesiapp::FrameDecoder decoder;
+
+    if (decodeBase64Scalar(payload) != decoder.decodeAudioChunk(chunkFrame).data) {
+        std::fprintf(stderr, "base64 kernel output differs from the scalar reference\n");
+        return 1;
+    }
+    std::string decoded;
+    measure("base64 payload, scalar reference", payload, iterations, [&]() {
+        return decodeBase64Scalar(payload).size();
+        });
+    measure(std::string("base64 payload, ") + cartesiapp::codec::base64KernelName() + " kernel", payload, iterations, [&]() {
+        cartesiapp::codec::decodeBase64(payload, decoded);
+        return decoded.size();
+        });
+
+    measure("TTS chunk, nlohmann DOM", chunkFrame, iterations, [&]() {
+        return cartesiapp::response::tts::AudioChunkResponse::fromJson(chunkFrame).data.size();
+        });
+    measure(std::string("TTS chunk, frame decoder (") + backend + ")", chunkFrame, iterations, [&]() {
+        return decoder.decodeAudioChunk(chunkFrame).data.size();
+        });
+    measure(std::string("TTS chunk view, frame decoder (") + backend + ")", chunkFrame, iterations, [&]() {
+        return decoder.decodeAudioChunkView(chunkFrame).size;
+        });
+    measure("STT transcript, nlohmann DOM", transcriptFrame, iterations, [&]() {
+        return cartesiapp::response::stt::TranscriptionResponse::fromJson(transcriptFrame).words.size();
+        });
+    measure(std::string("STT transcript, frame decoder (") + backend + ")", transcriptFrame, iterations, [&]() {
+        return decoder.decodeTranscription(transcriptFrame).words.size();
+        });
+
+    return 0;
+}
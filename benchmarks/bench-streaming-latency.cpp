@@ -0,0 +1,1704 @@
+/**
+ * @file bench-streaming-latency.cpp
+ * @brief End-to-end latency benchmark for the TTS and STT WebSocket clients
+ *
+ * This benchmark starts a local TLS WebSocket server that mimics the Cartesia streaming
+ * protocol, points TTSWebsocketClient and STTWebsocketClient at it and measures:
+ * - TTS request to first audio chunk latency
+ * - Inter-chunk jitter for paced streams
+ * - Frame delivery latency, from the server writing a frame to the listener callback
+ *   (both ends share the process monotonic clock, so this covers the loopback hop,
+ *   the socket read, parsing and dispatch)
+ * - Maximum sustainable frames per second on a single connection
+ * - STT audio write to transcript round trip latency
+ * - Connect phase breakdown (DNS, TCP, TLS, upgrade)
+ * - STT round trip latency with many sessions sharing a small pool of I/O threads
+ * - Request to done latency of many TTS contexts multiplexed over one connection
+ * - Session start on a pre-connected socket from a TTSWebsocketPool versus a cold connect
+ * - STT recovery time after the server drops the connection, with automatic reconnect and audio replay, and
+ *   no reconnect after the normal close that follows done
+ * - Wire bytes and I/O CPU time of a TTS stream with and without permessage-deflate
+ * - A TTS burst into a slow listener, inline and behind each listener dispatch overflow policy
+ * - Frame delivery latency and batch sizes of a TTS stream polled from a TTSEventQueue
+ * - Ping round trip time, and the time to detect a server that stops responding or never completes the handshake
+ * - STT messages and round trip latency for 10 ms audio writes, sent as written and framed by duration,
+ *   and the upload time of audio paced in real time
+ * - Audio dropped by client-side silence suppression of speech with pauses, and its cost per 10 ms window
+ * - End of speech to flush_done latency with client-side endpointing on a live 16 kHz stream
+ *
+ * Every measurement is reported as an HDR-style percentile distribution.
+ *
+ * Options (all optional):
+ *   --iterations=N        TTS requests in the latency run (default 50)
+ *   --frames=N            Chunks per TTS request in the latency run (default 20)
+ *   --interval-us=N       Server pacing between chunks in the latency runs (default 5000)
+ *   --chunk-bytes=N       Decoded audio bytes per TTS chunk (default 3840, 40 ms of 48 kHz s16le)
+ *   --burst-frames=N      Frames in the throughput runs (default 20000)
+ *   --stt-frames=N        Audio frames in the STT latency run (default 200)
+ *   --stt-frame-bytes=N   Bytes per STT audio frame (default 3200, 100 ms of 16 kHz s16le)
+ *   --sessions=N          Concurrent STT sessions in the shared engine run (default 64, 0 to skip)
+ *   --session-frames=N    Audio frames per session in the shared engine run (default 50)
+ *   --io-threads=N        I/O threads of the shared engine (default 0, one per hardware thread)
+ *   --contexts=N          TTS contexts in the multiplexed run (default 32, 0 to skip)
+ *   --max-contexts=N      Contexts open on the socket at once in the multiplexed run (default 4)
+ *   --pool-size=N         Warm sockets in the pooled session run (default 2, 0 to skip)
+ *   --drops=N             Connection drops in the STT reconnect run (default 5, 0 to skip)
+ *   --deflate-frames=N    TTS chunks per mode in the compression run (default 2000, 0 to skip)
+ *   --slow-frames=N       TTS chunks per mode in the slow listener run (default 2000, 0 to skip)
+ *   --listener-delay-us=N Time the slow listener spends on every chunk (default 200)
+ *   --queue-frames=N      TTS chunks in the event queue run (default 2000, 0 to skip)
+ *   --stalls=N            Unresponsive server episodes in the dead peer run (default 5, 0 to skip)
+ *   --idle-timeout-ms=N   Idle timeout of the dead peer run (default 300)
+ *   --framing-writes=N    10 ms audio writes per mode in the STT framing run (default 2000, 0 to skip)
+ *   --paced-ms=N          Audio uploaded with real time pacing in the STT framing run (default 1000)
+ *   --silence-seconds=N   Audio per encoding in the STT silence suppression run (default 40, 0 to skip)
+ *   --utterances=N        Utterances in the STT endpointing run, streamed in real time (default 5, 0 to skip)
+ *   --trailing-silence-ms=N Trailing silence ending an utterance in the endpointing run (default 300)
+ *   --metrics             Print the library metrics in Prometheus text format at the end
+ */
+
+#include <cartesiapp/cartesiapp_metrics.hpp>
+#include <cartesiapp/event_queue.hpp>
+#include <cartesiapp/io_engine.hpp>
+#include <cartesiapp/streaming_tts.hpp>
+#include <cartesiapp/streaming_stt.hpp>
+#include <cartesiapp/tts_context_manager.hpp>
+#include <cartesiapp/tts_websocket_pool.hpp>
+
+#include "bench_common.hpp"
+
+#include <atomic>
+#include <cmath>
+#include <condition_variable>
+#include <cstring>
+#include <list>
+#include <mutex>
+#include <set>
+#include <sstream>
+#include <thread>
+
+#include <nlohmann/json.hpp>
+#include <spdlog/spdlog.h>
+
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/asio/ssl.hpp>
+#include <boost/beast/core.hpp>
+#include <boost/beast/http.hpp>
+#include <boost/beast/websocket.hpp>
+#include <boost/beast/websocket/ssl.hpp>
+
+#include <openssl/evp.h>
+#include <openssl/ec.h>
+#include <openssl/x509.h>
+
+namespace beast = boost::beast;
+namespace http = beast::http;
+namespace websocket = beast::websocket;
+namespace net = boost::asio;
+namespace ssl = net::ssl;
+using tcp = net::ip::tcp;
+
+namespace {
+
+    /**
+     * @brief Installs a freshly generated self-signed P-256 certificate into the server context.
+     * The clients run with certificate verification disabled, so no trust store setup is needed.
+     */
+    void useSelfSignedCertificate(ssl::context& context) {
+        EVP_PKEY* key = nullptr;
+        EVP_PKEY_CTX* keyContext = EVP_PKEY_CTX_new_id(EVP_PKEY_EC, nullptr);
+        if (!keyContext
+            || EVP_PKEY_keygen_init(keyContext) <= 0
+            || EVP_PKEY_CTX_set_ec_paramgen_curve_nid(keyContext, NID_X9_62_prime256v1) <= 0
+            || EVP_PKEY_keygen(keyContext, &key) <= 0) {
+            EVP_PKEY_CTX_free(keyContext);
+            throw std::runtime_error("Failed to generate benchmark server key");
+        }
+        EVP_PKEY_CTX_free(keyContext);
+
+        X509* certificate = X509_new();
+        ASN1_INTEGER_set(X509_get_serialNumber(certificate), 1);
+        X509_gmtime_adj(X509_getm_notBefore(certificate), 0);
+        X509_gmtime_adj(X509_getm_notAfter(certificate), 24 * 3600);
+        X509_set_pubkey(certificate, key);
+        X509_NAME* name = X509_get_subject_name(certificate);
+        X509_NAME_add_entry_by_txt(name, "CN", MBSTRING_ASC, reinterpret_cast<const unsigned char*>("localhost"), -1, -1, 0);
+        X509_set_issuer_name(certificate, name);
+        X509_sign(certificate, key, EVP_sha256());
+
+        SSL_CTX_use_certificate(context.native_handle(), certificate);
+        SSL_CTX_use_PrivateKey(context.native_handle(), key);
+        X509_free(certificate);
+        EVP_PKEY_free(key);
+    }
+
+    std::string toBase64(const std::string& input) {
+        static const char* alphabet = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+        std::string output;
+        output.reserve((input.size() + 2) / 3 * 4);
+        size_t i = 0;
+        for (; i + 2 < input.size(); i += 3) {
+            uint32_t triple = (uint8_t(input[i]) << 16) | (uint8_t(input[i + 1]) << 8) | uint8_t(input[i + 2]);
+            output.push_back(alphabet[(triple >> 18) & 0x3F]);
+            output.push_back(alphabet[(triple >> 12) & 0x3F]);
+            output.push_back(alphabet[(triple >> 6) & 0x3F]);
+            output.push_back(alphabet[triple & 0x3F]);
+        }
+        if (i < input.size()) {
+            uint32_t triple = uint8_t(input[i]) << 16;
+            if (i + 1 < input.size()) {
+                triple |= uint8_t(input[i + 1]) << 8;
+            }
+            output.push_back(alphabet[(triple >> 18) & 0x3F]);
+            output.push_back(alphabet[(triple >> 12) & 0x3F]);
+            output.push_back(i + 1 < input.size() ? alphabet[(triple >> 6) & 0x3F] : '=');
+            output.push_back('=');
+        }
+        return output;
+    }
+
+    void writeStamp(char* destination, uint64_t stamp) {
+        std::memcpy(destination, &stamp, sizeof(stamp));
+    }
+
+    uint64_t readStamp(const char* source) {
+        uint64_t stamp = 0;
+        std::memcpy(&stamp, source, sizeof(stamp));
+        return stamp;
+    }
+
+    /**
+     * @brief Parses the "key=value;key=value" instructions the benchmark sends as TTS transcript.
+     */
+    std::map<std::string, long long> parseInstructions(const std::string& transcript) {
+        std::map<std::string, long long> values;
+        std::stringstream stream(transcript);
+        std::string item;
+        while (std::getline(stream, item, ';')) {
+            auto eq = item.find('=');
+            if (eq != std::string::npos) {
+                values[item.substr(0, eq)] = std::atoll(item.c_str() + eq + 1);
+            }
+        }
+        return values;
+    }
+
+    /**
+     * @brief Produces 16-bit little-endian PCM of a 440 Hz tone at 24 kHz with some noise, continuing across calls.
+     */
+    class ToneGenerator {
+        public:
+        void fill(char* out, size_t size) {
+            for (size_t i = 0; i + 1 < size; i += 2) {
+                _noise = _noise * 1664525u + 1013904223u;
+                double sample = 8000.0 * std::sin(_phase) + static_cast<double>(static_cast<int32_t>(_noise >> 16) % 512);
+                _phase += 2.0 * 3.14159265358979323846 * 440.0 / 24000.0;
+                auto value = static_cast<uint16_t>(static_cast<int16_t>(sample));
+                out[i] = static_cast<char>(value & 0xff);
+                out[i + 1] = static_cast<char>(value >> 8);
+            }
+        }
+
+        private:
+        double _phase = 0.0;
+        uint32_t _noise = 12345;
+    };
+
+    /**
+     * @brief Local TLS WebSocket server speaking a minimal subset of the Cartesia streaming protocol.
+     *
+     * TTS (/tts/websocket): each generation request carries "frames=N;interval_us=I;bytes=B" as
+     * transcript, the server answers with N chunk frames whose decoded audio starts with the server
+     * send timestamp, followed by a done frame. With "signal=1" the audio after the timestamp is a
+     * noisy tone that differs from frame to frame instead of silence, for compression measurements.
+     *
+     * Both endpoints accept permessage-deflate when the client offers it.
+     *
+     * STT (/stt/websocket): every binary audio frame is answered by a transcript frame whose text is
+     * the client timestamp found in the first 8 audio bytes and whose request_id is the server send
+     * timestamp. "finalize" is acknowledged with a flush_done frame, "done" with a done frame followed by a
+     * normal close, like the real service. An audio frame
+     * stamped with the current time whose ninth byte is DROP_MARKER makes the server close the socket
+     * without a close frame, once per timestamp so that the replay of the frame after a reconnect goes through.
+     */
+    class LocalStreamingServer {
+        public:
+        LocalStreamingServer() :
+            _sslContext(ssl::context::tls_server),
+            _acceptor(_ioContext, tcp::endpoint(net::ip::make_address("127.0.0.1"), 0)) {
+            useSelfSignedCertificate(_sslContext);
+            _port = _acceptor.local_endpoint().port();
+            _acceptThread = std::thread([this]() { acceptLoop(); });
+        }
+
+        ~LocalStreamingServer() {
+            _stopping.store(true);
+            // wake up the blocking accept with a throwaway connection
+            try {
+                net::io_context ioContext;
+                tcp::socket socket(ioContext);
+                socket.connect(tcp::endpoint(net::ip::make_address("127.0.0.1"), _port));
+            }
+            catch (const std::exception&) {
+            }
+            if (_acceptThread.joinable()) {
+                _acceptThread.join();
+            }
+            for (auto& session : _sessions) {
+                if (session.joinable()) {
+                    session.join();
+                }
+            }
+        }
+
+        unsigned short port() const {
+            return _port;
+        }
+
+        static constexpr char DROP_MARKER = '\x7f';
+
+        private:
+        using ServerWebsocket = websocket::stream<ssl::stream<tcp::socket>>;
+
+        void acceptLoop() {
+            while (!_stopping.load()) {
+                tcp::socket socket(_ioContext);
+                beast::error_code ec;
+                _acceptor.accept(socket, ec);
+                if (ec || _stopping.load()) {
+                    break;
+                }
+                socket.set_option(tcp::no_delay(true), ec);
+                _sessions.emplace_back([this, s = std::move(socket)]() mutable {
+                    runSession(std::move(s));
+                    });
+            }
+        }
+
+        void runSession(tcp::socket socket) {
+            beast::error_code ec;
+            ServerWebsocket ws(std::move(socket), _sslContext);
+            ws.next_layer().handshake(ssl::stream_base::server, ec);
+            if (ec) {
+                return;
+            }
+
+            beast::flat_buffer buffer;
+            http::request<http::string_body> upgradeRequest;
+            http::read(ws.next_layer(), buffer, upgradeRequest, ec);
+            if (ec) {
+                return;
+            }
+            websocket::permessage_deflate deflate;
+            deflate.server_enable = true;
+            ws.set_option(deflate);
+            ws.accept(upgradeRequest, ec);
+            if (ec) {
+                return;
+            }
+
+            bool isSTT = std::string(upgradeRequest.target()).rfind(cartesiapp::request::constants::ENDPOINT_STT_WEBSOCKET, 0) == 0;
+
+            while (true) {
+                beast::flat_buffer frame;
+                ws.read(frame, ec);
+                if (ec) {
+                    return;
+                }
+                std::string message = beast::buffers_to_string(frame.data());
+                bool ok = isSTT ? handleSTTMessage(ws, message, ws.got_binary()) : handleTTSMessage(ws, message);
+                if (!ok) {
+                    return;
+                }
+            }
+        }
+
+        bool handleTTSMessage(ServerWebsocket& ws, const std::string& message) {
+            nlohmann::json request = nlohmann::json::parse(message, nullptr, false);
+            if (request.is_discarded() || !request.contains("transcript")) {
+                return true;
+            }
+            auto instructions = parseInstructions(request["transcript"].get<std::string>());
+            if (instructions.count("stall_ms")) {
+                // a half-open peer: neither frames nor pongs, as nothing is read, then the connection goes away
+                std::this_thread::sleep_for(std::chrono::milliseconds(instructions["stall_ms"]));
+                return false;
+            }
+            long long frames = instructions.count("frames") ? instructions["frames"] : 10;
+            long long intervalUs = instructions.count("interval_us") ? instructions["interval_us"] : 0;
+            long long chunkBytes = std::max<long long>(instructions.count("bytes") ? instructions["bytes"] : 3840, 9);
+            bool signal = instructions.count("signal") && instructions["signal"] != 0;
+            std::string contextId = request.value("context_id", "");
+
+            // pre-encode the frame once, only the first 12 base64 characters (the first 9 payload
+            // bytes, which hold the timestamp) change from frame to frame
+            std::string payload(static_cast<size_t>(chunkBytes), '\0');
+            std::string framePrefix = "{\"type\":\"chunk\",\"data\":\"";
+            std::string frameSuffix = "\",\"done\":false,\"status_code\":206,\"step_time\":0.5,\"context_id\":\"" + contextId + "\"}";
+            std::string frameText = framePrefix + toBase64(payload) + frameSuffix;
+            ToneGenerator tone;
+
+            ws.text(true);
+            beast::error_code ec;
+            auto start = std::chrono::steady_clock::now();
+            for (long long i = 0; i < frames; ++i) {
+                if (intervalUs > 0) {
+                    std::this_thread::sleep_until(start + std::chrono::microseconds(intervalUs * i));
+                }
+                if (signal) {
+                    tone.fill(&payload[9], payload.size() - 9);
+                    writeStamp(&payload[0], bench::nowNs());
+                    frameText = framePrefix + toBase64(payload) + frameSuffix;
+                }
+                else {
+                    std::string head(9, '\0');
+                    writeStamp(&head[0], bench::nowNs());
+                    std::string encodedHead = toBase64(head);
+                    std::memcpy(&frameText[framePrefix.size()], encodedHead.data(), encodedHead.size());
+                }
+                ws.write(net::buffer(frameText), ec);
+                if (ec) {
+                    return false;
+                }
+            }
+            std::string done = "{\"type\":\"done\",\"done\":true,\"status_code\":200,\"context_id\":\"" + contextId + "\"}";
+            ws.write(net::buffer(done), ec);
+            return !ec;
+        }
+
+        bool handleSTTMessage(ServerWebsocket& ws, const std::string& message, bool isBinary) {
+            beast::error_code ec;
+            ws.text(true);
+            if (!isBinary) {
+                if (message == "finalize") {
+                    ws.write(net::buffer(std::string("{\"type\":\"flush_done\",\"request_id\":\"bench\"}")), ec);
+                }
+                else if (message == "done") {
+                    ws.write(net::buffer(std::string("{\"type\":\"done\",\"request_id\":\"bench\"}")), ec);
+                    ws.close(beast::websocket::close_code::normal, ec);
+                    return false;
+                }
+                return !ec;
+            }
+            uint64_t clientStamp = message.size() >= sizeof(uint64_t) ? readStamp(message.data()) : 0;
+            // the stamp must be a recent clock reading, so that arbitrary audio never matches
+            bool stamped = clientStamp <= bench::nowNs() && bench::nowNs() - clientStamp < 60'000'000'000ull;
+            if (stamped && message.size() > sizeof(uint64_t) && message[sizeof(uint64_t)] == DROP_MARKER) {
+                std::lock_guard<std::mutex> lock(_dropsMutex);
+                if (_droppedStamps.insert(clientStamp).second) {
+                    beast::get_lowest_layer(ws).close(ec);
+                    return false;
+                }
+            }
+            std::string text = "{\"type\":\"transcript\",\"text\":\"" + std::to_string(clientStamp)
+                + "\",\"is_final\":false,\"duration\":0.1,\"words\":[],\"request_id\":\"";
+            text += std::to_string(bench::nowNs()) + "\"}";
+            ws.write(net::buffer(text), ec);
+            return !ec;
+        }
+
+        net::io_context _ioContext;
+        ssl::context _sslContext;
+        tcp::acceptor _acceptor;
+        unsigned short _port = 0;
+        std::atomic_bool _stopping{ false };
+        std::thread _acceptThread;
+        std::list<std::thread> _sessions;
+        std::mutex _dropsMutex;
+        std::set<uint64_t> _droppedStamps;
+    };
+
+    /**
+     * @brief Accepts TCP connections and never answers, like a server stuck before the TLS handshake.
+     */
+    class SilentServer {
+        public:
+        SilentServer() : _acceptor(_ioContext, tcp::endpoint(net::ip::make_address("127.0.0.1"), 0)) {
+            _acceptThread = std::thread([this]() {
+                while (!_stopping.load()) {
+                    tcp::socket socket(_ioContext);
+                    beast::error_code ec;
+                    _acceptor.accept(socket, ec);
+                    if (ec) {
+                        break;
+                    }
+                    // held open without reading until the server goes away
+                    _sockets.push_back(std::move(socket));
+                }
+                });
+        }
+
+        ~SilentServer() {
+            _stopping.store(true);
+            try {
+                net::io_context ioContext;
+                tcp::socket socket(ioContext);
+                socket.connect(tcp::endpoint(net::ip::make_address("127.0.0.1"), port()));
+            }
+            catch (const std::exception&) {
+            }
+            _acceptThread.join();
+        }
+
+        unsigned short port() const {
+            return _acceptor.local_endpoint().port();
+        }
+
+        private:
+        net::io_context _ioContext;
+        tcp::acceptor _acceptor;
+        std::atomic_bool _stopping{ false };
+        std::thread _acceptThread;
+        std::list<tcp::socket> _sockets;
+    };
+
+    /**
+     * @brief TTS listener recording latency distributions for the current request.
+     */
+    class BenchTTSListener : public cartesiapp::TTSResponseListener {
+        public:
+        bench::LatencyHistogram firstChunkLatency;
+        bench::LatencyHistogram interChunkJitter;
+        bench::LatencyHistogram deliveryLatency;
+
+        void beginRequest(uint64_t expectedIntervalNs) {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _expectedIntervalNs = expectedIntervalNs;
+            _requestNs = bench::nowNs();
+            _firstChunkNs = 0;
+            _lastChunkNs = 0;
+            _chunks = 0;
+            _done = false;
+        }
+
+        bool waitForDone(std::chrono::seconds timeout) {
+            std::unique_lock<std::mutex> lock(_mutex);
+            return _cv.wait_for(lock, timeout, [this]() { return _done || _failed; }) && !_failed;
+        }
+
+        uint64_t chunks() const {
+            return _chunks;
+        }
+
+        uint64_t streamDurationNs() const {
+            return _lastChunkNs - _firstChunkNs;
+        }
+
+        void onConnected() override {
+        }
+
+        void onDisconnected(const std::string& /*reason*/) override {
+        }
+
+        void onNetworkError(const std::string& errorMessage) override {
+            spdlog::error("TTS network error: {}", errorMessage);
+            std::lock_guard<std::mutex> lock(_mutex);
+            _failed = true;
+            _cv.notify_all();
+        }
+
+        void onAudioChunkReceived(const cartesiapp::response::tts::AudioChunkResponse& /*response*/) override {
+        }
+
+        // consume chunks in place, the path a latency-sensitive application would take
+        void onAudioChunkView(const cartesiapp::response::tts::AudioChunkView& chunk) override {
+            uint64_t now = bench::nowNs();
+            if (chunk.size >= sizeof(uint64_t)) {
+                deliveryLatency.record(now - readStamp(reinterpret_cast<const char*>(chunk.data)));
+            }
+            if (_chunks == 0) {
+                _firstChunkNs = now;
+                firstChunkLatency.record(now - _requestNs);
+            }
+            else if (_expectedIntervalNs > 0) {
+                uint64_t delta = now - _lastChunkNs;
+                interChunkJitter.record(delta > _expectedIntervalNs ? delta - _expectedIntervalNs : _expectedIntervalNs - delta);
+            }
+            _lastChunkNs = now;
+            _chunks++;
+        }
+
+        void onDoneReceived(const cartesiapp::response::tts::DoneResponse& /*response*/) override {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _done = true;
+            _cv.notify_all();
+        }
+
+        void onWordTimestampsReceived(const cartesiapp::response::tts::WordTimestampsResponse& /*response*/) override {
+        }
+
+        void onPhonemeTimestampsReceived(const cartesiapp::response::tts::PhonemeTimestampsResponse& /*response*/) override {
+        }
+
+        void onFlushDoneReceived(const cartesiapp::response::tts::FlushDoneResponse& /*response*/) override {
+        }
+
+        void onError(const cartesiapp::response::tts::ErrorResponse& response) override {
+            spdlog::error("TTS error: {}", response.error);
+        }
+
+        private:
+        std::mutex _mutex;
+        std::condition_variable _cv;
+        bool _done = false;
+        bool _failed = false;
+        uint64_t _expectedIntervalNs = 0;
+        uint64_t _requestNs = 0;
+        uint64_t _firstChunkNs = 0;
+        uint64_t _lastChunkNs = 0;
+        uint64_t _chunks = 0;
+    };
+
+    /**
+     * @brief TTS listener spending a fixed time on every chunk, like one writing the audio to disk.
+     */
+    class BenchSlowTTSListener : public BenchTTSListener {
+        public:
+        explicit BenchSlowTTSListener(std::chrono::microseconds delay) : _delay(delay) {
+        }
+
+        uint64_t audioBytes() const {
+            return _audioBytes;
+        }
+
+        void onAudioChunkView(const cartesiapp::response::tts::AudioChunkView& chunk) override {
+            BenchTTSListener::onAudioChunkView(chunk);
+            _audioBytes += chunk.size;
+            std::this_thread::sleep_for(_delay);
+        }
+
+        private:
+        std::chrono::microseconds _delay;
+        uint64_t _audioBytes = 0;
+    };
+
+    /**
+     * @brief STT listener recording transcript round trip and delivery latencies.
+     */
+    class BenchSTTListener : public cartesiapp::STTResponseListener {
+        public:
+        bench::LatencyHistogram roundTripLatency;
+        bench::LatencyHistogram deliveryLatency;
+
+        std::atomic<uint64_t> transcripts{ 0 };
+        std::atomic<uint64_t> firstTranscriptNs{ 0 };
+        std::atomic<uint64_t> lastTranscriptNs{ 0 };
+
+        void reset() {
+            roundTripLatency = bench::LatencyHistogram();
+            deliveryLatency = bench::LatencyHistogram();
+            transcripts.store(0);
+            firstTranscriptNs.store(0);
+            lastTranscriptNs.store(0);
+        }
+
+        void onConnected() override {
+        }
+
+        void onDisconnected(const std::string& /*reason*/) override {
+        }
+
+        void onNetworkError(const std::string& errorMessage) override {
+            spdlog::error("STT network error: {}", errorMessage);
+        }
+
+        void onTranscriptionReceived(const cartesiapp::response::stt::TranscriptionResponse& response) override {
+            uint64_t now = bench::nowNs();
+            roundTripLatency.record(now - std::stoull(response.text));
+            deliveryLatency.record(now - std::stoull(response.request_id));
+            if (transcripts.load() == 0) {
+                firstTranscriptNs.store(now);
+            }
+            lastTranscriptNs.store(now);
+            transcripts.fetch_add(1);
+        }
+
+        void onDoneReceived(const cartesiapp::response::stt::DoneResponse& /*response*/) override {
+        }
+
+        void onFlushDoneReceived(const cartesiapp::response::stt::FlushDoneResponse& /*response*/) override {
+        }
+
+        void onError(const cartesiapp::response::stt::ErrorResponse& response) override {
+            spdlog::error("STT error: {}", response.error);
+        }
+    };
+
+    /**
+     * @brief STT listener additionally timestamping reconnections.
+     */
+    class BenchReconnectListener : public BenchSTTListener {
+        public:
+        std::atomic<uint64_t> reconnects{ 0 };
+        std::atomic<uint64_t> lastReconnectNs{ 0 };
+        std::atomic<uint64_t> disconnects{ 0 };
+
+        void onReconnected() override {
+            lastReconnectNs.store(bench::nowNs());
+            reconnects.fetch_add(1);
+        }
+
+        void onDisconnected(const std::string& /*reason*/) override {
+            disconnects.fetch_add(1);
+        }
+    };
+
+    /**
+     * @brief STT listener additionally counting flush_done acknowledgements.
+     */
+    class BenchFramingListener : public BenchSTTListener {
+        public:
+        std::atomic<uint64_t> flushes{ 0 };
+
+        void onFlushDoneReceived(const cartesiapp::response::stt::FlushDoneResponse& /*response*/) override {
+            flushes.fetch_add(1);
+        }
+    };
+
+    /**
+     * @brief STT listener counting transcripts and flush_done acknowledgements of audio without timestamps.
+     */
+    class BenchCountingSTTListener : public cartesiapp::STTResponseListener {
+        public:
+        std::atomic<uint64_t> transcripts{ 0 };
+        std::atomic<uint64_t> flushes{ 0 };
+        std::atomic<uint64_t> lastFlushNs{ 0 };
+
+        void onConnected() override {
+        }
+
+        void onDisconnected(const std::string& /*reason*/) override {
+        }
+
+        void onNetworkError(const std::string& errorMessage) override {
+            spdlog::error("STT network error: {}", errorMessage);
+        }
+
+        void onTranscriptionReceived(const cartesiapp::response::stt::TranscriptionResponse& /*response*/) override {
+            transcripts.fetch_add(1);
+        }
+
+        void onDoneReceived(const cartesiapp::response::stt::DoneResponse& /*response*/) override {
+        }
+
+        void onFlushDoneReceived(const cartesiapp::response::stt::FlushDoneResponse& /*response*/) override {
+            lastFlushNs.store(bench::nowNs());
+            flushes.fetch_add(1);
+        }
+
+        void onError(const cartesiapp::response::stt::ErrorResponse& response) override {
+            spdlog::error("STT error: {}", response.error);
+        }
+    };
+
+    /**
+     * @brief Encodes a 16-bit linear sample as G.711 mu-law.
+     */
+    uint8_t encodeMulaw(int16_t sample) {
+        const int bias = 0x84;
+        int sign = sample < 0 ? 0x80 : 0;
+        int magnitude = std::min(std::abs(static_cast<int>(sample)), 32635) + bias;
+        int exponent = 7;
+        for (int mask = 0x4000; (magnitude & mask) == 0 && exponent > 0; mask >>= 1) {
+            --exponent;
+        }
+        int mantissa = (magnitude >> (exponent + 3)) & 0x0F;
+        return static_cast<uint8_t>(~(sign | (exponent << 4) | mantissa));
+    }
+
+    /**
+     * @brief TTS listener recording when the connection is reported dead.
+     */
+    class BenchDeadPeerListener : public BenchTTSListener {
+        public:
+        void onNetworkError(const std::string& /*errorMessage*/) override {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _errorNs = bench::nowNs();
+            _cv.notify_all();
+        }
+
+        /**
+         * @return The time the network error was reported, 0 if it was not within the timeout.
+         */
+        uint64_t waitForError(std::chrono::milliseconds timeout) {
+            std::unique_lock<std::mutex> lock(_mutex);
+            _cv.wait_for(lock, timeout, [this]() { return _errorNs != 0; });
+            return _errorNs;
+        }
+
+        private:
+        std::mutex _mutex;
+        std::condition_variable _cv;
+        uint64_t _errorNs = 0;
+    };
+
+    /**
+     * @brief Listener of a single multiplexed TTS context, checking that it only receives its own events.
+     */
+    class BenchContextListener : public cartesiapp::TTSResponseListener {
+        public:
+        explicit BenchContextListener(std::string contextId) : _contextId(std::move(contextId)) {
+        }
+
+        std::atomic<uint64_t> chunks{ 0 };
+        std::atomic<uint64_t> misrouted{ 0 };
+        std::atomic<uint64_t> submittedNs{ 0 };
+        std::atomic<uint64_t> doneNs{ 0 };
+
+        void onConnected() override {
+        }
+
+        void onDisconnected(const std::string& /*reason*/) override {
+        }
+
+        void onNetworkError(const std::string& errorMessage) override {
+            spdlog::error("TTS context {} network error: {}", _contextId, errorMessage);
+        }
+
+        void onAudioChunkReceived(const cartesiapp::response::tts::AudioChunkResponse& /*response*/) override {
+        }
+
+        void onAudioChunkView(const cartesiapp::response::tts::AudioChunkView& chunk) override {
+            if (chunk.context_id != _contextId) {
+                misrouted.fetch_add(1);
+            }
+            chunks.fetch_add(1);
+        }
+
+        void onDoneReceived(const cartesiapp::response::tts::DoneResponse& response) override {
+            if (response.context_id.value_or("") != _contextId) {
+                misrouted.fetch_add(1);
+            }
+            doneNs.store(bench::nowNs());
+        }
+
+        void onWordTimestampsReceived(const cartesiapp::response::tts::WordTimestampsResponse& /*response*/) override {
+        }
+
+        void onPhonemeTimestampsReceived(const cartesiapp::response::tts::PhonemeTimestampsResponse& /*response*/) override {
+        }
+
+        void onFlushDoneReceived(const cartesiapp::response::tts::FlushDoneResponse& /*response*/) override {
+        }
+
+        void onError(const cartesiapp::response::tts::ErrorResponse& response) override {
+            spdlog::error("TTS context {} error: {}", _contextId, response.error);
+        }
+
+        private:
+        std::string _contextId;
+    };
+
+    void printConnectTimings(const cartesiapp::RequestTimings& timings) {
+        auto us = [](auto from, auto to) {
+            return std::chrono::duration<double, std::micro>(to - from).count();
+            };
+        std::printf("\n%s connect: dns %.1f us, tcp %.1f us, tls %.1f us, upgrade %.1f us, %zu B sent, %zu B received\n",
+            timings.endpoint.c_str(),
+            us(timings.start, timings.dns_resolved),
+            us(timings.dns_resolved, timings.tcp_connected),
+            us(timings.tcp_connected, timings.tls_handshake_done),
+            us(timings.tls_handshake_done, timings.completed),
+            timings.bytes_sent,
+            timings.bytes_received);
+    }
+
+    cartesiapp::WebsocketOptions localOptions(unsigned short port) {
+        cartesiapp::WebsocketOptions options;
+        options.host = "127.0.0.1";
+        options.port = std::to_string(port);
+        // the server answers every audio message with its own transcript
+        options.coalesce_binary_messages = false;
+        return options;
+    }
+
+    cartesiapp::request::tts::GenerationRequest makeTTSRequest(long long frames, long long intervalUs, long long chunkBytes, int index) {
+        cartesiapp::request::tts::GenerationRequest request;
+        request.transcript = "frames=" + std::to_string(frames)
+            + ";interval_us=" + std::to_string(intervalUs)
+            + ";bytes=" + std::to_string(chunkBytes);
+        request.context_id = "bench-" + std::to_string(index);
+        request.voice.id = "bench-voice";
+        return request;
+    }
+
+    bool runTTSBenchmarks(const bench::Options& options, unsigned short port) {
+        const long long iterations = options.getInt("iterations", 50);
+        const long long frames = options.getInt("frames", 20);
+        const long long intervalUs = options.getInt("interval-us", 5000);
+        const long long chunkBytes = options.getInt("chunk-bytes", 3840);
+        const long long burstFrames = options.getInt("burst-frames", 20000);
+
+        auto listener = std::make_shared<BenchTTSListener>();
+        cartesiapp::TTSWebsocketClient client("bench-api-key");
+        client.setWebsocketOptions(localOptions(port));
+        client.setRequestTimingsCallback(printConnectTimings);
+        client.registerTTSListener(listener);
+        if (!client.connectAndStart()) {
+            spdlog::error("TTS client failed to connect to the local server.");
+            return false;
+        }
+
+        // paced streams: first chunk latency, jitter and per-frame delivery latency
+        for (long long i = 0; i < iterations; ++i) {
+            listener->beginRequest(static_cast<uint64_t>(intervalUs) * 1000);
+            if (!client.requestTTS(makeTTSRequest(frames, intervalUs, chunkBytes, static_cast<int>(i)))
+                || !listener->waitForDone(std::chrono::seconds(30))) {
+                spdlog::error("TTS latency run failed at iteration {}", i);
+                return false;
+            }
+        }
+        listener->firstChunkLatency.print("TTS request -> first chunk");
+        listener->interChunkJitter.print("TTS inter-chunk jitter (|arrival delta - " + std::to_string(intervalUs) + " us|)");
+        listener->deliveryLatency.print("TTS server write -> onAudioChunkView (paced)");
+
+        // unpaced burst: maximum sustainable frame rate on one connection
+        listener->deliveryLatency = bench::LatencyHistogram();
+        listener->beginRequest(0);
+        if (!client.requestTTS(makeTTSRequest(burstFrames, 0, chunkBytes, -1))
+            || !listener->waitForDone(std::chrono::seconds(120))) {
+            spdlog::error("TTS throughput run failed");
+            return false;
+        }
+        double seconds = static_cast<double>(listener->streamDurationNs()) / 1e9;
+        double framesPerSecond = seconds > 0 ? static_cast<double>(listener->chunks() - 1) / seconds : 0.0;
+        listener->deliveryLatency.print("TTS server write -> onAudioChunkView (burst)");
+        std::printf("\nTTS burst: %llu chunks of %lld bytes in %.3f s -> %.0f frames/s, %.1f MiB/s decoded audio\n",
+            static_cast<unsigned long long>(listener->chunks()), chunkBytes, seconds, framesPerSecond,
+            framesPerSecond * static_cast<double>(chunkBytes) / (1024.0 * 1024.0));
+
+        client.unregisterTTSListener();
+        client.disconnect();
+        return true;
+    }
+
+    bool runSTTBenchmarks(const bench::Options& options, unsigned short port) {
+        const long long frames = options.getInt("stt-frames", 200);
+        const long long frameBytes = std::max<long long>(options.getInt("stt-frame-bytes", 3200), 8);
+        const long long intervalUs = options.getInt("interval-us", 5000);
+        const long long burstFrames = options.getInt("burst-frames", 20000);
+
+        auto listener = std::make_shared<BenchSTTListener>();
+        cartesiapp::STTWebsocketClient client("bench-api-key",
+            cartesiapp::request::stt_model::INK_WHISPER,
+            "en",
+            cartesiapp::request::stt_encoding::PCM_S16LE,
+            cartesiapp::request::sample_rate::SR_16000,
+            0.0f);
+        client.setWebsocketOptions(localOptions(port));
+        client.setRequestTimingsCallback(printConnectTimings);
+        client.registerSTTListener(listener);
+        if (!client.connectAndStart()) {
+            spdlog::error("STT client failed to connect to the local server.");
+            return false;
+        }
+
+        std::vector<char> audio(static_cast<size_t>(frameBytes), 0);
+        auto sendFrames = [&](long long count, long long pacingUs) {
+            auto start = std::chrono::steady_clock::now();
+            for (long long i = 0; i < count; ++i) {
+                if (pacingUs > 0) {
+                    std::this_thread::sleep_until(start + std::chrono::microseconds(pacingUs * i));
+                }
+                writeStamp(audio.data(), bench::nowNs());
+                if (!client.writeAudioBytes(audio.data(), audio.size())) {
+                    return false;
+                }
+            }
+            return true;
+            };
+        auto waitForTranscripts = [&](uint64_t expected) {
+            auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(60);
+            while (listener->transcripts.load() < expected && std::chrono::steady_clock::now() < deadline) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+            return listener->transcripts.load() >= expected;
+            };
+
+        // paced audio: write -> transcript round trip
+        if (!sendFrames(frames, intervalUs) || !waitForTranscripts(static_cast<uint64_t>(frames))) {
+            spdlog::error("STT latency run failed");
+            return false;
+        }
+        listener->roundTripLatency.print("STT writeAudioBytes -> onTranscriptionReceived (paced)");
+        listener->deliveryLatency.print("STT server write -> onTranscriptionReceived (paced)");
+
+        // unpaced audio: write and transcript rates on one connection
+        listener->reset();
+        uint64_t writeStart = bench::nowNs();
+        if (!sendFrames(burstFrames, 0)) {
+            spdlog::error("STT throughput run failed while writing");
+            return false;
+        }
+        double writeSeconds = static_cast<double>(bench::nowNs() - writeStart) / 1e9;
+        if (!waitForTranscripts(static_cast<uint64_t>(burstFrames))) {
+            spdlog::error("STT throughput run timed out waiting for transcripts");
+            return false;
+        }
+        double readSeconds = static_cast<double>(listener->lastTranscriptNs.load() - listener->firstTranscriptNs.load()) / 1e9;
+        listener->roundTripLatency.print("STT writeAudioBytes -> onTranscriptionReceived (burst)");
+        std::printf("\nSTT burst: %lld frames written in %.3f s -> %.0f writes/s, transcripts received at %.0f frames/s\n",
+            burstFrames, writeSeconds, static_cast<double>(burstFrames) / writeSeconds,
+            readSeconds > 0 ? static_cast<double>(burstFrames - 1) / readSeconds : 0.0);
+
+        client.sendDoneRequest();
+        client.unregisterSTTListener();
+        client.disconnect();
+        return true;
+    }
+
+    bool runMultiplexedContextsBenchmark(const bench::Options& options, unsigned short port) {
+        const long long contexts = options.getInt("contexts", 32);
+        const long long maxContexts = options.getInt("max-contexts", 4);
+        const long long frames = options.getInt("frames", 20);
+        const long long chunkBytes = options.getInt("chunk-bytes", 3840);
+        if (contexts <= 0) {
+            return true;
+        }
+
+        cartesiapp::TTSWebsocketClient client("bench-api-key");
+        client.setWebsocketOptions(localOptions(port));
+        cartesiapp::TTSContextManager manager(client, static_cast<size_t>(maxContexts));
+        if (!client.connectAndStart()) {
+            spdlog::error("TTS client failed to connect to the local server.");
+            return false;
+        }
+
+        std::vector<std::shared_ptr<BenchContextListener>> listeners;
+        for (long long i = 0; i < contexts; ++i) {
+            auto request = makeTTSRequest(frames, 0, chunkBytes, static_cast<int>(i));
+            listeners.push_back(std::make_shared<BenchContextListener>(*request.context_id));
+            listeners.back()->submittedNs.store(bench::nowNs());
+            if (!manager.submit(request, listeners.back())) {
+                spdlog::error("Multiplexed run failed to submit context {}", i);
+                return false;
+            }
+        }
+        size_t queued = manager.queuedContexts();
+
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(60);
+        bench::LatencyHistogram requestToDone;
+        uint64_t misrouted = 0;
+        for (auto& listener : listeners) {
+            while (listener->doneNs.load() == 0 && std::chrono::steady_clock::now() < deadline) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+            if (listener->doneNs.load() == 0 || listener->chunks.load() != static_cast<uint64_t>(frames)) {
+                spdlog::error("Multiplexed run timed out or lost chunks ({} of {})", listener->chunks.load(), frames);
+                return false;
+            }
+            requestToDone.record(listener->doneNs.load() - listener->submittedNs.load());
+            misrouted += listener->misrouted.load();
+        }
+        requestToDone.print("TTS submit -> done (" + std::to_string(contexts) + " contexts, "
+            + std::to_string(maxContexts) + " open at once)");
+        std::printf("\nMultiplexed contexts: %zu queued locally at submit, %llu misrouted events\n",
+            queued, static_cast<unsigned long long>(misrouted));
+
+        client.disconnect();
+        return misrouted == 0;
+    }
+
+    bool runPooledSessionsBenchmark(const bench::Options& options, unsigned short port) {
+        const long long poolSize = options.getInt("pool-size", 2);
+        const long long sessions = std::max<long long>(options.getInt("iterations", 50), 1);
+        const long long chunkBytes = options.getInt("chunk-bytes", 3840);
+        if (poolSize <= 0) {
+            return true;
+        }
+
+        cartesiapp::TTSWebsocketPoolOptions poolOptions;
+        poolOptions.size = static_cast<size_t>(poolSize);
+        poolOptions.websocket = localOptions(port);
+        cartesiapp::TTSWebsocketPool pool("bench-api-key", poolOptions);
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+        while (pool.idleConnections() < static_cast<size_t>(poolSize) && std::chrono::steady_clock::now() < deadline) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+
+        // a session: get a connection, synthesize one chunk, hand the connection back
+        auto listener = std::make_shared<BenchTTSListener>();
+        bench::LatencyHistogram acquireLatency;
+        for (long long i = 0; i < sessions; ++i) {
+            uint64_t start = bench::nowNs();
+            auto client = pool.acquire();
+            acquireLatency.record(bench::nowNs() - start);
+            if (!client) {
+                spdlog::error("Pooled session run failed to get a connection");
+                return false;
+            }
+            client->registerTTSListener(listener);
+            listener->beginRequest(0);
+            if (!client->requestTTS(makeTTSRequest(1, 0, chunkBytes, static_cast<int>(i)))
+                || !listener->waitForDone(std::chrono::seconds(30))) {
+                spdlog::error("Pooled session run failed at session {}", i);
+                return false;
+            }
+            pool.release(std::move(client));
+        }
+        acquireLatency.print("TTSWebsocketPool::acquire (" + std::to_string(poolSize) + " warm sockets)");
+        listener->firstChunkLatency.print("TTS request -> first chunk on a pooled socket");
+
+        bench::LatencyHistogram coldConnect;
+        for (long long i = 0; i < std::min<long long>(sessions, 10); ++i) {
+            cartesiapp::TTSWebsocketClient client("bench-api-key");
+            client.setWebsocketOptions(localOptions(port));
+            uint64_t start = bench::nowNs();
+            if (!client.connectAndStart()) {
+                spdlog::error("Cold connect failed");
+                return false;
+            }
+            coldConnect.record(bench::nowNs() - start);
+            client.disconnect();
+        }
+        coldConnect.print("TTSWebsocketClient::connectAndStart (cold, for comparison)");
+        return true;
+    }
+
+    bool runReconnectBenchmark(const bench::Options& options, unsigned short port) {
+        const long long drops = options.getInt("drops", 5);
+        const long long frameBytes = std::max<long long>(options.getInt("stt-frame-bytes", 3200), 16);
+        if (drops <= 0) {
+            return true;
+        }
+
+        auto listener = std::make_shared<BenchReconnectListener>();
+        cartesiapp::STTWebsocketClient client("bench-api-key",
+            cartesiapp::request::stt_model::INK_WHISPER,
+            "en",
+            cartesiapp::request::stt_encoding::PCM_S16LE,
+            cartesiapp::request::sample_rate::SR_16000,
+            0.0f);
+        client.setWebsocketOptions(localOptions(port));
+        cartesiapp::STTReconnectOptions reconnectOptions;
+        reconnectOptions.enabled = true;
+        reconnectOptions.initial_backoff = std::chrono::milliseconds(1);
+        client.setReconnectOptions(reconnectOptions);
+        client.registerSTTListener(listener);
+        if (!client.connectAndStart()) {
+            spdlog::error("STT reconnect run failed to connect to the local server.");
+            return false;
+        }
+
+        auto waitFor = [](const std::atomic<uint64_t>& counter, uint64_t expected) {
+            auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+            while (counter.load() < expected && std::chrono::steady_clock::now() < deadline) {
+                std::this_thread::sleep_for(std::chrono::microseconds(100));
+            }
+            return counter.load() >= expected;
+            };
+
+        std::vector<char> audio(static_cast<size_t>(frameBytes), 0);
+        bench::LatencyHistogram reconnectGap;
+        bench::LatencyHistogram transcriptGap;
+        for (long long i = 0; i < drops; ++i) {
+            uint64_t transcripts = listener->transcripts.load();
+            uint64_t dropNs = bench::nowNs();
+            writeStamp(audio.data(), dropNs);
+            audio[sizeof(uint64_t)] = LocalStreamingServer::DROP_MARKER;
+            // accepted even while the connection is down, the frame is replayed once it is back
+            if (!client.writeAudioBytes(audio.data(), audio.size())
+                || !waitFor(listener->reconnects, static_cast<uint64_t>(i + 1))
+                || !waitFor(listener->transcripts, transcripts + 1)) {
+                spdlog::error("STT reconnect run failed at drop {}", i);
+                return false;
+            }
+            reconnectGap.record(listener->lastReconnectNs.load() - dropNs);
+            transcriptGap.record(listener->lastTranscriptNs.load() - dropNs);
+        }
+        audio[sizeof(uint64_t)] = 0;
+        reconnectGap.print("STT connection drop -> onReconnected (" + std::to_string(drops) + " drops)");
+        transcriptGap.print("STT connection drop -> transcript of the replayed audio");
+
+        // the server closes normally after done, which ends the session instead of starting a reconnect
+        client.sendDoneRequest();
+        bool closed = waitFor(listener->disconnects, 1);
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        client.unregisterSTTListener();
+        client.disconnect();
+        if (!closed || listener->reconnects.load() != static_cast<uint64_t>(drops)) {
+            spdlog::error("STT reconnect run: the close after done {}", closed ? "started a reconnect" : "was not reported");
+            return false;
+        }
+        return true;
+    }
+
+    bool runCompressionBenchmark(const bench::Options& options, unsigned short port) {
+        const long long frames = options.getInt("deflate-frames", 2000);
+        const long long chunkBytes = options.getInt("chunk-bytes", 3840);
+        if (frames <= 0) {
+            return true;
+        }
+
+        std::printf("\nTTS stream of %lld chunks of %lld audio bytes, with and without permessage-deflate:\n", frames, chunkBytes);
+        for (bool deflate : { false, true }) {
+            auto listener = std::make_shared<BenchTTSListener>();
+            cartesiapp::WebsocketOptions websocketOptions = localOptions(port);
+            websocketOptions.compression.enabled = deflate;
+            websocketOptions.record_io_cpu_time = true;
+            cartesiapp::TTSWebsocketClient client("bench-api-key");
+            client.setWebsocketOptions(websocketOptions);
+            client.registerTTSListener(listener);
+            if (!client.connectAndStart()) {
+                spdlog::error("Compression run failed to connect to the local server.");
+                return false;
+            }
+
+            auto before = cartesiapp::metrics::MetricsRegistry::instance().snapshot();
+            auto request = makeTTSRequest(frames, 0, chunkBytes, -1);
+            request.transcript += ";signal=1";
+            listener->beginRequest(0);
+            uint64_t start = bench::nowNs();
+            if (!client.requestTTS(request) || !listener->waitForDone(std::chrono::seconds(60))) {
+                spdlog::error("Compression run failed");
+                return false;
+            }
+            double seconds = static_cast<double>(bench::nowNs() - start) / 1e9;
+            auto after = cartesiapp::metrics::MetricsRegistry::instance().snapshot();
+            client.disconnect();
+
+            uint64_t payload = after.websocket_payload_bytes_received - before.websocket_payload_bytes_received;
+            uint64_t wire = after.websocket_wire_bytes_received - before.websocket_wire_bytes_received;
+            uint64_t cpuNs = after.websocket_io_cpu_ns - before.websocket_io_cpu_ns;
+            std::printf("  deflate %-3s: %llu payload B, %llu wire B (ratio %.2f), I/O CPU %.2f us per chunk, %.0f chunks/s\n",
+                deflate ? "on" : "off",
+                static_cast<unsigned long long>(payload),
+                static_cast<unsigned long long>(wire),
+                wire ? static_cast<double>(payload) / static_cast<double>(wire) : 0.0,
+                static_cast<double>(cpuNs) / 1e3 / static_cast<double>(frames),
+                static_cast<double>(frames) / seconds);
+        }
+        return true;
+    }
+
+    bool runSlowListenerBenchmark(const bench::Options& options, unsigned short port) {
+        const long long frames = options.getInt("slow-frames", 2000);
+        const long long chunkBytes = options.getInt("chunk-bytes", 3840);
+        const long long delayUs = options.getInt("listener-delay-us", 200);
+        if (frames <= 0) {
+            return true;
+        }
+
+        struct Mode {
+            const char* name;
+            bool dispatch;
+            cartesiapp::DispatchOverflowPolicy policy;
+        };
+        const Mode modes[] = {
+            { "inline", false, cartesiapp::DispatchOverflowPolicy::BLOCK },
+            { "block", true, cartesiapp::DispatchOverflowPolicy::BLOCK },
+            { "drop-oldest", true, cartesiapp::DispatchOverflowPolicy::DROP_OLDEST },
+            { "coalesce", true, cartesiapp::DispatchOverflowPolicy::COALESCE_AUDIO },
+        };
+
+        std::printf("\nTTS burst of %lld chunks into a listener taking %lld us per chunk:\n", frames, delayUs);
+        for (const Mode& mode : modes) {
+            auto listener = std::make_shared<BenchSlowTTSListener>(std::chrono::microseconds(delayUs));
+            cartesiapp::ListenerDispatchOptions dispatchOptions;
+            dispatchOptions.enabled = mode.dispatch;
+            dispatchOptions.overflow_policy = mode.policy;
+            cartesiapp::TTSWebsocketClient client("bench-api-key");
+            client.setWebsocketOptions(localOptions(port));
+            client.setListenerDispatchOptions(dispatchOptions);
+            client.registerTTSListener(listener);
+            if (!client.connectAndStart()) {
+                spdlog::error("Slow listener run failed to connect to the local server.");
+                return false;
+            }
+
+            cartesiapp::metrics::MetricsRegistry::instance().reset();
+            listener->beginRequest(0);
+            uint64_t start = bench::nowNs();
+            if (!client.requestTTS(makeTTSRequest(frames, 0, chunkBytes, -1)) || !listener->waitForDone(std::chrono::seconds(120))) {
+                spdlog::error("Slow listener run failed");
+                return false;
+            }
+            double seconds = static_cast<double>(bench::nowNs() - start) / 1e9;
+            auto snapshot = cartesiapp::metrics::MetricsRegistry::instance().snapshot();
+            client.disconnect();
+
+            std::printf("  %-11s: done after %.3f s, %llu callbacks, %.1f%% of the audio, queue p99 %.2f ms, %llu dropped, %llu coalesced\n",
+                mode.name,
+                seconds,
+                static_cast<unsigned long long>(listener->chunks()),
+                100.0 * static_cast<double>(listener->audioBytes()) / static_cast<double>(frames * chunkBytes),
+                static_cast<double>(snapshot.listener_queue_latency_ns.valueAtPercentile(99.0)) / 1e6,
+                static_cast<unsigned long long>(snapshot.listener_frames_dropped),
+                static_cast<unsigned long long>(snapshot.listener_frames_coalesced));
+        }
+        return true;
+    }
+
+    bool runEventQueueBenchmark(const bench::Options& options, unsigned short port) {
+        const long long frames = options.getInt("queue-frames", 2000);
+        const long long chunkBytes = options.getInt("chunk-bytes", 3840);
+        if (frames <= 0) {
+            return true;
+        }
+
+        cartesiapp::TTSWebsocketClient client("bench-api-key");
+        client.setWebsocketOptions(localOptions(port));
+        // room for the whole stream, so the run measures polling rather than drops
+        cartesiapp::TTSEventQueue events(client, static_cast<size_t>(frames) + 16);
+        if (!client.connectAndStart()) {
+            spdlog::error("Event queue run failed to connect to the local server.");
+            return false;
+        }
+
+        bench::LatencyHistogram deliveryLatency;
+        uint64_t chunks = 0;
+        uint64_t batches = 0;
+        bool done = false;
+        bool failed = false;
+        auto visit = [&](cartesiapp::TTSEvent& event) {
+            if (auto* chunk = std::get_if<cartesiapp::response::tts::AudioChunkResponse>(&event)) {
+                if (chunk->data.size() >= sizeof(uint64_t)) {
+                    deliveryLatency.record(bench::nowNs() - readStamp(chunk->data.data()));
+                }
+                chunks++;
+            }
+            else if (std::holds_alternative<cartesiapp::response::tts::DoneResponse>(event)) {
+                done = true;
+            }
+            else if (std::holds_alternative<cartesiapp::connection_events::NetworkError>(event)) {
+                failed = true;
+            }
+            };
+
+        // a consumer loop polling like a render thread: wait for the first event, then drain what has piled up
+        if (!client.requestTTS(makeTTSRequest(frames, 0, chunkBytes, -1))) {
+            spdlog::error("Event queue run failed");
+            return false;
+        }
+        cartesiapp::TTSEvent event;
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(60);
+        while (!done && !failed && std::chrono::steady_clock::now() < deadline) {
+            if (!events.popFor(event, std::chrono::milliseconds(100))) {
+                continue;
+            }
+            visit(event);
+            events.drain(visit);
+            batches++;
+        }
+        client.disconnect();
+        if (!done) {
+            spdlog::error("Event queue run did not complete");
+            return false;
+        }
+
+        deliveryLatency.print("TTS server write -> TTSEventQueue consumer (burst)");
+        std::printf("\nTTSEventQueue: %llu chunks in %llu wake-ups (%.1f events per wake-up), %llu dropped\n",
+            static_cast<unsigned long long>(chunks),
+            static_cast<unsigned long long>(batches),
+            batches ? static_cast<double>(chunks) / static_cast<double>(batches) : 0.0,
+            static_cast<unsigned long long>(events.droppedEvents()));
+        return true;
+    }
+
+    bool runDeadPeerBenchmark(const bench::Options& options, unsigned short port) {
+        const long long stalls = options.getInt("stalls", 5);
+        const long long idleTimeoutMs = options.getInt("idle-timeout-ms", 300);
+        if (stalls <= 0) {
+            return true;
+        }
+
+        cartesiapp::WebsocketOptions websocketOptions = localOptions(port);
+        websocketOptions.ping_interval = std::chrono::milliseconds(std::max<long long>(idleTimeoutMs / 3, 1));
+        websocketOptions.idle_timeout = std::chrono::milliseconds(idleTimeoutMs);
+        websocketOptions.handshake_timeout = std::chrono::milliseconds(idleTimeoutMs);
+
+        // round trip time of the keepalive pings on an idle connection
+        {
+            auto listener = std::make_shared<BenchTTSListener>();
+            cartesiapp::TTSWebsocketClient client("bench-api-key");
+            client.setWebsocketOptions(websocketOptions);
+            client.registerTTSListener(listener);
+            if (!client.connectAndStart()) {
+                spdlog::error("Dead peer run failed to connect to the local server.");
+                return false;
+            }
+            auto before = cartesiapp::metrics::MetricsRegistry::instance().snapshot();
+            std::this_thread::sleep_for(websocketOptions.ping_interval * 10);
+            auto after = cartesiapp::metrics::MetricsRegistry::instance().snapshot();
+            bool alive = client.isConnectedAndStarted();
+            std::printf("\nIdle connection pinged every %lld ms: %llu pongs, latest ping RTT %.1f us, %s\n",
+                static_cast<long long>(websocketOptions.ping_interval.count()),
+                static_cast<unsigned long long>(after.websocket_ping_rtt_ns.count - before.websocket_ping_rtt_ns.count),
+                static_cast<double>(client.pingRoundTripTime().count()) / 1e3,
+                alive ? "still connected" : "dropped");
+            client.disconnect();
+            if (!alive) {
+                spdlog::error("A live but idle connection hit the idle timeout");
+                return false;
+            }
+        }
+
+        // the server stops reading mid-session: no frames, no pongs
+        bench::LatencyHistogram detection;
+        for (long long i = 0; i < stalls; ++i) {
+            auto listener = std::make_shared<BenchDeadPeerListener>();
+            cartesiapp::TTSWebsocketClient client("bench-api-key");
+            client.setWebsocketOptions(websocketOptions);
+            client.registerTTSListener(listener);
+            if (!client.connectAndStart()) {
+                spdlog::error("Dead peer run failed to connect to the local server.");
+                return false;
+            }
+            cartesiapp::request::tts::GenerationRequest request = makeTTSRequest(0, 0, 0, static_cast<int>(i));
+            request.transcript = "stall_ms=" + std::to_string(idleTimeoutMs * 10);
+            uint64_t start = bench::nowNs();
+            client.requestTTS(request);
+            uint64_t errorNs = listener->waitForError(std::chrono::milliseconds(idleTimeoutMs * 5));
+            client.disconnect();
+            if (errorNs == 0) {
+                spdlog::error("Unresponsive server not detected within {} ms", idleTimeoutMs * 5);
+                return false;
+            }
+            detection.record(errorNs - start);
+        }
+        detection.print("Server stops responding -> onNetworkError (idle timeout " + std::to_string(idleTimeoutMs) + " ms)");
+
+        // a server that accepts the TCP connection and never answers the TLS handshake
+        SilentServer silentServer;
+        cartesiapp::WebsocketOptions silentOptions = websocketOptions;
+        silentOptions.port = std::to_string(silentServer.port());
+        cartesiapp::TTSWebsocketClient client("bench-api-key");
+        client.setWebsocketOptions(silentOptions);
+        uint64_t start = bench::nowNs();
+        bool connected = client.connectAndStart();
+        std::printf("\nConnect to a server that never completes the handshake: %s after %.1f ms (handshake timeout %lld ms)\n",
+            connected ? "connected" : "failed",
+            static_cast<double>(bench::nowNs() - start) / 1e6,
+            static_cast<long long>(silentOptions.handshake_timeout.count()));
+        return !connected;
+    }
+
+    bool runAudioFramingBenchmark(const bench::Options& options, unsigned short port) {
+        const long long writes = options.getInt("framing-writes", 2000);
+        const long long pacedMs = options.getInt("paced-ms", 1000);
+        if (writes <= 0) {
+            return true;
+        }
+        // 10 ms of 16 kHz pcm_s16le, a typical capture buffer
+        const size_t writeBytes = 320;
+
+        // writes `count` buffers, then waits for the flush_done answering the finalize request behind them
+        auto upload = [&](const cartesiapp::STTAudioFramingOptions& framing, long long count, const std::string& label) {
+            auto listener = std::make_shared<BenchFramingListener>();
+            cartesiapp::STTWebsocketClient client("bench-api-key",
+                cartesiapp::request::stt_model::INK_WHISPER,
+                "en",
+                cartesiapp::request::stt_encoding::PCM_S16LE,
+                cartesiapp::request::sample_rate::SR_16000,
+                0.0f);
+            client.setWebsocketOptions(localOptions(port));
+            client.setAudioFramingOptions(framing);
+            client.registerSTTListener(listener);
+            if (!client.connectAndStart()) {
+                spdlog::error("STT framing run failed to connect to the local server.");
+                return false;
+            }
+            auto before = cartesiapp::metrics::MetricsRegistry::instance().snapshot();
+            std::vector<char> audio(writeBytes, 0);
+            uint64_t start = bench::nowNs();
+            for (long long i = 0; i < count; ++i) {
+                writeStamp(audio.data(), bench::nowNs());
+                if (!client.writeAudioBytes(audio.data(), audio.size())) {
+                    spdlog::error("STT framing run failed while writing");
+                    return false;
+                }
+            }
+            client.sendFinalizeRequest();
+            auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(60);
+            while (listener->flushes.load() == 0 && std::chrono::steady_clock::now() < deadline) {
+                std::this_thread::sleep_for(std::chrono::microseconds(100));
+            }
+            uint64_t elapsed = bench::nowNs() - start;
+            auto after = cartesiapp::metrics::MetricsRegistry::instance().snapshot();
+            client.unregisterSTTListener();
+            client.disconnect();
+            if (listener->flushes.load() == 0) {
+                spdlog::error("STT framing run timed out waiting for flush_done");
+                return false;
+            }
+            if (!framing.realtime_pacing) {
+                listener->roundTripLatency.print("STT writeAudioBytes -> onTranscriptionReceived (" + label + ")");
+            }
+            std::printf("\nSTT %s: %lld writes of %.0f ms sent as %llu messages, finalize acknowledged after %.1f ms\n",
+                label.c_str(),
+                count,
+                static_cast<double>(writeBytes) / 32.0,
+                static_cast<unsigned long long>(after.websocket_messages_sent - before.websocket_messages_sent - 1),
+                static_cast<double>(elapsed) / 1e6);
+            return true;
+            };
+
+        cartesiapp::STTAudioFramingOptions framing;
+        if (!upload(framing, writes, "as written")) {
+            return false;
+        }
+        framing.enabled = true;
+        framing.frame_duration = std::chrono::milliseconds(40);
+        if (!upload(framing, writes, "40 ms frames")) {
+            return false;
+        }
+        if (pacedMs <= 0) {
+            return true;
+        }
+        framing.frame_duration = std::chrono::milliseconds(100);
+        framing.realtime_pacing = true;
+        return upload(framing, pacedMs / 10, std::to_string(pacedMs) + " ms file, 100 ms frames paced in real time");
+    }
+
+    bool runSilenceSuppressionBenchmark(const bench::Options& options, unsigned short port) {
+        const long long seconds = options.getInt("silence-seconds", 40);
+        if (seconds <= 0) {
+            return true;
+        }
+
+        // a caller speaking for 1.5 s, then pausing for 2.5 s over a -70 dBFS noise floor
+        auto signalAt = [](long long sample, int sampleRate, uint32_t& noise) {
+            noise = noise * 1664525u + 1013904223u;
+            double floor = 0.0003 * (static_cast<double>(noise >> 8) / static_cast<double>(1u << 24) - 0.5) * 2.0;
+            double t = static_cast<double>(sample) / sampleRate;
+            bool speaking = std::fmod(t, 4.0) < 1.5;
+            return floor + (speaking ? 0.3 * std::sin(2.0 * 3.14159265358979323846 * 220.0 * t) : 0.0);
+            };
+
+        struct Encoding {
+            std::string name;
+            int sampleRate;
+        };
+        const Encoding encodings[] = {
+            { cartesiapp::request::stt_encoding::PCM_S16LE, cartesiapp::request::sample_rate::SR_16000 },
+            { cartesiapp::request::stt_encoding::PCM_F32LE, cartesiapp::request::sample_rate::SR_16000 },
+            { cartesiapp::request::stt_encoding::PCM_MULAW, cartesiapp::request::sample_rate::SR_8000 },
+        };
+        for (const Encoding& encoding : encodings) {
+            // the whole stream is synthesized up front so that the write loop only times the client
+            const int sampleBytes = encoding.name == cartesiapp::request::stt_encoding::PCM_F32LE ? 4
+                : encoding.name == cartesiapp::request::stt_encoding::PCM_MULAW ? 1 : 2;
+            const long long samples = seconds * encoding.sampleRate;
+            std::vector<char> audio(static_cast<size_t>(samples * sampleBytes));
+            uint32_t noise = 12345;
+            for (long long i = 0; i < samples; ++i) {
+                double value = signalAt(i, encoding.sampleRate, noise);
+                char* out = audio.data() + i * sampleBytes;
+                if (sampleBytes == 4) {
+                    float sample = static_cast<float>(value);
+                    std::memcpy(out, &sample, sizeof(sample));
+                }
+                else {
+                    auto sample = static_cast<int16_t>(std::lround(value * 32767.0));
+                    if (sampleBytes == 1) {
+                        out[0] = static_cast<char>(encodeMulaw(sample));
+                    }
+                    else {
+                        std::memcpy(out, &sample, sizeof(sample));
+                    }
+                }
+            }
+
+            auto listener = std::make_shared<BenchCountingSTTListener>();
+            cartesiapp::STTWebsocketClient client("bench-api-key",
+                cartesiapp::request::stt_model::INK_WHISPER,
+                "en",
+                encoding.name,
+                encoding.sampleRate,
+                0.0f);
+            client.setWebsocketOptions(localOptions(port));
+            cartesiapp::STTSilenceSuppressionOptions suppression;
+            suppression.enabled = true;
+            client.setSilenceSuppressionOptions(suppression);
+            client.registerSTTListener(listener);
+            if (!client.connectAndStart()) {
+                spdlog::error("STT silence suppression run failed to connect to the local server.");
+                return false;
+            }
+            auto before = cartesiapp::metrics::MetricsRegistry::instance().snapshot();
+            // 10 ms writes, as a capture device delivers them
+            const size_t writeBytes = static_cast<size_t>(encoding.sampleRate / 100 * sampleBytes);
+            uint64_t start = bench::nowNs();
+            for (size_t offset = 0; offset < audio.size(); offset += writeBytes) {
+                if (!client.writeAudioBytes(audio.data() + offset, std::min(writeBytes, audio.size() - offset))) {
+                    spdlog::error("STT silence suppression run failed while writing");
+                    return false;
+                }
+            }
+            uint64_t writeNs = bench::nowNs() - start;
+            client.sendFinalizeRequest();
+            auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(60);
+            while (listener->flushes.load() == 0 && std::chrono::steady_clock::now() < deadline) {
+                std::this_thread::sleep_for(std::chrono::microseconds(100));
+            }
+            auto after = cartesiapp::metrics::MetricsRegistry::instance().snapshot();
+            cartesiapp::STTSilenceSuppressionStats stats = client.silenceSuppressionStats();
+            client.unregisterSTTListener();
+            client.disconnect();
+            if (listener->flushes.load() == 0) {
+                spdlog::error("STT silence suppression run timed out waiting for flush_done");
+                return false;
+            }
+            uint64_t sent = after.websocket_payload_bytes_sent - before.websocket_payload_bytes_sent;
+            std::printf("\nSTT silence suppression, %s at %d Hz: %lld s written, %.1f s suppressed (%.0f%%), %llu of %zu bytes sent, %.0f ns per 10 ms write\n",
+                encoding.name.c_str(),
+                encoding.sampleRate,
+                seconds,
+                stats.seconds_suppressed,
+                100.0 * stats.seconds_suppressed / static_cast<double>(seconds),
+                static_cast<unsigned long long>(sent),
+                audio.size(),
+                static_cast<double>(writeNs) / static_cast<double>(seconds * 100));
+        }
+        return true;
+    }
+
+    bool runEndpointingBenchmark(const bench::Options& options, unsigned short port) {
+        const long long utterances = options.getInt("utterances", 5);
+        const long long trailingSilenceMs = options.getInt("trailing-silence-ms", 300);
+        if (utterances <= 0) {
+            return true;
+        }
+
+        auto listener = std::make_shared<BenchCountingSTTListener>();
+        cartesiapp::STTWebsocketClient client("bench-api-key",
+            cartesiapp::request::stt_model::INK_WHISPER,
+            "en",
+            cartesiapp::request::stt_encoding::PCM_S16LE,
+            cartesiapp::request::sample_rate::SR_16000,
+            0.0f);
+        client.setWebsocketOptions(localOptions(port));
+        cartesiapp::STTEndpointingOptions endpointing;
+        endpointing.enabled = true;
+        endpointing.trailing_silence = std::chrono::milliseconds(trailingSilenceMs);
+        client.setEndpointingOptions(endpointing);
+        client.registerSTTListener(listener);
+        if (!client.connectAndStart()) {
+            spdlog::error("STT endpointing run failed to connect to the local server.");
+            return false;
+        }
+
+        // 10 ms writes at the pace of a live microphone: 600 ms of a tone, then silence until the utterance is finalized
+        std::vector<int16_t> speech(160);
+        std::vector<int16_t> silence(160, 0);
+        bench::LatencyHistogram endOfSpeech;
+        auto next = std::chrono::steady_clock::now();
+        long long sample = 0;
+        for (long long i = 0; i < utterances; ++i) {
+            for (int write = 0; write < 60; ++write) {
+                for (auto& value : speech) {
+                    value = static_cast<int16_t>(8000.0 * std::sin(2.0 * 3.14159265358979323846 * 220.0 * static_cast<double>(sample++) / 16000.0));
+                }
+                std::this_thread::sleep_until(next += std::chrono::milliseconds(10));
+                client.writeAudioBytes(reinterpret_cast<const char*>(speech.data()), speech.size() * sizeof(int16_t));
+            }
+            uint64_t flushes = listener->flushes.load();
+            uint64_t speechEndNs = 0;
+            auto deadline = next + std::chrono::milliseconds(trailingSilenceMs + 1000);
+            while (listener->flushes.load() == flushes && next < deadline) {
+                std::this_thread::sleep_until(next += std::chrono::milliseconds(10));
+                speechEndNs = speechEndNs ? speechEndNs : bench::nowNs();
+                client.writeAudioBytes(reinterpret_cast<const char*>(silence.data()), silence.size() * sizeof(int16_t));
+            }
+            if (listener->flushes.load() == flushes) {
+                spdlog::error("STT endpointing run: utterance {} was not finalized", i);
+                client.disconnect();
+                return false;
+            }
+            endOfSpeech.record(listener->lastFlushNs.load() - speechEndNs);
+        }
+        client.unregisterSTTListener();
+        client.disconnect();
+        endOfSpeech.print("STT end of speech -> flush_done (local endpointing, trailing silence " + std::to_string(trailingSilenceMs) + " ms)");
+        return true;
+    }
+
+    bool runSharedEngineBenchmark(const bench::Options& options, unsigned short port) {
+        const long long sessions = options.getInt("sessions", 64);
+        const long long frames = options.getInt("session-frames", 50);
+        const long long intervalUs = options.getInt("interval-us", 5000);
+        if (sessions <= 0) {
+            return true;
+        }
+
+        auto engine = std::make_shared<cartesiapp::IoEngine>(static_cast<size_t>(options.getInt("io-threads", 0)));
+        std::vector<std::shared_ptr<BenchSTTListener>> listeners;
+        std::vector<std::unique_ptr<cartesiapp::STTWebsocketClient>> clients;
+        for (long long i = 0; i < sessions; ++i) {
+            listeners.push_back(std::make_shared<BenchSTTListener>());
+            clients.push_back(std::make_unique<cartesiapp::STTWebsocketClient>("bench-api-key",
+                cartesiapp::request::stt_model::INK_WHISPER,
+                "en",
+                cartesiapp::request::stt_encoding::PCM_S16LE,
+                cartesiapp::request::sample_rate::SR_16000,
+                0.0f));
+            clients.back()->setWebsocketOptions(localOptions(port));
+            clients.back()->setIoEngine(engine);
+            clients.back()->registerSTTListener(listeners.back());
+            if (!clients.back()->connectAndStart()) {
+                spdlog::error("STT session {} failed to connect to the local server.", i);
+                return false;
+            }
+        }
+
+        // every tick writes one frame to each session, a paced audio source per session
+        std::vector<char> audio(3200, 0);
+        auto start = std::chrono::steady_clock::now();
+        for (long long frame = 0; frame < frames; ++frame) {
+            std::this_thread::sleep_until(start + std::chrono::microseconds(intervalUs * frame));
+            for (auto& client : clients) {
+                writeStamp(audio.data(), bench::nowNs());
+                if (!client->writeAudioBytes(audio.data(), audio.size())) {
+                    spdlog::error("Shared engine run failed while writing");
+                    return false;
+                }
+            }
+        }
+
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(60);
+        bench::LatencyHistogram roundTrip;
+        for (size_t i = 0; i < clients.size(); ++i) {
+            while (listeners[i]->transcripts.load() < static_cast<uint64_t>(frames) && std::chrono::steady_clock::now() < deadline) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+            if (listeners[i]->transcripts.load() < static_cast<uint64_t>(frames)) {
+                spdlog::error("Shared engine run timed out waiting for the transcripts of session {}", i);
+                return false;
+            }
+            clients[i]->unregisterSTTListener();
+            clients[i]->disconnect();
+            roundTrip.merge(listeners[i]->roundTripLatency);
+        }
+        roundTrip.print("STT writeAudioBytes -> onTranscriptionReceived (" + std::to_string(sessions) + " sessions on "
+            + std::to_string(engine->threadCount()) + " I/O threads)");
+        return true;
+    }
+}
+
+int main(int ac, char** av) {
+    spdlog::set_level(spdlog::level::warn);
+
+    bench::Options options(ac, av);
+    LocalStreamingServer server;
+    std::printf("Local streaming server listening on 127.0.0.1:%u\n", server.port());
+
+    bool ok = runTTSBenchmarks(options, server.port());
+    ok = runSTTBenchmarks(options, server.port()) && ok;
+    ok = runMultiplexedContextsBenchmark(options, server.port()) && ok;
+    ok = runPooledSessionsBenchmark(options, server.port()) && ok;
+    ok = runReconnectBenchmark(options, server.port()) && ok;
+    ok = runCompressionBenchmark(options, server.port()) && ok;
+    ok = runSlowListenerBenchmark(options, server.port()) && ok;
+    ok = runEventQueueBenchmark(options, server.port()) && ok;
+    ok = runDeadPeerBenchmark(options, server.port()) && ok;
+    ok = runAudioFramingBenchmark(options, server.port()) && ok;
+    ok = runSilenceSuppressionBenchmark(options, server.port()) && ok;
+    ok = runEndpointingBenchmark(options, server.port()) && ok;
+    ok = runSharedEngineBenchmark(options, server.port()) && ok;
+
+    if (options.has("metrics")) {
+        std::printf("\n%s", cartesiapp::metrics::toPrometheusText(cartesiapp::metrics::MetricsRegistry::instance().snapshot()).c_str());
+    }
+
+    return ok ? 0 : -1;
+}
@@ -0,0 +1,225 @@
+/**
+ * @file bench_common.hpp
+ * @brief Shared helpers for the CartesiaPP benchmark applications
+ *
+ * Provides:
+ * - A log-linear (HDR-style) latency histogram with percentile reporting
+ * - Monotonic clock helpers
+ * - Minimal command line option parsing
+ */
+
+#ifndef CARTESIAPP_BENCH_COMMON_HPP
+#define CARTESIAPP_BENCH_COMMON_HPP
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace bench {
+
+    /**
+     * @brief Nanoseconds on the monotonic clock, comparable across threads of the same process.
+     */
+    inline uint64_t nowNs() {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count());
+    }
+
+    /**
+     * @brief Log-linear histogram in the spirit of HdrHistogram.
+     *
+     * Values below 2^SUB_BUCKET_BITS are stored exactly, larger values are grouped by power of two
+     * and split into 2^SUB_BUCKET_BITS linear sub-buckets, which bounds the relative error to ~0.8%.
+     */
+    class LatencyHistogram {
+        public:
+        static constexpr int SUB_BUCKET_BITS = 7;
+        static constexpr uint64_t SUB_BUCKET_COUNT = uint64_t(1) << SUB_BUCKET_BITS;
+
+        LatencyHistogram() : _counts((64 - SUB_BUCKET_BITS + 1) * SUB_BUCKET_COUNT, 0) {
+        }
+
+        void record(uint64_t value) {
+            _counts[indexOf(value)]++;
+            _totalCount++;
+            _sum += value;
+            _min = std::min(_min, value);
+            _max = std::max(_max, value);
+        }
+
+        /**
+         * @brief Adds the samples of another histogram, e.g. one recorded per thread.
+         */
+        void merge(const LatencyHistogram& other) {
+            for (size_t i = 0; i < _counts.size(); ++i) {
+                _counts[i] += other._counts[i];
+            }
+            _totalCount += other._totalCount;
+            _sum += other._sum;
+            _min = std::min(_min, other._min);
+            _max = std::max(_max, other._max);
+        }
+
+        uint64_t count() const {
+            return _totalCount;
+        }
+
+        uint64_t max() const {
+            return _max;
+        }
+
+        double mean() const {
+            return _totalCount ? static_cast<double>(_sum) / static_cast<double>(_totalCount) : 0.0;
+        }
+
+        uint64_t valueAtPercentile(double percentile) const {
+            if (_totalCount == 0) {
+                return 0;
+            }
+            uint64_t target = static_cast<uint64_t>((percentile / 100.0) * static_cast<double>(_totalCount) + 0.5);
+            target = std::max<uint64_t>(1, std::min(target, _totalCount));
+            uint64_t cumulative = 0;
+            for (size_t i = 0; i < _counts.size(); ++i) {
+                cumulative += _counts[i];
+                if (cumulative >= target) {
+                    return std::min(highestEquivalentValue(i), _max);
+                }
+            }
+            return _max;
+        }
+
+        /**
+         * @brief Prints summary percentiles and an HDR-style percentile distribution.
+         * @param title Name of the measured quantity.
+         * @param unitScale Divisor applied to recorded values (1e3 prints microseconds for ns input).
+         * @param unitName Unit label.
+         */
+        void print(const std::string& title, double unitScale = 1e3, const char* unitName = "us") const {
+            std::printf("\n=== %s (%llu samples, unit: %s) ===\n", title.c_str(),
+                static_cast<unsigned long long>(_totalCount), unitName);
+            if (_totalCount == 0) {
+                std::printf("  no samples\n");
+                return;
+            }
+            std::printf("  min %.3f  mean %.3f  p50 %.3f  p90 %.3f  p99 %.3f  p99.9 %.3f  max %.3f\n",
+                static_cast<double>(_min) / unitScale,
+                mean() / unitScale,
+                static_cast<double>(valueAtPercentile(50.0)) / unitScale,
+                static_cast<double>(valueAtPercentile(90.0)) / unitScale,
+                static_cast<double>(valueAtPercentile(99.0)) / unitScale,
+                static_cast<double>(valueAtPercentile(99.9)) / unitScale,
+                static_cast<double>(_max) / unitScale);
+            std::printf("  %14s %14s %12s %16s\n", "Value", "Percentile", "TotalCount", "1/(1-Percentile)");
+
+            // percentile ticks halve the remaining distance to 100%, as in HdrHistogram's output
+            double percentile = 0.0;
+            double remaining = 100.0;
+            while (true) {
+                uint64_t value = valueAtPercentile(percentile);
+                uint64_t cumulative = countAtOrBelow(value);
+                double fraction = static_cast<double>(cumulative) / static_cast<double>(_totalCount);
+                if (fraction >= 1.0) {
+                    std::printf("  %14.3f %14.6f %12llu %16s\n", static_cast<double>(_max) / unitScale, 1.0,
+                        static_cast<unsigned long long>(_totalCount), "inf");
+                    break;
+                }
+                std::printf("  %14.3f %14.6f %12llu %16.2f\n", static_cast<double>(value) / unitScale, fraction,
+                    static_cast<unsigned long long>(cumulative), 1.0 / (1.0 - fraction));
+                remaining /= 2.0;
+                percentile = 100.0 - remaining;
+            }
+        }
+
+        private:
+        static int bitWidth(uint64_t value) {
+            int width = 0;
+            while (value) {
+                ++width;
+                value >>= 1;
+            }
+            return width;
+        }
+
+        static size_t indexOf(uint64_t value) {
+            if (value < SUB_BUCKET_COUNT) {
+                return static_cast<size_t>(value);
+            }
+            int shift = bitWidth(value) - 1 - SUB_BUCKET_BITS;
+            uint64_t subBucket = (value >> shift) - SUB_BUCKET_COUNT;
+            return static_cast<size_t>((static_cast<uint64_t>(shift) + 1) * SUB_BUCKET_COUNT + subBucket);
+        }
+
+        static uint64_t lowestEquivalentValue(size_t index) {
+            if (index < SUB_BUCKET_COUNT) {
+                return index;
+            }
+            uint64_t shift = index / SUB_BUCKET_COUNT - 1;
+            uint64_t subBucket = index % SUB_BUCKET_COUNT + SUB_BUCKET_COUNT;
+            return subBucket << shift;
+        }
+
+        static uint64_t highestEquivalentValue(size_t index) {
+            if (index < SUB_BUCKET_COUNT) {
+                return index;
+            }
+            uint64_t shift = index / SUB_BUCKET_COUNT - 1;
+            return lowestEquivalentValue(index) + ((uint64_t(1) << shift) - 1);
+        }
+
+        uint64_t countAtOrBelow(uint64_t value) const {
+            uint64_t cumulative = 0;
+            size_t last = indexOf(value);
+            for (size_t i = 0; i <= last; ++i) {
+                cumulative += _counts[i];
+            }
+            return cumulative;
+        }
+
+        std::vector<uint64_t> _counts;
+        uint64_t _totalCount = 0;
+        uint64_t _sum = 0;
+        uint64_t _min = UINT64_MAX;
+        uint64_t _max = 0;
+    };
+
+    /**
+     * @brief Parses "--name=value" arguments into a map, bare "--flag" maps to "1".
+     */
+    class Options {
+        public:
+        Options(int ac, char** av) {
+            for (int i = 1; i < ac; ++i) {
+                std::string arg = av[i];
+                if (arg.rfind("--", 0) != 0) {
+                    continue;
+                }
+                auto eq = arg.find('=');
+                if (eq == std::string::npos) {
+                    _values[arg.substr(2)] = "1";
+                }
+                else {
+                    _values[arg.substr(2, eq - 2)] = arg.substr(eq + 1);
+                }
+            }
+        }
+
+        long long getInt(const std::string& name, long long defaultValue) const {
+            auto it = _values.find(name);
+            return it == _values.end() ? defaultValue : std::atoll(it->second.c_str());
+        }
+
+        bool has(const std::string& name) const {
+            return _values.count(name) > 0;
+        }
+
+        private:
+        std::map<std::string, std::string> _values;
+    };
+}
+
+#endif // CARTESIAPP_BENCH_COMMON_HPP
@@ -9,6 +9,7 @@
 
 #include "cartesiapp_request.hpp"
 #include "cartesiapp_response.hpp"
+#include "cartesiapp_timings.hpp"
 
 namespace cartesiapp {
 
@@ -30,6 +31,20 @@ namespace cartesiapp {
          */
         void overrideApiVersion(const std::string& apiVersion);
 
+        /**
+         * @brief Registers a hook receiving the timing breakdown (DNS, connect, TLS, upload, server time,
+         * download, bytes on the wire) of every subsequent REST call, including failed ones.
+         * @param callback The hook to invoke, or an empty function to disable it.
+         */
+        void setRequestTimingsCallback(RequestTimingsCallback callback);
+
+        /**
+         * @brief Sets the memory resource the voice lists and transcription word timings returned by this
+         * client are allocated from.
+         * @param resource The resource to use, or nullptr for std::pmr::get_default_resource(). Must outlive the returned responses.
+         */
+        void setMemoryResource(std::pmr::memory_resource* resource);
+
         /**
          * @brief Retrieves the current API key being used.
          * @return The API key string.
@@ -0,0 +1,503 @@
+#ifndef CARTESIAPP_METRICS_HPP
+#define CARTESIAPP_METRICS_HPP
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "cartesiapp_export.hpp"
+#include "cartesiapp_timings.hpp"
+
+namespace cartesiapp {
+
+    /**
+     * @brief Namespace for the library's built-in, process-wide instrumentation
+     */
+    namespace metrics {
+
+        /**
+         * @brief API endpoints tracked separately by the request latency histograms.
+         */
+        enum class Endpoint : size_t {
+            API_INFO,
+            VOICES,
+            TTS_BYTES,
+            STT,
+            TTS_WEBSOCKET,
+            STT_WEBSOCKET,
+            OTHER,
+            COUNT
+        };
+
+        constexpr size_t ENDPOINT_COUNT = static_cast<size_t>(Endpoint::COUNT);
+
+        /**
+         * @brief Highest HTTP status code tracked individually, larger codes are counted under 0.
+         */
+        constexpr int MAX_STATUS_CODE = 599;
+
+        /**
+         * @brief Returns the API path of an endpoint, e.g. "/tts/bytes".
+         */
+        CARTESIAPP_EXPORT const char* endpointPath(Endpoint endpoint);
+
+        /**
+         * @brief Maps an API path (as found in RequestTimings::endpoint) to its endpoint, query strings and
+         * path parameters such as a voice id are ignored.
+         */
+        CARTESIAPP_EXPORT Endpoint endpointFromPath(const std::string& path);
+
+        /**
+         * @brief Monotonically increasing counter, padded to its own cache line so concurrent writers of
+         * neighbouring counters do not contend.
+         */
+        class alignas(64) Counter {
+            public:
+            void add(uint64_t value = 1) noexcept {
+                _value.fetch_add(value, std::memory_order_relaxed);
+            }
+
+            uint64_t value() const noexcept {
+                return _value.load(std::memory_order_relaxed);
+            }
+
+            void reset() noexcept {
+                _value.store(0, std::memory_order_relaxed);
+            }
+
+            private:
+            std::atomic<uint64_t> _value{ 0 };
+        };
+
+        /**
+         * @brief Value that can go up and down, e.g. the number of open connections.
+         */
+        class alignas(64) Gauge {
+            public:
+            void add(int64_t value = 1) noexcept {
+                _value.fetch_add(value, std::memory_order_relaxed);
+            }
+
+            void sub(int64_t value = 1) noexcept {
+                _value.fetch_sub(value, std::memory_order_relaxed);
+            }
+
+            int64_t value() const noexcept {
+                return _value.load(std::memory_order_relaxed);
+            }
+
+            void reset() noexcept {
+                _value.store(0, std::memory_order_relaxed);
+            }
+
+            private:
+            std::atomic<int64_t> _value{ 0 };
+        };
+
+        /**
+         * @brief Point-in-time copy of a Histogram.
+         */
+        struct CARTESIAPP_EXPORT HistogramSnapshot {
+            uint64_t count = 0;
+            uint64_t sum = 0;
+            uint64_t max = 0;
+
+            /**
+             * @brief Per-bucket counts, see Histogram for the bucket layout.
+             */
+            std::vector<uint64_t> buckets;
+
+            double mean() const;
+
+            /**
+             * @brief Returns the upper bound of the bucket holding the given percentile (0-100).
+             */
+            uint64_t valueAtPercentile(double percentile) const;
+        };
+
+        /**
+         * @brief Lock-free log-linear histogram.
+         *
+         * Values below 2^SUB_BUCKET_BITS are stored exactly, larger values are grouped by power of two and
+         * split into 2^SUB_BUCKET_BITS linear sub-buckets, bounding the relative error to ~3%. Values above
+         * MAX_VALUE (about 18 minutes in nanoseconds) are clamped. Recording is a handful of relaxed atomic
+         * increments, so concurrent recorders never block each other; a snapshot taken while recording is in
+         * progress may be off by the in-flight samples.
+         */
+        class CARTESIAPP_EXPORT Histogram {
+            public:
+            static constexpr int SUB_BUCKET_BITS = 5;
+            static constexpr int MAX_VALUE_BITS = 40;
+            static constexpr uint64_t SUB_BUCKET_COUNT = uint64_t(1) << SUB_BUCKET_BITS;
+            static constexpr uint64_t MAX_VALUE = (uint64_t(1) << MAX_VALUE_BITS) - 1;
+            static constexpr size_t BUCKET_COUNT = (MAX_VALUE_BITS - SUB_BUCKET_BITS + 1) * SUB_BUCKET_COUNT;
+
+            void record(uint64_t value) noexcept {
+                value = value > MAX_VALUE ? MAX_VALUE : value;
+                _buckets[indexOf(value)].fetch_add(1, std::memory_order_relaxed);
+                _sum.fetch_add(value, std::memory_order_relaxed);
+                uint64_t currentMax = _max.load(std::memory_order_relaxed);
+                while (value > currentMax && !_max.compare_exchange_weak(currentMax, value, std::memory_order_relaxed)) {
+                }
+            }
+
+            HistogramSnapshot snapshot() const;
+
+            void reset() noexcept;
+
+            static size_t indexOf(uint64_t value) noexcept {
+                if (value < SUB_BUCKET_COUNT) {
+                    return static_cast<size_t>(value);
+                }
+                int shift = highestBit(value) - SUB_BUCKET_BITS;
+                uint64_t subBucket = (value >> shift) - SUB_BUCKET_COUNT;
+                return static_cast<size_t>((static_cast<uint64_t>(shift) + 1) * SUB_BUCKET_COUNT + subBucket);
+            }
+
+            static uint64_t highestEquivalentValue(size_t index) noexcept {
+                if (index < SUB_BUCKET_COUNT) {
+                    return index;
+                }
+                uint64_t shift = index / SUB_BUCKET_COUNT - 1;
+                uint64_t lowest = (index % SUB_BUCKET_COUNT + SUB_BUCKET_COUNT) << shift;
+                return lowest + ((uint64_t(1) << shift) - 1);
+            }
+
+            private:
+            static int highestBit(uint64_t value) noexcept {
+#if defined(__GNUC__) || defined(__clang__)
+                return 63 - __builtin_clzll(value);
+#else
+                int bit = 0;
+                while (value >>= 1) {
+                    ++bit;
+                }
+                return bit;
+#endif
+            }
+
+            std::array<std::atomic<uint64_t>, BUCKET_COUNT> _buckets{};
+            alignas(64) std::atomic<uint64_t> _sum{ 0 };
+            std::atomic<uint64_t> _max{ 0 };
+        };
+
+        /**
+         * @brief Point-in-time copy of every metric in the registry. Durations are in nanoseconds.
+         */
+        struct CARTESIAPP_EXPORT MetricsSnapshot {
+            /**
+             * @brief Latency of successful REST calls and WebSocket connects, indexed by Endpoint.
+             */
+            std::array<HistogramSnapshot, ENDPOINT_COUNT> request_latency_ns;
+
+            /**
+             * @brief Time from sending a TTS generation request to receiving the first audio chunk of its context.
+             */
+            HistogramSnapshot tts_time_to_first_chunk_ns;
+
+            uint64_t tts_chunks_received = 0;
+            uint64_t tts_audio_bytes_received = 0;
+            uint64_t base64_bytes_decoded = 0;
+            uint64_t reconnects = 0;
+
+            /**
+             * @brief Audio bytes sent again to the STT service after a reconnect.
+             */
+            uint64_t stt_audio_bytes_replayed = 0;
+
+            /**
+             * @brief writeAudioBytes() calls buffered by STT audio framing, and the frames they were sent as.
+             */
+            uint64_t stt_audio_writes_framed = 0;
+            uint64_t stt_audio_frames_sent = 0;
+
+            /**
+             * @brief STT audio dropped by client-side silence suppression, in bytes and in stream time.
+             */
+            uint64_t stt_silence_bytes_suppressed = 0;
+            uint64_t stt_silence_suppressed_ns = 0;
+
+            /**
+             * @brief STT utterances finalized by client-side endpointing.
+             */
+            uint64_t stt_endpoints_detected = 0;
+
+            /**
+             * @brief Failed calls and error events by HTTP status code, 0 counts transport failures that
+             * produced no status. Only non-zero entries are present.
+             */
+            std::map<int, uint64_t> errors_by_status;
+
+            int64_t open_connections = 0;
+
+            /**
+             * @brief Time from queueing a WebSocket message to the completion of the write carrying it.
+             */
+            HistogramSnapshot websocket_send_latency_ns;
+
+            uint64_t websocket_messages_sent = 0;
+
+            /**
+             * @brief Messages merged into the write of an earlier queued message instead of being written on their own.
+             */
+            uint64_t websocket_messages_coalesced = 0;
+
+            /**
+             * @brief Messages queued for sending and not written yet, across all connections.
+             */
+            int64_t websocket_send_queue_depth = 0;
+
+            /**
+             * @brief WebSocket message payloads received and sent, after decompression and before compression.
+             */
+            uint64_t websocket_payload_bytes_received = 0;
+            uint64_t websocket_payload_bytes_sent = 0;
+
+            /**
+             * @brief TLS bytes read and written by WebSocket connections once upgraded. The ratio of payload to
+             * wire bytes is the effective compression ratio, including framing and TLS overhead.
+             */
+            uint64_t websocket_wire_bytes_received = 0;
+            uint64_t websocket_wire_bytes_sent = 0;
+
+            /**
+             * @brief CPU time of the I/O handlers of connections with WebsocketOptions::record_io_cpu_time set.
+             */
+            uint64_t websocket_io_cpu_ns = 0;
+
+            /**
+             * @brief Round trip time of WebSocket pings, from writing the ping to reading its pong.
+             */
+            HistogramSnapshot websocket_ping_rtt_ns;
+
+            /**
+             * @brief WebSocket connections closed by the handshake or idle timeout.
+             */
+            uint64_t websocket_timeouts = 0;
+
+            /**
+             * @brief Time frames waited in a listener dispatch queue before delivery.
+             */
+            HistogramSnapshot listener_queue_latency_ns;
+
+            uint64_t listener_frames_dropped = 0;
+
+            /**
+             * @brief TTS chunks merged into a queued chunk of the same context by the COALESCE_AUDIO policy.
+             */
+            uint64_t listener_frames_coalesced = 0;
+
+            /**
+             * @brief Frames waiting in listener dispatch queues, across all clients.
+             */
+            int64_t listener_queue_depth = 0;
+        };
+
+        /**
+         * @brief Process-wide registry the library records into.
+         *
+         * All recording methods are safe to call from any thread and cost a few relaxed atomic operations.
+         */
+        class CARTESIAPP_EXPORT MetricsRegistry {
+            public:
+            static MetricsRegistry& instance();
+
+            MetricsRegistry(const MetricsRegistry&) = delete;
+            MetricsRegistry& operator=(const MetricsRegistry&) = delete;
+
+            /**
+             * @brief Records a finished REST call or WebSocket connect. Successful calls feed the latency
+             * histogram of their endpoint, failed calls and HTTP status codes >= 400 count as errors.
+             * @param timings The timing breakdown of the call.
+             * @param statusCode The HTTP status code of the response, or 0 if none was received.
+             */
+            void recordRequest(const RequestTimings& timings, int statusCode);
+
+            void recordError(int statusCode) noexcept {
+                if (statusCode < 0 || statusCode > MAX_STATUS_CODE) {
+                    statusCode = 0;
+                }
+                _errorsByStatus[static_cast<size_t>(statusCode)].fetch_add(1, std::memory_order_relaxed);
+            }
+
+            void recordTTSTimeToFirstChunk(uint64_t nanoseconds) noexcept {
+                _ttsTimeToFirstChunk.record(nanoseconds);
+            }
+
+            void recordTTSChunk(size_t audioBytes) noexcept {
+                _ttsChunksReceived.add();
+                _ttsAudioBytesReceived.add(audioBytes);
+            }
+
+            void recordBase64Decoded(size_t bytes) noexcept {
+                _base64BytesDecoded.add(bytes);
+            }
+
+            void recordReconnect() noexcept {
+                _reconnects.add();
+            }
+
+            void recordSTTAudioReplayed(size_t bytes) noexcept {
+                _sttAudioBytesReplayed.add(bytes);
+            }
+
+            void recordSTTAudioFramed(size_t writes) noexcept {
+                _sttAudioWritesFramed.add(writes);
+                _sttAudioFramesSent.add();
+            }
+
+            void recordSTTSilenceSuppressed(size_t bytes, uint64_t streamNs) noexcept {
+                _sttSilenceBytesSuppressed.add(bytes);
+                _sttSilenceSuppressed.add(streamNs);
+            }
+
+            void recordSTTEndpoint() noexcept {
+                _sttEndpointsDetected.add();
+            }
+
+            void connectionOpened() noexcept {
+                _openConnections.add();
+            }
+
+            void connectionClosed() noexcept {
+                _openConnections.sub();
+            }
+
+            void websocketMessageQueued() noexcept {
+                _websocketSendQueueDepth.add();
+            }
+
+            /**
+             * @brief Records a completed WebSocket write.
+             * @param messages The number of queued messages the write carried, more than one when coalesced.
+             * @param latencyNanoseconds Time since the oldest of them was queued.
+             */
+            void recordWebsocketWrite(size_t messages, uint64_t latencyNanoseconds) noexcept {
+                _websocketSendQueueDepth.sub(static_cast<int64_t>(messages));
+                _websocketMessagesSent.add(messages);
+                _websocketMessagesCoalesced.add(messages - 1);
+                _websocketSendLatency.record(latencyNanoseconds);
+            }
+
+            /**
+             * @brief Removes queued messages that will never be written, e.g. after the connection failed.
+             */
+            void websocketMessagesDropped(size_t messages) noexcept {
+                _websocketSendQueueDepth.sub(static_cast<int64_t>(messages));
+            }
+
+            /**
+             * @brief Records a received WebSocket message.
+             * @param payloadBytes The size of the message, decompressed.
+             * @param wireBytes The TLS bytes read since the previous message of the connection.
+             */
+            void recordWebsocketReceived(size_t payloadBytes, size_t wireBytes) noexcept {
+                _websocketPayloadBytesReceived.add(payloadBytes);
+                _websocketWireBytesReceived.add(wireBytes);
+            }
+
+            /**
+             * @brief Records a completed WebSocket write.
+             * @param payloadBytes The size of the written message, before compression.
+             * @param wireBytes The TLS bytes written since the previous write of the connection.
+             */
+            void recordWebsocketBytesSent(size_t payloadBytes, size_t wireBytes) noexcept {
+                _websocketPayloadBytesSent.add(payloadBytes);
+                _websocketWireBytesSent.add(wireBytes);
+            }
+
+            void recordWebsocketIoCpuTime(uint64_t nanoseconds) noexcept {
+                _websocketIoCpu.add(nanoseconds);
+            }
+
+            void recordWebsocketPingRtt(uint64_t nanoseconds) noexcept {
+                _websocketPingRtt.record(nanoseconds);
+            }
+
+            void recordWebsocketTimeout() noexcept {
+                _websocketTimeouts.add();
+            }
+
+            void listenerFrameQueued() noexcept {
+                _listenerQueueDepth.add();
+            }
+
+            /**
+             * @brief Records a frame taken off a listener dispatch queue for delivery.
+             */
+            void recordListenerDispatch(uint64_t queuedNanoseconds) noexcept {
+                _listenerQueueDepth.sub();
+                _listenerQueueLatency.record(queuedNanoseconds);
+            }
+
+            void recordListenerFramesDropped(size_t frames) noexcept {
+                _listenerQueueDepth.sub(static_cast<int64_t>(frames));
+                _listenerFramesDropped.add(frames);
+            }
+
+            void recordListenerFramesCoalesced(size_t frames) noexcept {
+                _listenerFramesCoalesced.add(frames);
+            }
+
+            /**
+             * @brief Removes queued frames that will never be delivered, e.g. when the client is destroyed.
+             */
+            void listenerFramesDiscarded(size_t frames) noexcept {
+                _listenerQueueDepth.sub(static_cast<int64_t>(frames));
+            }
+
+            MetricsSnapshot snapshot() const;
+
+            /**
+             * @brief Clears every metric except the open connections and queue depth gauges, which track live state.
+             */
+            void reset();
+
+            private:
+            MetricsRegistry() = default;
+
+            std::array<Histogram, ENDPOINT_COUNT> _requestLatency;
+            Histogram _ttsTimeToFirstChunk;
+            Counter _ttsChunksReceived;
+            Counter _ttsAudioBytesReceived;
+            Counter _base64BytesDecoded;
+            Counter _reconnects;
+            Counter _sttAudioBytesReplayed;
+            Counter _sttAudioWritesFramed;
+            Counter _sttAudioFramesSent;
+            Counter _sttSilenceBytesSuppressed;
+            Counter _sttSilenceSuppressed;
+            Counter _sttEndpointsDetected;
+            Gauge _openConnections;
+            std::array<std::atomic<uint64_t>, MAX_STATUS_CODE + 1> _errorsByStatus{};
+            Histogram _websocketSendLatency;
+            Counter _websocketMessagesSent;
+            Counter _websocketMessagesCoalesced;
+            Gauge _websocketSendQueueDepth;
+            Counter _websocketPayloadBytesReceived;
+            Counter _websocketPayloadBytesSent;
+            Counter _websocketWireBytesReceived;
+            Counter _websocketWireBytesSent;
+            Counter _websocketIoCpu;
+            Histogram _websocketPingRtt;
+            Counter _websocketTimeouts;
+            Histogram _listenerQueueLatency;
+            Counter _listenerFramesDropped;
+            Counter _listenerFramesCoalesced;
+            Gauge _listenerQueueDepth;
+        };
+
+        /**
+         * @brief Renders a snapshot in the Prometheus text exposition format (version 0.0.4).
+         *
+         * Histograms are exported as summaries with 0.5, 0.9, 0.99 and 0.999 quantiles, in seconds.
+         */
+        CARTESIAPP_EXPORT std::string toPrometheusText(const MetricsSnapshot& snapshot);
+    }
+}
+
+#endif // CARTESIAPP_METRICS_HPP
@@ -335,6 +335,38 @@ namespace cartesiapp::request {
             std::string toJson() const;
         };
 
+        /**
+         * @brief A GenerationRequest with its per-context invariant fields serialized once.
+         *
+         * Streaming sessions usually send many messages that only differ by transcript, context ID and the
+         * continue/flush flags. The model, voice, generation config, output format and the remaining options
+         * of the template request are written to JSON at construction, and serialize() only appends the
+         * variable fields to a copy of that prefix held in an internal buffer that is reused across calls.
+         *
+         * Not thread-safe: use one instance per sending thread.
+         */
+        class CARTESIAPP_EXPORT PreparedGenerationRequest {
+            public:
+            /**
+             * @param request Template request; its transcript, context_id, continue_ and flush fields are ignored.
+             */
+            explicit PreparedGenerationRequest(const GenerationRequest& request);
+
+            /**
+             * @brief Serializes a message for the given transcript and context.
+             * @param contextId Context ID of the message, omitted from the JSON if empty.
+             * @return The JSON message, valid until the next call to serialize().
+             */
+            const std::string& serialize(const std::string& transcript,
+                const std::string& contextId,
+                bool continueContext,
+                bool flush = false);
+
+            private:
+            std::string _prefix;
+            std::string _buffer;
+        };
+
         /**
          * @brief Request structure to cancel an ongoing TTS context/session
          */
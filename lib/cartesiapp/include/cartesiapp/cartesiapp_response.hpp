@@ -1,13 +1,27 @@
 #ifndef CARTESIAPP_RESPONSE_HPP
 #define CARTESIAPP_RESPONSE_HPP
 
+#include <cstddef>
+#include <memory_resource>
 #include <string>
+#include <string_view>
 #include <vector>
 #include <optional>
 
 #include "cartesiapp_export.hpp"
 
 namespace cartesiapp::response {
+    /**
+     * @brief Copies a response vector into a `std::vector` allocated from the global heap.
+     *
+     * The vector members of responses are `std::pmr::vector`s since 0.2.0; code that binds them to
+     * `std::vector<T>&` can take a copy through this instead, e.g. `toStdVector(transcript.words)`.
+     */
+    template <typename T>
+    std::vector<T> toStdVector(const std::pmr::vector<T>& values) {
+        return std::vector<T>(values.begin(), values.end());
+    }
+
     /**
      * Struct to hold API information
      */
@@ -40,7 +54,14 @@ namespace cartesiapp::response {
      * Struct to hold a page of Voice List results
      */
     struct CARTESIAPP_EXPORT VoiceListPage {
-        std::vector<Voice> voices;
+        VoiceListPage() = default;
+        /**
+         * @brief Allocates the voice list from the given memory resource.
+         */
+        explicit VoiceListPage(std::pmr::memory_resource* resource) : voices(resource) {
+        }
+
+        std::pmr::vector<Voice> voices;
         bool has_more;
 
         static VoiceListPage fromJson(const std::string& jsonStr);
@@ -65,6 +86,13 @@ namespace cartesiapp::response {
          * Struct to hold STT response information
          */
         struct CARTESIAPP_EXPORT TranscriptionResponse {
+            TranscriptionResponse() = default;
+            /**
+             * @brief Allocates the word timings from the given memory resource.
+             */
+            explicit TranscriptionResponse(std::pmr::memory_resource* resource) : words(resource) {
+            }
+
             std::string type;
             std::string text;
             std::optional<std::string> language;
@@ -72,8 +100,7 @@ namespace cartesiapp::response {
             std::string request_id;
             bool is_final;
 
-
-            std::vector<WordTiming> words;
+            std::pmr::vector<WordTiming> words;
 
             static TranscriptionResponse fromJson(const std::string& jsonStr);
         };
@@ -129,6 +156,30 @@ namespace cartesiapp::response {
             static AudioChunkResponse fromJson(const std::string& jsonStr);
         };
 
+        /**
+         * Non-owning view of a TTS audio chunk, pointing into buffers owned by the streaming client.
+         * Only valid for the duration of the listener callback it is passed to, copy what must be kept.
+         */
+        struct CARTESIAPP_EXPORT AudioChunkView {
+            /**
+             * @brief Decoded audio bytes.
+             */
+            const std::byte* data = nullptr;
+            size_t size = 0;
+            bool done = false;
+            int status_code = 0;
+            double step_time = 0.0;
+            /**
+             * @brief Context ID of the chunk, empty if the frame has none.
+             */
+            std::string_view context_id;
+
+            /**
+             * @brief Copies the chunk into an owning AudioChunkResponse.
+             */
+            AudioChunkResponse toResponse() const;
+        };
+
         /**
          * Struct to hold flush done response information
          */
@@ -159,6 +210,13 @@ namespace cartesiapp::response {
          * Struct to hold word timestamps response information
          */
         struct CARTESIAPP_EXPORT WordTimestampsResponse {
+            WordTimestampsResponse() = default;
+            /**
+             * @brief Allocates the timestamp arrays from the given memory resource.
+             */
+            explicit WordTimestampsResponse(std::pmr::memory_resource* resource) : word_timestamps(resource) {
+            }
+
             std::string type;
             bool done;
             int status_code;
@@ -168,13 +226,17 @@ namespace cartesiapp::response {
              * Struct to hold word-level timing information
              */
             struct WordTimestamps {
-                std::vector<std::string> words;
-                std::vector<double> start;
-                std::vector<double> end;
+                WordTimestamps() = default;
+                explicit WordTimestamps(std::pmr::memory_resource* resource) : words(resource), start(resource), end(resource) {
+                }
+
+                std::pmr::vector<std::string> words;
+                std::pmr::vector<double> start;
+                std::pmr::vector<double> end;
 
                 static WordTimestamps fromJson(const std::string& jsonStr);
             };
-            std::vector<WordTimestamps> word_timestamps;
+            std::pmr::vector<WordTimestamps> word_timestamps;
 
             static WordTimestampsResponse fromJson(const std::string& jsonStr);
         };
@@ -183,6 +245,13 @@ namespace cartesiapp::response {
          * Struct to hold phoneme timestamps response information
          */
         struct CARTESIAPP_EXPORT PhonemeTimestampsResponse {
+            PhonemeTimestampsResponse() = default;
+            /**
+             * @brief Allocates the timestamp arrays from the given memory resource.
+             */
+            explicit PhonemeTimestampsResponse(std::pmr::memory_resource* resource) : phoneme_timestamps(resource) {
+            }
+
             std::string type;
             bool done;
             int status_code;
@@ -192,9 +261,13 @@ namespace cartesiapp::response {
              * Struct to hold phoneme-level timing information
              */
             struct PhonemeTimestamps {
-                std::vector<std::string> phonemes;
-                std::vector<double> start;
-                std::vector<double> end;
+                PhonemeTimestamps() = default;
+                explicit PhonemeTimestamps(std::pmr::memory_resource* resource) : phonemes(resource), start(resource), end(resource) {
+                }
+
+                std::pmr::vector<std::string> phonemes;
+                std::pmr::vector<double> start;
+                std::pmr::vector<double> end;
 
                 static PhonemeTimestamps fromJson(const std::string& jsonStr);
             };
@@ -203,6 +276,51 @@ namespace cartesiapp::response {
             static PhonemeTimestampsResponse fromJson(const std::string& jsonStr);
         };
 
+        /**
+         * Timestamps event whose payload is kept as the raw frame and only decoded on first access to get().
+         * Response is WordTimestampsResponse or PhonemeTimestampsResponse.
+         * Not thread-safe: the first get() decodes in place.
+         */
+        template <typename Response>
+        class LazyTimestampsResponse {
+            public:
+            /**
+             * @brief Keeps a copy of the frame, allocated from the given memory resource like the decoded response.
+             */
+            explicit LazyTimestampsResponse(std::string_view frame,
+                std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+
+            /**
+             * @brief The raw JSON frame.
+             */
+            std::string_view raw() const {
+                return _frame;
+            }
+
+            /**
+             * @brief Whether get() has already decoded the payload.
+             */
+            bool isDecoded() const {
+                return _decoded.has_value();
+            }
+
+            /**
+             * @brief Decodes the frame on the first call and returns the cached response afterwards.
+             * @throws nlohmann::json::exception if the frame is not a valid timestamps response.
+             */
+            const Response& get() const;
+
+            private:
+            std::pmr::string _frame;
+            mutable std::optional<Response> _decoded;
+        };
+
+        extern template class CARTESIAPP_EXPORT LazyTimestampsResponse<WordTimestampsResponse>;
+        extern template class CARTESIAPP_EXPORT LazyTimestampsResponse<PhonemeTimestampsResponse>;
+
+        using LazyWordTimestampsResponse = LazyTimestampsResponse<WordTimestampsResponse>;
+        using LazyPhonemeTimestampsResponse = LazyTimestampsResponse<PhonemeTimestampsResponse>;
+
         /**
          * Struct to hold error response information
          */
@@ -0,0 +1,67 @@
+#ifndef CARTESIAPP_TIMINGS_HPP
+#define CARTESIAPP_TIMINGS_HPP
+
+#include <string>
+#include <chrono>
+#include <cstddef>
+#include <functional>
+
+#include "cartesiapp_export.hpp"
+
+namespace cartesiapp {
+
+    /**
+     * @brief Per-request timing breakdown of a REST call or a WebSocket connect.
+     *
+     * All time points come from the monotonic clock. Phases that do not apply to a call, or that
+     * were not reached because the call failed, keep a default-constructed (epoch) time point.
+     * For WebSocket connects the upgrade request and response form a single step, so only
+     * completed is set after tls_handshake_done.
+     */
+    struct CARTESIAPP_EXPORT RequestTimings {
+        using Clock = std::chrono::steady_clock;
+
+        /**
+         * @brief The API endpoint the call targeted, e.g. "/tts/bytes" or "/stt/websocket".
+         */
+        std::string endpoint;
+
+        Clock::time_point start;
+        Clock::time_point dns_resolved;
+        Clock::time_point tcp_connected;
+        Clock::time_point tls_handshake_done;
+
+        /**
+         * @brief The request (or WebSocket upgrade request) has been fully written.
+         */
+        Clock::time_point request_sent;
+
+        /**
+         * @brief The response headers have been received, the gap since request_sent is server think time.
+         */
+        Clock::time_point first_byte_received;
+
+        /**
+         * @brief The response body has been fully received (or the WebSocket upgrade completed).
+         */
+        Clock::time_point completed;
+
+        /**
+         * @brief Bytes written to and read from the network, including TLS handshake and record overhead.
+         */
+        size_t bytes_sent = 0;
+        size_t bytes_received = 0;
+
+        /**
+         * @brief True if the call completed, false if it failed part way through.
+         */
+        bool succeeded = false;
+    };
+
+    /**
+     * @brief Hook invoked with the timing breakdown once a call finishes, successfully or not.
+     */
+    using RequestTimingsCallback = std::function<void(const RequestTimings& timings)>;
+}
+
+#endif // CARTESIAPP_TIMINGS_HPP
@@ -0,0 +1,355 @@
+#ifndef CARTESIAPP_EVENT_QUEUE_HPP
+#define CARTESIAPP_EVENT_QUEUE_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <variant>
+#include <vector>
+
+#include "cartesiapp_export.hpp"
+#include "streaming_stt.hpp"
+#include "streaming_tts.hpp"
+
+namespace cartesiapp {
+
+    /**
+     * @brief Connection events delivered through an event queue, next to the responses.
+     */
+    namespace connection_events {
+        struct Connected {
+        };
+
+        struct Disconnected {
+            std::string reason;
+        };
+
+        struct NetworkError {
+            std::string message;
+        };
+
+        /**
+         * @brief The STT connection dropped and reconnection starts, see STTWebsocketClient::setReconnectOptions().
+         */
+        struct Reconnecting {
+            std::string reason;
+        };
+
+        struct Reconnected {
+        };
+    }
+
+    /**
+     * @brief An event of a TTS stream: one of the TTSResponseListener callbacks.
+     */
+    using TTSEvent = std::variant<
+        connection_events::Connected,
+        connection_events::Disconnected,
+        connection_events::NetworkError,
+        response::tts::AudioChunkResponse,
+        response::tts::WordTimestampsResponse,
+        response::tts::PhonemeTimestampsResponse,
+        response::tts::FlushDoneResponse,
+        response::tts::DoneResponse,
+        response::tts::ErrorResponse>;
+
+    /**
+     * @brief An event of an STT stream: one of the STTResponseListener callbacks.
+     */
+    using STTEvent = std::variant<
+        connection_events::Connected,
+        connection_events::Disconnected,
+        connection_events::NetworkError,
+        connection_events::Reconnecting,
+        connection_events::Reconnected,
+        response::stt::TranscriptionResponse,
+        response::stt::FlushDoneResponse,
+        response::stt::DoneResponse,
+        response::stt::ErrorResponse>;
+
+    /**
+     * @brief Bounded single-producer single-consumer ring of events.
+     *
+     * The capacity is rounded up to a power of two. Events are written into and read from preallocated slots,
+     * which keep their buffers, so once every slot has held an event of a kind, queueing another one of the same
+     * kind reuses that memory. Neither side takes a lock, except a consumer blocked in popFor() and the producer
+     * waking it up. When the ring is full the new event is dropped and counted. A few slots can be reserved for
+     * events that must not be lost (connection changes, done, errors): ordinary events leave them free.
+     */
+    template <typename Event>
+    class EventRing {
+        public:
+        /**
+         * @param capacity The number of ordinary events held before new ones are dropped.
+         * @param reservedSlots Extra slots only reserved events may take.
+         */
+        explicit EventRing(size_t capacity, size_t reservedSlots = 0) :
+            _slots(roundUpToPowerOfTwo(std::max<size_t>(capacity, 2) + reservedSlots)),
+            _mask(_slots.size() - 1),
+            _ordinaryLimit(_slots.size() - reservedSlots) {
+        }
+
+        EventRing(const EventRing&) = delete;
+        EventRing& operator=(const EventRing&) = delete;
+
+        /**
+         * @brief Producer side: writes an event into the next free slot.
+         * @param write Called with the slot, which still holds the event it carried last time.
+         * @param reserved True if the event may take the reserved slots.
+         * @return false if the ring is full and the event was dropped.
+         */
+        template <typename Writer>
+        bool tryPush(Writer&& write, bool reserved = false) {
+            const size_t limit = reserved ? _slots.size() : _ordinaryLimit;
+            size_t tail = _tail.load(std::memory_order_relaxed);
+            if (tail - _cachedHead >= limit) {
+                _cachedHead = _head.load(std::memory_order_acquire);
+                if (tail - _cachedHead >= limit) {
+                    _dropped.fetch_add(1, std::memory_order_relaxed);
+                    return false;
+                }
+            }
+            write(_slots[tail & _mask]);
+            _tail.store(tail + 1, std::memory_order_release);
+            // pairs with the fence in popFor(): either the consumer sees the event or we see it waiting
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (_consumerWaiting.load(std::memory_order_relaxed)) {
+                std::lock_guard<std::mutex> lock(_waitMutex);
+                _notEmpty.notify_one();
+            }
+            return true;
+        }
+
+        /**
+         * @brief Consumer side: moves the oldest event out, without waiting.
+         */
+        bool tryPop(Event& event) {
+            return drain([&event](Event& next) {
+                event = std::move(next);
+                }, 1) == 1;
+        }
+
+        /**
+         * @brief Consumer side: moves the oldest event out, waiting up to the timeout for one to arrive.
+         */
+        template <typename Rep, typename Period>
+        bool popFor(Event& event, const std::chrono::duration<Rep, Period>& timeout) {
+            if (tryPop(event)) {
+                return true;
+            }
+            std::unique_lock<std::mutex> lock(_waitMutex);
+            _consumerWaiting.store(true, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            bool popped = _notEmpty.wait_for(lock, timeout, [this, &event]() {
+                return tryPop(event);
+                });
+            _consumerWaiting.store(false, std::memory_order_relaxed);
+            return popped;
+        }
+
+        /**
+         * @brief Consumer side: passes the queued events to the visitor in order, in place, then frees their slots
+         * at once. Events arriving meanwhile are left for the next call.
+         * @param visit Called with each event as `Event&`; it may move from it, the slot is overwritten later.
+         * @param maxEvents The most events to visit.
+         * @return The number of events visited.
+         */
+        template <typename Visitor>
+        size_t drain(Visitor&& visit, size_t maxEvents = std::numeric_limits<size_t>::max()) {
+            size_t head = _head.load(std::memory_order_relaxed);
+            if (_cachedTail == head) {
+                _cachedTail = _tail.load(std::memory_order_acquire);
+            }
+            size_t count = std::min(_cachedTail - head, maxEvents);
+            size_t visited = 0;
+            try {
+                for (; visited < count; ++visited) {
+                    visit(_slots[(head + visited) & _mask]);
+                }
+            }
+            catch (...) {
+                // the event that threw counts as consumed
+                _head.store(head + visited + 1, std::memory_order_release);
+                throw;
+            }
+            _head.store(head + count, std::memory_order_release);
+            return count;
+        }
+
+        /**
+         * @brief Returns the number of queued events, exact only when called from either side with the other idle.
+         */
+        size_t size() const {
+            // head first, it never passes the tail read after it
+            size_t head = _head.load(std::memory_order_acquire);
+            return _tail.load(std::memory_order_acquire) - head;
+        }
+
+        /**
+         * @brief Returns the number of slots, reserved ones included.
+         */
+        size_t capacity() const {
+            return _slots.size();
+        }
+
+        /**
+         * @brief Returns the number of events dropped because the ring was full.
+         */
+        uint64_t droppedEvents() const {
+            return _dropped.load(std::memory_order_relaxed);
+        }
+
+        private:
+        static size_t roundUpToPowerOfTwo(size_t value) {
+            size_t power = 1;
+            while (power < value) {
+                power <<= 1;
+            }
+            return power;
+        }
+
+        std::vector<Event> _slots;
+        const size_t _mask;
+        const size_t _ordinaryLimit;
+
+        // each side owns a cache line: its index and its cached copy of the other side's
+        alignas(64) std::atomic<size_t> _tail{ 0 };
+        size_t _cachedHead = 0;
+        alignas(64) std::atomic<size_t> _head{ 0 };
+        size_t _cachedTail = 0;
+
+        alignas(64) std::atomic<bool> _consumerWaiting{ false };
+        std::atomic<uint64_t> _dropped{ 0 };
+        std::mutex _waitMutex;
+        std::condition_variable _notEmpty;
+    };
+
+    // Forward declaration of the listeners feeding the queues
+    class TTSEventQueueListener;
+    class STTEventQueueListener;
+
+    /**
+     * @brief Delivers the events of a TTS stream through a queue polled by the application, instead of callbacks
+     * on the client's I/O thread.
+     *
+     * The queue registers itself as the client's listener, so the client must not be given another one, and the
+     * client must outlive the queue. Audio chunks are copied into the slot of the event, reusing its buffer, so
+     * a consumer draining events in place does not allocate in steady state. One thread consumes the queue.
+     */
+    class CARTESIAPP_EXPORT TTSEventQueue {
+        public:
+        /**
+         * @brief Slots kept for connection events, done, flush_done and errors beyond the capacity, so a full queue
+         * still reports how the stream ended.
+         */
+        static constexpr size_t RESERVED_EVENTS = 16;
+
+        /**
+         * @brief Takes over the listener slot of the client.
+         * @param client The connection whose events are queued.
+         * @param capacity The number of responses held before new ones are dropped, rounded up to a power of two
+         * together with RESERVED_EVENTS.
+         */
+        TTSEventQueue(TTSWebsocketClient& client, size_t capacity = 1024);
+        ~TTSEventQueue();
+
+        TTSEventQueue(const TTSEventQueue&) = delete;
+        TTSEventQueue& operator=(const TTSEventQueue&) = delete;
+
+        bool tryPop(TTSEvent& event) {
+            return _events->tryPop(event);
+        }
+
+        template <typename Rep, typename Period>
+        bool popFor(TTSEvent& event, const std::chrono::duration<Rep, Period>& timeout) {
+            return _events->popFor(event, timeout);
+        }
+
+        /**
+         * @brief Visits the queued events in place, see EventRing::drain().
+         */
+        template <typename Visitor>
+        size_t drain(Visitor&& visit, size_t maxEvents = std::numeric_limits<size_t>::max()) {
+            return _events->drain(std::forward<Visitor>(visit), maxEvents);
+        }
+
+        size_t size() const {
+            return _events->size();
+        }
+
+        uint64_t droppedEvents() const {
+            return _events->droppedEvents();
+        }
+
+        private:
+        std::shared_ptr<EventRing<TTSEvent>> _events;
+        std::shared_ptr<TTSEventQueueListener> _listener;
+    };
+
+    /**
+     * @brief Delivers the events of an STT stream through a queue polled by the application, instead of callbacks
+     * on the client's I/O thread.
+     *
+     * The queue registers itself as the client's listener, so the client must not be given another one, and the
+     * client must outlive the queue. One thread consumes the queue.
+     */
+    class CARTESIAPP_EXPORT STTEventQueue {
+        public:
+        /**
+         * @brief Slots kept for connection events, done, flush_done and errors beyond the capacity, so a full queue
+         * still reports how the stream ended.
+         */
+        static constexpr size_t RESERVED_EVENTS = 16;
+
+        /**
+         * @brief Takes over the listener slot of the client.
+         * @param client The connection whose events are queued.
+         * @param capacity The number of responses held before new ones are dropped, rounded up to a power of two
+         * together with RESERVED_EVENTS.
+         */
+        STTEventQueue(STTWebsocketClient& client, size_t capacity = 1024);
+        ~STTEventQueue();
+
+        STTEventQueue(const STTEventQueue&) = delete;
+        STTEventQueue& operator=(const STTEventQueue&) = delete;
+
+        bool tryPop(STTEvent& event) {
+            return _events->tryPop(event);
+        }
+
+        template <typename Rep, typename Period>
+        bool popFor(STTEvent& event, const std::chrono::duration<Rep, Period>& timeout) {
+            return _events->popFor(event, timeout);
+        }
+
+        /**
+         * @brief Visits the queued events in place, see EventRing::drain().
+         */
+        template <typename Visitor>
+        size_t drain(Visitor&& visit, size_t maxEvents = std::numeric_limits<size_t>::max()) {
+            return _events->drain(std::forward<Visitor>(visit), maxEvents);
+        }
+
+        size_t size() const {
+            return _events->size();
+        }
+
+        uint64_t droppedEvents() const {
+            return _events->droppedEvents();
+        }
+
+        private:
+        std::shared_ptr<EventRing<STTEvent>> _events;
+        std::shared_ptr<STTEventQueueListener> _listener;
+    };
+}
+
+#endif // CARTESIAPP_EVENT_QUEUE_HPP
@@ -0,0 +1,57 @@
+#ifndef CARTESIAPP_IO_ENGINE_HPP
+#define CARTESIAPP_IO_ENGINE_HPP
+
+#include <cstddef>
+#include <memory>
+
+#include "cartesiapp_export.hpp"
+
+namespace cartesiapp {
+    // Forward declaration of implementation classes
+    class IoEngineImpl;
+    class WebsocketClientImpl;
+
+    /**
+     * @brief A fixed pool of I/O threads running the asynchronous reads and writes of WebSocket connections.
+     *
+     * Every TTSWebsocketClient and STTWebsocketClient attached to the same engine shares its threads, each
+     * connection being serialized on its own strand, so the number of threads no longer grows with the number
+     * of open connections. Callbacks of the listeners are invoked on these threads and should not block.
+     *
+     * Clients keep the engine alive while they are connected. A client that is not given an engine creates a
+     * private single-threaded one on connect.
+     */
+    class CARTESIAPP_EXPORT IoEngine {
+        public:
+        /**
+         * @brief Starts the I/O threads.
+         * @param threadCount The number of threads, 0 for one per hardware thread.
+         */
+        explicit IoEngine(size_t threadCount = 0);
+
+        /**
+         * @brief Stops and joins the I/O threads. Connections still running on the engine are aborted. When called
+         * from one of the I/O threads, they finish in the background once their current handlers return.
+         */
+        ~IoEngine();
+
+        IoEngine(const IoEngine&) = delete;
+        IoEngine& operator=(const IoEngine&) = delete;
+
+        /**
+         * @brief Returns the number of I/O threads.
+         */
+        size_t threadCount() const;
+
+        /**
+         * @brief Returns a process-wide engine with one thread per hardware thread, created on first use.
+         */
+        static std::shared_ptr<IoEngine> shared();
+
+        private:
+        friend class WebsocketClientImpl;
+        std::shared_ptr<IoEngineImpl> _impl;
+    };
+}
+
+#endif // CARTESIAPP_IO_ENGINE_HPP
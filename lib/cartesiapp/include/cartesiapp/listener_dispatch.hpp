@@ -0,0 +1,62 @@
+#ifndef CARTESIAPP_LISTENER_DISPATCH_HPP
+#define CARTESIAPP_LISTENER_DISPATCH_HPP
+
+#include <cstddef>
+#include <functional>
+
+#include "cartesiapp_export.hpp"
+
+namespace cartesiapp {
+
+    /**
+     * @brief What the socket reader does with a frame when the dispatch queue is full.
+     */
+    enum class DispatchOverflowPolicy {
+        /**
+         * @brief Waits for the listener to catch up. Nothing is lost, reads stall as they would without a queue.
+         */
+        BLOCK,
+
+        /**
+         * @brief Discards the oldest queued TTS audio chunk or interim STT transcript. Connection events, final
+         * transcripts and terminal or control frames (done, error, flush_done, timestamps) are never discarded; with
+         * none of the former queued, the reader waits as with BLOCK.
+         */
+        DROP_OLDEST,
+
+        /**
+         * @brief Merges a TTS audio chunk into the newest queued chunk of the same context, which then reaches the
+         * listener as one larger chunk. Other frames wait as with BLOCK.
+         */
+        COALESCE_AUDIO
+    };
+
+    /**
+     * @brief Moves listener callbacks off the socket read path of a streaming client.
+     *
+     * Frames are copied into a bounded queue by the reader and decoded and delivered to the listener by a
+     * dispatcher, so a slow listener no longer holds up network reads. Disconnection and network error events
+     * go through the same queue and keep their order relative to the frames.
+     */
+    struct CARTESIAPP_EXPORT ListenerDispatchOptions {
+        /**
+         * @brief Enables the dispatch stage. Without it, listeners run inline on the I/O thread.
+         */
+        bool enabled = false;
+
+        /**
+         * @brief Frames the queue holds before the overflow policy applies.
+         */
+        size_t queue_capacity = 256;
+
+        DispatchOverflowPolicy overflow_policy = DispatchOverflowPolicy::BLOCK;
+
+        /**
+         * @brief Runs the dispatch work, e.g. by posting it to an application thread pool. It must eventually
+         * run every task it is given. When empty, the client starts a dedicated dispatcher thread.
+         */
+        std::function<void(std::function<void()>)> executor;
+    };
+}
+
+#endif // CARTESIAPP_LISTENER_DISPATCH_HPP
@@ -1,7 +1,13 @@
 #ifndef CARTESIA_STT_WS_HPP
 #define CARTESIA_STT_WS_HPP
 
+#include <chrono>
+#include <cstdint>
+
 #include "cartesiapp.hpp"
+#include "io_engine.hpp"
+#include "listener_dispatch.hpp"
+#include "websocket_options.hpp"
 
 namespace cartesiapp {
     // Forward declaration of WebsocketClient implementation class
@@ -10,6 +16,21 @@ namespace cartesiapp {
     // Forward declaration of STTResponseListener interface
     class STTResponseListener;
 
+    // Forward declaration of the reconnect and replay state
+    class STTSessionRecovery;
+
+    // Forward declaration of the listener dispatch queue
+    class ListenerDispatcher;
+
+    // Forward declaration of the audio framing buffer
+    class STTAudioSender;
+
+    // Forward declaration of the silence suppression stage
+    class STTSilenceSuppressor;
+
+    // Forward declaration of the local end of speech detector
+    class STTEndpointDetector;
+
     /**
      * @brief Namespace for Speech-to-Text related events
      */
@@ -20,6 +41,139 @@ namespace cartesiapp {
         constexpr const char* ERROR_ = "error";
     };
 
+    /**
+     * @brief Automatic reconnection settings of an STTWebsocketClient.
+     */
+    struct CARTESIAPP_EXPORT STTReconnectOptions {
+        /**
+         * @brief Reconnects when the connection drops, instead of ending the session.
+         */
+        bool enabled = false;
+
+        /**
+         * @brief Connect attempts per drop before giving up, 0 to retry until disconnect() is called.
+         */
+        int max_attempts = 8;
+
+        /**
+         * @brief The delay before the first attempt, doubled after every failed one.
+         */
+        std::chrono::milliseconds initial_backoff{ 250 };
+
+        /**
+         * @brief The upper bound of the delay between attempts.
+         */
+        std::chrono::milliseconds max_backoff{ 8000 };
+
+        /**
+         * @brief Capacity of the buffer of recently written audio replayed after a reconnect. Audio acknowledged
+         * by a final transcript leaves the buffer early; older audio is dropped once it is full. The default
+         * holds about 32 seconds of 16 kHz pcm_s16le.
+         */
+        size_t replay_buffer_bytes = 1024 * 1024;
+    };
+
+    /**
+     * @brief Send-side framing of the audio written to an STTWebsocketClient.
+     */
+    struct CARTESIAPP_EXPORT STTAudioFramingOptions {
+        /**
+         * @brief Buffers the written audio and sends it in frames of frame_duration, instead of one message per
+         * writeAudioBytes() call. Requires a PCM encoding, whose byte rate gives the frame size.
+         */
+        bool enabled = false;
+
+        /**
+         * @brief Audio per frame. 40 to 100 ms cuts the per-message cost of 10 ms capture buffers without
+         * delaying transcripts noticeably.
+         */
+        std::chrono::milliseconds frame_duration{ 40 };
+
+        /**
+         * @brief A partial frame is sent once no audio was written for this long, e.g. when the capture pauses.
+         * Finalize and done requests send it right away. Keep it above the capture buffer duration.
+         */
+        std::chrono::milliseconds flush_timeout{ 100 };
+
+        /**
+         * @brief Sends frames no faster than real time, for audio read from files faster than it plays.
+         */
+        bool realtime_pacing = false;
+
+        /**
+         * @brief Audio waiting to be sent beyond which writes are refused. The default holds about 4 minutes
+         * of 16 kHz pcm_s16le.
+         */
+        size_t max_buffered_bytes = 8 * 1024 * 1024;
+    };
+
+    /**
+     * @brief Client-side silence suppression of the audio written to an STTWebsocketClient.
+     */
+    struct CARTESIAPP_EXPORT STTSilenceSuppressionOptions {
+        /**
+         * @brief Drops the middle of long silent stretches instead of uploading them. Supports pcm_s16le,
+         * pcm_f32le, pcm_mulaw and pcm_alaw.
+         */
+        bool enabled = false;
+
+        /**
+         * @brief Level of 10 ms of audio, in dB relative to full scale, below which it is silent.
+         */
+        float threshold_dbfs = -50.0f;
+
+        /**
+         * @brief Silence still sent after speech, so trailing words are not cut off.
+         */
+        std::chrono::milliseconds hangover{ 300 };
+
+        /**
+         * @brief Silence sent again before speech resumes, so its onset is not cut off. Silent stretches shorter
+         * than hangover plus pre-roll are sent in full.
+         */
+        std::chrono::milliseconds pre_roll{ 200 };
+    };
+
+    /**
+     * @brief Client-side end of speech detection of an STTWebsocketClient.
+     */
+    struct CARTESIAPP_EXPORT STTEndpointingOptions {
+        /**
+         * @brief Sends a finalize request once an utterance is followed by trailing_silence, instead of waiting for
+         * the server to end it. Supports pcm_s16le, pcm_f32le, pcm_mulaw and pcm_alaw.
+         */
+        bool enabled = false;
+
+        /**
+         * @brief Level of 10 ms of audio, in dB relative to full scale, from which it counts as speech.
+         */
+        float speech_threshold_dbfs = -40.0f;
+
+        /**
+         * @brief Level below which audio counts as silence, at most the speech threshold. Audio in between
+         * continues an utterance but does not start one.
+         */
+        float silence_threshold_dbfs = -50.0f;
+
+        /**
+         * @brief Speech needed to start an utterance, so clicks and short noises do not trigger a finalize.
+         */
+        std::chrono::milliseconds min_speech{ 150 };
+
+        /**
+         * @brief Silence that ends an utterance. Shorter values finalize sooner but split utterances at pauses.
+         */
+        std::chrono::milliseconds trailing_silence{ 500 };
+    };
+
+    /**
+     * @brief Audio held back by silence suppression since the client connected.
+     */
+    struct CARTESIAPP_EXPORT STTSilenceSuppressionStats {
+        uint64_t bytes_suppressed = 0;
+        double seconds_suppressed = 0.0;
+    };
+
     /**
      * @brief Client class for managing Speech-to-Text WebSocket connections.
      */
@@ -49,6 +203,99 @@ namespace cartesiapp {
          */
         bool isConnectedAndStarted() const;
 
+        /**
+         * @brief Returns the round trip time measured by the latest pong of the connection, 0 before the first.
+         * Pings are sent every WebsocketOptions::ping_interval.
+         */
+        std::chrono::nanoseconds pingRoundTripTime() const;
+
+        /**
+         * @brief Overrides the connection options (host, port). Must be called before connectAndStart().
+         * @param options The WebsocketOptions to use for subsequent connections.
+         */
+        void setWebsocketOptions(const WebsocketOptions& options);
+
+        /**
+         * @brief Registers a hook receiving the timing breakdown of every subsequent connect attempt.
+         * @param callback The hook to invoke, or an empty function to disable it.
+         */
+        void setRequestTimingsCallback(RequestTimingsCallback callback);
+
+        /**
+         * @brief Runs the connection on the given I/O engine, shared with other clients. Must be called before connectAndStart().
+         *
+         * Without one, the client creates a private single-threaded engine, i.e. one I/O thread per connection.
+         * @param engine The engine to use, e.g. IoEngine::shared(), or nullptr for a private one.
+         */
+        void setIoEngine(std::shared_ptr<IoEngine> engine);
+
+        /**
+         * @brief Sets the memory resource backing the per-connection frame arena. Must be called before connectAndStart().
+         *
+         * The responses passed to the listener are allocated from an arena that is reset after every frame,
+         * so they are only valid during the callback; copies use the default resource and may be kept.
+         * @param resource The upstream resource, or nullptr for std::pmr::get_default_resource(). Must outlive the connection.
+         */
+        void setMemoryResource(std::pmr::memory_resource* resource);
+
+        /**
+         * @brief Enables transparent reconnection. Must be called before connectAndStart().
+         *
+         * When the connection drops, the client reconnects with exponential backoff and replays the written audio
+         * that no final transcript covered yet, then resumes sending. writeAudioBytes() keeps accepting audio in the
+         * meantime. Finalize requests not yet answered by a flush_done are sent again in place. Word timings of
+         * transcripts stay relative to the start of the whole session. The listener gets onReconnecting() and
+         * onReconnected() instead of onNetworkError(), which is only reported once every attempt failed. Once the done
+         * request reached the server, or the server closed the connection normally, the session is not reconnected.
+         * @param options The reconnection settings.
+         */
+        void setReconnectOptions(const STTReconnectOptions& options);
+
+        /**
+         * @brief Delivers listener callbacks from a dispatcher instead of the socket read path. Must be called before connectAndStart().
+         *
+         * Frames are queued by the reader and decoded on the dispatcher. Transcripts are never merged, so
+         * COALESCE_AUDIO behaves as BLOCK.
+         * @param options The dispatch settings, disabled by default.
+         */
+        void setListenerDispatchOptions(const ListenerDispatchOptions& options);
+
+        /**
+         * @brief Frames the written audio by duration before sending it. Must be called before connectAndStart().
+         *
+         * Frames are sent from a timer on the connection's strand, so writeAudioBytes() only copies the audio.
+         * sendFinalizeRequest() and sendDoneRequest() are sent after the audio written before them; disconnect()
+         * sends the requests still queued and the audio before them first, and drops the audio written after.
+         * @param options The framing settings, disabled by default.
+         */
+        void setAudioFramingOptions(const STTAudioFramingOptions& options);
+
+        /**
+         * @brief Drops long silences from the written audio before it is sent. Must be called before connectAndStart().
+         *
+         * Each 10 ms of audio is measured against the threshold. Silence following speech is sent for the
+         * hangover, and the last pre-roll of a silence is sent before the speech that ends it; the rest is
+         * dropped. Word timings of transcripts are moved back onto the timeline of the written audio.
+         * A partial 10 ms window waits for the next write, or for a finalize or done request.
+         * @param options The suppression settings, disabled by default.
+         */
+        void setSilenceSuppressionOptions(const STTSilenceSuppressionOptions& options);
+
+        /**
+         * @brief Returns how much audio silence suppression dropped since connectAndStart().
+         */
+        STTSilenceSuppressionStats silenceSuppressionStats() const;
+
+        /**
+         * @brief Finalizes utterances locally at the end of speech. Must be called before connectAndStart().
+         *
+         * The written audio is measured in 10 ms windows. When an utterance of at least min_speech is followed by
+         * trailing_silence, sendFinalizeRequest() is called after the write that completed the silence, so the
+         * final transcript does not wait for the server's own endpointing.
+         * @param options The endpointing settings, disabled by default.
+         */
+        void setEndpointingOptions(const STTEndpointingOptions& options);
+
         /**
          * @brief Sends a done request to the STT service.
          */
@@ -61,6 +308,10 @@ namespace cartesiapp {
 
         /**
          * @brief Writes audio bytes to the STT WebSocket.
+         *
+         * The bytes are copied into the connection's outbound queue and written by its I/O engine, so the call
+         * never blocks on the network and may be made from any thread. Returns false if the socket is not connected,
+         * unless reconnection is enabled and in progress, in which case the audio is buffered for replay.
          * @param data Pointer to the audio byte data.
          * @param size Size of the audio byte data.
          */
@@ -78,8 +329,30 @@ namespace cartesiapp {
         void unregisterSTTListener();
 
         private:
+        /**
+         * @brief Runs a connection event on the listener, through the dispatcher if enabled.
+         */
+        void notifyListener(std::function<void()> call);
+
+        /**
+         * @brief Sends audio past the silence suppression, through the framing buffer or reconnection if enabled.
+         */
+        bool sendAudio(const char* data, size_t size) const;
+
+        // declared before the implementation so it outlives the reads awaited by its destructor
+        std::unique_ptr<STTEndpointDetector> _endpointDetector;
+        std::unique_ptr<STTSilenceSuppressor> _silenceSuppressor;
+        std::shared_ptr<STTAudioSender> _audioSender;
+        std::unique_ptr<STTSessionRecovery> _recovery;
+        std::unique_ptr<ListenerDispatcher> _dispatcher;
         std::unique_ptr<WebsocketClientImpl> _websocketClientImpl;
+        STTReconnectOptions _reconnectOptions;
+        ListenerDispatchOptions _dispatchOptions;
+        STTAudioFramingOptions _framingOptions;
+        STTSilenceSuppressionOptions _silenceOptions;
+        STTEndpointingOptions _endpointingOptions;
         std::weak_ptr<STTResponseListener> _sttListener;
+        std::pmr::memory_resource* _memoryResource = nullptr;
         std::string _model;
         std::string _language;
         std::string _encoding;
@@ -137,6 +410,17 @@ namespace cartesiapp {
          * @param response The ErrorResponse received from the STT service.
          */
         virtual void onError(const response::stt::ErrorResponse& response) = 0;
+
+        /**
+         * @brief Callback method invoked when the connection dropped and reconnection starts, if enabled.
+         * @param reason The reason the connection was lost.
+         */
+        virtual void onReconnecting(const std::string& reason);
+
+        /**
+         * @brief Callback method invoked once a new connection is up and the unacknowledged audio is queued on it.
+         */
+        virtual void onReconnected();
     };
 }
 
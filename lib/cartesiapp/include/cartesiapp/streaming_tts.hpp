@@ -1,7 +1,13 @@
 #ifndef STREAMING_TTS_HPP
 #define STREAMING_TTS_HPP
 
+#include <mutex>
+
 #include "cartesiapp.hpp"
+#include "timestamp_index.hpp"
+#include "io_engine.hpp"
+#include "listener_dispatch.hpp"
+#include "websocket_options.hpp"
 
 namespace cartesiapp {
 
@@ -11,6 +17,12 @@ namespace cartesiapp {
     // Forward declaration of TTSResponseListener interface
     class TTSResponseListener;
 
+    // Forward declaration of the time-to-first-chunk tracker
+    class FirstChunkTracker;
+
+    // Forward declaration of the listener dispatch queue
+    class ListenerDispatcher;
+
     namespace tts_events {
         constexpr const char* AUDIO_CHUNK = "chunk";
         constexpr const char* DONE = "done";
@@ -44,12 +56,96 @@ namespace cartesiapp {
          */
         bool isConnectedAndStarted() const;
 
+        /**
+         * @brief Overrides the connection options (host, port). Must be called before connectAndStart().
+         * @param options The WebsocketOptions to use for subsequent connections.
+         */
+        void setWebsocketOptions(const WebsocketOptions& options);
+
+        /**
+         * @brief Registers a hook receiving the timing breakdown of every subsequent connect attempt.
+         * @param callback The hook to invoke, or an empty function to disable it.
+         */
+        void setRequestTimingsCallback(RequestTimingsCallback callback);
+
+        /**
+         * @brief Runs the connection on the given I/O engine, shared with other clients. Must be called before connectAndStart().
+         *
+         * Without one, the client creates a private single-threaded engine, i.e. one I/O thread per connection.
+         * @param engine The engine to use, e.g. IoEngine::shared(), or nullptr for a private one.
+         */
+        void setIoEngine(std::shared_ptr<IoEngine> engine);
+
+        /**
+         * @brief Sets the memory resource backing the per-connection frame arena. Must be called before connectAndStart().
+         *
+         * The timestamp responses passed to the listener are allocated from an arena that is reset after every
+         * frame, so they are only valid during the callback; copies use the default resource and may be kept.
+         * @param resource The upstream resource, or nullptr for std::pmr::get_default_resource(). Must outlive the connection.
+         */
+        void setMemoryResource(std::pmr::memory_resource* resource);
+
+        /**
+         * @brief Delivers timestamp events with lazily decoded payloads. Must be called before connectAndStart().
+         *
+         * When enabled, timestamp frames are only copied on the reception thread and passed to
+         * onLazyWordTimestampsReceived() / onLazyPhonemeTimestampsReceived(); the payload is parsed on the first
+         * get(), from the listener or later from a kept copy.
+         * @param enabled Whether to defer decoding of timestamp payloads, disabled by default.
+         */
+        void setLazyTimestamps(bool enabled);
+
+        /**
+         * @brief Feeds the word and phoneme timestamps of every context into the given index from the reception thread,
+         * whether or not a listener is registered. Must be called before connectAndStart().
+         * @param index The index to feed, or nullptr to stop feeding one.
+         */
+        void setTimestampIndex(std::shared_ptr<TimestampIndex> index);
+
+        /**
+         * @brief Delivers listener callbacks from a dispatcher instead of the socket read path. Must be called before connectAndStart().
+         *
+         * Frames are queued by the reader and decoded on the dispatcher, which also feeds the timestamp index.
+         * With COALESCE_AUDIO, chunks of one context that pile up are passed to onAudioChunkView() as one chunk.
+         * @param options The dispatch settings, disabled by default.
+         */
+        void setListenerDispatchOptions(const ListenerDispatchOptions& options);
+
+        /**
+         * @brief Sends a WebSocket ping, e.g. to keep an idle connection from being dropped by proxies.
+         * @return false if the socket is not connected.
+         */
+        bool ping() const;
+
+        /**
+         * @brief Returns the round trip time measured by the latest pong of the connection, 0 before the first.
+         * Pongs answer ping() and the pings sent every WebsocketOptions::ping_interval.
+         */
+        std::chrono::nanoseconds pingRoundTripTime() const;
+
         /**
          * @brief Initiates a Text-to-Speech generation request via streaming.
+         *
+         * The request is queued for the connection's I/O engine, so the call never blocks on the network and may
+         * be made from several threads at once. Returns false if the socket is not connected.
          * @param request The GenerationRequest containing generation parameters.
          */
         bool requestTTS(const request::tts::GenerationRequest& request) const;
 
+        /**
+         * @brief Sends a TTS generation request built from a prepared template, without re-serializing its invariant fields.
+         * @param request The prepared template, must not be shared with another sending thread.
+         * @param transcript The text to synthesize.
+         * @param contextId The context ID of the request, may be empty.
+         * @param continue_ Whether more text will follow on this context.
+         * @param flush Whether to flush the buffered text of the context.
+         */
+        bool requestTTS(request::tts::PreparedGenerationRequest& request,
+            const std::string& transcript,
+            const std::string& contextId,
+            bool continue_ = true,
+            bool flush = false) const;
+
         /**
          * @brief Cancels an ongoing TTS context/session.
          * @param request The TTSCancelContextRequest containing the context ID to cancel.
@@ -57,7 +153,7 @@ namespace cartesiapp {
         bool cancelTTSContext(const request::tts::CancelContextRequest& request) const;
 
         /**
-         * @brief Registers a TTS response listener.
+         * @brief Registers a TTS response listener. May be called while connected, e.g. on a pooled client.
          * @param listener A weak pointer to the TTSResponseListener to register.
          */
         void registerTTSListener(std::weak_ptr<TTSResponseListener> listener);
@@ -68,8 +164,19 @@ namespace cartesiapp {
         void unregisterTTSListener();
 
         private:
+        std::shared_ptr<TTSResponseListener> currentListener() const;
+
+        // declared before the implementation so it outlives the reads awaited by its destructor
+        std::unique_ptr<FirstChunkTracker> _firstChunkTracker;
+        std::unique_ptr<ListenerDispatcher> _dispatcher;
         std::unique_ptr<WebsocketClientImpl> _websocketClientImpl;
+        // swapped by users while the I/O thread reads it
+        mutable std::mutex _listenerMutex;
         std::weak_ptr<TTSResponseListener> _ttsListener;
+        std::pmr::memory_resource* _memoryResource = nullptr;
+        bool _lazyTimestamps = false;
+        std::shared_ptr<TimestampIndex> _timestampIndex;
+        ListenerDispatchOptions _dispatchOptions;
         std::string _apiVersion;
         std::string _apiKey;
     };
@@ -106,6 +213,16 @@ namespace cartesiapp {
          */
         virtual void onAudioChunkReceived(const response::tts::AudioChunkResponse& response) = 0;
 
+        /**
+         * @brief Callback method invoked for every TTS audio chunk, before any copy of the audio is made.
+         *
+         * The view points into buffers reused by the next frame of the connection, so it must not outlive
+         * the callback. The default implementation copies the chunk and forwards it to onAudioChunkReceived();
+         * override it to consume the audio in place without any per-chunk allocation.
+         * @param chunk The AudioChunkView of the received chunk.
+         */
+        virtual void onAudioChunkView(const response::tts::AudioChunkView& chunk);
+
         /**
          * @brief Callback method invoked when a TTS done response is received.
          * @param response The DoneResponse received from the TTS service.
@@ -124,6 +241,24 @@ namespace cartesiapp {
          */
         virtual void onPhonemeTimestampsReceived(const response::tts::PhonemeTimestampsResponse& response) = 0;
 
+        /**
+         * @brief Callback method invoked for word timestamps when lazy timestamps are enabled on the client.
+         *
+         * The response is backed by the connection's frame arena and must be copied to be kept after the callback.
+         * The default implementation decodes it and forwards it to onWordTimestampsReceived().
+         * @param response The LazyWordTimestampsResponse holding the undecoded frame.
+         */
+        virtual void onLazyWordTimestampsReceived(const response::tts::LazyWordTimestampsResponse& response);
+
+        /**
+         * @brief Callback method invoked for phoneme timestamps when lazy timestamps are enabled on the client.
+         *
+         * The response is backed by the connection's frame arena and must be copied to be kept after the callback.
+         * The default implementation decodes it and forwards it to onPhonemeTimestampsReceived().
+         * @param response The LazyPhonemeTimestampsResponse holding the undecoded frame.
+         */
+        virtual void onLazyPhonemeTimestampsReceived(const response::tts::LazyPhonemeTimestampsResponse& response);
+
         /**
          * @brief Callback method invoked when a flush done response is received.
          * @param response The FlushDoneResponse received from the TTS service.
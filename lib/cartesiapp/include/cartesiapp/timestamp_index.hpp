@@ -0,0 +1,134 @@
+#ifndef CARTESIAPP_TIMESTAMP_INDEX_HPP
+#define CARTESIAPP_TIMESTAMP_INDEX_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <optional>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "cartesiapp_export.hpp"
+#include "cartesiapp_response.hpp"
+
+namespace cartesiapp {
+    /**
+     * @brief Accumulates the word and phoneme timings of TTS contexts for "what is playing at time t" lookups.
+     *
+     * Timings are appended per context into contiguous struct-of-arrays tracks (float start and end, interned
+     * text) kept sorted by start time, so lookups are binary searches over a single array. Feed it from a
+     * listener, or attach it with TTSWebsocketClient::setTimestampIndex() to have the reception thread feed it.
+     *
+     * Timings outlive the generation of their context, since its audio usually plays on after the done event.
+     * Contexts marked finished are dropped oldest first once more than a bounded number of them are kept.
+     *
+     * Thread-safe: appends take an exclusive lock, lookups a shared one.
+     */
+    class CARTESIAPP_EXPORT TimestampIndex {
+        public:
+        /**
+         * @param maxFinishedContexts The number of finished contexts whose timings are kept.
+         */
+        explicit TimestampIndex(size_t maxFinishedContexts = 16);
+
+        /**
+         * @brief A timed word or phoneme. The text points into the index and stays valid until clear().
+         */
+        struct Entry {
+            std::string_view text;
+            float start = 0.0f;
+            float end = 0.0f;
+        };
+
+        /**
+         * @brief Appends the words of a timestamps event to the track of its context.
+         */
+        void addWords(const response::tts::WordTimestampsResponse& response);
+
+        /**
+         * @brief Appends the phonemes of a timestamps event to the track of its context.
+         */
+        void addPhonemes(const response::tts::PhonemeTimestampsResponse& response);
+
+        /**
+         * @brief Returns the word playing at the given time of a context, if any.
+         * @param contextId The context ID, empty for events without one.
+         * @param time Seconds since the start of the context's audio.
+         */
+        std::optional<Entry> wordAt(const std::string& contextId, float time) const;
+
+        /**
+         * @brief Returns the phoneme playing at the given time of a context, if any.
+         * @param contextId The context ID, empty for events without one.
+         * @param time Seconds since the start of the context's audio.
+         */
+        std::optional<Entry> phonemeAt(const std::string& contextId, float time) const;
+
+        /**
+         * @brief Appends the words of a context overlapping [from, to) to the output, in start order.
+         * @return The number of entries appended.
+         */
+        size_t wordsInRange(const std::string& contextId, float from, float to, std::vector<Entry>& out) const;
+
+        /**
+         * @brief Appends the phonemes of a context overlapping [from, to) to the output, in start order.
+         * @return The number of entries appended.
+         */
+        size_t phonemesInRange(const std::string& contextId, float from, float to, std::vector<Entry>& out) const;
+
+        /**
+         * @brief Marks a context as finished, called by the client on its done or error event. Its timings stay
+         * available until more than maxFinishedContexts later contexts have finished.
+         */
+        void finishContext(const std::string& contextId);
+
+        /**
+         * @brief Drops the timings of a context. Interned text is kept for the other contexts.
+         */
+        void clearContext(const std::string& contextId);
+
+        /**
+         * @brief Drops all timings and interned text, invalidating every Entry handed out.
+         */
+        void clear();
+
+        private:
+        /**
+         * @brief Timings of one kind for one context, as parallel arrays sorted by start time.
+         */
+        struct Track {
+            std::vector<float> starts;
+            std::vector<float> ends;
+            // running maximum of ends, an entry can outlast later-starting ones
+            std::vector<float> maxEnds;
+            std::vector<uint32_t> symbols;
+
+            void append(uint32_t symbol, float start, float end);
+            std::optional<size_t> find(float time) const;
+        };
+
+        struct Timeline {
+            Track words;
+            Track phonemes;
+        };
+
+        uint32_t intern(const std::string& text);
+        Entry entryAt(const Track& track, size_t index) const;
+        std::optional<Entry> lookup(const std::string& contextId, Track Timeline::* track, float time) const;
+        size_t collect(const std::string& contextId, Track Timeline::* track, float from, float to, std::vector<Entry>& out) const;
+
+        const size_t _maxFinishedContexts;
+        mutable std::shared_mutex _mutex;
+        std::unordered_map<std::string, Timeline> _timelines;
+        // finished contexts, oldest first
+        std::deque<std::string> _finished;
+        // deque elements never move, so the map keys and handed-out entries can view them
+        std::deque<std::string> _symbols;
+        std::unordered_map<std::string_view, uint32_t> _symbolIds;
+    };
+}
+
+#endif // CARTESIAPP_TIMESTAMP_INDEX_HPP
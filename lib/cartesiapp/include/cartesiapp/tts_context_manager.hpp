@@ -0,0 +1,73 @@
+#ifndef CARTESIAPP_TTS_CONTEXT_MANAGER_HPP
+#define CARTESIAPP_TTS_CONTEXT_MANAGER_HPP
+
+#include <cstddef>
+#include <memory>
+#include <string>
+
+#include "cartesiapp_export.hpp"
+#include "streaming_tts.hpp"
+
+namespace cartesiapp {
+    // Forward declaration of implementation class
+    class TTSContextManagerImpl;
+
+    /**
+     * @brief Multiplexes many concurrent TTS contexts over a single TTSWebsocketClient.
+     *
+     * Each context is opened with its own listener; chunk, timestamps, flush_done, done and error events are
+     * routed to it by context_id. At most `maxConcurrentContexts` contexts are open on the socket at once,
+     * further contexts wait in a local FIFO queue and are sent as soon as a running one is done. A queued
+     * context whose requests cannot be sent when it starts is dropped, and its listener receives onError().
+     *
+     * The manager registers itself as the client's listener, so the client must not be given another one,
+     * and the client must outlive the manager. Thread-safe; listeners are invoked on the client's I/O thread
+     * without any lock held, so they may submit or cancel contexts from their callbacks.
+     */
+    class CARTESIAPP_EXPORT TTSContextManager {
+        public:
+        /**
+         * @brief Takes over the listener slot of the client.
+         * @param client The connection the contexts run on.
+         * @param maxConcurrentContexts The number of contexts open on the socket at once, 0 for no limit.
+         */
+        TTSContextManager(TTSWebsocketClient& client, size_t maxConcurrentContexts = 0);
+        ~TTSContextManager();
+
+        TTSContextManager(const TTSContextManager&) = delete;
+        TTSContextManager& operator=(const TTSContextManager&) = delete;
+
+        /**
+         * @brief Sends a generation request on its context, opening or queueing the context on its first request.
+         *
+         * Continuations of a context that is still queued are kept with it and sent in order once it starts.
+         * @param request The request, its context_id is required.
+         * @param listener The listener of the context, required to open a context and ignored for continuations.
+         * @return false if the request has no context ID, opens a context without a listener, or could not be sent.
+         */
+        bool submit(const request::tts::GenerationRequest& request,
+            std::shared_ptr<TTSResponseListener> listener = nullptr);
+
+        /**
+         * @brief Cancels a context: a queued one is dropped, an open one is cancelled on the server and its slot
+         * released right away. Its listener receives no further events.
+         * @return false if the context is unknown.
+         */
+        bool cancel(const std::string& contextId);
+
+        /**
+         * @brief Returns the number of contexts open on the socket.
+         */
+        size_t activeContexts() const;
+
+        /**
+         * @brief Returns the number of contexts waiting for a free slot.
+         */
+        size_t queuedContexts() const;
+
+        private:
+        std::shared_ptr<TTSContextManagerImpl> _impl;
+    };
+}
+
+#endif // CARTESIAPP_TTS_CONTEXT_MANAGER_HPP
@@ -0,0 +1,96 @@
+#ifndef CARTESIAPP_TTS_WEBSOCKET_POOL_HPP
+#define CARTESIAPP_TTS_WEBSOCKET_POOL_HPP
+
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <string>
+
+#include "cartesiapp_export.hpp"
+#include "streaming_tts.hpp"
+
+namespace cartesiapp {
+    // Forward declaration of implementation class
+    class TTSWebsocketPoolImpl;
+
+    /**
+     * @brief Options of a TTSWebsocketPool.
+     */
+    struct CARTESIAPP_EXPORT TTSWebsocketPoolOptions {
+        /**
+         * @brief The number of connected sockets kept ready to be handed out.
+         */
+        size_t size = 4;
+
+        /**
+         * @brief How often idle sockets are pinged to keep them open.
+         */
+        std::chrono::milliseconds keepalive_interval{ 15000 };
+
+        /**
+         * @brief The delay before connecting again after a failed attempt to replenish the pool.
+         */
+        std::chrono::milliseconds retry_interval{ 1000 };
+
+        /**
+         * @brief The connection options of the pooled clients.
+         */
+        WebsocketOptions websocket;
+
+        /**
+         * @brief The engine running the pooled connections, nullptr for one private engine per client.
+         */
+        std::shared_ptr<IoEngine> io_engine;
+
+        /**
+         * @brief The listener dispatch stage of the pooled clients.
+         */
+        ListenerDispatchOptions listener_dispatch;
+    };
+
+    /**
+     * @brief Keeps TTS WebSocket connections upgraded and authenticated ahead of time, so a session starts on a
+     * ready socket instead of paying for DNS, TCP, TLS and the upgrade.
+     *
+     * A background thread connects sockets until `size` are idle, pings them every `keepalive_interval` and
+     * replaces those that dropped. Thread-safe.
+     */
+    class CARTESIAPP_EXPORT TTSWebsocketPool {
+        public:
+        TTSWebsocketPool(const std::string& apiKey,
+            const TTSWebsocketPoolOptions& options = TTSWebsocketPoolOptions(),
+            const std::string& apiVersion = request::api_versions::LATEST);
+
+        /**
+         * @brief Stops the background thread and disconnects the idle sockets. Clients handed out are not affected.
+         */
+        ~TTSWebsocketPool();
+
+        TTSWebsocketPool(const TTSWebsocketPool&) = delete;
+        TTSWebsocketPool& operator=(const TTSWebsocketPool&) = delete;
+
+        /**
+         * @brief Hands out a connected client, without a listener. When no socket is ready, one is connected on the
+         * calling thread.
+         * @return The client, or nullptr if no socket was ready and connecting failed.
+         */
+        std::unique_ptr<TTSWebsocketClient> acquire();
+
+        /**
+         * @brief Returns a client whose session ended cleanly, with no context still streaming. Its listener is
+         * unregistered and it is kept for reuse if it is still connected and the pool is not full, otherwise it
+         * is disconnected.
+         */
+        void release(std::unique_ptr<TTSWebsocketClient> client);
+
+        /**
+         * @brief Returns the number of connected sockets ready to be handed out.
+         */
+        size_t idleConnections() const;
+
+        private:
+        std::unique_ptr<TTSWebsocketPoolImpl> _impl;
+    };
+}
+
+#endif // CARTESIAPP_TTS_WEBSOCKET_POOL_HPP
@@ -0,0 +1,115 @@
+#ifndef CARTESIAPP_WEBSOCKET_OPTIONS_HPP
+#define CARTESIAPP_WEBSOCKET_OPTIONS_HPP
+
+#include <chrono>
+#include <string>
+
+#include "cartesiapp_export.hpp"
+#include "cartesiapp_request.hpp"
+
+namespace cartesiapp {
+
+    /**
+     * @brief permessage-deflate (RFC 7692) settings offered in the WebSocket upgrade. The server may decline the
+     * extension, the connection is then uncompressed.
+     */
+    struct CARTESIAPP_EXPORT WebsocketCompressionOptions {
+        /**
+         * @brief Offers the extension. Worth it for JSON traffic such as TTS chunks and timestamps, not for raw audio.
+         */
+        bool enabled = false;
+
+        /**
+         * @brief LZ77 window of the messages the client sends, 9 to 15 bits.
+         */
+        int client_max_window_bits = 15;
+
+        /**
+         * @brief LZ77 window requested for the messages the server sends, 9 to 15 bits.
+         */
+        int server_max_window_bits = 15;
+
+        /**
+         * @brief Resets the client compressor after every message, trading ratio for memory.
+         */
+        bool client_no_context_takeover = false;
+
+        /**
+         * @brief Asks the server to reset its compressor after every message.
+         */
+        bool server_no_context_takeover = false;
+
+        /**
+         * @brief Outgoing messages smaller than this are sent uncompressed. Requires Boost 1.81 or later,
+         * older versions compress every message.
+         */
+        size_t threshold_bytes = 0;
+
+        /**
+         * @brief Deflate level of the messages the client sends, 0 to 9.
+         */
+        int level = 6;
+
+        /**
+         * @brief Deflate memory level, 1 to 9.
+         */
+        int mem_level = 8;
+    };
+
+    /**
+     * @brief Connection options shared by the TTS and STT WebSocket clients.
+     */
+    struct CARTESIAPP_EXPORT WebsocketOptions {
+        /**
+         * @brief The host to connect to. Defaults to the Cartesia API host, override it to target a proxy or a local test server.
+         */
+        std::string host = request::constants::HOST;
+
+        /**
+         * @brief The TCP port to connect to.
+         */
+        std::string port = "443";
+
+        /**
+         * @brief Merges consecutive queued binary (audio) messages into a single frame of up to 64 KiB when the
+         * writer falls behind. Disable it for servers that expect one message per audio write.
+         */
+        bool coalesce_binary_messages = true;
+
+        /**
+         * @brief Per-message compression of the connection.
+         */
+        WebsocketCompressionOptions compression;
+
+        /**
+         * @brief Adds the CPU time of the connection's I/O handlers (TLS, framing, compression), excluding the
+         * listener callbacks, to the websocket_io_cpu metric. Costs a thread CPU clock read per frame.
+         *
+         * The time is measured per I/O thread between the connection's read and write completions, so it is only
+         * attributed correctly when the connection runs alone on its IoEngine. On a shared engine it also counts
+         * the handlers and callbacks of the other connections served by the same threads in between.
+         */
+        bool record_io_cpu_time = false;
+
+        /**
+         * @brief Upper bound of the TCP connect, TLS handshake and WebSocket upgrade of a connect attempt,
+         * 0 to wait for the operating system. DNS resolution is not covered.
+         */
+        std::chrono::milliseconds handshake_timeout{ 10000 };
+
+        /**
+         * @brief Interval of the pings sent on the connection, 0 to send none. Each pong updates the round trip
+         * time of the connection and the websocket_ping_rtt metric.
+         */
+        std::chrono::milliseconds ping_interval{ 0 };
+
+        /**
+         * @brief Dead peer detection, 0 to wait for the operating system. Once half of it passes without receiving
+         * anything the client pings the server, and if the other half passes without an answer either, the
+         * connection fails with a network error. A live but quiet server answers the ping and is never cut off.
+         */
+        std::chrono::milliseconds idle_timeout{ 0 };
+    };
+}
+
+#endif // CARTESIAPP_WEBSOCKET_OPTIONS_HPP
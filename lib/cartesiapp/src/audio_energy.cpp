@@ -0,0 +1,296 @@
+#include "impl/audio_energy.hpp"
+
+#include <cstdint>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define CARTESIAPP_ENERGY_X86
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#define CARTESIAPP_ENERGY_NEON
+#include <arm_neon.h>
+#endif
+
+// GCC and Clang only emit vector instructions for functions explicitly targeting them, MSVC always does
+#if defined(CARTESIAPP_ENERGY_X86) && (defined(__GNUC__) || defined(__clang__))
+#define CARTESIAPP_TARGET(features) __attribute__((target(features)))
+#else
+#define CARTESIAPP_TARGET(features)
+#endif
+
+namespace {
+    constexpr double S16_FULL_SCALE_SQUARED = 32768.0 * 32768.0;
+
+    /**
+     * @brief Squares of the 16-bit linear values of the 256 codes of a G.711 law.
+     */
+    struct G711SquareTable {
+        uint32_t values[256];
+
+        constexpr explicit G711SquareTable(bool alaw) : values() {
+            for (int code = 0; code < 256; ++code) {
+                int magnitude = 0;
+                if (alaw) {
+                    int bits = code ^ 0x55;
+                    int exponent = (bits >> 4) & 0x07;
+                    int mantissa = bits & 0x0F;
+                    magnitude = exponent == 0 ? (mantissa << 4) + 8 : ((mantissa << 4) + 0x108) << (exponent - 1);
+                }
+                else {
+                    int bits = ~code & 0xFF;
+                    int exponent = (bits >> 4) & 0x07;
+                    int mantissa = bits & 0x0F;
+                    magnitude = (((mantissa << 3) + 0x84) << exponent) - 0x84;
+                }
+                // the sign bit does not change the square
+                values[code] = static_cast<uint32_t>(magnitude) * static_cast<uint32_t>(magnitude);
+            }
+        }
+    };
+
+    constexpr G711SquareTable MULAW_SQUARES(false);
+    constexpr G711SquareTable ALAW_SQUARES(true);
+
+    /**
+     * @brief Adds the squares of whole vectors of samples from the start of the input to the sum.
+     * @return Number of samples consumed, the scalar tail handles the rest.
+     */
+    using S16Kernel = size_t(*)(const char* data, size_t samples, uint64_t& sum);
+    using F32Kernel = size_t(*)(const char* data, size_t samples, double& sum);
+
+    uint64_t sumSquaresS16Scalar(const char* data, size_t samples) {
+        uint64_t sum = 0;
+        for (size_t i = 0; i < samples; ++i) {
+            int16_t sample;
+            std::memcpy(&sample, data + i * sizeof(int16_t), sizeof(int16_t));
+            sum += static_cast<uint64_t>(static_cast<int64_t>(sample) * sample);
+        }
+        return sum;
+    }
+
+    double sumSquaresF32Scalar(const char* data, size_t samples) {
+        double sum = 0.0;
+        for (size_t i = 0; i < samples; ++i) {
+            float sample;
+            std::memcpy(&sample, data + i * sizeof(float), sizeof(float));
+            sum += static_cast<double>(sample) * sample;
+        }
+        return sum;
+    }
+
+#ifdef CARTESIAPP_ENERGY_X86
+    CARTESIAPP_TARGET("sse2")
+    size_t sumSquaresS16Sse2(const char* data, size_t samples, uint64_t& sum) {
+        const __m128i zero = _mm_setzero_si128();
+        __m128i total = zero;
+        size_t i = 0;
+        for (; i + 8 <= samples; i += 8) {
+            __m128i values = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i * 2));
+            // a sum of two squares is at most 2^31, it fits in an unsigned 32-bit lane
+            __m128i pairs = _mm_madd_epi16(values, values);
+            total = _mm_add_epi64(total, _mm_unpacklo_epi32(pairs, zero));
+            total = _mm_add_epi64(total, _mm_unpackhi_epi32(pairs, zero));
+        }
+        alignas(16) uint64_t lanes[2];
+        _mm_store_si128(reinterpret_cast<__m128i*>(lanes), total);
+        sum += lanes[0] + lanes[1];
+        return i;
+    }
+
+    CARTESIAPP_TARGET("sse2")
+    size_t sumSquaresF32Sse2(const char* data, size_t samples, double& sum) {
+        __m128d total = _mm_setzero_pd();
+        size_t i = 0;
+        for (; i + 4 <= samples; i += 4) {
+            __m128 values = _mm_loadu_ps(reinterpret_cast<const float*>(data + i * 4));
+            __m128d low = _mm_cvtps_pd(values);
+            __m128d high = _mm_cvtps_pd(_mm_movehl_ps(values, values));
+            total = _mm_add_pd(total, _mm_add_pd(_mm_mul_pd(low, low), _mm_mul_pd(high, high)));
+        }
+        alignas(16) double lanes[2];
+        _mm_store_pd(lanes, total);
+        sum += lanes[0] + lanes[1];
+        return i;
+    }
+
+    CARTESIAPP_TARGET("avx2")
+    size_t sumSquaresS16Avx2(const char* data, size_t samples, uint64_t& sum) {
+        const __m256i zero = _mm256_setzero_si256();
+        __m256i total = zero;
+        size_t i = 0;
+        for (; i + 16 <= samples; i += 16) {
+            __m256i values = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i * 2));
+            __m256i pairs = _mm256_madd_epi16(values, values);
+            total = _mm256_add_epi64(total, _mm256_unpacklo_epi32(pairs, zero));
+            total = _mm256_add_epi64(total, _mm256_unpackhi_epi32(pairs, zero));
+        }
+        alignas(32) uint64_t lanes[4];
+        _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), total);
+        sum += lanes[0] + lanes[1] + lanes[2] + lanes[3];
+        return i;
+    }
+
+    CARTESIAPP_TARGET("avx2")
+    size_t sumSquaresF32Avx2(const char* data, size_t samples, double& sum) {
+        __m256d total = _mm256_setzero_pd();
+        size_t i = 0;
+        for (; i + 8 <= samples; i += 8) {
+            __m256 values = _mm256_loadu_ps(reinterpret_cast<const float*>(data + i * 4));
+            __m256d low = _mm256_cvtps_pd(_mm256_castps256_ps128(values));
+            __m256d high = _mm256_cvtps_pd(_mm256_extractf128_ps(values, 1));
+            total = _mm256_add_pd(total, _mm256_add_pd(_mm256_mul_pd(low, low), _mm256_mul_pd(high, high)));
+        }
+        alignas(32) double lanes[4];
+        _mm256_store_pd(lanes, total);
+        sum += lanes[0] + lanes[1] + lanes[2] + lanes[3];
+        return i;
+    }
+#endif
+
+#ifdef CARTESIAPP_ENERGY_NEON
+    size_t sumSquaresS16Neon(const char* data, size_t samples, uint64_t& sum) {
+        int64x2_t total = vdupq_n_s64(0);
+        size_t i = 0;
+        for (; i + 8 <= samples; i += 8) {
+            int16x8_t values = vld1q_s16(reinterpret_cast<const int16_t*>(data + i * 2));
+            // a single square is at most 2^30, the widening multiply cannot overflow
+            total = vpadalq_s32(total, vmull_s16(vget_low_s16(values), vget_low_s16(values)));
+            total = vpadalq_s32(total, vmull_high_s16(values, values));
+        }
+        sum += static_cast<uint64_t>(vaddvq_s64(total));
+        return i;
+    }
+
+    size_t sumSquaresF32Neon(const char* data, size_t samples, double& sum) {
+        float64x2_t total = vdupq_n_f64(0.0);
+        size_t i = 0;
+        for (; i + 4 <= samples; i += 4) {
+            float32x4_t values = vld1q_f32(reinterpret_cast<const float*>(data + i * 4));
+            float64x2_t low = vcvt_f64_f32(vget_low_f32(values));
+            float64x2_t high = vcvt_high_f64_f32(values);
+            total = vfmaq_f64(total, low, low);
+            total = vfmaq_f64(total, high, high);
+        }
+        sum += vaddvq_f64(total);
+        return i;
+    }
+#endif
+
+    struct Kernel {
+        const char* name;
+        S16Kernel sumSquaresS16;
+        F32Kernel sumSquaresF32;
+    };
+
+    Kernel selectKernel() {
+#if defined(CARTESIAPP_ENERGY_X86)
+#if defined(_MSC_VER) && !defined(__clang__)
+        int info[4];
+        __cpuid(info, 0);
+        int maxLeaf = info[0];
+        __cpuid(info, 1);
+        bool sse2 = (info[3] & (1 << 26)) != 0;
+        // AVX registers are only usable if the OS saves them on context switches
+        bool osSavesAvx = (info[2] & (1 << 27)) != 0 && (info[2] & (1 << 28)) != 0 && (_xgetbv(0) & 0x6) == 0x6;
+        bool avx2 = false;
+        if (maxLeaf >= 7 && osSavesAvx) {
+            __cpuidex(info, 7, 0);
+            avx2 = (info[1] & (1 << 5)) != 0;
+        }
+#else
+        __builtin_cpu_init();
+        bool sse2 = __builtin_cpu_supports("sse2");
+        bool avx2 = __builtin_cpu_supports("avx2");
+#endif
+        if (avx2) {
+            return { "avx2", sumSquaresS16Avx2, sumSquaresF32Avx2 };
+        }
+        if (sse2) {
+            return { "sse2", sumSquaresS16Sse2, sumSquaresF32Sse2 };
+        }
+#elif defined(CARTESIAPP_ENERGY_NEON)
+        // NEON is mandatory on AArch64
+        return { "neon", sumSquaresS16Neon, sumSquaresF32Neon };
+#endif
+        return { "scalar", nullptr, nullptr };
+    }
+
+    const Kernel& selectedKernel() {
+        static const Kernel kernel = selectKernel();
+        return kernel;
+    }
+
+    double meanSquareG711(const G711SquareTable& table, const char* data, size_t samples) {
+        uint64_t sum = 0;
+        for (size_t i = 0; i < samples; ++i) {
+            sum += table.values[static_cast<uint8_t>(data[i])];
+        }
+        return static_cast<double>(sum) / S16_FULL_SCALE_SQUARED / static_cast<double>(samples);
+    }
+}
+
+bool cartesiapp::codec::sampleFormatOf(const std::string& encoding, SampleFormat& format)
+{
+    if (encoding == "pcm_s16le") {
+        format = SampleFormat::PCM_S16LE;
+    }
+    else if (encoding == "pcm_f32le") {
+        format = SampleFormat::PCM_F32LE;
+    }
+    else if (encoding == "pcm_mulaw") {
+        format = SampleFormat::PCM_MULAW;
+    }
+    else if (encoding == "pcm_alaw") {
+        format = SampleFormat::PCM_ALAW;
+    }
+    else {
+        return false;
+    }
+    return true;
+}
+
+size_t cartesiapp::codec::sampleBytesOf(SampleFormat format)
+{
+    switch (format) {
+    case SampleFormat::PCM_S16LE:
+        return 2;
+    case SampleFormat::PCM_F32LE:
+        return 4;
+    default:
+        return 1;
+    }
+}
+
+double cartesiapp::codec::meanSquare(SampleFormat format, const char* data, size_t samples)
+{
+    if (samples == 0) {
+        return 0.0;
+    }
+    const Kernel& kernel = selectedKernel();
+    switch (format) {
+    case SampleFormat::PCM_S16LE: {
+        uint64_t sum = 0;
+        size_t consumed = kernel.sumSquaresS16 ? kernel.sumSquaresS16(data, samples, sum) : 0;
+        sum += sumSquaresS16Scalar(data + consumed * 2, samples - consumed);
+        return static_cast<double>(sum) / S16_FULL_SCALE_SQUARED / static_cast<double>(samples);
+    }
+    case SampleFormat::PCM_F32LE: {
+        double sum = 0.0;
+        size_t consumed = kernel.sumSquaresF32 ? kernel.sumSquaresF32(data, samples, sum) : 0;
+        sum += sumSquaresF32Scalar(data + consumed * 4, samples - consumed);
+        return sum / static_cast<double>(samples);
+    }
+    case SampleFormat::PCM_MULAW:
+        return meanSquareG711(MULAW_SQUARES, data, samples);
+    default:
+        return meanSquareG711(ALAW_SQUARES, data, samples);
+    }
+}
+
+const char* cartesiapp::codec::audioEnergyKernelName()
+{
+    return selectedKernel().name;
+}
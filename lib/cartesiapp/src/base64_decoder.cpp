@@ -0,0 +1,314 @@
+#include "impl/base64_decoder.hpp"
+
+#include <cstdint>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define CARTESIAPP_BASE64_X86
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#define CARTESIAPP_BASE64_NEON
+#include <arm_neon.h>
+#endif
+
+// GCC and Clang only emit vector instructions for functions explicitly targeting them, MSVC always does
+#if defined(CARTESIAPP_BASE64_X86) && (defined(__GNUC__) || defined(__clang__))
+#define CARTESIAPP_TARGET(features) __attribute__((target(features)))
+#else
+#define CARTESIAPP_TARGET(features)
+#endif
+
+namespace {
+    constexpr uint8_t INVALID = 0xFF;
+
+    struct DecodeTable {
+        uint8_t values[256];
+
+        constexpr DecodeTable() : values() {
+            constexpr char alphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+            for (int i = 0; i < 256; ++i) {
+                values[i] = INVALID;
+            }
+            for (int i = 0; i < 64; ++i) {
+                values[static_cast<uint8_t>(alphabet[i])] = static_cast<uint8_t>(i);
+            }
+        }
+    };
+
+    constexpr DecodeTable DECODE_TABLE;
+
+    /*
+     * The vector kernels translate characters to 6-bit values with the nibble lookup scheme of
+     * W. Muła and D. Lemire, "Faster Base64 Encoding and Decoding Using AVX2 Instructions" (2018):
+     * - a character is valid iff LUT_LO[low nibble] & LUT_HI[high nibble] == 0
+     * - its value is the character plus LUT_ROLL[high nibble], '/' being shifted to its own slot
+     */
+    alignas(16) constexpr uint8_t LUT_LO[16] = {
+        0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x13, 0x1A, 0x1B, 0x1B, 0x1B, 0x1A
+    };
+    alignas(16) constexpr uint8_t LUT_HI[16] = {
+        0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10
+    };
+    alignas(16) constexpr uint8_t LUT_ROLL[16] = {
+        0, 16, 19, 4, 191, 191, 185, 185, 0, 0, 0, 0, 0, 0, 0, 0 // 191 == -65, 185 == -71
+    };
+
+    /**
+     * @brief Decodes whole blocks from the start of the input into the output.
+     *
+     * Stops before the first block holding a character outside the alphabet, the scalar tail then reports it.
+     * @return Number of input characters consumed, always a multiple of 4.
+     */
+    using BlockKernel = size_t(*)(const uint8_t* in, size_t length, uint8_t* out);
+
+    /**
+     * @brief Decodes unpadded base64 of any valid length, used for the input left over by the block kernels.
+     */
+    bool decodeScalar(const uint8_t* in, size_t length, uint8_t* out) {
+        const uint8_t* table = DECODE_TABLE.values;
+        size_t i = 0;
+        for (; i + 4 <= length; i += 4) {
+            uint32_t a = table[in[i]];
+            uint32_t b = table[in[i + 1]];
+            uint32_t c = table[in[i + 2]];
+            uint32_t d = table[in[i + 3]];
+            if ((a | b | c | d) & 0x80) {
+                return false;
+            }
+            uint32_t bits = (a << 18) | (b << 12) | (c << 6) | d;
+            out[0] = static_cast<uint8_t>(bits >> 16);
+            out[1] = static_cast<uint8_t>(bits >> 8);
+            out[2] = static_cast<uint8_t>(bits);
+            out += 3;
+        }
+        size_t rest = length - i;
+        if (rest == 0) {
+            return true;
+        }
+        if (rest == 1) {
+            return false;
+        }
+        uint32_t a = table[in[i]];
+        uint32_t b = table[in[i + 1]];
+        uint32_t c = rest == 3 ? table[in[i + 2]] : 0;
+        if ((a | b | c) & 0x80) {
+            return false;
+        }
+        uint32_t bits = (a << 18) | (b << 12) | (c << 6);
+        out[0] = static_cast<uint8_t>(bits >> 16);
+        if (rest == 3) {
+            out[1] = static_cast<uint8_t>(bits >> 8);
+        }
+        return true;
+    }
+
+#ifdef CARTESIAPP_BASE64_X86
+    CARTESIAPP_TARGET("ssse3,sse4.1")
+    size_t decodeBlocksSse41(const uint8_t* in, size_t length, uint8_t* out) {
+        const __m128i lutLo = _mm_load_si128(reinterpret_cast<const __m128i*>(LUT_LO));
+        const __m128i lutHi = _mm_load_si128(reinterpret_cast<const __m128i*>(LUT_HI));
+        const __m128i lutRoll = _mm_load_si128(reinterpret_cast<const __m128i*>(LUT_ROLL));
+        const __m128i nibbleMask = _mm_set1_epi8(0x0F);
+        const __m128i slash = _mm_set1_epi8('/');
+        // merge 4 x 6 bits into 24 bits per 32-bit lane, then gather the 3 bytes of each lane
+        const __m128i mergePairs = _mm_set1_epi32(0x01400140);
+        const __m128i mergeQuads = _mm_set1_epi32(0x00011000);
+        const __m128i gatherBytes = _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1);
+
+        size_t consumed = 0;
+        // a block decodes 12 bytes but stores 16, keep going only while the extra bytes land inside the output
+        while (consumed + 24 <= length) {
+            __m128i chars = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + consumed));
+            __m128i hiNibbles = _mm_and_si128(_mm_srli_epi32(chars, 4), nibbleMask);
+            __m128i lo = _mm_shuffle_epi8(lutLo, _mm_and_si128(chars, nibbleMask));
+            __m128i hi = _mm_shuffle_epi8(lutHi, hiNibbles);
+            if (!_mm_testz_si128(lo, hi)) {
+                break;
+            }
+            __m128i roll = _mm_shuffle_epi8(lutRoll, _mm_add_epi8(_mm_cmpeq_epi8(chars, slash), hiNibbles));
+            __m128i values = _mm_add_epi8(chars, roll);
+            __m128i merged = _mm_madd_epi16(_mm_maddubs_epi16(values, mergePairs), mergeQuads);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out), _mm_shuffle_epi8(merged, gatherBytes));
+            consumed += 16;
+            out += 12;
+        }
+        return consumed;
+    }
+
+    CARTESIAPP_TARGET("avx2")
+    size_t decodeBlocksAvx2(const uint8_t* in, size_t length, uint8_t* out) {
+        const __m256i lutLo = _mm256_broadcastsi128_si256(_mm_load_si128(reinterpret_cast<const __m128i*>(LUT_LO)));
+        const __m256i lutHi = _mm256_broadcastsi128_si256(_mm_load_si128(reinterpret_cast<const __m128i*>(LUT_HI)));
+        const __m256i lutRoll = _mm256_broadcastsi128_si256(_mm_load_si128(reinterpret_cast<const __m128i*>(LUT_ROLL)));
+        const __m256i nibbleMask = _mm256_set1_epi8(0x0F);
+        const __m256i slash = _mm256_set1_epi8('/');
+        const __m256i mergePairs = _mm256_set1_epi32(0x01400140);
+        const __m256i mergeQuads = _mm256_set1_epi32(0x00011000);
+        const __m256i gatherBytes = _mm256_setr_epi8(
+            2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1,
+            2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1);
+        // the byte shuffle works per 128-bit lane, join the two 12-byte halves
+        const __m256i joinLanes = _mm256_setr_epi32(0, 1, 2, 4, 5, 6, -1, -1);
+
+        size_t consumed = 0;
+        // a block decodes 24 bytes but stores 32
+        while (consumed + 48 <= length) {
+            __m256i chars = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + consumed));
+            __m256i hiNibbles = _mm256_and_si256(_mm256_srli_epi32(chars, 4), nibbleMask);
+            __m256i lo = _mm256_shuffle_epi8(lutLo, _mm256_and_si256(chars, nibbleMask));
+            __m256i hi = _mm256_shuffle_epi8(lutHi, hiNibbles);
+            if (!_mm256_testz_si256(lo, hi)) {
+                break;
+            }
+            __m256i roll = _mm256_shuffle_epi8(lutRoll, _mm256_add_epi8(_mm256_cmpeq_epi8(chars, slash), hiNibbles));
+            __m256i values = _mm256_add_epi8(chars, roll);
+            __m256i merged = _mm256_madd_epi16(_mm256_maddubs_epi16(values, mergePairs), mergeQuads);
+            __m256i packed = _mm256_permutevar8x32_epi32(_mm256_shuffle_epi8(merged, gatherBytes), joinLanes);
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(out), packed);
+            consumed += 32;
+            out += 24;
+        }
+        return consumed;
+    }
+#endif
+
+#ifdef CARTESIAPP_BASE64_NEON
+    inline bool translateNeon(uint8x16_t chars, uint8x16_t lutLo, uint8x16_t lutHi, uint8x16_t lutRoll, uint8x16_t& values) {
+        uint8x16_t hiNibbles = vshrq_n_u8(chars, 4);
+        uint8x16_t lo = vqtbl1q_u8(lutLo, vandq_u8(chars, vdupq_n_u8(0x0F)));
+        uint8x16_t hi = vqtbl1q_u8(lutHi, hiNibbles);
+        if (vmaxvq_u8(vandq_u8(lo, hi)) != 0) {
+            return false;
+        }
+        uint8x16_t roll = vqtbl1q_u8(lutRoll, vaddq_u8(vceqq_u8(chars, vdupq_n_u8('/')), hiNibbles));
+        values = vaddq_u8(chars, roll);
+        return true;
+    }
+
+    size_t decodeBlocksNeon(const uint8_t* in, size_t length, uint8_t* out) {
+        const uint8x16_t lutLo = vld1q_u8(LUT_LO);
+        const uint8x16_t lutHi = vld1q_u8(LUT_HI);
+        const uint8x16_t lutRoll = vld1q_u8(LUT_ROLL);
+
+        size_t consumed = 0;
+        // the de-interleaving load puts characters 0, 1, 2 and 3 of every quad in separate registers,
+        // so the bytes are assembled with plain shifts and stored exactly by the interleaving store
+        while (consumed + 64 <= length) {
+            uint8x16x4_t chars = vld4q_u8(in + consumed);
+            uint8x16_t a, b, c, d;
+            if (!translateNeon(chars.val[0], lutLo, lutHi, lutRoll, a)
+                || !translateNeon(chars.val[1], lutLo, lutHi, lutRoll, b)
+                || !translateNeon(chars.val[2], lutLo, lutHi, lutRoll, c)
+                || !translateNeon(chars.val[3], lutLo, lutHi, lutRoll, d)) {
+                break;
+            }
+            uint8x16x3_t bytes;
+            bytes.val[0] = vorrq_u8(vshlq_n_u8(a, 2), vshrq_n_u8(b, 4));
+            bytes.val[1] = vorrq_u8(vshlq_n_u8(b, 4), vshrq_n_u8(c, 2));
+            bytes.val[2] = vorrq_u8(vshlq_n_u8(c, 6), d);
+            vst3q_u8(out, bytes);
+            consumed += 64;
+            out += 48;
+        }
+        return consumed;
+    }
+#endif
+
+    struct Kernel {
+        const char* name;
+        BlockKernel decodeBlocks;
+    };
+
+    Kernel selectKernel() {
+#if defined(CARTESIAPP_BASE64_X86)
+#if defined(_MSC_VER) && !defined(__clang__)
+        int info[4];
+        __cpuid(info, 0);
+        int maxLeaf = info[0];
+        __cpuid(info, 1);
+        bool ssse3 = (info[2] & (1 << 9)) != 0;
+        bool sse41 = (info[2] & (1 << 19)) != 0;
+        // AVX registers are only usable if the OS saves them on context switches
+        bool osSavesAvx = (info[2] & (1 << 27)) != 0 && (info[2] & (1 << 28)) != 0 && (_xgetbv(0) & 0x6) == 0x6;
+        bool avx2 = false;
+        if (maxLeaf >= 7 && osSavesAvx) {
+            __cpuidex(info, 7, 0);
+            avx2 = (info[1] & (1 << 5)) != 0;
+        }
+#else
+        __builtin_cpu_init();
+        bool ssse3 = __builtin_cpu_supports("ssse3");
+        bool sse41 = __builtin_cpu_supports("sse4.1");
+        bool avx2 = __builtin_cpu_supports("avx2");
+#endif
+        if (avx2) {
+            return { "avx2", decodeBlocksAvx2 };
+        }
+        if (ssse3 && sse41) {
+            return { "sse4.1", decodeBlocksSse41 };
+        }
+#elif defined(CARTESIAPP_BASE64_NEON)
+        // NEON is mandatory on AArch64
+        return { "neon", decodeBlocksNeon };
+#endif
+        return { "scalar", nullptr };
+    }
+
+    const Kernel& selectedKernel() {
+        static const Kernel kernel = selectKernel();
+        return kernel;
+    }
+
+    /**
+     * @brief Length of the input without its padding, padding is only recognized on inputs of a multiple of 4 characters.
+     */
+    size_t unpaddedLength(std::string_view encoded) {
+        size_t length = encoded.size();
+        if (length % 4 == 0) {
+            for (int i = 0; i < 2 && length > 0 && encoded[length - 1] == '='; ++i) {
+                --length;
+            }
+        }
+        return length;
+    }
+}
+
+size_t cartesiapp::codec::base64DecodedSize(std::string_view encoded)
+{
+    size_t length = unpaddedLength(encoded);
+    size_t rest = length % 4;
+    return length / 4 * 3 + (rest > 1 ? rest - 1 : 0);
+}
+
+bool cartesiapp::codec::decodeBase64(std::string_view encoded, char* out)
+{
+    size_t length = unpaddedLength(encoded);
+    if (length % 4 == 1) {
+        return false;
+    }
+    const uint8_t* in = reinterpret_cast<const uint8_t*>(encoded.data());
+    uint8_t* output = reinterpret_cast<uint8_t*>(out);
+    size_t consumed = 0;
+    BlockKernel decodeBlocks = selectedKernel().decodeBlocks;
+    if (decodeBlocks) {
+        consumed = decodeBlocks(in, length, output);
+    }
+    return decodeScalar(in + consumed, length - consumed, output + consumed / 4 * 3);
+}
+
+bool cartesiapp::codec::decodeBase64(std::string_view encoded, std::string& out)
+{
+    out.resize(base64DecodedSize(encoded));
+    if (!decodeBase64(encoded, out.data())) {
+        out.clear();
+        return false;
+    }
+    return true;
+}
+
+const char* cartesiapp::codec::base64KernelName()
+{
+    return selectedKernel().name;
+}
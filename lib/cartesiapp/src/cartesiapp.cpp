@@ -21,6 +21,16 @@ void cartesiapp::Cartesia::overrideApiVersion(const std::string& apiVersion)
     _clientImpl->overrideApiVersion(apiVersion);
 }
 
+void cartesiapp::Cartesia::setRequestTimingsCallback(RequestTimingsCallback callback)
+{
+    _clientImpl->setRequestTimingsCallback(std::move(callback));
+}
+
+void cartesiapp::Cartesia::setMemoryResource(std::pmr::memory_resource* resource)
+{
+    _clientImpl->setMemoryResource(resource);
+}
+
 std::string cartesiapp::Cartesia::getApiKey() const
 {
     return _apiKey;
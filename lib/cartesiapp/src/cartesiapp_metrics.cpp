@@ -0,0 +1,359 @@
+#include "cartesiapp_metrics.hpp"
+#include "cartesiapp_request.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+
+using namespace cartesiapp::metrics;
+
+namespace {
+    constexpr const char* ENDPOINT_PATHS[ENDPOINT_COUNT] = {
+        cartesiapp::request::constants::ENDPOINT_API_STATUS_INFO,
+        cartesiapp::request::constants::ENDPOINT_VOICES,
+        cartesiapp::request::constants::ENDPOINT_TTS_BYTES,
+        cartesiapp::request::constants::ENDPOINT_STT,
+        cartesiapp::request::constants::ENDPOINT_TTS_WEBSOCKET,
+        cartesiapp::request::constants::ENDPOINT_STT_WEBSOCKET,
+        "other"
+    };
+
+    constexpr double SUMMARY_QUANTILES[] = { 0.5, 0.9, 0.99, 0.999 };
+
+    constexpr double NANOSECONDS_PER_SECOND = 1e9;
+
+    void appendNumber(std::string& out, double value) {
+        char buffer[32];
+        std::snprintf(buffer, sizeof(buffer), "%.9g", value);
+        out += buffer;
+    }
+
+    void appendNumber(std::string& out, uint64_t value) {
+        out += std::to_string(value);
+    }
+
+    void appendHeader(std::string& out, const char* name, const char* type, const char* help) {
+        out += "# HELP ";
+        out += name;
+        out += ' ';
+        out += help;
+        out += "\n# TYPE ";
+        out += name;
+        out += ' ';
+        out += type;
+        out += '\n';
+    }
+
+    /**
+     * @brief Writes the quantile, _sum and _count samples of a summary, labels is either empty or "key=\"value\"".
+     */
+    void appendSummary(std::string& out, const char* name, const std::string& labels, const HistogramSnapshot& histogram) {
+        for (double quantile : SUMMARY_QUANTILES) {
+            out += name;
+            out += '{';
+            if (!labels.empty()) {
+                out += labels;
+                out += ',';
+            }
+            out += "quantile=\"";
+            appendNumber(out, quantile);
+            out += "\"} ";
+            appendNumber(out, static_cast<double>(histogram.valueAtPercentile(quantile * 100.0)) / NANOSECONDS_PER_SECOND);
+            out += '\n';
+        }
+        std::string suffixLabels = labels.empty() ? std::string() : "{" + labels + "}";
+        out += name;
+        out += "_sum";
+        out += suffixLabels;
+        out += ' ';
+        appendNumber(out, static_cast<double>(histogram.sum) / NANOSECONDS_PER_SECOND);
+        out += '\n';
+        out += name;
+        out += "_count";
+        out += suffixLabels;
+        out += ' ';
+        appendNumber(out, histogram.count);
+        out += '\n';
+    }
+
+    void appendCounter(std::string& out, const char* name, const char* help, uint64_t value) {
+        appendHeader(out, name, "counter", help);
+        out += name;
+        out += ' ';
+        appendNumber(out, value);
+        out += '\n';
+    }
+
+    void appendLabeledCounter(std::string& out, const char* name, const char* labels, uint64_t value) {
+        out += name;
+        out += '{';
+        out += labels;
+        out += "} ";
+        appendNumber(out, value);
+        out += '\n';
+    }
+}
+
+const char* cartesiapp::metrics::endpointPath(Endpoint endpoint)
+{
+    size_t index = static_cast<size_t>(endpoint);
+    return index < ENDPOINT_COUNT ? ENDPOINT_PATHS[index] : ENDPOINT_PATHS[static_cast<size_t>(Endpoint::OTHER)];
+}
+
+Endpoint cartesiapp::metrics::endpointFromPath(const std::string& path)
+{
+    // strip the query string, then match "/voices/<id>" against "/voices"
+    std::string route = path.substr(0, path.find('?'));
+    if (route == request::constants::ENDPOINT_API_STATUS_INFO) {
+        return Endpoint::API_INFO;
+    }
+    for (size_t i = 1; i < static_cast<size_t>(Endpoint::OTHER); ++i) {
+        size_t length = std::strlen(ENDPOINT_PATHS[i]);
+        if (route.compare(0, length, ENDPOINT_PATHS[i]) == 0 && (route.size() == length || route[length] == '/')) {
+            // "/stt/websocket" also starts with "/stt/", keep looking for the more specific match
+            if (i == static_cast<size_t>(Endpoint::STT) && route.size() > length) {
+                continue;
+            }
+            return static_cast<Endpoint>(i);
+        }
+    }
+    return Endpoint::OTHER;
+}
+
+double cartesiapp::metrics::HistogramSnapshot::mean() const
+{
+    return count ? static_cast<double>(sum) / static_cast<double>(count) : 0.0;
+}
+
+uint64_t cartesiapp::metrics::HistogramSnapshot::valueAtPercentile(double percentile) const
+{
+    if (count == 0) {
+        return 0;
+    }
+    uint64_t target = static_cast<uint64_t>((percentile / 100.0) * static_cast<double>(count) + 0.5);
+    target = std::max<uint64_t>(1, std::min(target, count));
+    uint64_t cumulative = 0;
+    for (size_t i = 0; i < buckets.size(); ++i) {
+        cumulative += buckets[i];
+        if (cumulative >= target) {
+            return std::min(Histogram::highestEquivalentValue(i), max);
+        }
+    }
+    return max;
+}
+
+HistogramSnapshot cartesiapp::metrics::Histogram::snapshot() const
+{
+    HistogramSnapshot snapshot;
+    snapshot.buckets.resize(BUCKET_COUNT);
+    uint64_t count = 0;
+    for (size_t i = 0; i < BUCKET_COUNT; ++i) {
+        snapshot.buckets[i] = _buckets[i].load(std::memory_order_relaxed);
+        count += snapshot.buckets[i];
+    }
+    // the count is derived from the buckets, which keeps percentiles consistent with a concurrent recorder
+    snapshot.count = count;
+    snapshot.sum = _sum.load(std::memory_order_relaxed);
+    snapshot.max = _max.load(std::memory_order_relaxed);
+    return snapshot;
+}
+
+void cartesiapp::metrics::Histogram::reset() noexcept
+{
+    for (auto& bucket : _buckets) {
+        bucket.store(0, std::memory_order_relaxed);
+    }
+    _sum.store(0, std::memory_order_relaxed);
+    _max.store(0, std::memory_order_relaxed);
+}
+
+MetricsRegistry& cartesiapp::metrics::MetricsRegistry::instance()
+{
+    static MetricsRegistry registry;
+    return registry;
+}
+
+void cartesiapp::metrics::MetricsRegistry::recordRequest(const RequestTimings& timings, int statusCode)
+{
+    if (!timings.succeeded) {
+        recordError(statusCode);
+        return;
+    }
+    if (statusCode >= 400) {
+        recordError(statusCode);
+    }
+    auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(timings.completed - timings.start).count();
+    _requestLatency[static_cast<size_t>(endpointFromPath(timings.endpoint))].record(static_cast<uint64_t>(std::max<int64_t>(elapsed, 0)));
+}
+
+MetricsSnapshot cartesiapp::metrics::MetricsRegistry::snapshot() const
+{
+    MetricsSnapshot snapshot;
+    for (size_t i = 0; i < ENDPOINT_COUNT; ++i) {
+        snapshot.request_latency_ns[i] = _requestLatency[i].snapshot();
+    }
+    snapshot.tts_time_to_first_chunk_ns = _ttsTimeToFirstChunk.snapshot();
+    snapshot.tts_chunks_received = _ttsChunksReceived.value();
+    snapshot.tts_audio_bytes_received = _ttsAudioBytesReceived.value();
+    snapshot.base64_bytes_decoded = _base64BytesDecoded.value();
+    snapshot.reconnects = _reconnects.value();
+    snapshot.stt_audio_bytes_replayed = _sttAudioBytesReplayed.value();
+    snapshot.stt_audio_writes_framed = _sttAudioWritesFramed.value();
+    snapshot.stt_audio_frames_sent = _sttAudioFramesSent.value();
+    snapshot.stt_silence_bytes_suppressed = _sttSilenceBytesSuppressed.value();
+    snapshot.stt_silence_suppressed_ns = _sttSilenceSuppressed.value();
+    snapshot.stt_endpoints_detected = _sttEndpointsDetected.value();
+    for (size_t status = 0; status < _errorsByStatus.size(); ++status) {
+        uint64_t value = _errorsByStatus[status].load(std::memory_order_relaxed);
+        if (value) {
+            snapshot.errors_by_status[static_cast<int>(status)] = value;
+        }
+    }
+    snapshot.open_connections = _openConnections.value();
+    snapshot.websocket_send_latency_ns = _websocketSendLatency.snapshot();
+    snapshot.websocket_messages_sent = _websocketMessagesSent.value();
+    snapshot.websocket_messages_coalesced = _websocketMessagesCoalesced.value();
+    snapshot.websocket_send_queue_depth = _websocketSendQueueDepth.value();
+    snapshot.websocket_payload_bytes_received = _websocketPayloadBytesReceived.value();
+    snapshot.websocket_payload_bytes_sent = _websocketPayloadBytesSent.value();
+    snapshot.websocket_wire_bytes_received = _websocketWireBytesReceived.value();
+    snapshot.websocket_wire_bytes_sent = _websocketWireBytesSent.value();
+    snapshot.websocket_io_cpu_ns = _websocketIoCpu.value();
+    snapshot.websocket_ping_rtt_ns = _websocketPingRtt.snapshot();
+    snapshot.websocket_timeouts = _websocketTimeouts.value();
+    snapshot.listener_queue_latency_ns = _listenerQueueLatency.snapshot();
+    snapshot.listener_frames_dropped = _listenerFramesDropped.value();
+    snapshot.listener_frames_coalesced = _listenerFramesCoalesced.value();
+    snapshot.listener_queue_depth = _listenerQueueDepth.value();
+    return snapshot;
+}
+
+void cartesiapp::metrics::MetricsRegistry::reset()
+{
+    for (auto& histogram : _requestLatency) {
+        histogram.reset();
+    }
+    _ttsTimeToFirstChunk.reset();
+    _ttsChunksReceived.reset();
+    _ttsAudioBytesReceived.reset();
+    _base64BytesDecoded.reset();
+    _reconnects.reset();
+    _sttAudioBytesReplayed.reset();
+    _sttAudioWritesFramed.reset();
+    _sttAudioFramesSent.reset();
+    _sttSilenceBytesSuppressed.reset();
+    _sttSilenceSuppressed.reset();
+    _sttEndpointsDetected.reset();
+    for (auto& counter : _errorsByStatus) {
+        counter.store(0, std::memory_order_relaxed);
+    }
+    _websocketSendLatency.reset();
+    _websocketMessagesSent.reset();
+    _websocketMessagesCoalesced.reset();
+    _websocketPayloadBytesReceived.reset();
+    _websocketPayloadBytesSent.reset();
+    _websocketWireBytesReceived.reset();
+    _websocketWireBytesSent.reset();
+    _websocketIoCpu.reset();
+    _websocketPingRtt.reset();
+    _websocketTimeouts.reset();
+    _listenerQueueLatency.reset();
+    _listenerFramesDropped.reset();
+    _listenerFramesCoalesced.reset();
+}
+
+std::string cartesiapp::metrics::toPrometheusText(const MetricsSnapshot& snapshot)
+{
+    std::string out;
+    out.reserve(4096);
+
+    appendHeader(out, "cartesiapp_request_duration_seconds", "summary",
+        "Duration of successful REST calls and WebSocket connects.");
+    for (size_t i = 0; i < ENDPOINT_COUNT; ++i) {
+        std::string labels = std::string("endpoint=\"") + ENDPOINT_PATHS[i] + "\"";
+        appendSummary(out, "cartesiapp_request_duration_seconds", labels, snapshot.request_latency_ns[i]);
+    }
+
+    appendHeader(out, "cartesiapp_tts_time_to_first_chunk_seconds", "summary",
+        "Time from sending a TTS generation request to receiving its first audio chunk.");
+    appendSummary(out, "cartesiapp_tts_time_to_first_chunk_seconds", std::string(), snapshot.tts_time_to_first_chunk_ns);
+
+    appendCounter(out, "cartesiapp_tts_chunks_received_total", "TTS audio chunks received.", snapshot.tts_chunks_received);
+    appendCounter(out, "cartesiapp_tts_audio_bytes_received_total", "Decoded TTS audio bytes received.", snapshot.tts_audio_bytes_received);
+    appendCounter(out, "cartesiapp_base64_decoded_bytes_total", "Bytes produced by base64 decoding.", snapshot.base64_bytes_decoded);
+    appendCounter(out, "cartesiapp_reconnects_total", "WebSocket reconnections.", snapshot.reconnects);
+    appendCounter(out, "cartesiapp_stt_audio_bytes_replayed_total", "STT audio bytes sent again after a reconnect.", snapshot.stt_audio_bytes_replayed);
+    appendCounter(out, "cartesiapp_stt_audio_writes_framed_total", "STT audio writes buffered into frames.", snapshot.stt_audio_writes_framed);
+    appendCounter(out, "cartesiapp_stt_audio_frames_sent_total", "STT audio frames sent by the framing buffer.", snapshot.stt_audio_frames_sent);
+    appendCounter(out, "cartesiapp_stt_silence_bytes_suppressed_total", "STT audio bytes dropped by silence suppression.", snapshot.stt_silence_bytes_suppressed);
+    appendHeader(out, "cartesiapp_stt_silence_suppressed_seconds_total", "counter",
+        "Stream time of the STT audio dropped by silence suppression.");
+    out += "cartesiapp_stt_silence_suppressed_seconds_total ";
+    appendNumber(out, static_cast<double>(snapshot.stt_silence_suppressed_ns) / NANOSECONDS_PER_SECOND);
+    out += '\n';
+    appendCounter(out, "cartesiapp_stt_endpoints_detected_total", "STT utterances finalized by client-side endpointing.", snapshot.stt_endpoints_detected);
+
+    appendHeader(out, "cartesiapp_errors_total", "counter",
+        "Failed calls and error events by HTTP status code, 0 for transport failures.");
+    for (const auto& entry : snapshot.errors_by_status) {
+        out += "cartesiapp_errors_total{status=\"";
+        out += std::to_string(entry.first);
+        out += "\"} ";
+        appendNumber(out, entry.second);
+        out += '\n';
+    }
+
+    appendHeader(out, "cartesiapp_open_connections", "gauge", "Currently open connections.");
+    out += "cartesiapp_open_connections ";
+    out += std::to_string(snapshot.open_connections);
+    out += '\n';
+
+    appendHeader(out, "cartesiapp_websocket_send_duration_seconds", "summary",
+        "Time from queueing a WebSocket message to the completion of its write.");
+    appendSummary(out, "cartesiapp_websocket_send_duration_seconds", std::string(), snapshot.websocket_send_latency_ns);
+
+    appendCounter(out, "cartesiapp_websocket_messages_sent_total", "WebSocket messages written.", snapshot.websocket_messages_sent);
+    appendCounter(out, "cartesiapp_websocket_messages_coalesced_total", "WebSocket messages merged into an earlier write.", snapshot.websocket_messages_coalesced);
+
+    appendHeader(out, "cartesiapp_websocket_send_queue_depth", "gauge", "WebSocket messages queued and not written yet.");
+    out += "cartesiapp_websocket_send_queue_depth ";
+    out += std::to_string(snapshot.websocket_send_queue_depth);
+    out += '\n';
+
+    appendHeader(out, "cartesiapp_websocket_payload_bytes_total", "counter",
+        "WebSocket message bytes, uncompressed.");
+    appendLabeledCounter(out, "cartesiapp_websocket_payload_bytes_total", "direction=\"received\"", snapshot.websocket_payload_bytes_received);
+    appendLabeledCounter(out, "cartesiapp_websocket_payload_bytes_total", "direction=\"sent\"", snapshot.websocket_payload_bytes_sent);
+
+    appendHeader(out, "cartesiapp_websocket_wire_bytes_total", "counter",
+        "TLS bytes of upgraded WebSocket connections, after compression and framing.");
+    appendLabeledCounter(out, "cartesiapp_websocket_wire_bytes_total", "direction=\"received\"", snapshot.websocket_wire_bytes_received);
+    appendLabeledCounter(out, "cartesiapp_websocket_wire_bytes_total", "direction=\"sent\"", snapshot.websocket_wire_bytes_sent);
+
+    appendHeader(out, "cartesiapp_websocket_io_cpu_seconds_total", "counter",
+        "CPU time of WebSocket I/O handlers, for connections recording it.");
+    out += "cartesiapp_websocket_io_cpu_seconds_total ";
+    appendNumber(out, static_cast<double>(snapshot.websocket_io_cpu_ns) / NANOSECONDS_PER_SECOND);
+    out += '\n';
+
+    appendHeader(out, "cartesiapp_websocket_ping_rtt_seconds", "summary",
+        "Round trip time of WebSocket pings.");
+    appendSummary(out, "cartesiapp_websocket_ping_rtt_seconds", std::string(), snapshot.websocket_ping_rtt_ns);
+
+    appendCounter(out, "cartesiapp_websocket_timeouts_total", "WebSocket connections closed by the handshake or idle timeout.", snapshot.websocket_timeouts);
+
+    appendHeader(out, "cartesiapp_listener_queue_duration_seconds", "summary",
+        "Time frames waited in listener dispatch queues.");
+    appendSummary(out, "cartesiapp_listener_queue_duration_seconds", std::string(), snapshot.listener_queue_latency_ns);
+
+    appendCounter(out, "cartesiapp_listener_frames_dropped_total", "Frames dropped by full listener dispatch queues.", snapshot.listener_frames_dropped);
+    appendCounter(out, "cartesiapp_listener_frames_coalesced_total", "TTS chunks merged into a queued chunk by listener dispatch queues.", snapshot.listener_frames_coalesced);
+
+    appendHeader(out, "cartesiapp_listener_queue_depth", "gauge", "Frames waiting in listener dispatch queues.");
+    out += "cartesiapp_listener_queue_depth ";
+    out += std::to_string(snapshot.listener_queue_depth);
+    out += '\n';
+
+    return out;
+}
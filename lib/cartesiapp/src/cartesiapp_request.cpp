@@ -1,53 +1,111 @@
 #include "cartesiapp_request.hpp"
-#include <nlohmann/json.hpp>
+#include "impl/json_schema.hpp"
+#include "impl/json_writer.hpp"
 #include <sstream>
 
+using namespace cartesiapp;
+
+namespace cartesiapp::schema {
+    template <>
+    struct Schema<request::Voice> {
+        static constexpr auto fields = std::make_tuple(
+            field("mode", &request::Voice::mode),
+            field("id", &request::Voice::id));
+    };
+
+    template <>
+    struct Schema<request::OutputFormat> {
+        static constexpr auto fields = std::make_tuple(
+            field("container", &request::OutputFormat::container),
+            field("encoding", &request::OutputFormat::encoding),
+            field("sample_rate", &request::OutputFormat::sample_rate),
+            field("bit_rate", &request::OutputFormat::bit_rate));
+    };
+
+    template <>
+    struct Schema<request::GenerationConfig> {
+        static constexpr auto fields = std::make_tuple(
+            field("volume", &request::GenerationConfig::volume),
+            field("speed", &request::GenerationConfig::speed),
+            field("emotion", &request::GenerationConfig::emotion));
+    };
+
+    template <>
+    struct Schema<request::TTSBytesRequest> {
+        static constexpr auto fields = std::make_tuple(
+            field("model_id", &request::TTSBytesRequest::model_id),
+            field("transcript", &request::TTSBytesRequest::transcript),
+            field("voice", &request::TTSBytesRequest::voice),
+            field("language", &request::TTSBytesRequest::language),
+            field("output_format", &request::TTSBytesRequest::output_format),
+            field("duration", &request::TTSBytesRequest::duration),
+            field("speed", &request::TTSBytesRequest::speed),
+            field("generation_config", &request::TTSBytesRequest::generation_config),
+            field("pronunciation_dict_id", &request::TTSBytesRequest::pronunciation_dict_id),
+            field("save", &request::TTSBytesRequest::save));
+    };
+
+    template <>
+    struct Schema<request::tts::GenerationRequest> {
+        using Request = request::tts::GenerationRequest;
+
+        /**
+         * @brief Fields that stay the same across the messages of a context, prepared once by PreparedGenerationRequest.
+         */
+        static constexpr auto invariantFields = std::make_tuple(
+            field("model_id", &Request::model_id),
+            field("voice", &Request::voice),
+            field("generation_config", &Request::generation_config),
+            field("output_format", &Request::output_format),
+            field("language", &Request::language),
+            field("max_buffer_delay_ms", &Request::max_buffer_delay_ms),
+            field("add_timestamps", &Request::add_timestamps),
+            field("add_phoneme_timestamps", &Request::add_phoneme_timestamps),
+            field("use_normalized_timestamps", &Request::use_normalized_timestamps),
+            field("pronunciation_dict_id", &Request::pronunciation_dict_id));
+
+        static constexpr auto fields = std::tuple_cat(invariantFields, std::make_tuple(
+            field("transcript", &Request::transcript),
+            field("context_id", &Request::context_id),
+            field("continue", &Request::continue_),
+            field("flush", &Request::flush)));
+    };
+
+    template <>
+    struct Schema<request::tts::CancelContextRequest> {
+        static constexpr auto fields = std::make_tuple(
+            field("context_id", &request::tts::CancelContextRequest::context_id),
+            field("cancel", &request::tts::CancelContextRequest::cancel));
+    };
+}
+
+namespace {
+    /**
+     * @brief Serializes a request struct described by a schema into a new string.
+     */
+    template <typename T>
+    std::string encode(const T& source, size_t reserve = 0) {
+        std::string json;
+        json.reserve(reserve);
+        JsonWriter writer(json);
+        schema::encodeObject(writer, source);
+        return json;
+    }
+}
+
 std::string cartesiapp::request::Voice::toJson() const
 {
-    nlohmann::json jsonObj;
-    jsonObj["mode"] = mode;
-    jsonObj["id"] = id;
-    return jsonObj.dump();
+    return encode(*this);
 }
 
 std::string cartesiapp::request::OutputFormat::toJson() const
 {
-    nlohmann::json jsonObj;
-    jsonObj["container"] = container;
-    jsonObj["encoding"] = encoding;
-    jsonObj["sample_rate"] = sample_rate;
-    if (bit_rate) {
-        jsonObj["bit_rate"] = bit_rate.value();
-    }
-    return jsonObj.dump();
+    return encode(*this);
 }
 
 std::string cartesiapp::request::TTSBytesRequest::toJson() const
 {
-    nlohmann::json jsonObj;
-    jsonObj["model_id"] = model_id;
-    jsonObj["transcript"] = transcript;
-    jsonObj["voice"] = nlohmann::json::parse(voice.toJson());
-    if (language) {
-        jsonObj["language"] = language.value();
-    }
-    jsonObj["output_format"] = nlohmann::json::parse(output_format.toJson());
-    if (duration) {
-        jsonObj["duration"] = duration.value();
-    }
-    if (speed) {
-        jsonObj["speed"] = speed.value();
-    }
-    if (generation_config) {
-        jsonObj["generation_config"] = nlohmann::json::parse(generation_config->toJson());
-    }
-    if (pronunciation_dict_id) {
-        jsonObj["pronunciation_dict_id"] = pronunciation_dict_id.value();
-    }
-    if (save) {
-        jsonObj["save"] = save.value();
-    }
-    return jsonObj.dump();
+    return encode(*this, 256 + transcript.size());
 }
 
 std::string cartesiapp::request::VoiceListRequest::toQueryParams() const
@@ -93,11 +151,7 @@ std::string cartesiapp::request::VoiceListRequest::toQueryParams() const
 
 std::string cartesiapp::request::GenerationConfig::toJson() const
 {
-    nlohmann::json jsonObj;
-    jsonObj["volume"] = volume;
-    jsonObj["speed"] = speed;
-    jsonObj["emotion"] = emotion;
-    return jsonObj.dump();
+    return encode(*this);
 }
 
 std::string cartesiapp::request::stt::BatchRequest::toQueryParams() const
@@ -117,46 +171,36 @@ std::string cartesiapp::request::stt::BatchRequest::toQueryParams() const
 
 std::string cartesiapp::request::tts::GenerationRequest::toJson() const
 {
-    nlohmann::json jsonObj;
-    jsonObj["model_id"] = model_id;
-    jsonObj["transcript"] = transcript;
-    jsonObj["voice"] = nlohmann::json::parse(voice.toJson());
-    jsonObj["generation_config"] = nlohmann::json::parse(generation_config.toJson());
-    jsonObj["output_format"] = nlohmann::json::parse(output_format.toJson());
-    if (language) {
-        jsonObj["language"] = language.value();
-    }
-    if (context_id) {
-        jsonObj["context_id"] = context_id.value();
-    }
-    if (continue_) {
-        jsonObj["continue"] = continue_.value();
-    }
-    if (max_buffer_delay_ms) {
-        jsonObj["max_buffer_delay_ms"] = max_buffer_delay_ms.value();
-    }
-    if (flush) {
-        jsonObj["flush"] = flush.value();
-    }
-    if (add_timestamps) {
-        jsonObj["add_timestamps"] = add_timestamps.value();
-    }
-    if (add_phoneme_timestamps) {
-        jsonObj["add_phoneme_timestamps"] = add_phoneme_timestamps.value();
-    }
-    if (use_normalized_timestamps) {
-        jsonObj["use_normalized_timestamps"] = use_normalized_timestamps.value();
-    }
-    if (pronunciation_dict_id) {
-        jsonObj["pronunciation_dict_id"] = pronunciation_dict_id.value();
-    }    
-    return jsonObj.dump();
+    return encode(*this, 320 + transcript.size());
+}
+
+cartesiapp::request::tts::PreparedGenerationRequest::PreparedGenerationRequest(const GenerationRequest& request)
+{
+    JsonWriter writer(_prefix);
+    writer.beginObject();
+    schema::encodeFields(writer, schema::Schema<GenerationRequest>::invariantFields, request);
+}
+
+const std::string& cartesiapp::request::tts::PreparedGenerationRequest::serialize(const std::string& transcript,
+    const std::string& contextId,
+    bool continueContext,
+    bool flush)
+{
+    _buffer.assign(_prefix);
+    // the prefix always holds at least model_id, so the variable fields are written as continuations
+    _buffer += ',';
+    JsonWriter writer(_buffer);
+    writer.field("transcript", transcript);
+    if (!contextId.empty()) {
+        writer.field("context_id", contextId);
+    }
+    writer.field("continue", continueContext)
+        .field("flush", flush)
+        .endObject();
+    return _buffer;
 }
 
 std::string cartesiapp::request::tts::CancelContextRequest::toJson() const
 {
-    nlohmann::json jsonObj;
-    jsonObj["context_id"] = context_id;
-    jsonObj["cancel"] = cancel;
-    return jsonObj.dump();
+    return encode(*this);
 }
@@ -1,215 +1,366 @@
 #include "cartesiapp_response.hpp"
 #include <nlohmann/json.hpp>
-#include "cartesiapp_response.hpp"
-#include <base64.hpp>
+#include <stdexcept>
+#include "cartesiapp_metrics.hpp"
+#include "impl/base64_decoder.hpp"
+#include "impl/cartesiapp_json.hpp"
+#include "impl/json_schema.hpp"
 
 using namespace cartesiapp::response;
 
+namespace {
+    /**
+     * @brief Decodes the base64 audio payload of a chunk, recording the decoded size.
+     */
+    void readAudioData(const nlohmann::json& jsonValue, std::string& target) {
+        if (!cartesiapp::codec::decodeBase64(jsonValue.get_ref<const std::string&>(), target)) {
+            throw std::runtime_error("Invalid base64 audio data in chunk response");
+        }
+        cartesiapp::metrics::MetricsRegistry::instance().recordBase64Decoded(target.size());
+    }
+}
+
+namespace cartesiapp::schema {
+    template <>
+    struct Schema<ApiInfo> {
+        static constexpr auto fields = std::make_tuple(
+            field("version", &ApiInfo::version),
+            field("ok", &ApiInfo::ok));
+    };
+
+    template <>
+    struct Schema<Voice> {
+        static constexpr auto fields = std::make_tuple(
+            field("id", &Voice::id),
+            field("name", &Voice::name),
+            field("is_owner", &Voice::is_owner),
+            field("is_public", &Voice::is_public),
+            field("gender", &Voice::gender),
+            field("description", &Voice::description),
+            field("created_at", &Voice::created_at),
+            field("embedding", &Voice::embedding),
+            field("is_starred", &Voice::is_starred),
+            field("language", &Voice::language));
+    };
+
+    template <>
+    struct Schema<VoiceListPage> {
+        static constexpr auto fields = std::make_tuple(
+            field("has_more", &VoiceListPage::has_more),
+            arrayField("data", &VoiceListPage::voices));
+    };
+
+    template <>
+    struct Schema<stt::WordTiming> {
+        static constexpr auto fields = std::make_tuple(
+            field("word", &stt::WordTiming::word),
+            field("start", &stt::WordTiming::start),
+            field("end", &stt::WordTiming::end));
+    };
+
+    template <>
+    struct Schema<stt::TranscriptionResponse> {
+        static constexpr auto fields = std::make_tuple(
+            field("type", &stt::TranscriptionResponse::type),
+            field("text", &stt::TranscriptionResponse::text),
+            field("language", &stt::TranscriptionResponse::language),
+            field("duration", &stt::TranscriptionResponse::duration),
+            field("is_final", &stt::TranscriptionResponse::is_final),
+            field("request_id", &stt::TranscriptionResponse::request_id),
+            arrayField("words", &stt::TranscriptionResponse::words));
+    };
+
+    template <>
+    struct Schema<stt::FlushDoneResponse> {
+        static constexpr auto fields = std::make_tuple(
+            field("type", &stt::FlushDoneResponse::type),
+            field("request_id", &stt::FlushDoneResponse::request_id));
+    };
+
+    template <>
+    struct Schema<stt::DoneResponse> {
+        static constexpr auto fields = std::make_tuple(
+            field("type", &stt::DoneResponse::type),
+            field("request_id", &stt::DoneResponse::request_id));
+    };
+
+    template <>
+    struct Schema<stt::ErrorResponse> {
+        static constexpr auto fields = std::make_tuple(
+            field("type", &stt::ErrorResponse::type),
+            field("error", &stt::ErrorResponse::error),
+            field("request_id", &stt::ErrorResponse::request_id));
+    };
+
+    template <>
+    struct Schema<tts::AudioChunkResponse> {
+        static constexpr auto fields = std::make_tuple(
+            field("type", &tts::AudioChunkResponse::type),
+            field("data", &tts::AudioChunkResponse::data, &readAudioData),
+            field("done", &tts::AudioChunkResponse::done),
+            field("status_code", &tts::AudioChunkResponse::status_code),
+            field("step_time", &tts::AudioChunkResponse::step_time),
+            field("context_id", &tts::AudioChunkResponse::context_id));
+    };
+
+    template <>
+    struct Schema<tts::FlushDoneResponse> {
+        static constexpr auto fields = std::make_tuple(
+            field("type", &tts::FlushDoneResponse::type),
+            field("done", &tts::FlushDoneResponse::done),
+            field("flush_done", &tts::FlushDoneResponse::flush_done),
+            field("flush_id", &tts::FlushDoneResponse::flush_id),
+            field("status_code", &tts::FlushDoneResponse::status_code),
+            field("context_id", &tts::FlushDoneResponse::context_id));
+    };
+
+    template <>
+    struct Schema<tts::DoneResponse> {
+        static constexpr auto fields = std::make_tuple(
+            field("type", &tts::DoneResponse::type),
+            field("done", &tts::DoneResponse::done),
+            field("status_code", &tts::DoneResponse::status_code),
+            field("context_id", &tts::DoneResponse::context_id));
+    };
+
+    template <>
+    struct Schema<tts::WordTimestampsResponse::WordTimestamps> {
+        static constexpr auto fields = std::make_tuple(
+            field("words", &tts::WordTimestampsResponse::WordTimestamps::words),
+            field("start", &tts::WordTimestampsResponse::WordTimestamps::start),
+            field("end", &tts::WordTimestampsResponse::WordTimestamps::end));
+    };
+
+    template <>
+    struct Schema<tts::WordTimestampsResponse> {
+        static constexpr auto fields = std::make_tuple(
+            field("type", &tts::WordTimestampsResponse::type),
+            field("done", &tts::WordTimestampsResponse::done),
+            field("status_code", &tts::WordTimestampsResponse::status_code),
+            field("context_id", &tts::WordTimestampsResponse::context_id),
+            arrayField("word_timestamps", &tts::WordTimestampsResponse::word_timestamps));
+    };
+
+    template <>
+    struct Schema<tts::PhonemeTimestampsResponse::PhonemeTimestamps> {
+        static constexpr auto fields = std::make_tuple(
+            field("phonemes", &tts::PhonemeTimestampsResponse::PhonemeTimestamps::phonemes),
+            field("start", &tts::PhonemeTimestampsResponse::PhonemeTimestamps::start),
+            field("end", &tts::PhonemeTimestampsResponse::PhonemeTimestamps::end));
+    };
+
+    template <>
+    struct Schema<tts::PhonemeTimestampsResponse> {
+        static constexpr auto fields = std::make_tuple(
+            field("type", &tts::PhonemeTimestampsResponse::type),
+            field("done", &tts::PhonemeTimestampsResponse::done),
+            field("status_code", &tts::PhonemeTimestampsResponse::status_code),
+            field("context_id", &tts::PhonemeTimestampsResponse::context_id),
+            field("phoneme_timestamps", &tts::PhonemeTimestampsResponse::phoneme_timestamps));
+    };
+
+    template <>
+    struct Schema<tts::ErrorResponse> {
+        static constexpr auto fields = std::make_tuple(
+            field("type", &tts::ErrorResponse::type),
+            field("done", &tts::ErrorResponse::done),
+            field("error", &tts::ErrorResponse::error),
+            field("status_code", &tts::ErrorResponse::status_code),
+            field("context_id", &tts::ErrorResponse::context_id));
+    };
+}
+
+void cartesiapp::response::from_json(const nlohmann::json& jsonObj, ApiInfo& apiInfo)
+{
+    schema::decodeObject(jsonObj, apiInfo);
+}
+
 ApiInfo cartesiapp::response::ApiInfo::fromJson(const std::string& jsonStr)
 {
-    nlohmann::json jsonObj = nlohmann::json::parse(jsonStr);
-    ApiInfo apiInfo;
-    apiInfo.version = jsonObj["version"].get<std::string>();
-    apiInfo.ok = jsonObj["ok"].get<bool>();
-    return apiInfo;
+    return nlohmann::json::parse(jsonStr).get<ApiInfo>();
+}
+
+void cartesiapp::response::from_json(const nlohmann::json& jsonObj, Voice& voice)
+{
+    schema::decodeObject(jsonObj, voice);
 }
 
 Voice cartesiapp::response::Voice::fromJson(const std::string& jsonStr)
 {
-    nlohmann::json jsonObj = nlohmann::json::parse(jsonStr);
-    Voice voice;
-    voice.id = std::move(jsonObj["id"].get<std::string>());
-    voice.name = std::move(jsonObj["name"].get<std::string>());
-    voice.is_owner = jsonObj["is_owner"].get<bool>();
-    voice.is_public = jsonObj["is_public"].get<bool>();
-    voice.gender = std::move(jsonObj["gender"].get<std::string>());
-    voice.description = std::move(jsonObj["description"].get<std::string>());
-    voice.created_at = std::move(jsonObj["created_at"].get<std::string>());
-    if (jsonObj.contains("embedding") && !jsonObj["embedding"].is_null()) {
-        voice.embedding = std::move(jsonObj["embedding"].get<std::vector<int>>());
-    }
-    if (jsonObj.contains("is_starred") && !jsonObj["is_starred"].is_null()) {
-        voice.is_starred = jsonObj["is_starred"].get<bool>();
-    }
-    voice.language = std::move(jsonObj["language"].get<std::string>());
-    return voice;
+    return nlohmann::json::parse(jsonStr).get<Voice>();
+}
+
+void cartesiapp::response::from_json(const nlohmann::json& jsonObj, VoiceListPage& voiceListPage)
+{
+    schema::decodeObject(jsonObj, voiceListPage);
 }
 
 VoiceListPage cartesiapp::response::VoiceListPage::fromJson(const std::string& jsonStr)
 {
-    nlohmann::json jsonObj = nlohmann::json::parse(jsonStr);
-    VoiceListPage voiceListPage;
-    voiceListPage.has_more = jsonObj["has_more"].get<bool>();
-    for (const auto& voiceJson : jsonObj["data"]) {
-        voiceListPage.voices.push_back(Voice::fromJson(voiceJson.dump()));
-    }
-    return voiceListPage;
+    return nlohmann::json::parse(jsonStr).get<VoiceListPage>();
+}
+
+void cartesiapp::response::stt::from_json(const nlohmann::json& jsonObj, WordTiming& wordTiming)
+{
+    schema::decodeObject(jsonObj, wordTiming);
 }
 
 cartesiapp::response::stt::WordTiming cartesiapp::response::stt::WordTiming::fromJson(const std::string& jsonStr)
 {
-    nlohmann::json jsonObj = nlohmann::json::parse(jsonStr);
-    WordTiming wordTiming;
-    wordTiming.word = std::move(jsonObj["word"].get<std::string>());
-    wordTiming.start = jsonObj["start"].get<float>();
-    wordTiming.end = jsonObj["end"].get<float>();
-    return wordTiming;
+    return nlohmann::json::parse(jsonStr).get<WordTiming>();
+}
+
+void cartesiapp::response::stt::from_json(const nlohmann::json& jsonObj, TranscriptionResponse& sttResponse)
+{
+    schema::decodeObject(jsonObj, sttResponse);
 }
 
 cartesiapp::response::stt::TranscriptionResponse cartesiapp::response::stt::TranscriptionResponse::fromJson(const std::string& jsonStr)
 {
-    nlohmann::json jsonObj = nlohmann::json::parse(jsonStr);
-    TranscriptionResponse sttResponse;
-    sttResponse.type = std::move(jsonObj["type"].get<std::string>());
-    sttResponse.text = std::move(jsonObj["text"].get<std::string>());
-    if (jsonObj.contains("language") && !jsonObj["language"].is_null()) {
-        sttResponse.language = std::move(jsonObj["language"].get<std::string>());
-    }
-    sttResponse.duration = jsonObj["duration"].get<float>();
-    sttResponse.is_final = jsonObj["is_final"].get<bool>();
-    sttResponse.request_id = std::move(jsonObj["request_id"].get<std::string>());
+    return nlohmann::json::parse(jsonStr).get<TranscriptionResponse>();
+}
 
-    for (const auto& wordJson : jsonObj["words"]) {
-        sttResponse.words.push_back(WordTiming::fromJson(wordJson.dump()));
-    }
-    return sttResponse;
+void cartesiapp::response::tts::from_json(const nlohmann::json& jsonObj, AudioChunkResponse& audioChunkResponse)
+{
+    schema::decodeObject(jsonObj, audioChunkResponse);
 }
 
 cartesiapp::response::tts::AudioChunkResponse cartesiapp::response::tts::AudioChunkResponse::fromJson(const std::string& jsonStr)
 {
-    nlohmann::json jsonObj = nlohmann::json::parse(jsonStr);
-    AudioChunkResponse audioChunkResponse;
-    audioChunkResponse.type = std::move(jsonObj["type"].get<std::string>());
-    audioChunkResponse.data = std::move(base64::from_base64(jsonObj["data"].get<std::string>()));
-    audioChunkResponse.done = jsonObj["done"].get<bool>();
-    audioChunkResponse.status_code = jsonObj["status_code"].get<int>();
-    audioChunkResponse.step_time = jsonObj["step_time"].get<double>();
-    if (jsonObj.contains("context_id") && !jsonObj["context_id"].is_null()) {
-        audioChunkResponse.context_id = std::move(jsonObj["context_id"].get<std::string>());
+    return nlohmann::json::parse(jsonStr).get<AudioChunkResponse>();
+}
+
+cartesiapp::response::tts::AudioChunkResponse cartesiapp::response::tts::AudioChunkView::toResponse() const
+{
+    AudioChunkResponse response;
+    response.type = "chunk";
+    response.data.assign(reinterpret_cast<const char*>(data), size);
+    response.done = done;
+    response.status_code = status_code;
+    response.step_time = step_time;
+    if (!context_id.empty()) {
+        response.context_id = std::string(context_id);
     }
-    return audioChunkResponse;
+    return response;
+}
+
+void cartesiapp::response::tts::from_json(const nlohmann::json& jsonObj, FlushDoneResponse& flushDoneResponse)
+{
+    schema::decodeObject(jsonObj, flushDoneResponse);
 }
 
 cartesiapp::response::tts::FlushDoneResponse cartesiapp::response::tts::FlushDoneResponse::fromJson(const std::string& jsonStr)
 {
-    nlohmann::json jsonObj = nlohmann::json::parse(jsonStr);
-    FlushDoneResponse flushDoneResponse;
-    flushDoneResponse.type = std::move(jsonObj["type"].get<std::string>());
-    flushDoneResponse.done = jsonObj["done"].get<bool>();
-    flushDoneResponse.flush_done = jsonObj["flush_done"].get<bool>();
-    flushDoneResponse.flush_id = jsonObj["flush_id"].get<int>();
-    flushDoneResponse.status_code = jsonObj["status_code"].get<int>();
-    if (jsonObj.contains("context_id") && !jsonObj["context_id"].is_null()) {
-        flushDoneResponse.context_id = std::move(jsonObj["context_id"].get<std::string>());
-    }
-    return flushDoneResponse;
+    return nlohmann::json::parse(jsonStr).get<FlushDoneResponse>();
+}
+
+void cartesiapp::response::tts::from_json(const nlohmann::json& jsonObj, DoneResponse& doneResponse)
+{
+    schema::decodeObject(jsonObj, doneResponse);
 }
 
 cartesiapp::response::tts::DoneResponse cartesiapp::response::tts::DoneResponse::fromJson(const std::string& jsonStr)
 {
-    nlohmann::json jsonObj = nlohmann::json::parse(jsonStr);
-    DoneResponse doneResponse;
-    doneResponse.type = std::move(jsonObj["type"].get<std::string>());
-    doneResponse.done = jsonObj["done"].get<bool>();
-    doneResponse.status_code = jsonObj["status_code"].get<int>();
-    if (jsonObj.contains("context_id") && !jsonObj["context_id"].is_null()) {
-        doneResponse.context_id = std::move(jsonObj["context_id"].get<std::string>());
-    }
-    return doneResponse;
+    return nlohmann::json::parse(jsonStr).get<DoneResponse>();
+}
+
+void cartesiapp::response::tts::from_json(const nlohmann::json& jsonObj, WordTimestampsResponse::WordTimestamps& wordTimestamps)
+{
+    schema::decodeObject(jsonObj, wordTimestamps);
 }
 
 cartesiapp::response::tts::WordTimestampsResponse::WordTimestamps cartesiapp::response::tts::WordTimestampsResponse::WordTimestamps::fromJson(const std::string& jsonStr)
 {
-    nlohmann::json jsonObj = nlohmann::json::parse(jsonStr);
-    WordTimestamps wordTimestamps;
-    wordTimestamps.words = std::move(jsonObj["words"].get<std::vector<std::string>>());
-    wordTimestamps.start = jsonObj["start"].get<std::vector<double>>();
-    wordTimestamps.end = jsonObj["end"].get<std::vector<double>>();
-    return wordTimestamps;
+    return nlohmann::json::parse(jsonStr).get<WordTimestamps>();
+}
+
+void cartesiapp::response::tts::from_json(const nlohmann::json& jsonObj, WordTimestampsResponse& wordTimestampsResponse)
+{
+    schema::decodeObject(jsonObj, wordTimestampsResponse);
 }
 
 cartesiapp::response::tts::WordTimestampsResponse cartesiapp::response::tts::WordTimestampsResponse::fromJson(const std::string& jsonStr)
 {
-    nlohmann::json jsonObj = nlohmann::json::parse(jsonStr);
-    WordTimestampsResponse wordTimestampsResponse;
-    wordTimestampsResponse.type = std::move(jsonObj["type"].get<std::string>());
-    wordTimestampsResponse.done = jsonObj["done"].get<bool>();
-    wordTimestampsResponse.status_code = jsonObj["status_code"].get<int>();
-    if (jsonObj.contains("context_id") && !jsonObj["context_id"].is_null()) {
-        wordTimestampsResponse.context_id = std::move(jsonObj["context_id"].get<std::string>());
-    }
+    return nlohmann::json::parse(jsonStr).get<WordTimestampsResponse>();
+}
 
-    // Based on header definition, word_timestamps is a vector, so parse as array
-    for (const auto& timestampJson : jsonObj["word_timestamps"]) {
-        wordTimestampsResponse.word_timestamps.push_back(WordTimestamps::fromJson(timestampJson.dump()));
-    }
-    return wordTimestampsResponse;
+void cartesiapp::response::tts::from_json(const nlohmann::json& jsonObj, PhonemeTimestampsResponse::PhonemeTimestamps& phonemeTimestamps)
+{
+    schema::decodeObject(jsonObj, phonemeTimestamps);
 }
 
 cartesiapp::response::tts::PhonemeTimestampsResponse::PhonemeTimestamps cartesiapp::response::tts::PhonemeTimestampsResponse::PhonemeTimestamps::fromJson(const std::string& jsonStr)
 {
-    nlohmann::json jsonObj = nlohmann::json::parse(jsonStr);
-    PhonemeTimestamps phonemeTimestamps;
-    phonemeTimestamps.phonemes = std::move(jsonObj["phonemes"].get<std::vector<std::string>>());
-    phonemeTimestamps.start = jsonObj["start"].get<std::vector<double>>();
-    phonemeTimestamps.end = jsonObj["end"].get<std::vector<double>>();
-    return phonemeTimestamps;
+    return nlohmann::json::parse(jsonStr).get<PhonemeTimestamps>();
+}
+
+void cartesiapp::response::tts::from_json(const nlohmann::json& jsonObj, PhonemeTimestampsResponse& phonemeTimestampsResponse)
+{
+    schema::decodeObject(jsonObj, phonemeTimestampsResponse);
 }
 
 cartesiapp::response::tts::PhonemeTimestampsResponse cartesiapp::response::tts::PhonemeTimestampsResponse::fromJson(const std::string& jsonStr)
 {
-    nlohmann::json jsonObj = nlohmann::json::parse(jsonStr);
-    PhonemeTimestampsResponse phonemeTimestampsResponse;
-    phonemeTimestampsResponse.type = std::move(jsonObj["type"].get<std::string>());
-    phonemeTimestampsResponse.done = jsonObj["done"].get<bool>();
-    phonemeTimestampsResponse.status_code = jsonObj["status_code"].get<int>();
-    if (jsonObj.contains("context_id") && !jsonObj["context_id"].is_null()) {
-        phonemeTimestampsResponse.context_id = std::move(jsonObj["context_id"].get<std::string>());
-    }
+    return nlohmann::json::parse(jsonStr).get<PhonemeTimestampsResponse>();
+}
 
-    // Based on header definition, phoneme_timestamps is a single object
-    phonemeTimestampsResponse.phoneme_timestamps = PhonemeTimestamps::fromJson(jsonObj["phoneme_timestamps"].dump());
-    return phonemeTimestampsResponse;
+void cartesiapp::response::tts::from_json(const nlohmann::json& jsonObj, ErrorResponse& errorResponse)
+{
+    schema::decodeObject(jsonObj, errorResponse);
 }
 
 cartesiapp::response::tts::ErrorResponse cartesiapp::response::tts::ErrorResponse::fromJson(const std::string& jsonStr)
 {
-    nlohmann::json jsonObj = nlohmann::json::parse(jsonStr);
-    ErrorResponse errorResponse;
-    errorResponse.type = std::move(jsonObj["type"].get<std::string>());
-    errorResponse.done = jsonObj["done"].get<bool>();
-    errorResponse.error = std::move(jsonObj["error"].get<std::string>());
-    errorResponse.status_code = jsonObj["status_code"].get<int>();
-    if (jsonObj.contains("context_id") && !jsonObj["context_id"].is_null()) {
-        errorResponse.context_id = std::move(jsonObj["context_id"].get<std::string>());
-    }
-    return errorResponse;
+    return nlohmann::json::parse(jsonStr).get<ErrorResponse>();
+}
+
+void cartesiapp::response::stt::from_json(const nlohmann::json& jsonObj, FlushDoneResponse& flushDoneResponse)
+{
+    schema::decodeObject(jsonObj, flushDoneResponse);
 }
 
 cartesiapp::response::stt::FlushDoneResponse cartesiapp::response::stt::FlushDoneResponse::fromJson(const std::string& jsonStr)
 {
-    nlohmann::json jsonObj = nlohmann::json::parse(jsonStr);
-    FlushDoneResponse flushDoneResponse;
-    flushDoneResponse.type = std::move(jsonObj["type"].get<std::string>());
-    flushDoneResponse.request_id = std::move(jsonObj["request_id"].get<std::string>());
-    return flushDoneResponse;
+    return nlohmann::json::parse(jsonStr).get<FlushDoneResponse>();
+}
+
+void cartesiapp::response::stt::from_json(const nlohmann::json& jsonObj, DoneResponse& doneResponse)
+{
+    schema::decodeObject(jsonObj, doneResponse);
 }
 
 cartesiapp::response::stt::DoneResponse cartesiapp::response::stt::DoneResponse::fromJson(const std::string& jsonStr)
 {
-    nlohmann::json jsonObj = nlohmann::json::parse(jsonStr);
-    DoneResponse doneResponse;
-    doneResponse.type = std::move(jsonObj["type"].get<std::string>());
-    doneResponse.request_id = std::move(jsonObj["request_id"].get<std::string>());
-    return doneResponse;
+    return nlohmann::json::parse(jsonStr).get<DoneResponse>();
+}
+
+void cartesiapp::response::stt::from_json(const nlohmann::json& jsonObj, ErrorResponse& errorResponse)
+{
+    schema::decodeObject(jsonObj, errorResponse);
 }
 
 cartesiapp::response::stt::ErrorResponse cartesiapp::response::stt::ErrorResponse::fromJson(const std::string& jsonStr)
 {
-    nlohmann::json jsonObj = nlohmann::json::parse(jsonStr);
-    ErrorResponse errorResponse;
-    errorResponse.type = std::move(jsonObj["type"].get<std::string>());
-    errorResponse.error = std::move(jsonObj["error"].get<std::string>());
-    errorResponse.request_id = std::move(jsonObj["request_id"].get<std::string>());
-    return errorResponse;
-}
\ No newline at end of file
+    return nlohmann::json::parse(jsonStr).get<ErrorResponse>();
+}
+
+template <typename Response>
+cartesiapp::response::tts::LazyTimestampsResponse<Response>::LazyTimestampsResponse(std::string_view frame, std::pmr::memory_resource* resource) :
+    _frame(frame, resource)
+{
+}
+
+template <typename Response>
+const Response& cartesiapp::response::tts::LazyTimestampsResponse<Response>::get() const
+{
+    if (!_decoded) {
+        // the decoded arrays come from the same resource as the retained frame
+        Response response(_frame.get_allocator().resource());
+        nlohmann::json::parse(_frame).get_to(response);
+        _decoded.emplace(std::move(response));
+    }
+    return *_decoded;
+}
+
+template class cartesiapp::response::tts::LazyTimestampsResponse<cartesiapp::response::tts::WordTimestampsResponse>;
+template class cartesiapp::response::tts::LazyTimestampsResponse<cartesiapp::response::tts::PhonemeTimestampsResponse>;
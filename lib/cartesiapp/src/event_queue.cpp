@@ -0,0 +1,26 @@
+#include "event_queue.hpp"
+#include "impl/event_queue_listeners.hpp"
+
+cartesiapp::TTSEventQueue::TTSEventQueue(TTSWebsocketClient& client, size_t capacity) :
+    _events(std::make_shared<EventRing<TTSEvent>>(capacity, RESERVED_EVENTS)),
+    _listener(std::make_shared<TTSEventQueueListener>(_events))
+{
+    client.registerTTSListener(_listener);
+}
+
+cartesiapp::TTSEventQueue::~TTSEventQueue()
+{
+    // the client only holds a weak reference to the listener, which shares the ring, events arriving from now on are never read
+}
+
+cartesiapp::STTEventQueue::STTEventQueue(STTWebsocketClient& client, size_t capacity) :
+    _events(std::make_shared<EventRing<STTEvent>>(capacity, RESERVED_EVENTS)),
+    _listener(std::make_shared<STTEventQueueListener>(_events))
+{
+    client.registerSTTListener(_listener);
+}
+
+cartesiapp::STTEventQueue::~STTEventQueue()
+{
+    // the client only holds a weak reference to the listener, which shares the ring, events arriving from now on are never read
+}
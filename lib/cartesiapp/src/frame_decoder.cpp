@@ -0,0 +1,328 @@
+#include "impl/frame_decoder.hpp"
+#include "impl/cartesiapp_json.hpp"
+#include "impl/base64_decoder.hpp"
+#include "cartesiapp_metrics.hpp"
+
+#include <nlohmann/json.hpp>
+
+#ifdef CARTESIAPP_USE_SIMDJSON
+#include <simdjson.h>
+#endif
+
+using namespace cartesiapp;
+
+struct cartesiapp::FrameDecoder::State {
+    /**
+     * @brief Decoded audio of the last chunk returned as a view, reused across frames.
+     */
+    std::string audio;
+
+    /**
+     * @brief Context ID of the last view decoded by the nlohmann path, which leaves nothing for the view to point into.
+     */
+    std::string contextId;
+
+#ifdef CARTESIAPP_USE_SIMDJSON
+    simdjson::ondemand::parser parser;
+
+    /**
+     * @brief Copy of the frame followed by the padding simdjson needs, reused across frames.
+     */
+    std::string scratch;
+
+    /**
+     * @brief Returns a padded copy of the frame; the frame itself lives in the connection's read buffer,
+     * which gives no guarantee about the bytes that follow it.
+     */
+    simdjson::padded_string_view pad(std::string_view frame) {
+        scratch.reserve(frame.size() + simdjson::SIMDJSON_PADDING);
+        scratch.assign(frame.data(), frame.size());
+        return simdjson::padded_string_view(scratch.data(), scratch.size(), scratch.capacity());
+    }
+#endif
+};
+
+#ifdef CARTESIAPP_USE_SIMDJSON
+namespace {
+    bool readString(simdjson::ondemand::value& value, std::string& target) {
+        std::string_view text;
+        if (value.get_string().get(text)) {
+            return false;
+        }
+        target.assign(text.data(), text.size());
+        return true;
+    }
+
+    bool readOptionalString(simdjson::ondemand::value& value, std::optional<std::string>& target) {
+        bool isNull = false;
+        if (value.is_null().get(isNull)) {
+            return false;
+        }
+        if (isNull) {
+            target.reset();
+            return true;
+        }
+        target.emplace();
+        return readString(value, *target);
+    }
+
+    /**
+     * @brief Decodes a chunk frame, the audio into `audio` and the other fields into `view`.
+     *
+     * The type and context ID views point into the parser's string buffer.
+     */
+    bool decodeAudioChunkFields(simdjson::ondemand::parser& parser, simdjson::padded_string_view json,
+        std::string& audio, std::string_view& type, response::tts::AudioChunkView& view) {
+        enum : unsigned { TYPE = 1, DATA = 2, DONE = 4, STATUS_CODE = 8, STEP_TIME = 16, ALL_REQUIRED = 31 };
+        simdjson::ondemand::document document;
+        simdjson::ondemand::object object;
+        if (parser.iterate(json).get(document) || document.get_object().get(object)) {
+            return false;
+        }
+        unsigned seen = 0;
+        for (auto field : object) {
+            std::string_view key;
+            simdjson::ondemand::value value;
+            if (field.unescaped_key().get(key) || field.value().get(value)) {
+                return false;
+            }
+            if (key == "data") {
+                std::string_view encoded;
+                if (value.get_string().get(encoded) || !codec::decodeBase64(encoded, audio)) {
+                    return false;
+                }
+                seen |= DATA;
+            }
+            else if (key == "type") {
+                if (value.get_string().get(type)) {
+                    return false;
+                }
+                seen |= TYPE;
+            }
+            else if (key == "done") {
+                if (value.get_bool().get(view.done)) {
+                    return false;
+                }
+                seen |= DONE;
+            }
+            else if (key == "status_code") {
+                int64_t statusCode = 0;
+                if (value.get_int64().get(statusCode)) {
+                    return false;
+                }
+                view.status_code = static_cast<int>(statusCode);
+                seen |= STATUS_CODE;
+            }
+            else if (key == "step_time") {
+                if (value.get_double().get(view.step_time)) {
+                    return false;
+                }
+                seen |= STEP_TIME;
+            }
+            else if (key == "context_id") {
+                bool isNull = false;
+                if (value.is_null().get(isNull) || (!isNull && value.get_string().get(view.context_id))) {
+                    return false;
+                }
+            }
+        }
+        return seen == ALL_REQUIRED;
+    }
+
+    bool decodeWordTiming(simdjson::ondemand::object& object, response::stt::WordTiming& word) {
+        enum : unsigned { WORD = 1, START = 2, END = 4, ALL_REQUIRED = 7 };
+        unsigned seen = 0;
+        for (auto field : object) {
+            std::string_view key;
+            simdjson::ondemand::value fieldValue;
+            if (field.unescaped_key().get(key) || field.value().get(fieldValue)) {
+                return false;
+            }
+            double number = 0.0;
+            if (key == "word") {
+                if (!readString(fieldValue, word.word)) {
+                    return false;
+                }
+                seen |= WORD;
+            }
+            else if (key == "start") {
+                if (fieldValue.get_double().get(number)) {
+                    return false;
+                }
+                word.start = static_cast<float>(number);
+                seen |= START;
+            }
+            else if (key == "end") {
+                if (fieldValue.get_double().get(number)) {
+                    return false;
+                }
+                word.end = static_cast<float>(number);
+                seen |= END;
+            }
+        }
+        return seen == ALL_REQUIRED;
+    }
+
+    bool decodeTranscriptionFields(simdjson::ondemand::parser& parser, simdjson::padded_string_view json,
+        response::stt::TranscriptionResponse& transcription) {
+        enum : unsigned { TYPE = 1, TEXT = 2, DURATION = 4, IS_FINAL = 8, REQUEST_ID = 16, ALL_REQUIRED = 31 };
+        simdjson::ondemand::document document;
+        simdjson::ondemand::object object;
+        if (parser.iterate(json).get(document) || document.get_object().get(object)) {
+            return false;
+        }
+        // missing or null words mean none
+        transcription.words.clear();
+        unsigned seen = 0;
+        for (auto field : object) {
+            std::string_view key;
+            simdjson::ondemand::value value;
+            if (field.unescaped_key().get(key) || field.value().get(value)) {
+                return false;
+            }
+            if (key == "words") {
+                bool isNull = false;
+                if (value.is_null().get(isNull)) {
+                    return false;
+                }
+                if (isNull) {
+                    continue;
+                }
+                simdjson::ondemand::array words;
+                if (value.get_array().get(words)) {
+                    return false;
+                }
+                for (auto wordResult : words) {
+                    simdjson::ondemand::object wordObject;
+                    if (wordResult.get_object().get(wordObject)) {
+                        return false;
+                    }
+                    transcription.words.emplace_back();
+                    if (!decodeWordTiming(wordObject, transcription.words.back())) {
+                        return false;
+                    }
+                }
+            }
+            else if (key == "text") {
+                if (!readString(value, transcription.text)) {
+                    return false;
+                }
+                seen |= TEXT;
+            }
+            else if (key == "type") {
+                if (!readString(value, transcription.type)) {
+                    return false;
+                }
+                seen |= TYPE;
+            }
+            else if (key == "request_id") {
+                if (!readString(value, transcription.request_id)) {
+                    return false;
+                }
+                seen |= REQUEST_ID;
+            }
+            else if (key == "duration") {
+                double duration = 0.0;
+                if (value.get_double().get(duration)) {
+                    return false;
+                }
+                transcription.duration = static_cast<float>(duration);
+                seen |= DURATION;
+            }
+            else if (key == "is_final") {
+                if (value.get_bool().get(transcription.is_final)) {
+                    return false;
+                }
+                seen |= IS_FINAL;
+            }
+            else if (key == "language") {
+                if (!readOptionalString(value, transcription.language)) {
+                    return false;
+                }
+            }
+        }
+        return seen == ALL_REQUIRED;
+    }
+}
+#endif
+
+cartesiapp::FrameDecoder::FrameDecoder() : _state(std::make_unique<State>())
+{
+}
+
+cartesiapp::FrameDecoder::~FrameDecoder()
+{
+}
+
+response::tts::AudioChunkResponse cartesiapp::FrameDecoder::decodeAudioChunk(std::string_view frame)
+{
+#ifdef CARTESIAPP_USE_SIMDJSON
+    response::tts::AudioChunkResponse chunk;
+    response::tts::AudioChunkView view;
+    std::string_view type;
+    if (decodeAudioChunkFields(_state->parser, _state->pad(frame), chunk.data, type, view)) {
+        chunk.type.assign(type.data(), type.size());
+        chunk.done = view.done;
+        chunk.status_code = view.status_code;
+        chunk.step_time = view.step_time;
+        if (!view.context_id.empty()) {
+            chunk.context_id = std::string(view.context_id);
+        }
+        metrics::MetricsRegistry::instance().recordBase64Decoded(chunk.data.size());
+        return chunk;
+    }
+#endif
+    // the nlohmann path reports malformed frames with a descriptive exception
+    return nlohmann::json::parse(frame).get<response::tts::AudioChunkResponse>();
+}
+
+response::tts::AudioChunkView cartesiapp::FrameDecoder::decodeAudioChunkView(std::string_view frame)
+{
+    response::tts::AudioChunkView view;
+#ifdef CARTESIAPP_USE_SIMDJSON
+    std::string_view type;
+    if (decodeAudioChunkFields(_state->parser, _state->pad(frame), _state->audio, type, view)) {
+        view.data = reinterpret_cast<const std::byte*>(_state->audio.data());
+        view.size = _state->audio.size();
+        metrics::MetricsRegistry::instance().recordBase64Decoded(view.size);
+        return view;
+    }
+    view = response::tts::AudioChunkView();
+#endif
+    auto chunk = nlohmann::json::parse(frame).get<response::tts::AudioChunkResponse>();
+    _state->audio.swap(chunk.data);
+    _state->contextId = chunk.context_id.value_or("");
+    view.data = reinterpret_cast<const std::byte*>(_state->audio.data());
+    view.size = _state->audio.size();
+    view.done = chunk.done;
+    view.status_code = chunk.status_code;
+    view.step_time = chunk.step_time;
+    view.context_id = _state->contextId;
+    return view;
+}
+
+response::stt::TranscriptionResponse cartesiapp::FrameDecoder::decodeTranscription(std::string_view frame)
+{
+    response::stt::TranscriptionResponse transcription;
+    decodeTranscription(frame, transcription);
+    return transcription;
+}
+
+void cartesiapp::FrameDecoder::decodeTranscription(std::string_view frame, response::stt::TranscriptionResponse& transcription)
+{
+#ifdef CARTESIAPP_USE_SIMDJSON
+    if (decodeTranscriptionFields(_state->parser, _state->pad(frame), transcription)) {
+        return;
+    }
+#endif
+    nlohmann::json::parse(frame).get_to(transcription);
+}
+
+bool cartesiapp::FrameDecoder::usesSimdjson()
+{
+#ifdef CARTESIAPP_USE_SIMDJSON
+    return true;
+#else
+    return false;
+#endif
+}
@@ -0,0 +1,45 @@
+#ifndef CARTESIAPP_AUDIO_ENERGY_HPP
+#define CARTESIAPP_AUDIO_ENERGY_HPP
+
+#include <cstddef>
+#include <string>
+
+namespace cartesiapp::codec {
+    /**
+     * @brief Sample formats whose energy can be measured, a subset of the STT input encodings.
+     */
+    enum class SampleFormat {
+        PCM_S16LE,
+        PCM_F32LE,
+        PCM_MULAW,
+        PCM_ALAW,
+    };
+
+    /**
+     * @brief Maps an STT encoding name to its sample format.
+     * @return False if the energy of the encoding cannot be measured.
+     */
+    bool sampleFormatOf(const std::string& encoding, SampleFormat& format);
+
+    /**
+     * @brief Size of one sample of the format in bytes.
+     */
+    size_t sampleBytesOf(SampleFormat format);
+
+    /**
+     * @brief Mean square of the samples, scaled so that a full-scale square wave measures 1.
+     *
+     * 16-bit and float samples are summed by the widest kernel the CPU supports (AVX2, SSE2 or NEON), detected
+     * once on first use, G.711 samples through a table of their linear values.
+     * @param data Little-endian samples, need not be aligned.
+     * @param samples The number of samples, not bytes.
+     */
+    double meanSquare(SampleFormat format, const char* data, size_t samples);
+
+    /**
+     * @brief Name of the kernel selected for this CPU ("avx2", "sse2", "neon" or "scalar").
+     */
+    const char* audioEnergyKernelName();
+}
+
+#endif // CARTESIAPP_AUDIO_ENERGY_HPP
@@ -0,0 +1,100 @@
+#ifndef CARTESIAPP_AUDIO_WINDOWS_HPP
+#define CARTESIAPP_AUDIO_WINDOWS_HPP
+
+#include "audio_energy.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+namespace cartesiapp {
+    /**
+     * @brief Cuts a stream of audio written in arbitrary sizes into 10 ms analysis windows.
+     *
+     * The bytes of an incomplete window are kept until the next write completes it. Not thread-safe.
+     */
+    class AudioWindowCutter {
+        public:
+        AudioWindowCutter(codec::SampleFormat format, int sampleRate) :
+            _format(format),
+            _sampleBytes(codec::sampleBytesOf(format)),
+            _bytesPerSecond(static_cast<uint64_t>(std::max(sampleRate, 1)) * _sampleBytes),
+            _windowBytes(std::max<size_t>(static_cast<size_t>(std::max(sampleRate, 1) / 100), 1) * _sampleBytes) {
+        }
+
+        /**
+         * @brief Calls `onWindow(window, meanSquare)` for every window completed by the written bytes, in order.
+         */
+        template <typename WindowHandler>
+        void feed(const char* data, size_t size, WindowHandler&& onWindow) {
+            size_t consumed = 0;
+            if (!_partial.empty()) {
+                size_t missing = std::min(_windowBytes - _partial.size(), size);
+                _partial.insert(_partial.end(), data, data + missing);
+                consumed = missing;
+                if (_partial.size() < _windowBytes) {
+                    return;
+                }
+                onWindow(_partial.data(), level(_partial.data()));
+                _partial.clear();
+            }
+            for (; consumed + _windowBytes <= size; consumed += _windowBytes) {
+                onWindow(data + consumed, level(data + consumed));
+            }
+            _partial.assign(data + consumed, data + size);
+        }
+
+        /**
+         * @brief The bytes of the incomplete window.
+         */
+        const std::vector<char>& partial() const {
+            return _partial;
+        }
+
+        void clearPartial() {
+            _partial.clear();
+        }
+
+        size_t windowBytes() const {
+            return _windowBytes;
+        }
+
+        size_t sampleBytes() const {
+            return _sampleBytes;
+        }
+
+        uint64_t bytesPerSecond() const {
+            return _bytesPerSecond;
+        }
+
+        /**
+         * @brief Bytes of whole samples lasting the duration.
+         */
+        size_t bytesOf(std::chrono::milliseconds duration) const {
+            uint64_t bytes = _bytesPerSecond * static_cast<uint64_t>(std::max<long long>(duration.count(), 0)) / 1000;
+            return static_cast<size_t>(bytes) / _sampleBytes * _sampleBytes;
+        }
+
+        /**
+         * @brief Mean square of a level given in dB relative to full scale.
+         */
+        static double meanSquareOf(float dbfs) {
+            return std::pow(10.0, static_cast<double>(dbfs) / 10.0);
+        }
+
+        private:
+        double level(const char* window) const {
+            return codec::meanSquare(_format, window, _windowBytes / _sampleBytes);
+        }
+
+        const codec::SampleFormat _format;
+        const size_t _sampleBytes;
+        const uint64_t _bytesPerSecond;
+        const size_t _windowBytes;
+        std::vector<char> _partial;
+    };
+}
+
+#endif // CARTESIAPP_AUDIO_WINDOWS_HPP
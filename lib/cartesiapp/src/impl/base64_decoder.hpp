@@ -0,0 +1,42 @@
+#ifndef CARTESIAPP_BASE64_DECODER_HPP
+#define CARTESIAPP_BASE64_DECODER_HPP
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+namespace cartesiapp::codec {
+    /**
+     * @brief Number of bytes the standard (RFC 4648) base64 text decodes to, ignoring trailing '=' padding.
+     *
+     * The result is only meaningful for well-formed input, decodeBase64() reports anything else.
+     */
+    size_t base64DecodedSize(std::string_view encoded);
+
+    /**
+     * @brief Decodes standard base64 into a caller-supplied buffer of at least base64DecodedSize(encoded) bytes.
+     *
+     * Padding is optional. Whole blocks are decoded by the widest kernel the CPU supports (AVX2, SSE4.1 or
+     * NEON), detected once on first use, and the remainder by a scalar loop. The decoder never writes past
+     * base64DecodedSize(encoded) bytes of the output.
+     * @return False if the input contains a character outside the base64 alphabet or has an invalid length,
+     * in which case the content of the output is unspecified.
+     */
+    bool decodeBase64(std::string_view encoded, char* out);
+
+    /**
+     * @brief Decodes standard base64 into `out`, resizing it to the decoded size.
+     *
+     * Reusing the same string across calls keeps its capacity, so decoding does not allocate once it has
+     * grown to the working size.
+     * @return False if the input is not valid base64, `out` is then left empty.
+     */
+    bool decodeBase64(std::string_view encoded, std::string& out);
+
+    /**
+     * @brief Name of the kernel selected for this CPU ("avx2", "sse4.1", "neon" or "scalar").
+     */
+    const char* base64KernelName();
+}
+
+#endif // CARTESIAPP_BASE64_DECODER_HPP
@@ -2,24 +2,41 @@
 #define CARTESIA_APP_BOOST_IMPL_HPP
 
 #include "cartesiapp.hpp"
-
+#include "cartesiapp_metrics.hpp"
+#include "websocket_options.hpp"
+#include "cartesiapp_json.hpp"
+#include "mpsc_queue.hpp"
+#include "io_engine.hpp"
+#include "io_engine_impl.hpp"
+#include "thread_cpu_clock.hpp"
+
+#include <algorithm>
+#include <charconv>
 #include <string>
+#include <string_view>
 #include <sstream>
 #include <iostream>
 #include <fstream>
 #include <chrono>
 #include <thread>
 #include <mutex>
+#include <condition_variable>
+#include <optional>
 #include <atomic>
 
 #include <nlohmann/json.hpp>
 #include <spdlog/spdlog.h>
 
 // boost
+#include <boost/version.hpp>
 #include <boost/beast/core.hpp>
 #include <boost/beast/http.hpp>
 #include <boost/beast/version.hpp>
 #include <boost/asio/connect.hpp>
+#include <boost/asio/dispatch.hpp>
+#include <boost/asio/post.hpp>
+#include <boost/asio/steady_timer.hpp>
+#include <boost/asio/strand.hpp>
 #include <boost/asio/ip/tcp.hpp>
 #include <boost/asio/ssl.hpp>
 #include <boost/beast/websocket.hpp>
@@ -38,6 +55,31 @@ using tcp = net::ip::tcp;
 using Websocket = boost::beast::websocket::stream<ssl::stream<tcp::socket>>;
 
 namespace cartesiapp {
+    /**
+     * @brief Copies the TLS-level byte counters of a connection into the timings record.
+     */
+    inline void recordWireBytes(SSL* sslHandle, RequestTimings& timings) {
+        timings.bytes_sent = static_cast<size_t>(BIO_number_written(SSL_get_wbio(sslHandle)));
+        timings.bytes_received = static_cast<size_t>(BIO_number_read(SSL_get_rbio(sslHandle)));
+    }
+
+    /**
+     * @brief Counts a connection in the open connections gauge for as long as the scope lives.
+     */
+    class OpenConnectionScope {
+        public:
+        OpenConnectionScope() {
+            metrics::MetricsRegistry::instance().connectionOpened();
+        }
+
+        ~OpenConnectionScope() {
+            metrics::MetricsRegistry::instance().connectionClosed();
+        }
+
+        OpenConnectionScope(const OpenConnectionScope&) = delete;
+        OpenConnectionScope& operator=(const OpenConnectionScope&) = delete;
+    };
+
     /**
      * @brief Implementation class for Cartesia API client using Boost.Beast
      */
@@ -62,12 +104,16 @@ namespace cartesiapp {
             return _apiVersion;
         }
 
-        response::ApiInfo getApiInfo() const {
-            spdlog::debug("Getting API info...");
+        void setRequestTimingsCallback(RequestTimingsCallback callback) {
+            _timingsCallback = std::move(callback);
+        }
 
-            beast::error_code ec;
+        void setMemoryResource(std::pmr::memory_resource* resource) {
+            _memoryResource = resource;
+        }
 
-            ssl::stream<beast::tcp_stream> sslStream = createSSLStream(_verifyCertificates);
+        response::ApiInfo getApiInfo() const {
+            spdlog::debug("Getting API info...");
 
             http::request<http::empty_body> httpRequest{
                 http::verb::get,
@@ -81,17 +127,8 @@ namespace cartesiapp {
             httpRequest.set(http::field::connection, "close");
             httpRequest.prepare_payload();
 
-            http::write(sslStream, httpRequest);
-
-            beast::flat_buffer buffer;
-            http::response<http::string_body> httpResponse;
-            http::read(sslStream, buffer, httpResponse);
-
-            sslStream.shutdown(ec);
-
-            if (ec && ec != beast::errc::not_connected) {
-                throw beast::system_error{ ec };
-            }
+            http::response<http::string_body> httpResponse = performRequest(httpRequest,
+                cartesiapp::request::constants::ENDPOINT_API_STATUS_INFO);
 
             response::ApiInfo apiInfo = response::ApiInfo::fromJson(httpResponse.body());
             return apiInfo;
@@ -99,7 +136,6 @@ namespace cartesiapp {
 
         response::Voice getVoice(const std::string& voiceId) const {
             spdlog::debug("Getting voice with ID: {}", voiceId);
-            ssl::stream<beast::tcp_stream> sslStream = createSSLStream(_verifyCertificates);
 
             // request url with voice id
             std::string requestUrl = std::string(cartesiapp::request::constants::ENDPOINT_VOICES) + "/" + voiceId;
@@ -119,17 +155,8 @@ namespace cartesiapp {
 
             httpRequest.prepare_payload();
 
-            http::write(sslStream, httpRequest);
-
-            beast::flat_buffer buffer;
-            http::response<http::string_body> httpResponse;
-            http::read(sslStream, buffer, httpResponse);
-            beast::error_code ec;
-            sslStream.shutdown(ec);
-
-            if (ec && ec != beast::errc::not_connected) {
-                throw beast::system_error{ ec };
-            }
+            http::response<http::string_body> httpResponse = performRequest(httpRequest,
+                cartesiapp::request::constants::ENDPOINT_VOICES);
 
             int code = httpResponse.result_int();
             std::string response = std::move(httpResponse.body());
@@ -146,7 +173,6 @@ namespace cartesiapp {
         response::VoiceListPage getVoiceList(const request::VoiceListRequest& request) const {
             std::string queryParams = request.toQueryParams();
             spdlog::debug("Getting voice list... query params: {}", queryParams);
-            ssl::stream<beast::tcp_stream> sslStream = createSSLStream(_verifyCertificates);
 
             // request url with query parameters
             std::string requestUrl = cartesiapp::request::constants::ENDPOINT_VOICES + queryParams;
@@ -166,17 +192,8 @@ namespace cartesiapp {
 
             httpRequest.prepare_payload();
 
-            http::write(sslStream, httpRequest);
-
-            beast::flat_buffer buffer;
-            http::response<http::string_body> httpResponse;
-            http::read(sslStream, buffer, httpResponse);
-            beast::error_code ec;
-            sslStream.shutdown(ec);
-
-            if (ec && ec != beast::errc::not_connected) {
-                throw beast::system_error{ ec };
-            }
+            http::response<http::string_body> httpResponse = performRequest(httpRequest,
+                cartesiapp::request::constants::ENDPOINT_VOICES);
 
             int code = httpResponse.result_int();
             std::string response = std::move(httpResponse.body());
@@ -187,14 +204,12 @@ namespace cartesiapp {
                 throw spdlog::spdlog_ex(errorMsg, code);
             }
 
-            return response::VoiceListPage::fromJson(response);
+            return decodeWithMemoryResource<response::VoiceListPage>(response);
         }
 
         std::string ttsBytes(const request::TTSBytesRequest& request) const {
             spdlog::debug("Performing TTS Bytes request...");
 
-            ssl::stream<beast::tcp_stream> sslStream = createSSLStream(_verifyCertificates);
-
             // create the HTTP POST request
             http::request<http::string_body> httpRequest{
                 http::verb::post,
@@ -216,21 +231,8 @@ namespace cartesiapp {
 
             httpRequest.prepare_payload();
 
-            // send the HTTP request to the remote host
-            http::write(sslStream, httpRequest);
-
-            // receive the HTTP response
-            beast::flat_buffer buffer;
-            http::response<http::string_body> httpResponse;
-            http::read(sslStream, buffer, httpResponse);
-
-            beast::error_code ec;
-            sslStream.shutdown(ec);
-
-            // check for errors
-            if (ec && ec != beast::errc::not_connected) {
-                throw beast::system_error{ ec };
-            }
+            http::response<http::string_body> httpResponse = performRequest(httpRequest,
+                cartesiapp::request::constants::ENDPOINT_TTS_BYTES);
 
             std::string response = httpResponse.body();
             return response;
@@ -241,8 +243,6 @@ namespace cartesiapp {
             const std::string& mime = "application/octet-stream") const {
             spdlog::debug("Performing STT Batch request...");
 
-            ssl::stream<beast::tcp_stream> sslStream = createSSLStream(_verifyCertificates);
-
             // request URL with query parameters
             std::string requestUrl = cartesiapp::request::constants::ENDPOINT_STT + request.toQueryParams();
 
@@ -316,21 +316,8 @@ namespace cartesiapp {
             httpRequest.body() = std::move(formData);
             httpRequest.prepare_payload();
 
-            // send the HTTP request to the remote host
-            http::write(sslStream, httpRequest);
-
-            // receive the HTTP response
-            beast::flat_buffer buffer;
-            http::response<http::string_body> httpResponse;
-            http::read(sslStream, buffer, httpResponse);
-
-            beast::error_code ec;
-            sslStream.shutdown(ec);
-
-            // check for errors
-            if (ec && ec != beast::errc::not_connected) {
-                throw beast::system_error{ ec };
-            }
+            http::response<http::string_body> httpResponse = performRequest(httpRequest,
+                cartesiapp::request::constants::ENDPOINT_STT);
 
             int code = httpResponse.result_int();
             std::string response = std::move(httpResponse.body());
@@ -343,11 +330,64 @@ namespace cartesiapp {
 
             spdlog::debug("STT Batch response: {}", response);
 
-            return response::stt::TranscriptionResponse::fromJson(response);
+            return decodeWithMemoryResource<response::stt::TranscriptionResponse>(response);
         }
 
         private:
-        ssl::stream<beast::tcp_stream> createSSLStream(bool verifyCertificates) const {
+        /**
+         * @brief Sends the request over a new TLS connection and reads the whole response, recording
+         * the timing of each phase and reporting it through the timings callback, even on failure.
+         */
+        template <class RequestBody>
+        http::response<http::string_body> performRequest(http::request<RequestBody>& httpRequest, const char* endpoint) const {
+            RequestTimings timings;
+            timings.endpoint = endpoint;
+            timings.start = RequestTimings::Clock::now();
+            int statusCode = 0;
+            try {
+                ssl::stream<beast::tcp_stream> sslStream = createSSLStream(_verifyCertificates, timings);
+                OpenConnectionScope connectionScope;
+
+                // send the HTTP request to the remote host
+                http::write(sslStream, httpRequest);
+                timings.request_sent = RequestTimings::Clock::now();
+
+                // receive the HTTP response, headers first so server time and download time can be told apart
+                beast::flat_buffer buffer;
+                http::response_parser<http::string_body> parser;
+                http::read_header(sslStream, buffer, parser);
+                timings.first_byte_received = RequestTimings::Clock::now();
+                statusCode = parser.get().result_int();
+                http::read(sslStream, buffer, parser);
+                timings.completed = RequestTimings::Clock::now();
+                recordWireBytes(sslStream.native_handle(), timings);
+
+                beast::error_code ec;
+                sslStream.shutdown(ec);
+
+                // check for errors
+                if (ec && ec != beast::errc::not_connected) {
+                    throw beast::system_error{ ec };
+                }
+
+                timings.succeeded = true;
+                reportTimings(timings, statusCode);
+                return parser.release();
+            }
+            catch (...) {
+                reportTimings(timings, statusCode);
+                throw;
+            }
+        }
+
+        void reportTimings(const RequestTimings& timings, int statusCode) const {
+            metrics::MetricsRegistry::instance().recordRequest(timings, statusCode);
+            if (_timingsCallback) {
+                _timingsCallback(timings);
+            }
+        }
+
+        ssl::stream<beast::tcp_stream> createSSLStream(bool verifyCertificates, RequestTimings& timings) const {
             //ssl::context _sslContext(ssl::context::tls_client);
 
             beast::error_code ec;
@@ -379,6 +419,7 @@ namespace cartesiapp {
                 });
 
             auto const results = _resolver.resolve(cartesiapp::request::constants::HOST, "443");
+            timings.dns_resolved = RequestTimings::Clock::now();
 
             ssl::stream<beast::tcp_stream> sslStream(_ioContext, _sslContext);
 
@@ -389,15 +430,29 @@ namespace cartesiapp {
             }
 
             beast::get_lowest_layer(sslStream).connect(results);
+            timings.tcp_connected = RequestTimings::Clock::now();
             sslStream.handshake(ssl::stream_base::client);
+            timings.tls_handshake_done = RequestTimings::Clock::now();
 
             return std::move(sslStream);
         }
 
+        /**
+         * @brief Decodes a response whose containers are allocated from the client's memory resource.
+         */
+        template <typename T>
+        T decodeWithMemoryResource(const std::string& body) const {
+            T decoded(_memoryResource ? _memoryResource : std::pmr::get_default_resource());
+            nlohmann::json::parse(body).get_to(decoded);
+            return decoded;
+        }
+
         private:
         std::string _apiKey;
         std::string _apiVersion;
         bool _verifyCertificates;
+        RequestTimingsCallback _timingsCallback;
+        std::pmr::memory_resource* _memoryResource = nullptr;
 
         // Boost.Asio components, mutable to allow modification in const methods that are exposed to users
         mutable ssl::context _sslContext;
@@ -419,49 +474,120 @@ namespace cartesiapp {
             _apiVersion(apiVersion),
             _resolver(_ioContext),
             _sslContext(ssl::context::tls_client),
-            _websocket(_ioContext, _sslContext),
             _verifyCertificates(verifyCertificates) {
 
         }
 
         ~WebsocketClientImpl() {
-            disconnectAndStop();
+            if (!_isStoppedFlag.load()) {
+                disconnectAndStop();
+            }
+            waitForOperations();
+            // messages queued after the writer stopped are never written
+            size_t dropped = 0;
+            while (_outbound.pop()) {
+                ++dropped;
+            }
+            metrics::MetricsRegistry::instance().websocketMessagesDropped(dropped);
+        }
+
+        /**
+         * @brief Destroys a client. From one of its own I/O callbacks, where its pending operations cannot be awaited,
+         * the client stops calling back, shuts its socket down and is destroyed by a handler posted to its I/O engine
+         * once they complete. The client holds the engine, which therefore outlives every release in flight.
+         */
+        static void release(std::unique_ptr<WebsocketClientImpl> client) {
+            if (!client || !client->_strand || !client->_strand->running_in_this_thread()) {
+                client.reset();
+                return;
+            }
+            // owned by the strand, which is running this thread
+            client->_callbacksDetached = true;
+            client->_shouldStopFlag.store(true);
+            client->markConnectionClosed();
+            client->closeSocket();
+            // nothing is left to close gracefully, the destructor only waits for the operations
+            client->_isStoppedFlag.store(true);
+            WebsocketClientImpl* released = client.release();
+            bool idle = false;
+            {
+                std::lock_guard<std::mutex> lock(released->_operationsMutex);
+                released->_released = true;
+                idle = released->_pendingOperations == 0;
+            }
+            if (idle) {
+                released->destroyOnEngine();
+            }
         }
 
         bool isConnectedAndStarted() const {
-            return _websocket.is_open() && !_shouldStopFlag.load();
+            return _connectionOpen.load() && !_shouldStopFlag.load();
         }
 
-        bool sendText(const std::string& text) {
-            if (!_websocket.is_open()) {
-                spdlog::error("sendText: WebSocket is not connected.");
-                return false;
-            }
-            _websocket.text(true);
-            beast::error_code ec;
-            _websocket.write(net::buffer(text), ec);
-            if (ec) {
-                spdlog::error("sendText: Error sending text over WebSocket: {}", ec.message());
-                return false;
-            }
-            return true;
+        void setOptions(const WebsocketOptions& options) {
+            _options = options;
+        }
+
+        void setRequestTimingsCallback(RequestTimingsCallback callback) {
+            _timingsCallback = std::move(callback);
+        }
+
+        /**
+         * @brief Selects the engine running the connection, before it is established.
+         */
+        void setIoEngine(std::shared_ptr<IoEngine> engine) {
+            _engine = std::move(engine);
+        }
+
+        /**
+         * @brief Queues a text message for the writer, without blocking on the network. Safe to call from any thread.
+         * @return false if the connection is not open; write errors are reported asynchronously through the error callback.
+         */
+        bool sendText(std::string text) {
+            return enqueue(std::move(text), false, "sendText");
         }
 
+        /**
+         * @brief Queues a binary message for the writer, without blocking on the network. Safe to call from any thread.
+         * @return false if the connection is not open; write errors are reported asynchronously through the error callback.
+         */
         bool sendBytes(const char* data, size_t size) {
-            if (!_websocket.is_open()) {
-                spdlog::error("sendBytes: WebSocket is not connected.");
+            return enqueue(std::string(data, size), true, "sendBytes");
+        }
+
+        /**
+         * @brief Sends a ping control frame, without blocking. At most one ping is in flight, further calls
+         * while one is pending are no-ops.
+         * @return false if the connection is not open.
+         */
+        bool sendPing() {
+            if (!_connectionOpen.load() || _shouldStopFlag.load()) {
                 return false;
             }
-            beast::error_code ec;
-            _websocket.binary(true);
-            _websocket.write(net::buffer(data, size), ec);
-            if (ec) {
-                spdlog::error("sendBytes: Error sending bytes over WebSocket: {}", ec.message());
-                return false;
+            if (_pingInFlight.exchange(true)) {
+                return true;
             }
+            beginOperation();
+            net::post(*_strand, [this]() {
+                writePing();
+                });
             return true;
         }
 
+        /**
+         * @brief The strand the reads and writes of the current connection run on. Only valid once connected.
+         */
+        net::strand<net::io_context::executor_type> strand() const {
+            return *_strand;
+        }
+
+        /**
+         * @brief Round trip time measured by the latest pong of the connection, 0 before the first.
+         */
+        uint64_t lastPingRttNs() const {
+            return _lastPingRttNs.load(std::memory_order_relaxed);
+        }
+
         bool disconnectAndStop() {
             // check if websocket is already disconnected
             if (_isStoppedFlag.load()) {
@@ -469,42 +595,34 @@ namespace cartesiapp {
                 return false;
             }
 
-            // mark to stop the worker thread
+            // mark to stop the pending operations
             _shouldStopFlag.store(true);
-
-            // First, forcefully shutdown the underlying TCP socket to unblock any pending reads
-            {
-                try {
-                    beast::error_code ec;
-                    // Shutdown the underlying TCP socket to interrupt any blocking read operations
-                    beast::get_lowest_layer(_websocket).close(ec);
-                    if (ec) {
-                        spdlog::warn("disconnectWebsocket: Error closing underlying socket: {}", ec.message());
-                    }
-                }
-                catch (const std::exception& ex) {
-                    spdlog::error("disconnectWebsocket: Exception while closing underlying socket: {}", ex.what());
-                }
+            markConnectionClosed();
+            if (!_websocket) {
+                _isStoppedFlag.store(true);
+                return true;
             }
 
-            // join the worker thread first (it should exit quickly now that socket is closed)
-            {
-                try {
-                    if (_workerThread.joinable()) {
-                        _workerThread.join();
-                    }
-                }
-                catch (const std::exception& ex) {
-                    spdlog::error("disconnectWebsocket: Error joining worker thread: {}", ex.what());
-                }
+            // First, forcefully shutdown the underlying TCP socket to complete the pending read and write with an
+            // error. The socket belongs to the strand while operations are pending, so the shutdown is posted to it.
+            if (_strand->running_in_this_thread()) {
+                closeSocket();
+            }
+            else {
+                beginOperation();
+                net::post(*_strand, [this]() {
+                    OperationScope operation(*this);
+                    closeSocket();
+                    });
             }
+            waitForOperations();
 
             // Now attempt graceful WebSocket close (though connection may already be broken)
             {
                 try {
                     beast::error_code ec;
-                    if (_websocket.is_open()) {
-                        _websocket.close(beast::websocket::close_code::normal, ec);
+                    if (_websocket->is_open()) {
+                        _websocket->close(beast::websocket::close_code::normal, ec);
                         if (ec && ec != beast::websocket::error::closed && ec != net::error::eof) {
                             spdlog::warn("disconnectWebsocket: Error closing WebSocket gracefully: {}", ec.message());
                         }
@@ -520,7 +638,14 @@ namespace cartesiapp {
             return true;
         }
 
-        bool connectWebsocketAndStartThread(const std::function<void(const std::string&)>& dataReadCallback,
+        /**
+         * @brief Connects and starts reading on the I/O engine. Each frame is handed to `dataReadCallback`, on an
+         * engine thread, as a view into the connection's read buffer, only valid until the callback returns.
+         *
+         * The resolve, TCP connect, TLS and upgrade handshakes block the calling thread, for at most the handshake
+         * timeout; only the reads and writes that follow run on the engine.
+         */
+        bool connectWebsocketAndStartThread(const std::function<void(std::string_view)>& dataReadCallback,
             const std::function<void()>& onConnectedCallback,
             const std::function<void(const std::string& message)>& onDisconnectedCallback,
             const std::function<void(const std::string& errorMessage)>& onErrorCallback,
@@ -536,65 +661,421 @@ namespace cartesiapp {
                 }
             }
 
-            _workerThread = std::thread([this,
-                dataReadCallback,
-                onDisconnectedCallback,
-                onErrorCallback]()
-                {
-                    beast::flat_buffer buffer;
-                    beast::error_code ec;
-                    _shouldStopFlag.store(false);
-                    try {
-                        while (!_shouldStopFlag.load() && _websocket.is_open())
-                        {
-                            size_t bytesRead = 0;
-
-                            // check if websocket is still open and we should continue
-                            if (!_websocket.is_open() || _shouldStopFlag.load()) {
-                                spdlog::warn("WebSocket is no longer open or stop requested, stopping data reception thread.");
-                                break;
-                            }
-
-                            // read data from websocket                    
-                            try {
-                                bytesRead = _websocket.read(buffer, ec);
-                            }
-                            catch (const std::exception& read_ex) {
-                                spdlog::warn("Exception during WebSocket read: {}", read_ex.what());
-                                ec = beast::error_code(net::error::operation_aborted, net::error::get_system_category());
-                            }
-
-                            if (_shouldStopFlag.load()) {
-                                if (onDisconnectedCallback) {
-                                    onDisconnectedCallback("WebSocket disconnected.");
-                                }
-                                break;
-                            }
-                            if (ec) {
-                                _shouldStopFlag.store(true);
-                                if (onErrorCallback) {
-                                    onErrorCallback(ec.message());
-                                    break;
-                                }
-                            }
-                            else {
-                                std::string data(beast::buffers_to_string(buffer.data()));
-                                buffer.consume(bytesRead);
-                                dataReadCallback(data);
-                            }
-                        }
+            _dataReadCallback = dataReadCallback;
+            _onDisconnectedCallback = onDisconnectedCallback;
+            _onErrorCallback = onErrorCallback;
+            _headers = headers;
+            _queryParams = queryParams;
+            _shouldStopFlag.store(false);
+
+            // the reads and writes of the connection are asynchronous operations on its strand, run by the engine
+            beginOperation();
+            net::dispatch(*_strand, [this]() {
+                readNext();
+                });
+            if (_options.ping_interval.count() > 0) {
+                beginOperation();
+                net::dispatch(*_strand, [this]() {
+                    scheduleKeepalivePing();
+                    });
+            }
+            return true;
+        }
+
+        /**
+         * @brief Connects again after the connection failed, with the callbacks, headers and query parameters of the
+         * last connectWebsocketAndStartThread() call. The connected callback is not invoked again. Fails once
+         * disconnectAndStop() was called.
+         */
+        bool reconnect() {
+            auto dataReadCallback = _dataReadCallback;
+            auto onDisconnectedCallback = _onDisconnectedCallback;
+            auto onErrorCallback = _onErrorCallback;
+            auto headers = _headers;
+            auto queryParams = _queryParams;
+            return connectWebsocketAndStartThread(dataReadCallback, nullptr, onDisconnectedCallback, onErrorCallback,
+                headers, queryParams);
+        }
+
+        private:
+        /**
+         * @brief A message waiting in the outbound queue.
+         */
+        struct OutboundMessage {
+            std::string payload;
+            bool binary = false;
+            std::chrono::steady_clock::time_point queuedAt;
+        };
+
+        /**
+         * @brief Ends an operation when it leaves the scope, exceptions included, unless the chain goes on with
+         * another asynchronous step that ends it instead.
+         */
+        class OperationScope {
+            public:
+            explicit OperationScope(WebsocketClientImpl& client) : _client(&client) {
+            }
+
+            ~OperationScope() {
+                if (_client) {
+                    _client->endOperation();
+                }
+            }
+
+            OperationScope(const OperationScope&) = delete;
+            OperationScope& operator=(const OperationScope&) = delete;
+
+            /**
+             * @brief Passes the operation on to the step just started.
+             */
+            void handOff() {
+                _client = nullptr;
+            }
+
+            private:
+            WebsocketClientImpl* _client;
+        };
+
+        /**
+         * @brief Upper bound of a binary write built by coalescing consecutive queued audio messages.
+         */
+        static constexpr size_t MAX_COALESCED_BYTES = 64 * 1024;
+
+        bool enqueue(std::string payload, bool binary, const char* caller) {
+            if (!_connectionOpen.load() || _shouldStopFlag.load()) {
+                spdlog::error("{}: WebSocket is not connected.", caller);
+                return false;
+            }
+            metrics::MetricsRegistry::instance().websocketMessageQueued();
+            // counted before the push so the writer never sees more messages than the count
+            bool writerIdle = _pendingMessages.fetch_add(1, std::memory_order_acq_rel) == 0;
+            _outbound.push(OutboundMessage{ std::move(payload), binary, std::chrono::steady_clock::now() });
+            if (writerIdle) {
+                // the write chain keeps the connection alive until the queue drains
+                beginOperation();
+                net::post(_websocket->get_executor(), [this]() {
+                    writeNext();
+                    });
+            }
+            return true;
+        }
+
+        /**
+         * @brief Writes the next queued message. Runs on the strand, at most one write chain is active at a time.
+         */
+        void writeNext() {
+            OperationScope operation(*this);
+            size_t messages = 0;
+            do {
+                if (!_outbound.pop(_inFlight)) {
+                    // a producer counted its message but has not linked it yet
+                    net::post(_websocket->get_executor(), [this]() {
+                        writeNext();
+                        });
+                    operation.handOff();
+                    return;
+                }
+                messages = 1;
+                if (_inFlight.binary && _options.coalesce_binary_messages) {
+                    // consecutive audio messages form one byte stream, send them as a single frame
+                    OutboundMessage* next = _outbound.front();
+                    while (next && next->binary && _inFlight.payload.size() + next->payload.size() <= MAX_COALESCED_BYTES) {
+                        _inFlight.payload += next->payload;
+                        _outbound.pop();
+                        ++messages;
+                        next = _outbound.front();
                     }
-                    catch (std::exception& e)
-                    {
-                        if (onErrorCallback) {
-                            onErrorCallback(e.what());
+                }
+                if (_writeFailed && !finishWrite(messages, false)) {
+                    return;
+                }
+            } while (_writeFailed);
+            _websocket->binary(_inFlight.binary);
+            _websocket->async_write(net::buffer(_inFlight.payload),
+                [this, messages](beast::error_code ec, size_t) {
+                    OperationScope operation(*this);
+                    if (_options.record_io_cpu_time) {
+                        metrics::MetricsRegistry::instance().recordWebsocketIoCpuTime(IoCpuAccounting::charge());
+                    }
+                    if (ec) {
+                        if (!_shouldStopFlag.load()) {
+                            spdlog::error("writeNext: Error sending over WebSocket: {}", ec.message());
                         }
+                        // the read fails as well once the socket is closed, which reports the error
+                        _writeFailed = true;
+                        closeSocket();
+                    }
+                    else {
+                        metrics::MetricsRegistry::instance().recordWebsocketBytesSent(_inFlight.payload.size(), wireBytesWritten());
+                    }
+                    if (finishWrite(messages, !ec)) {
+                        operation.handOff();
+                        writeNext();
                     }
                 });
-            return true;
+            operation.handOff();
         }
 
-        private:
+        /**
+         * @brief Accounts for the messages of the write that completed.
+         * @return true if more messages are queued, the write chain goes on.
+         */
+        bool finishWrite(size_t messages, bool written) {
+            if (written) {
+                auto elapsed = std::chrono::steady_clock::now() - _inFlight.queuedAt;
+                metrics::MetricsRegistry::instance().recordWebsocketWrite(messages,
+                    static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()));
+            }
+            else {
+                metrics::MetricsRegistry::instance().websocketMessagesDropped(messages);
+            }
+            _inFlight.payload.clear();
+            return _pendingMessages.fetch_sub(messages, std::memory_order_acq_rel) != messages;
+        }
+
+        /**
+         * @brief Writes a ping stamped with the send time, echoed by the pong. Runs on the strand, with
+         * `_pingInFlight` set and an operation begun by the caller.
+         */
+        void writePing() {
+            auto sentNs = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count();
+            beast::websocket::ping_data payload(std::to_string(sentNs).c_str());
+            _websocket->async_ping(payload, [this](beast::error_code ec) {
+                OperationScope operation(*this);
+                if (ec && !_shouldStopFlag.load()) {
+                    spdlog::warn("writePing: Error sending ping: {}", ec.message());
+                }
+                _pingInFlight.store(false);
+                });
+        }
+
+        /**
+         * @brief Measures the round trip time of a ping from the stamp its pong echoes. Pongs the server sends on
+         * its own carry no stamp and are ignored.
+         */
+        void onPong(std::string_view payload) {
+            uint64_t sentNs = 0;
+            auto parsed = std::from_chars(payload.data(), payload.data() + payload.size(), sentNs);
+            if (parsed.ec != std::errc() || parsed.ptr != payload.data() + payload.size()) {
+                return;
+            }
+            auto nowNs = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count());
+            if (nowNs < sentNs) {
+                return;
+            }
+            _lastPingRttNs.store(nowNs - sentNs, std::memory_order_relaxed);
+            metrics::MetricsRegistry::instance().recordWebsocketPingRtt(nowNs - sentNs);
+        }
+
+        /**
+         * @brief Pings the server every ping interval until the connection stops. Runs on the strand.
+         */
+        void scheduleKeepalivePing() {
+            _keepaliveTimer->expires_after(_options.ping_interval);
+            _keepaliveTimer->async_wait([this](beast::error_code ec) {
+                OperationScope operation(*this);
+                if (ec || _shouldStopFlag.load()) {
+                    return;
+                }
+                // skipped while the previous ping is still queued behind a large write
+                if (!_pingInFlight.exchange(true)) {
+                    beginOperation();
+                    writePing();
+                }
+                scheduleKeepalivePing();
+                operation.handOff();
+                });
+        }
+
+        void readNext() {
+            _websocket->async_read(_readBuffer, [this](beast::error_code ec, size_t bytesRead) {
+                onRead(ec, bytesRead);
+                });
+        }
+
+        void onRead(beast::error_code ec, size_t bytesRead) {
+            OperationScope operation(*this);
+            if (_shouldStopFlag.load()) {
+                if (_onDisconnectedCallback && !_callbacksDetached) {
+                    _onDisconnectedCallback("WebSocket disconnected.");
+                }
+                return;
+            }
+            if (ec) {
+                _shouldStopFlag.store(true);
+                markConnectionClosed();
+                closeSocket();
+                if (ec == beast::websocket::error::closed && _websocket->reason().code == beast::websocket::close_code::normal) {
+                    // the server ended the session, typically after a done request
+                    if (_onDisconnectedCallback && !_callbacksDetached) {
+                        _onDisconnectedCallback("WebSocket closed by the server.");
+                    }
+                    return;
+                }
+                std::string message = ec.message();
+                if (ec == beast::error::timeout) {
+                    // nothing, not even a pong, arrived within the idle timeout: the peer is gone
+                    metrics::MetricsRegistry::instance().recordWebsocketTimeout();
+                    message = "No data received from the server for " + std::to_string(_options.idle_timeout.count()) + " ms.";
+                }
+                if (_onErrorCallback && !_callbacksDetached) {
+                    _onErrorCallback(message);
+                }
+                return;
+            }
+            if (_options.record_io_cpu_time) {
+                metrics::MetricsRegistry::instance().recordWebsocketIoCpuTime(IoCpuAccounting::charge());
+            }
+            metrics::MetricsRegistry::instance().recordWebsocketReceived(bytesRead, wireBytesRead());
+            try {
+                // a flat_buffer holds the whole message contiguously, hand it out in place
+                auto frame = _readBuffer.cdata();
+                _dataReadCallback(std::string_view(static_cast<const char*>(frame.data()), frame.size()));
+            }
+            catch (std::exception& e) {
+                if (_onErrorCallback && !_callbacksDetached) {
+                    _onErrorCallback(e.what());
+                }
+                return;
+            }
+            if (_options.record_io_cpu_time) {
+                // the listener's share of the thread is not I/O
+                IoCpuAccounting::mark();
+            }
+            if (_callbacksDetached) {
+                // released by the callback, the remaining frames have no one to go to
+                return;
+            }
+            _readBuffer.consume(bytesRead);
+            readNext();
+            operation.handOff();
+        }
+
+        /**
+         * @brief TLS bytes read since the previous call, framing and compression included.
+         */
+        size_t wireBytesRead() {
+            uint64_t total = BIO_number_read(SSL_get_rbio(_websocket->next_layer().native_handle()));
+            uint64_t delta = total - _wireBytesRead;
+            _wireBytesRead = total;
+            return static_cast<size_t>(delta);
+        }
+
+        /**
+         * @brief TLS bytes written since the previous call.
+         */
+        size_t wireBytesWritten() {
+            uint64_t total = BIO_number_written(SSL_get_wbio(_websocket->next_layer().native_handle()));
+            uint64_t delta = total - _wireBytesWritten;
+            _wireBytesWritten = total;
+            return static_cast<size_t>(delta);
+        }
+
+        /**
+         * @brief Offers permessage-deflate in the upgrade request if enabled.
+         */
+        void applyCompressionOptions() {
+            const WebsocketCompressionOptions& compression = _options.compression;
+            if (!compression.enabled) {
+                return;
+            }
+            // zlib does not support 8-bit windows
+            auto windowBits = [](int bits) {
+                return std::clamp(bits, 9, 15);
+            };
+            beast::websocket::permessage_deflate deflate;
+            deflate.client_enable = true;
+            deflate.client_max_window_bits = windowBits(compression.client_max_window_bits);
+            deflate.server_max_window_bits = windowBits(compression.server_max_window_bits);
+            deflate.client_no_context_takeover = compression.client_no_context_takeover;
+            deflate.server_no_context_takeover = compression.server_no_context_takeover;
+            deflate.compLevel = std::clamp(compression.level, 0, 9);
+            deflate.memLevel = std::clamp(compression.mem_level, 1, 9);
+#if BOOST_VERSION >= 108100
+            deflate.msg_size_threshold = compression.threshold_bytes;
+#else
+            if (compression.threshold_bytes > 0) {
+                spdlog::warn("WebsocketClientImpl: The compression threshold requires Boost 1.81, every message is compressed.");
+            }
+#endif
+            _websocket->set_option(deflate);
+        }
+
+        /**
+         * @brief Counts an asynchronous chain (the reads, the writes, a posted shutdown) that refers to the client.
+         */
+        void beginOperation() {
+            std::lock_guard<std::mutex> lock(_operationsMutex);
+            ++_pendingOperations;
+        }
+
+        /**
+         * @brief Ends a chain. Must be the last access of the chain to the client, which may be destroyed right after.
+         */
+        void endOperation() {
+            bool destroy = false;
+            {
+                // notified under the lock so the waiter cannot destroy the condition variable in between
+                std::lock_guard<std::mutex> lock(_operationsMutex);
+                if (--_pendingOperations == 0) {
+                    _operationsDone.notify_all();
+                    destroy = _released;
+                }
+            }
+            if (destroy) {
+                // released from a callback, nothing else refers to the client any more
+                destroyOnEngine();
+            }
+        }
+
+        /**
+         * @brief Destroys a released client from a handler of its engine, outside of the chain that ended last.
+         */
+        void destroyOnEngine() {
+            net::post(_engine->_impl->context(), [this]() {
+                delete this;
+                });
+        }
+
+        /**
+         * @brief Waits for the chains still running on the engine, unless called from one of them.
+         */
+        void waitForOperations() {
+            {
+                std::lock_guard<std::mutex> lock(_operationsMutex);
+                if (_pendingOperations == 0) {
+                    return;
+                }
+            }
+            if (_strand && _strand->running_in_this_thread()) {
+                spdlog::warn("WebsocketClientImpl: Stopped from its own I/O callback, pending operations are not awaited.");
+                return;
+            }
+            std::unique_lock<std::mutex> lock(_operationsMutex);
+            _operationsDone.wait(lock, [this]() {
+                return _pendingOperations == 0;
+                });
+        }
+
+        /**
+         * @brief Shuts the TCP socket down, completing any pending read or write with an error, and stops the
+         * keepalive pings. Runs on the strand.
+         */
+        void closeSocket() {
+            if (_keepaliveTimer) {
+                _keepaliveTimer->cancel();
+            }
+            try {
+                beast::error_code ec;
+                beast::get_lowest_layer(*_websocket).shutdown(tcp::socket::shutdown_both, ec);
+                beast::get_lowest_layer(*_websocket).close(ec);
+            }
+            catch (const std::exception& ex) {
+                spdlog::error("closeSocket: Exception while closing underlying socket: {}", ex.what());
+            }
+        }
 
         ssl::stream<beast::tcp_stream> createSSLStream(bool verifyCertificates) const {
             beast::error_code ec;
@@ -649,17 +1130,45 @@ namespace cartesiapp {
                 spdlog::warn("WebSocket connection attempt aborted because it is stopped.");
                 return false;
             }
+            RequestTimings timings;
+            timings.endpoint = _endpoint;
+            timings.start = RequestTimings::Clock::now();
             try
             {
-                if (_websocket.is_open()) {
+                if (_websocket && _websocket->is_open()) {
                     spdlog::warn("WebSocket is already connected.");
                     return true;
                 }
-                auto const results = _resolver.resolve(cartesiapp::request::constants::HOST, "443");
-                net::connect(_websocket.next_layer().lowest_layer(), results.begin(), results.end());
+                if (!_engine) {
+                    _engine = std::make_shared<IoEngine>(1);
+                }
+                // a failed connection leaves a stream that is not reusable, each attempt starts from a fresh one
+                // once the operations of the previous one are done
+                waitForOperations();
+                _writeFailed = false;
+                // the handshake deadline of the previous attempt has completed
+                _handshakeExpired = false;
+                _readBuffer.clear();
+                _strand.emplace(net::make_strand(_engine->_impl->context()));
+                _websocket = std::make_unique<Websocket>(*_strand, _sslContext);
+                _keepaliveTimer.emplace(*_strand);
+                applyCompressionOptions();
+                _websocket->control_callback([this](beast::websocket::frame_type kind, beast::string_view payload) {
+                    if (kind == beast::websocket::frame_type::pong) {
+                        onPong(std::string_view(payload.data(), payload.size()));
+                    }
+                    });
+                if (_hasConnected) {
+                    metrics::MetricsRegistry::instance().recordReconnect();
+                }
+                auto const results = _resolver.resolve(_options.host, _options.port);
+                timings.dns_resolved = RequestTimings::Clock::now();
+                armHandshakeDeadline();
+                net::connect(_websocket->next_layer().lowest_layer(), results.begin(), results.end());
+                timings.tcp_connected = RequestTimings::Clock::now();
                 spdlog::info("Performing SSL handshake...");
 
-                _websocket.next_layer().set_verify_callback([verifyCertificates](bool preverified, ssl::verify_context& ctx) {
+                _websocket->next_layer().set_verify_callback([verifyCertificates](bool preverified, ssl::verify_context& ctx) {
                     // Log certificate info for debugging
                     X509_STORE_CTX* store_ctx = ctx.native_handle();
                     X509* cert = X509_STORE_CTX_get_current_cert(store_ctx);
@@ -677,12 +1186,12 @@ namespace cartesiapp {
                     return true;
                     });
                 // Set SNI hostname for websocket
-                if (!SSL_set_tlsext_host_name(_websocket.next_layer().native_handle(), cartesiapp::request::constants::HOST)) {
+                if (!SSL_set_tlsext_host_name(_websocket->next_layer().native_handle(), _options.host.c_str())) {
                     beast::error_code ec{ static_cast<int>(::ERR_get_error()), net::error::get_ssl_category() };
                     throw beast::system_error{ ec };
                 }
                 // Set WebSocket handshake headers including api key and version
-                _websocket.set_option(beast::websocket::stream_base::decorator(
+                _websocket->set_option(beast::websocket::stream_base::decorator(
                     [this, &headers](beast::websocket::request_type& req) {
                         req.set(http::field::user_agent, cartesiapp::request::constants::USER_AGENT);
                         req.set(cartesiapp::request::constants::HEADER_CARTESIA_VERSION, _apiVersion);
@@ -693,33 +1202,157 @@ namespace cartesiapp {
                     }));
 
                 spdlog::debug("Connecting to WebSocket endpoint: {}{}", _endpoint, queryParams);
-                _websocket.next_layer().set_verify_mode(ssl::verify_peer);
-                _websocket.next_layer().handshake(ssl::stream_base::handshake_type::client);
-                _websocket.handshake(cartesiapp::request::constants::HOST, _endpoint + queryParams);
+                _websocket->next_layer().set_verify_mode(ssl::verify_peer);
+                _websocket->next_layer().handshake(ssl::stream_base::handshake_type::client);
+                timings.tls_handshake_done = RequestTimings::Clock::now();
+                _websocket->handshake(_options.host, _endpoint + queryParams);
+                // the upgrade request and response are a single step, there is no separate send/first byte phase
+                timings.completed = RequestTimings::Clock::now();
+                if (disarmHandshakeDeadline()) {
+                    // the deadline shut the socket down right as the upgrade completed
+                    throw beast::system_error{ beast::error::timeout };
+                }
+                // applies to the asynchronous reads from now on. Beast only restarts the idle timer with its own
+                // pings: it pings once half the timeout passed without data and fails the read if the second half
+                // passes as well. Those pings carry no stamp, the round trip time comes from the keepalive pings.
+                beast::websocket::stream_base::timeout timeout;
+                timeout.handshake_timeout = beast::websocket::stream_base::none();
+                timeout.idle_timeout = _options.idle_timeout.count() > 0
+                    ? std::chrono::duration_cast<std::chrono::steady_clock::duration>(_options.idle_timeout)
+                    : beast::websocket::stream_base::none();
+                timeout.keep_alive_pings = true;
+                _websocket->set_option(timeout);
+                recordWireBytes(_websocket->next_layer().native_handle(), timings);
+                // the traffic counters start after the upgrade
+                _wireBytesRead = timings.bytes_received;
+                _wireBytesWritten = timings.bytes_sent;
                 spdlog::debug("WebSocket connected successfully: {}{}", _endpoint, queryParams);
             }
             catch (std::exception& e)
             {
-                spdlog::error("Error occurred: {}", e.what());
+                if (disarmHandshakeDeadline()) {
+                    metrics::MetricsRegistry::instance().recordWebsocketTimeout();
+                    spdlog::error("WebSocket handshake timed out after {} ms.", _options.handshake_timeout.count());
+                }
+                else {
+                    spdlog::error("Error occurred: {}", e.what());
+                }
+                reportTimings(timings);
                 return false;
             }
+            timings.succeeded = true;
+            reportTimings(timings);
+            _lastPingRttNs.store(0, std::memory_order_relaxed);
+            _hasConnected = true;
+            _connectionOpen.store(true);
+            metrics::MetricsRegistry::instance().connectionOpened();
             return true;
         }
+
+        /**
+         * @brief Shuts the socket down if the blocking connect, TLS handshake and upgrade outlast the handshake
+         * timeout, which fails them with an error. The timer runs on the engine.
+         */
+        void armHandshakeDeadline() {
+            std::lock_guard<std::mutex> lock(_handshakeMutex);
+            _handshakeFinished = false;
+            _handshakeExpired = false;
+            if (_options.handshake_timeout.count() <= 0) {
+                _handshakeTimer.reset();
+                return;
+            }
+            _handshakeTimer.emplace(_engine->_impl->context(), _options.handshake_timeout);
+            beginOperation();
+            _handshakeTimer->async_wait([this](beast::error_code ec) {
+                OperationScope operation(*this);
+                std::lock_guard<std::mutex> lock(_handshakeMutex);
+                if (!ec && !_handshakeFinished) {
+                    _handshakeExpired = true;
+                    // ::shutdown wakes a blocked connect or read, unlike closing the descriptor
+                    beast::error_code ignored;
+                    beast::get_lowest_layer(*_websocket).shutdown(tcp::socket::shutdown_both, ignored);
+                }
+                });
+        }
+
+        /**
+         * @brief Ends the handshake deadline of the attempt, if armed.
+         * @return true if the deadline expired and shut the socket down.
+         */
+        bool disarmHandshakeDeadline() {
+            std::lock_guard<std::mutex> lock(_handshakeMutex);
+            _handshakeFinished = true;
+            if (_handshakeTimer) {
+                _handshakeTimer->cancel();
+            }
+            return _handshakeExpired;
+        }
+
+        void reportTimings(const RequestTimings& timings) const {
+            // a failed upgrade surfaces as an exception without a usable status code
+            metrics::MetricsRegistry::instance().recordRequest(timings, 0);
+            if (_timingsCallback) {
+                _timingsCallback(timings);
+            }
+        }
+
+        /**
+         * @brief Releases the connection from the open connections gauge, exactly once per connection
+         * whether the reception thread or disconnectAndStop notices the close first.
+         */
+        void markConnectionClosed() {
+            if (_connectionOpen.exchange(false)) {
+                metrics::MetricsRegistry::instance().connectionClosed();
+            }
+        }
         private:
         std::string _apiKey;
         std::string _apiVersion;
         std::string _endpoint;
+        WebsocketOptions _options;
+        RequestTimingsCallback _timingsCallback;
         bool _verifyCertificates;
         bool _keepWebsocketRunning = false;
-        std::thread _workerThread;
+        std::function<void(std::string_view)> _dataReadCallback;
+        std::function<void(const std::string& message)> _onDisconnectedCallback;
+        std::function<void(const std::string& errorMessage)> _onErrorCallback;
+        std::map<std::string, std::string> _headers;
+        std::string _queryParams;
+        beast::flat_buffer _readBuffer;
+        MpscQueue<OutboundMessage> _outbound;
+        std::atomic<size_t> _pendingMessages{ 0 };
+        // owned by the strand
+        OutboundMessage _inFlight;
+        bool _writeFailed = false;
+        uint64_t _wireBytesRead = 0;
+        uint64_t _wireBytesWritten = 0;
         std::atomic_bool _shouldStopFlag = false;
         std::atomic_bool _isStoppedFlag = false;
+        std::atomic_bool _connectionOpen = false;
+        std::atomic_bool _pingInFlight = false;
+        // set on the strand by release(), no callback is invoked afterwards
+        bool _callbacksDetached = false;
+        // set by release(), guarded by the operations mutex; the end of the last operation destroys the client
+        bool _released = false;
+        std::atomic<uint64_t> _lastPingRttNs{ 0 };
+        std::mutex _handshakeMutex;
+        bool _handshakeFinished = false;
+        bool _handshakeExpired = false;
+        bool _hasConnected = false;
+        std::mutex _operationsMutex;
+        std::condition_variable _operationsDone;
+        size_t _pendingOperations = 0;
 
         // Boost.Asio components, mutable to allow modification in const methods that are exposed to users
         mutable ssl::context _sslContext;
         mutable net::io_context _ioContext;
         mutable tcp::resolver _resolver;
-        mutable Websocket _websocket;
+        // declared before the stream so that it outlives the stream's executor
+        std::shared_ptr<IoEngine> _engine;
+        std::optional<net::strand<net::io_context::executor_type>> _strand;
+        std::optional<net::steady_timer> _handshakeTimer;
+        std::optional<net::steady_timer> _keepaliveTimer;
+        std::unique_ptr<Websocket> _websocket;
     };
 }
 
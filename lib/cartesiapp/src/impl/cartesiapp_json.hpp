@@ -0,0 +1,140 @@
+#ifndef CARTESIAPP_JSON_HPP
+#define CARTESIAPP_JSON_HPP
+
+#include "cartesiapp_response.hpp"
+
+#include <optional>
+#include <string_view>
+
+#include <nlohmann/json.hpp>
+
+/**
+ * Decoding of responses from an already parsed JSON document, found by nlohmann::json through
+ * argument-dependent lookup so `json.get<T>()` builds a response without going back to text.
+ */
+namespace cartesiapp::response {
+    void from_json(const nlohmann::json& jsonObj, ApiInfo& response);
+    void from_json(const nlohmann::json& jsonObj, Voice& response);
+    void from_json(const nlohmann::json& jsonObj, VoiceListPage& response);
+
+    namespace stt {
+        void from_json(const nlohmann::json& jsonObj, WordTiming& response);
+        void from_json(const nlohmann::json& jsonObj, TranscriptionResponse& response);
+        void from_json(const nlohmann::json& jsonObj, FlushDoneResponse& response);
+        void from_json(const nlohmann::json& jsonObj, DoneResponse& response);
+        void from_json(const nlohmann::json& jsonObj, ErrorResponse& response);
+    }
+
+    namespace tts {
+        void from_json(const nlohmann::json& jsonObj, AudioChunkResponse& response);
+        void from_json(const nlohmann::json& jsonObj, FlushDoneResponse& response);
+        void from_json(const nlohmann::json& jsonObj, DoneResponse& response);
+        void from_json(const nlohmann::json& jsonObj, WordTimestampsResponse::WordTimestamps& response);
+        void from_json(const nlohmann::json& jsonObj, WordTimestampsResponse& response);
+        void from_json(const nlohmann::json& jsonObj, PhonemeTimestampsResponse::PhonemeTimestamps& response);
+        void from_json(const nlohmann::json& jsonObj, PhonemeTimestampsResponse& response);
+        void from_json(const nlohmann::json& jsonObj, ErrorResponse& response);
+    }
+}
+
+namespace cartesiapp {
+    /**
+     * @brief Finds where the value of a top-level field of a streaming frame starts, without parsing it.
+     *
+     * Strings are skipped as a whole and nested objects and arrays are tracked, so a key inside a nested
+     * value is never mistaken for the top-level one.
+     * @param quotedKey The key including its quotes, e.g. "\"type\"".
+     * @return The offset of the first character of the value, or npos if the frame has no such top-level field.
+     */
+    inline size_t findTopLevelValue(std::string_view frame, std::string_view quotedKey) {
+        int depth = 0;
+        size_t i = 0;
+        const size_t size = frame.size();
+        while (i < size) {
+            char c = frame[i];
+            if (c == '"') {
+                // a key at depth 1 can only be the wanted key if it matches literally
+                bool isWantedKey = depth == 1 && frame.compare(i, quotedKey.size(), quotedKey) == 0;
+                size_t end = i + 1;
+                while (end < size && frame[end] != '"') {
+                    end += frame[end] == '\\' ? 2 : 1;
+                }
+                if (end >= size) {
+                    return std::string_view::npos;
+                }
+                i = end + 1;
+                if (!isWantedKey) {
+                    continue;
+                }
+                while (i < size && (frame[i] == ' ' || frame[i] == '\t' || frame[i] == '\r' || frame[i] == '\n')) {
+                    ++i;
+                }
+                if (i >= size || frame[i] != ':') {
+                    // the match was a value, not a key
+                    continue;
+                }
+                ++i;
+                while (i < size && (frame[i] == ' ' || frame[i] == '\t' || frame[i] == '\r' || frame[i] == '\n')) {
+                    ++i;
+                }
+                return i < size ? i : std::string_view::npos;
+            }
+            if (c == '{' || c == '[') {
+                ++depth;
+            }
+            else if (c == '}' || c == ']') {
+                --depth;
+            }
+            ++i;
+        }
+        return std::string_view::npos;
+    }
+
+    /**
+     * @brief Extracts the value of a top-level string field of a streaming frame without parsing it.
+     *
+     * Escaped values are not unescaped.
+     * @param quotedKey The key including its quotes, e.g. "\"type\"".
+     * @return The value, or an empty view if the frame has no such top-level string field.
+     */
+    inline std::string_view peekStringField(std::string_view frame, std::string_view quotedKey) {
+        size_t i = findTopLevelValue(frame, quotedKey);
+        if (i == std::string_view::npos || frame[i] != '"') {
+            return {};
+        }
+        size_t valueEnd = frame.find('"', i + 1);
+        if (valueEnd == std::string_view::npos) {
+            return {};
+        }
+        return frame.substr(i + 1, valueEnd - i - 1);
+    }
+
+    /**
+     * @brief Extracts the value of a top-level boolean field of a streaming frame without parsing it.
+     * @param quotedKey The key including its quotes, e.g. "\"is_final\"".
+     * @return The value, or nothing if the frame has no such top-level boolean field.
+     */
+    inline std::optional<bool> peekBoolField(std::string_view frame, std::string_view quotedKey) {
+        size_t i = findTopLevelValue(frame, quotedKey);
+        if (i == std::string_view::npos) {
+            return std::nullopt;
+        }
+        if (frame.compare(i, 4, "true") == 0) {
+            return true;
+        }
+        if (frame.compare(i, 5, "false") == 0) {
+            return false;
+        }
+        return std::nullopt;
+    }
+
+    /**
+     * @brief Extracts the value of the top-level "type" field of a streaming frame without parsing it.
+     * @return The type, or an empty view if the frame has no top-level string "type" field.
+     */
+    inline std::string_view peekEventType(std::string_view frame) {
+        return peekStringField(frame, "\"type\"");
+    }
+}
+
+#endif // CARTESIAPP_JSON_HPP
@@ -0,0 +1,170 @@
+#ifndef CARTESIAPP_EVENT_QUEUE_LISTENERS_HPP
+#define CARTESIAPP_EVENT_QUEUE_LISTENERS_HPP
+
+#include "event_queue.hpp"
+
+#include <memory>
+#include <mutex>
+#include <string>
+
+namespace cartesiapp {
+    /**
+     * @brief Listener copying the events of a TTS client into the ring of a TTSEventQueue.
+     *
+     * The client invokes its listener from one thread at a time (its I/O strand, or the dispatcher), so the
+     * listener is the single producer of the ring.
+     */
+    class TTSEventQueueListener : public TTSResponseListener {
+        public:
+        explicit TTSEventQueueListener(std::shared_ptr<EventRing<TTSEvent>> events) : _events(std::move(events)) {
+        }
+
+        void onConnected() override {
+            pushReserved(connection_events::Connected{});
+        }
+
+        void onDisconnected(const std::string& reason) override {
+            pushReserved(connection_events::Disconnected{ reason });
+        }
+
+        void onNetworkError(const std::string& errorMessage) override {
+            pushReserved(connection_events::NetworkError{ errorMessage });
+        }
+
+        void onAudioChunkReceived(const response::tts::AudioChunkResponse& response) override {
+            push(response);
+        }
+
+        void onAudioChunkView(const response::tts::AudioChunkView& chunk) override {
+            _events->tryPush([&chunk](TTSEvent& slot) {
+                // decode straight into the audio buffer the slot kept from its previous chunk
+                auto* audio = std::get_if<response::tts::AudioChunkResponse>(&slot);
+                if (!audio) {
+                    audio = &slot.emplace<response::tts::AudioChunkResponse>();
+                }
+                audio->type = "chunk";
+                audio->data.assign(reinterpret_cast<const char*>(chunk.data), chunk.size);
+                audio->done = chunk.done;
+                audio->status_code = chunk.status_code;
+                audio->step_time = chunk.step_time;
+                if (chunk.context_id.empty()) {
+                    audio->context_id.reset();
+                }
+                else if (audio->context_id) {
+                    audio->context_id->assign(chunk.context_id);
+                }
+                else {
+                    audio->context_id.emplace(chunk.context_id);
+                }
+                });
+        }
+
+        void onDoneReceived(const response::tts::DoneResponse& response) override {
+            pushReserved(response);
+        }
+
+        void onWordTimestampsReceived(const response::tts::WordTimestampsResponse& response) override {
+            push(response);
+        }
+
+        void onPhonemeTimestampsReceived(const response::tts::PhonemeTimestampsResponse& response) override {
+            push(response);
+        }
+
+        void onFlushDoneReceived(const response::tts::FlushDoneResponse& response) override {
+            pushReserved(response);
+        }
+
+        void onError(const response::tts::ErrorResponse& response) override {
+            pushReserved(response);
+        }
+
+        private:
+        /**
+         * @brief Copies the event into its slot. Arena-backed vectors are copied to the slot's default resource.
+         */
+        template <typename T>
+        void push(const T& event, bool reserved = false) {
+            _events->tryPush([&event](TTSEvent& slot) {
+                slot = event;
+                }, reserved);
+        }
+
+        /**
+         * @brief Copies an event that must not be lost into its slot, which may be one of the reserved slots.
+         */
+        template <typename T>
+        void pushReserved(const T& event) {
+            push(event, true);
+        }
+
+        std::shared_ptr<EventRing<TTSEvent>> _events;
+    };
+
+    /**
+     * @brief Listener copying the events of an STT client into the ring of an STTEventQueue.
+     *
+     * Without a dispatch stage the reconnection events come from the recovery thread while transcripts come from
+     * the I/O thread, so pushes are serialized by a lock, uncontended outside of reconnects.
+     */
+    class STTEventQueueListener : public STTResponseListener {
+        public:
+        explicit STTEventQueueListener(std::shared_ptr<EventRing<STTEvent>> events) : _events(std::move(events)) {
+        }
+
+        void onConnected() override {
+            pushReserved(connection_events::Connected{});
+        }
+
+        void onDisconnected(const std::string& reason) override {
+            pushReserved(connection_events::Disconnected{ reason });
+        }
+
+        void onNetworkError(const std::string& errorMessage) override {
+            pushReserved(connection_events::NetworkError{ errorMessage });
+        }
+
+        void onTranscriptionReceived(const response::stt::TranscriptionResponse& response) override {
+            push(response);
+        }
+
+        void onDoneReceived(const response::stt::DoneResponse& response) override {
+            pushReserved(response);
+        }
+
+        void onFlushDoneReceived(const response::stt::FlushDoneResponse& response) override {
+            pushReserved(response);
+        }
+
+        void onError(const response::stt::ErrorResponse& response) override {
+            pushReserved(response);
+        }
+
+        void onReconnecting(const std::string& reason) override {
+            pushReserved(connection_events::Reconnecting{ reason });
+        }
+
+        void onReconnected() override {
+            pushReserved(connection_events::Reconnected{});
+        }
+
+        private:
+        template <typename T>
+        void push(const T& event, bool reserved = false) {
+            std::lock_guard<std::mutex> lock(_producerMutex);
+            _events->tryPush([&event](STTEvent& slot) {
+                slot = event;
+                }, reserved);
+        }
+
+        template <typename T>
+        void pushReserved(const T& event) {
+            push(event, true);
+        }
+
+        std::shared_ptr<EventRing<STTEvent>> _events;
+        std::mutex _producerMutex;
+    };
+}
+
+#endif // CARTESIAPP_EVENT_QUEUE_LISTENERS_HPP
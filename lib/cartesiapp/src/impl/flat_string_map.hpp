@@ -0,0 +1,148 @@
+#ifndef CARTESIAPP_FLAT_STRING_MAP_HPP
+#define CARTESIAPP_FLAT_STRING_MAP_HPP
+
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace cartesiapp {
+    /**
+     * @brief Open-addressing hash map from strings to values, looked up by string_view without building a key.
+     *
+     * Entries live in one contiguous slot array probed linearly, with the full hash stored next to the key so
+     * mismatching slots are skipped without a string compare. Erase shifts the following entries of the probe
+     * run back instead of leaving tombstones, so lookups never degrade after many insert/erase cycles.
+     * Not thread-safe; pointers returned by find() are invalidated by insert() and erase().
+     */
+    template <typename Value>
+    class FlatStringMap {
+        public:
+        Value* find(std::string_view key) {
+            if (_size == 0) {
+                return nullptr;
+            }
+            size_t hash = hashOf(key);
+            for (size_t i = hash & mask();; i = (i + 1) & mask()) {
+                Slot& slot = _slots[i];
+                if (!slot.used) {
+                    return nullptr;
+                }
+                if (slot.hash == hash && slot.key == key) {
+                    return &slot.value;
+                }
+            }
+        }
+
+        /**
+         * @brief Inserts the value, or replaces the value of an existing key.
+         */
+        Value& insert(std::string key, Value value) {
+            if ((_size + 1) * 2 > _slots.size()) {
+                grow();
+            }
+            size_t hash = hashOf(key);
+            size_t i = hash & mask();
+            while (_slots[i].used) {
+                if (_slots[i].hash == hash && _slots[i].key == key) {
+                    _slots[i].value = std::move(value);
+                    return _slots[i].value;
+                }
+                i = (i + 1) & mask();
+            }
+            _slots[i] = Slot{ std::move(key), std::move(value), hash, true };
+            ++_size;
+            return _slots[i].value;
+        }
+
+        bool erase(std::string_view key) {
+            if (_size == 0) {
+                return false;
+            }
+            size_t hash = hashOf(key);
+            size_t i = hash & mask();
+            while (!(_slots[i].hash == hash && _slots[i].used && _slots[i].key == key)) {
+                if (!_slots[i].used) {
+                    return false;
+                }
+                i = (i + 1) & mask();
+            }
+            // backward shift: move every following entry that may sit in the hole, until the run ends
+            for (size_t next = (i + 1) & mask(); _slots[next].used; next = (next + 1) & mask()) {
+                size_t home = _slots[next].hash & mask();
+                bool reachable = i <= next ? (home <= i || home > next) : (home <= i && home > next);
+                if (reachable) {
+                    _slots[i] = std::move(_slots[next]);
+                    i = next;
+                }
+            }
+            _slots[i] = Slot{};
+            --_size;
+            return true;
+        }
+
+        size_t size() const {
+            return _size;
+        }
+
+        bool empty() const {
+            return _size == 0;
+        }
+
+        void clear() {
+            _slots.clear();
+            _size = 0;
+        }
+
+        /**
+         * @brief Calls function(key, value) for every entry, in no particular order.
+         */
+        template <typename Function>
+        void forEach(Function&& function) {
+            for (Slot& slot : _slots) {
+                if (slot.used) {
+                    function(std::string_view(slot.key), slot.value);
+                }
+            }
+        }
+
+        private:
+        struct Slot {
+            std::string key;
+            Value value{};
+            size_t hash = 0;
+            bool used = false;
+        };
+
+        static constexpr size_t INITIAL_CAPACITY = 16;
+
+        static size_t hashOf(std::string_view key) {
+            return std::hash<std::string_view>{}(key);
+        }
+
+        size_t mask() const {
+            return _slots.size() - 1;
+        }
+
+        void grow() {
+            std::vector<Slot> previous = std::move(_slots);
+            _slots = std::vector<Slot>(previous.empty() ? INITIAL_CAPACITY : previous.size() * 2);
+            for (Slot& slot : previous) {
+                if (slot.used) {
+                    size_t i = slot.hash & mask();
+                    while (_slots[i].used) {
+                        i = (i + 1) & mask();
+                    }
+                    _slots[i] = std::move(slot);
+                }
+            }
+        }
+
+        std::vector<Slot> _slots;
+        size_t _size = 0;
+    };
+}
+
+#endif // CARTESIAPP_FLAT_STRING_MAP_HPP
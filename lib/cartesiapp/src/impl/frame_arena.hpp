@@ -0,0 +1,67 @@
+#ifndef CARTESIAPP_FRAME_ARENA_HPP
+#define CARTESIAPP_FRAME_ARENA_HPP
+
+#include <cstddef>
+#include <memory_resource>
+
+namespace cartesiapp {
+    /**
+     * @brief Per-connection arena the responses decoded from a single frame are allocated from.
+     *
+     * A monotonic resource over an initial block taken once from the upstream resource: allocations
+     * while decoding a frame are pointer bumps, and reset() hands everything back at once without
+     * touching the upstream resource. Frames outgrowing the initial block take extra blocks from
+     * upstream, which are returned on the next reset().
+     *
+     * Only used from the connection's reception thread.
+     */
+    class FrameArena {
+        public:
+        static constexpr size_t DEFAULT_INITIAL_SIZE = 64 * 1024;
+
+        explicit FrameArena(std::pmr::memory_resource* upstream, size_t initialSize = DEFAULT_INITIAL_SIZE) :
+            _initialBlock(initialSize, upstream),
+            _resource(_initialBlock.data(), _initialBlock.size(), upstream) {
+        }
+
+        FrameArena(const FrameArena&) = delete;
+        FrameArena& operator=(const FrameArena&) = delete;
+
+        std::pmr::memory_resource* resource() {
+            return &_resource;
+        }
+
+        /**
+         * @brief Releases every allocation made since the last reset. Nothing allocated from the arena may outlive it.
+         */
+        void reset() {
+            _resource.release();
+        }
+
+        /**
+         * @brief Resets the arena when leaving the scope; declare it before the objects allocated from the arena
+         * so they are destroyed first.
+         */
+        class ResetGuard {
+            public:
+            explicit ResetGuard(FrameArena& arena) : _arena(arena) {
+            }
+
+            ~ResetGuard() {
+                _arena.reset();
+            }
+
+            ResetGuard(const ResetGuard&) = delete;
+            ResetGuard& operator=(const ResetGuard&) = delete;
+
+            private:
+            FrameArena& _arena;
+        };
+
+        private:
+        std::pmr::vector<std::byte> _initialBlock;
+        std::pmr::monotonic_buffer_resource _resource;
+    };
+}
+
+#endif // CARTESIAPP_FRAME_ARENA_HPP
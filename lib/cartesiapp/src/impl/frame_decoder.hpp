@@ -0,0 +1,68 @@
+#ifndef CARTESIAPP_FRAME_DECODER_HPP
+#define CARTESIAPP_FRAME_DECODER_HPP
+
+#include "cartesiapp_response.hpp"
+
+#include <memory>
+#include <string>
+#include <string_view>
+
+namespace cartesiapp {
+    /**
+     * @brief Decoder for the highest-rate streaming frames, TTS "chunk" and STT "transcript".
+     *
+     * When the library is built with CARTESIAPP_USE_SIMDJSON the frames are decoded with simdjson's
+     * on-demand API in a single pass over the fields, straight into the response structs; any frame it
+     * cannot decode (malformed or missing fields) falls back to the nlohmann path so errors are reported
+     * the same way in both builds. Otherwise the nlohmann path is used directly.
+     *
+     * An instance keeps its parser, scratch and audio buffers across frames and must only be used by one
+     * thread at a time, typically one per connection.
+     */
+    class FrameDecoder {
+        public:
+        FrameDecoder();
+        ~FrameDecoder();
+
+        FrameDecoder(const FrameDecoder&) = delete;
+        FrameDecoder& operator=(const FrameDecoder&) = delete;
+
+        /**
+         * @brief Decodes a TTS "chunk" frame, including the base64 audio payload.
+         * @throws nlohmann::json::exception if the frame is malformed.
+         */
+        response::tts::AudioChunkResponse decodeAudioChunk(std::string_view frame);
+
+        /**
+         * @brief Decodes a TTS "chunk" frame into a view over the decoder's reusable audio buffer.
+         *
+         * With the simdjson backend no memory is allocated once the buffers have grown to the chunk size.
+         * The view, including its context ID, is only valid until the next call on this decoder.
+         * @throws nlohmann::json::exception if the frame is malformed.
+         */
+        response::tts::AudioChunkView decodeAudioChunkView(std::string_view frame);
+
+        /**
+         * @brief Decodes an STT "transcript" frame.
+         * @throws nlohmann::json::exception if the frame is malformed.
+         */
+        response::stt::TranscriptionResponse decodeTranscription(std::string_view frame);
+
+        /**
+         * @brief Decodes an STT "transcript" frame into an existing response, whose word list keeps its memory resource.
+         * @throws nlohmann::json::exception if the frame is malformed.
+         */
+        void decodeTranscription(std::string_view frame, response::stt::TranscriptionResponse& transcription);
+
+        /**
+         * @brief True if the library was built with the simdjson backend.
+         */
+        static bool usesSimdjson();
+
+        private:
+        struct State;
+        std::unique_ptr<State> _state;
+    };
+}
+
+#endif // CARTESIAPP_FRAME_DECODER_HPP
@@ -0,0 +1,52 @@
+#ifndef CARTESIAPP_IO_ENGINE_IMPL_HPP
+#define CARTESIAPP_IO_ENGINE_IMPL_HPP
+
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include <boost/asio/executor_work_guard.hpp>
+#include <boost/asio/io_context.hpp>
+
+namespace cartesiapp {
+    /**
+     * @brief The io_context shared by the connections of an IoEngine and the threads running it.
+     *
+     * Each thread holds a reference to the engine until its run() returns, so the context outlives the handlers
+     * even when the engine is released from one of them.
+     */
+    class IoEngineImpl : public std::enable_shared_from_this<IoEngineImpl> {
+        public:
+        explicit IoEngineImpl(size_t threadCount);
+
+        /**
+         * @brief Starts the threads. Called once, right after construction.
+         */
+        void start();
+
+        /**
+         * @brief Stops the threads and joins them. From one of the threads, which cannot join itself nor wait for
+         * the handlers running next to it, they are detached instead and the last one to exit releases the engine.
+         */
+        void stop();
+
+        boost::asio::io_context& context() {
+            return _ioContext;
+        }
+
+        size_t threadCount() const {
+            return _threadCount;
+        }
+
+        private:
+        void run();
+
+        const size_t _threadCount;
+        boost::asio::io_context _ioContext;
+        // keeps run() from returning while no connection has pending operations
+        boost::asio::executor_work_guard<boost::asio::io_context::executor_type> _workGuard;
+        std::vector<std::thread> _threads;
+    };
+}
+
+#endif // CARTESIAPP_IO_ENGINE_IMPL_HPP
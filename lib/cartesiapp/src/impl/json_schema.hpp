@@ -0,0 +1,253 @@
+#ifndef CARTESIAPP_JSON_SCHEMA_HPP
+#define CARTESIAPP_JSON_SCHEMA_HPP
+
+#include "json_writer.hpp"
+
+#include <cstdint>
+#include <memory_resource>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <nlohmann/json.hpp>
+
+/**
+ * Compile-time field descriptors the request encoders and response decoders are generated from.
+ *
+ * A struct opts in by specializing Schema with a constexpr tuple of field() entries. Decoding walks the
+ * JSON object once and dispatches every key to its member by comparing a hash computed once per key
+ * against the hashes of the field names, which are computed at compile time; required fields that were
+ * not seen are then reported with the same exception as nlohmann's at(), and array fields that were not seen
+ * are left empty. Encoding writes the fields in declaration order, skipping empty optionals.
+ */
+namespace cartesiapp::schema {
+    /**
+     * @brief 64-bit FNV-1a hash of a JSON key.
+     */
+    constexpr uint64_t hashKey(std::string_view key) noexcept {
+        uint64_t hash = 0xcbf29ce484222325ULL;
+        for (char c : key) {
+            hash ^= static_cast<uint8_t>(c);
+            hash *= 0x100000001b3ULL;
+        }
+        return hash;
+    }
+
+    /**
+     * @brief Describes one JSON field mapped to a struct member.
+     */
+    template <typename Struct, typename Member>
+    struct Field {
+        /**
+         * @brief Custom decoding for members whose JSON representation differs from the member type.
+         */
+        using Reader = void (*)(const nlohmann::json& json, Member& target);
+
+        std::string_view name;
+        uint64_t hash;
+        Member Struct::* member;
+        Reader reader;
+        // missing and null decode to an empty value instead of failing
+        bool emptyIfAbsent;
+    };
+
+    /**
+     * @brief Declares a field. std::optional members are optional in JSON, all others are required.
+     * @param reader Custom decoder, or nullptr to decode the member with nlohmann::json.
+     */
+    template <typename Struct, typename Member>
+    constexpr Field<Struct, Member> field(std::string_view name, Member Struct::* member,
+        typename Field<Struct, Member>::Reader reader = nullptr) {
+        return { name, hashKey(name), member, reader, false };
+    }
+
+    /**
+     * @brief Declares an array field that decodes to an empty container when it is missing or null, as servers
+     * leave out empty lists.
+     */
+    template <typename Struct, typename Member>
+    constexpr Field<Struct, Member> arrayField(std::string_view name, Member Struct::* member) {
+        return { name, hashKey(name), member, nullptr, true };
+    }
+
+    /**
+     * @brief Field table of a struct, specialized as `static constexpr auto fields = std::make_tuple(field(...), ...);`.
+     */
+    template <typename T>
+    struct Schema {
+    };
+
+    namespace detail {
+        template <typename T>
+        struct IsOptional : std::false_type {
+        };
+
+        template <typename T>
+        struct IsOptional<std::optional<T>> : std::true_type {
+        };
+
+        template <typename T, typename = void>
+        struct HasSchema : std::false_type {
+        };
+
+        template <typename T>
+        struct HasSchema<T, std::void_t<decltype(Schema<T>::fields)>> : std::true_type {
+        };
+
+        template <typename T>
+        constexpr size_t fieldCount() {
+            return std::tuple_size_v<std::decay_t<decltype(Schema<T>::fields)>>;
+        }
+
+        template <typename T>
+        void readValue(const nlohmann::json& json, T& target) {
+            json.get_to(target);
+        }
+
+        template <typename T>
+        void clearValue(T& target) {
+            target = T();
+        }
+
+        template <typename T>
+        void clearValue(std::pmr::vector<T>& target) {
+            // cleared in place so the vector keeps its memory resource
+            target.clear();
+        }
+
+        template <typename T>
+        void readValue(const nlohmann::json& json, std::optional<T>& target) {
+            if (json.is_null()) {
+                target.reset();
+                return;
+            }
+            readValue(json, target.emplace());
+        }
+
+        template <typename T>
+        void readValue(const nlohmann::json& json, std::pmr::vector<T>& target) {
+            // filled in place so the vector keeps the memory resource it was constructed with
+            const auto& items = json.get_ref<const nlohmann::json::array_t&>();
+            target.clear();
+            target.reserve(items.size());
+            for (const auto& item : items) {
+                if constexpr (std::is_constructible_v<T, std::pmr::memory_resource*>) {
+                    // elements with containers of their own allocate from the same resource
+                    target.emplace_back(target.get_allocator().resource());
+                    readValue(item, target.back());
+                }
+                else {
+                    target.push_back(item.get<T>());
+                }
+            }
+        }
+
+        template <size_t Index, typename Struct, typename Member>
+        bool dispatchField(const Field<Struct, Member>& descriptor, uint64_t hash, const std::string& key,
+            const nlohmann::json& value, Struct& target, uint64_t& seen) {
+            if (descriptor.hash != hash || descriptor.name != key) {
+                return false;
+            }
+            if (descriptor.emptyIfAbsent && value.is_null()) {
+                clearValue(target.*descriptor.member);
+            }
+            else if (descriptor.reader) {
+                descriptor.reader(value, target.*descriptor.member);
+            }
+            else {
+                readValue(value, target.*descriptor.member);
+            }
+            seen |= uint64_t(1) << Index;
+            return true;
+        }
+
+        template <size_t Index, typename Struct, typename Member>
+        void finishField(const Field<Struct, Member>& descriptor, const nlohmann::json& jsonObj, Struct& target, uint64_t seen) {
+            if (seen & (uint64_t(1) << Index)) {
+                return;
+            }
+            if constexpr (IsOptional<Member>::value) {
+                (target.*descriptor.member).reset();
+            }
+            else if (descriptor.emptyIfAbsent) {
+                clearValue(target.*descriptor.member);
+            }
+            else {
+                // throws the out_of_range error a direct lookup of the missing key would have
+                static_cast<void>(jsonObj.at(std::string(descriptor.name)));
+            }
+        }
+
+        template <typename T, size_t... Indices>
+        void decodeFields(const nlohmann::json& jsonObj, T& target, std::index_sequence<Indices...>) {
+            constexpr const auto& fields = Schema<T>::fields;
+            uint64_t seen = 0;
+            for (const auto& [key, value] : jsonObj.get_ref<const nlohmann::json::object_t&>()) {
+                const uint64_t hash = hashKey(key);
+                // short-circuits on the first matching field, unknown keys match none
+                static_cast<void>((dispatchField<Indices>(std::get<Indices>(fields), hash, key, value, target, seen) || ...));
+            }
+            (finishField<Indices>(std::get<Indices>(fields), jsonObj, target, seen), ...);
+        }
+
+        template <typename Member>
+        void writeValue(JsonWriter& writer, std::string_view name, const Member& value);
+
+        template <typename Struct, typename Member>
+        void encodeField(JsonWriter& writer, const Field<Struct, Member>& descriptor, const Struct& source) {
+            writeValue(writer, descriptor.name, source.*descriptor.member);
+        }
+    }
+
+    /**
+     * @brief Decodes a JSON object into a struct described by a Schema, in a single pass over its keys.
+     * @throws nlohmann::json::exception if the value is not an object, a required field is missing or a field has the wrong type.
+     */
+    template <typename T>
+    void decodeObject(const nlohmann::json& jsonObj, T& target) {
+        constexpr size_t FIELD_COUNT = detail::fieldCount<T>();
+        static_assert(FIELD_COUNT <= 64, "the seen-field mask holds at most 64 fields");
+        detail::decodeFields(jsonObj, target, std::make_index_sequence<FIELD_COUNT>{});
+    }
+
+    /**
+     * @brief Writes the given fields of a struct, without the surrounding braces.
+     */
+    template <typename Struct, typename Fields>
+    void encodeFields(JsonWriter& writer, const Fields& fields, const Struct& source) {
+        std::apply([&writer, &source](const auto&... descriptors) {
+            (detail::encodeField(writer, descriptors, source), ...);
+            }, fields);
+    }
+
+    /**
+     * @brief Writes a struct described by a Schema as a JSON object.
+     */
+    template <typename T>
+    void encodeObject(JsonWriter& writer, const T& source) {
+        writer.beginObject();
+        encodeFields(writer, Schema<T>::fields, source);
+        writer.endObject();
+    }
+
+    template <typename Member>
+    void detail::writeValue(JsonWriter& writer, std::string_view name, const Member& value) {
+        if constexpr (IsOptional<Member>::value) {
+            if (value) {
+                writeValue(writer, name, *value);
+            }
+        }
+        else if constexpr (HasSchema<Member>::value) {
+            encodeObject(writer.key(name), value);
+        }
+        else {
+            writer.field(name, value);
+        }
+    }
+}
+
+#endif // CARTESIAPP_JSON_SCHEMA_HPP
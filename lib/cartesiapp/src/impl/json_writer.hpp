@@ -0,0 +1,175 @@
+#ifndef CARTESIAPP_JSON_WRITER_HPP
+#define CARTESIAPP_JSON_WRITER_HPP
+
+#include <charconv>
+#include <cmath>
+#include <cstdio>
+#include <optional>
+#include <string>
+#include <string_view>
+
+namespace cartesiapp {
+    /**
+     * @brief Minimal streaming JSON writer appending straight into a caller-owned buffer.
+     *
+     * Keys and values are written in call order with no intermediate DOM, so reusing the same buffer
+     * across messages makes serialization allocation-free once the buffer has grown to its working size.
+     * The writer does not validate nesting, callers are expected to pair beginObject() and endObject().
+     */
+    class JsonWriter {
+        public:
+        explicit JsonWriter(std::string& out) : _out(out) {
+        }
+
+        JsonWriter& beginObject() {
+            separate();
+            _out += '{';
+            _first = true;
+            return *this;
+        }
+
+        JsonWriter& endObject() {
+            _out += '}';
+            _first = false;
+            return *this;
+        }
+
+        JsonWriter& key(std::string_view name) {
+            separate();
+            writeString(name);
+            _out += ':';
+            _afterKey = true;
+            return *this;
+        }
+
+        JsonWriter& value(std::string_view text) {
+            separate();
+            writeString(text);
+            return *this;
+        }
+
+        JsonWriter& value(const char* text) {
+            return value(std::string_view(text));
+        }
+
+        JsonWriter& value(const std::string& text) {
+            return value(std::string_view(text));
+        }
+
+        JsonWriter& value(bool flag) {
+            separate();
+            _out += flag ? "true" : "false";
+            return *this;
+        }
+
+        JsonWriter& value(int number) {
+            separate();
+            char buffer[16];
+            auto result = std::to_chars(buffer, buffer + sizeof(buffer), number);
+            _out.append(buffer, result.ptr);
+            return *this;
+        }
+
+        JsonWriter& value(float number) {
+            return writeFloatingPoint(number, "%.9g");
+        }
+
+        JsonWriter& value(double number) {
+            return writeFloatingPoint(number, "%.17g");
+        }
+
+        /**
+         * @brief Appends an already serialized JSON value verbatim.
+         */
+        JsonWriter& raw(std::string_view json) {
+            separate();
+            _out += json;
+            return *this;
+        }
+
+        template <typename T>
+        JsonWriter& field(std::string_view name, const T& fieldValue) {
+            key(name);
+            return value(fieldValue);
+        }
+
+        /**
+         * @brief Writes the field only if the optional holds a value, matching how the DOM-based serializers skipped unset fields.
+         */
+        template <typename T>
+        JsonWriter& optionalField(std::string_view name, const std::optional<T>& fieldValue) {
+            if (fieldValue) {
+                field(name, *fieldValue);
+            }
+            return *this;
+        }
+
+        private:
+        void separate() {
+            if (_afterKey) {
+                _afterKey = false;
+                return;
+            }
+            if (!_first) {
+                _out += ',';
+            }
+            _first = false;
+        }
+
+        JsonWriter& writeFloatingPoint(double number, const char* format) {
+            separate();
+            if (!std::isfinite(number)) {
+                // JSON has no representation for NaN and infinity
+                _out += "null";
+                return *this;
+            }
+            char buffer[32];
+            int length = std::snprintf(buffer, sizeof(buffer), format, number);
+            for (int i = 0; i < length; ++i) {
+                // snprintf honours LC_NUMERIC, JSON always uses a dot
+                if (buffer[i] == ',') {
+                    buffer[i] = '.';
+                }
+            }
+            _out.append(buffer, static_cast<size_t>(length));
+            return *this;
+        }
+
+        void writeString(std::string_view text) {
+            static constexpr char HEX_DIGITS[] = "0123456789abcdef";
+            _out += '"';
+            size_t runStart = 0;
+            for (size_t i = 0; i < text.size(); ++i) {
+                unsigned char c = static_cast<unsigned char>(text[i]);
+                if (c >= 0x20 && c != '"' && c != '\\') {
+                    continue;
+                }
+                // flush the run of characters that need no escaping, then the escape sequence
+                _out.append(text.data() + runStart, i - runStart);
+                runStart = i + 1;
+                switch (c) {
+                    case '"': _out += "\\\""; break;
+                    case '\\': _out += "\\\\"; break;
+                    case '\b': _out += "\\b"; break;
+                    case '\f': _out += "\\f"; break;
+                    case '\n': _out += "\\n"; break;
+                    case '\r': _out += "\\r"; break;
+                    case '\t': _out += "\\t"; break;
+                    default:
+                        _out += "\\u00";
+                        _out += HEX_DIGITS[c >> 4];
+                        _out += HEX_DIGITS[c & 0x0F];
+                        break;
+                }
+            }
+            _out.append(text.data() + runStart, text.size() - runStart);
+            _out += '"';
+        }
+
+        std::string& _out;
+        bool _first = true;
+        bool _afterKey = false;
+    };
+}
+
+#endif // CARTESIAPP_JSON_WRITER_HPP
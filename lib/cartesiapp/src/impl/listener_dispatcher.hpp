@@ -0,0 +1,386 @@
+#ifndef CARTESIAPP_LISTENER_DISPATCHER_HPP
+#define CARTESIAPP_LISTENER_DISPATCHER_HPP
+
+#include "listener_dispatch.hpp"
+#include "cartesiapp_metrics.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include <spdlog/spdlog.h>
+
+namespace cartesiapp {
+    /**
+     * @brief Bounded queue between the socket reader of one connection and the code delivering its frames to
+     * the listener, drained by a dedicated thread or by tasks posted to an executor.
+     *
+     * The reader is the only producer and at most one drain runs at a time, so the lock is only ever held to
+     * move an entry in or out. Frame buffers are recycled between the two sides, so once the queue has warmed
+     * up a frame costs a copy into an existing buffer.
+     */
+    class ListenerDispatcher {
+        public:
+        using Clock = std::chrono::steady_clock;
+        using FrameHandler = std::function<void(std::string_view frame)>;
+        /**
+         * @brief Delivers frames merged by COALESCE_AUDIO as one event, in arrival order.
+         */
+        using BatchHandler = std::function<void(const std::vector<std::string>& frames)>;
+        /**
+         * @brief Returns the key frames are merged by (the context of a TTS chunk), or nothing if the frame
+         * cannot be merged.
+         */
+        using CoalesceKey = std::function<std::optional<std::string_view>(std::string_view frame)>;
+        /**
+         * @brief Tells if DROP_OLDEST may discard a frame (an audio chunk, an interim transcript). Terminal and
+         * control frames must never be dropped.
+         */
+        using Droppable = std::function<bool(std::string_view frame)>;
+        using ErrorHandler = std::function<void(const std::string& message)>;
+
+        ListenerDispatcher(const ListenerDispatchOptions& options,
+            FrameHandler frameHandler,
+            BatchHandler batchHandler,
+            CoalesceKey coalesceKey,
+            Droppable droppable,
+            ErrorHandler errorHandler) :
+            _capacity(std::max<size_t>(options.queue_capacity, 1)),
+            _policy(options.overflow_policy),
+            _executor(options.executor),
+            _frameHandler(std::move(frameHandler)),
+            _batchHandler(std::move(batchHandler)),
+            _coalesceKey(std::move(coalesceKey)),
+            _droppable(std::move(droppable)),
+            _errorHandler(std::move(errorHandler)) {
+            if (!_batchHandler || !_coalesceKey) {
+                // nothing to merge, keep every frame
+                _policy = _policy == DispatchOverflowPolicy::COALESCE_AUDIO ? DispatchOverflowPolicy::BLOCK : _policy;
+            }
+            if (!_droppable) {
+                // nothing can be dropped safely
+                _policy = _policy == DispatchOverflowPolicy::DROP_OLDEST ? DispatchOverflowPolicy::BLOCK : _policy;
+            }
+            if (!_executor) {
+                _thread = std::thread([this]() {
+                    runThread();
+                    });
+            }
+        }
+
+        ~ListenerDispatcher() {
+            stop();
+            std::lock_guard<std::mutex> lock(_mutex);
+            // frames queued after the final drain are never delivered
+            metrics::MetricsRegistry::instance().listenerFramesDiscarded(_queuedFrames);
+        }
+
+        ListenerDispatcher(const ListenerDispatcher&) = delete;
+        ListenerDispatcher& operator=(const ListenerDispatcher&) = delete;
+
+        /**
+         * @brief Stops and destroys a dispatcher. From the dispatcher itself, e.g. a listener destroying its client,
+         * the entries still queued are discarded and the dispatcher is destroyed by its drain once the delivery in
+         * progress has returned, as their handlers belong to the client going away.
+         */
+        static void destroy(std::unique_ptr<ListenerDispatcher> dispatcher) {
+            if (!dispatcher) {
+                return;
+            }
+            std::unique_lock<std::mutex> lock(dispatcher->_mutex);
+            if (!dispatcher->isDispatcherThread()) {
+                lock.unlock();
+                dispatcher.reset();
+                return;
+            }
+            // owned by the drain running this thread; the frames still counted are recorded as discarded
+            dispatcher->_orphaned = true;
+            dispatcher->_stopping = true;
+            dispatcher->_released = true;
+            dispatcher->_entries.clear();
+            dispatcher->_notFull.notify_all();
+            if (dispatcher->_thread.joinable()) {
+                dispatcher->_thread.detach();
+            }
+            dispatcher.release();
+        }
+
+        /**
+         * @brief Queues a copy of a frame, applying the overflow policy if the queue is full. Called by the reader.
+         */
+        void pushFrame(std::string_view frame) {
+            std::unique_lock<std::mutex> lock(_mutex);
+            if (_orphaned) {
+                return;
+            }
+            if (_queuedFrames >= _capacity && !_released) {
+                if (_policy == DispatchOverflowPolicy::DROP_OLDEST && dropOldestFrame()) {
+                    metrics::MetricsRegistry::instance().recordListenerFramesDropped(1);
+                }
+                else if (_policy == DispatchOverflowPolicy::COALESCE_AUDIO && coalesceIntoNewest(frame)) {
+                    return;
+                }
+                else {
+                    _notFull.wait(lock, [this]() {
+                        return _queuedFrames < _capacity || _released;
+                        });
+                }
+            }
+            Entry entry;
+            entry.frames.push_back(takeBuffer());
+            entry.frames.back().assign(frame.data(), frame.size());
+            entry.droppable = _policy == DispatchOverflowPolicy::DROP_OLDEST && _droppable(frame);
+            entry.queuedAt = Clock::now();
+            _entries.push_back(std::move(entry));
+            ++_queuedFrames;
+            metrics::MetricsRegistry::instance().listenerFrameQueued();
+            schedule(lock);
+        }
+
+        /**
+         * @brief Queues a connection event, delivered after the frames queued before it. Never dropped.
+         */
+        void pushCall(std::function<void()> call) {
+            std::unique_lock<std::mutex> lock(_mutex);
+            if (_orphaned) {
+                return;
+            }
+            Entry entry;
+            entry.call = std::move(call);
+            entry.queuedAt = Clock::now();
+            _entries.push_back(std::move(entry));
+            schedule(lock);
+        }
+
+        /**
+         * @brief Lets the reader queue past the capacity from now on, so it never waits on a listener that is
+         * tearing the connection down. Frames are still delivered.
+         */
+        void release() {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _released = true;
+            _notFull.notify_all();
+        }
+
+        /**
+         * @brief Delivers what is still queued, then stops. Waits for it unless called from the dispatcher itself,
+         * which destroy() takes care of.
+         */
+        void stop() {
+            std::unique_lock<std::mutex> lock(_mutex);
+            _stopping = true;
+            _released = true;
+            _notEmpty.notify_all();
+            _notFull.notify_all();
+            if (isDispatcherThread()) {
+                return;
+            }
+            if (_thread.joinable()) {
+                lock.unlock();
+                _thread.join();
+                return;
+            }
+            _drained.wait(lock, [this]() {
+                return !_drainScheduled;
+                });
+        }
+
+        private:
+        struct Entry {
+            // one frame, or more once chunks were merged into it
+            std::vector<std::string> frames;
+            // a connection event instead of frames
+            std::function<void()> call;
+            // DROP_OLDEST may discard it
+            bool droppable = false;
+            Clock::time_point queuedAt;
+        };
+
+        void runThread() {
+            std::unique_lock<std::mutex> lock(_mutex);
+            _dispatcherThread = std::this_thread::get_id();
+            while (true) {
+                _notEmpty.wait(lock, [this]() {
+                    return _stopping || !_entries.empty();
+                    });
+                if (_entries.empty()) {
+                    break;
+                }
+                drainLocked(lock);
+            }
+            if (_orphaned) {
+                lock.unlock();
+                delete this;
+            }
+        }
+
+        /**
+         * @brief Wakes the dispatcher thread, or posts a drain task unless one is pending. Called with the lock held.
+         */
+        void schedule(std::unique_lock<std::mutex>& lock) {
+            if (!_executor) {
+                _notEmpty.notify_one();
+                return;
+            }
+            if (_drainScheduled) {
+                return;
+            }
+            _drainScheduled = true;
+            lock.unlock();
+            _executor([this]() {
+                std::unique_lock<std::mutex> drainLock(_mutex);
+                _dispatcherThread = std::this_thread::get_id();
+                drainLocked(drainLock);
+                _dispatcherThread = std::thread::id();
+                _drainScheduled = false;
+                if (_orphaned) {
+                    drainLock.unlock();
+                    delete this;
+                    return;
+                }
+                _drained.notify_all();
+                });
+        }
+
+        /**
+         * @brief Delivers entries until the queue is empty. Entered and left with the lock held, released around
+         * every delivery.
+         */
+        void drainLocked(std::unique_lock<std::mutex>& lock) {
+            while (!_entries.empty()) {
+                Entry entry = std::move(_entries.front());
+                _entries.pop_front();
+                if (!entry.call) {
+                    --_queuedFrames;
+                    _notFull.notify_one();
+                }
+                lock.unlock();
+
+                if (!entry.call) {
+                    auto waited = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - entry.queuedAt).count();
+                    metrics::MetricsRegistry::instance().recordListenerDispatch(static_cast<uint64_t>(waited));
+                }
+                deliver(entry);
+
+                lock.lock();
+                for (auto& buffer : entry.frames) {
+                    recycleBuffer(std::move(buffer));
+                }
+            }
+        }
+
+        void deliver(const Entry& entry) {
+            try {
+                if (entry.call) {
+                    entry.call();
+                }
+                else if (entry.frames.size() == 1) {
+                    _frameHandler(entry.frames.front());
+                }
+                else {
+                    _batchHandler(entry.frames);
+                }
+            }
+            catch (const std::exception& e) {
+                spdlog::error("ListenerDispatcher: Error while dispatching to the listener: {}", e.what());
+                if (_errorHandler) {
+                    _errorHandler(e.what());
+                }
+            }
+        }
+
+        /**
+         * @brief Discards the oldest droppable frame, skipping connection events and terminal or control frames.
+         * Called with the lock held.
+         * @return False if nothing queued may be dropped, the reader then waits as with BLOCK.
+         */
+        bool dropOldestFrame() {
+            for (auto it = _entries.begin(); it != _entries.end(); ++it) {
+                if (it->droppable) {
+                    for (auto& buffer : it->frames) {
+                        recycleBuffer(std::move(buffer));
+                    }
+                    _entries.erase(it);
+                    --_queuedFrames;
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        /**
+         * @brief Appends the frame to the newest entry if both are chunks of the same context. Called with the lock held.
+         */
+        bool coalesceIntoNewest(std::string_view frame) {
+            if (_entries.empty() || _entries.back().call) {
+                return false;
+            }
+            auto key = _coalesceKey(frame);
+            auto newestKey = _coalesceKey(_entries.back().frames.front());
+            if (!key || !newestKey || *key != *newestKey) {
+                return false;
+            }
+            _entries.back().frames.push_back(takeBuffer());
+            _entries.back().frames.back().assign(frame.data(), frame.size());
+            metrics::MetricsRegistry::instance().recordListenerFramesCoalesced(1);
+            return true;
+        }
+
+        std::string takeBuffer() {
+            if (_spareBuffers.empty()) {
+                return std::string();
+            }
+            std::string buffer = std::move(_spareBuffers.back());
+            _spareBuffers.pop_back();
+            return buffer;
+        }
+
+        void recycleBuffer(std::string buffer) {
+            if (_spareBuffers.size() < _capacity) {
+                buffer.clear();
+                _spareBuffers.push_back(std::move(buffer));
+            }
+        }
+
+        bool isDispatcherThread() const {
+            return _dispatcherThread == std::this_thread::get_id();
+        }
+
+        const size_t _capacity;
+        DispatchOverflowPolicy _policy;
+        std::function<void(std::function<void()>)> _executor;
+        FrameHandler _frameHandler;
+        BatchHandler _batchHandler;
+        CoalesceKey _coalesceKey;
+        Droppable _droppable;
+        ErrorHandler _errorHandler;
+
+        std::mutex _mutex;
+        std::condition_variable _notEmpty;
+        std::condition_variable _notFull;
+        std::condition_variable _drained;
+        std::deque<Entry> _entries;
+        // entries holding frames, connection events do not count against the capacity
+        size_t _queuedFrames = 0;
+        std::vector<std::string> _spareBuffers;
+        bool _released = false;
+        bool _stopping = false;
+        // destroyed by the drain, see destroy()
+        bool _orphaned = false;
+        bool _drainScheduled = false;
+        std::thread::id _dispatcherThread;
+        std::thread _thread;
+    };
+}
+
+#endif // CARTESIAPP_LISTENER_DISPATCHER_HPP
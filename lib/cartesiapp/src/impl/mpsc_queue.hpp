@@ -0,0 +1,87 @@
+#ifndef CARTESIAPP_MPSC_QUEUE_HPP
+#define CARTESIAPP_MPSC_QUEUE_HPP
+
+#include <atomic>
+#include <utility>
+
+namespace cartesiapp {
+    /**
+     * @brief Unbounded lock-free multi-producer single-consumer FIFO queue (Vyukov's node-based design).
+     *
+     * push() is wait-free, a single atomic exchange, and may be called from any thread. front() and pop()
+     * must only be called by the one consumer. A push that is still in progress may not be visible to the
+     * consumer yet even though it started earlier, so an empty result means "nothing ready", and consumers
+     * that track the number of pushed items separately must retry rather than assume the queue is empty.
+     *
+     * T must be default-constructible: the consumed node is kept as the dummy head of the list.
+     */
+    template <typename T>
+    class MpscQueue {
+        public:
+        MpscQueue() : _head(new Node()), _tail(_head.load(std::memory_order_relaxed)) {
+        }
+
+        ~MpscQueue() {
+            while (pop()) {
+            }
+            delete _tail;
+        }
+
+        MpscQueue(const MpscQueue&) = delete;
+        MpscQueue& operator=(const MpscQueue&) = delete;
+
+        void push(T value) {
+            Node* node = new Node(std::move(value));
+            Node* previous = _head.exchange(node, std::memory_order_acq_rel);
+            // until this store the node is published to producers but not yet reachable by the consumer
+            previous->next.store(node, std::memory_order_release);
+        }
+
+        /**
+         * @brief Returns the oldest ready item without removing it, or nullptr.
+         */
+        T* front() {
+            Node* next = _tail->next.load(std::memory_order_acquire);
+            return next ? &next->value : nullptr;
+        }
+
+        /**
+         * @brief Moves the oldest ready item into the target.
+         * @return false if no item is ready.
+         */
+        bool pop(T& target) {
+            Node* next = _tail->next.load(std::memory_order_acquire);
+            if (!next) {
+                return false;
+            }
+            target = std::move(next->value);
+            delete _tail;
+            _tail = next;
+            return true;
+        }
+
+        /**
+         * @brief Drops the oldest ready item.
+         * @return false if no item is ready.
+         */
+        bool pop() {
+            T discarded;
+            return pop(discarded);
+        }
+
+        private:
+        struct Node {
+            Node() = default;
+            explicit Node(T item) : value(std::move(item)) {
+            }
+
+            std::atomic<Node*> next{ nullptr };
+            T value;
+        };
+
+        alignas(64) std::atomic<Node*> _head;
+        alignas(64) Node* _tail;
+    };
+}
+
+#endif // CARTESIAPP_MPSC_QUEUE_HPP
@@ -0,0 +1,272 @@
+#ifndef CARTESIAPP_STT_AUDIO_SENDER_HPP
+#define CARTESIAPP_STT_AUDIO_SENDER_HPP
+
+#include "streaming_stt.hpp"
+#include "cartesiapp_metrics.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <spdlog/spdlog.h>
+
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/post.hpp>
+#include <boost/asio/steady_timer.hpp>
+#include <boost/asio/strand.hpp>
+
+namespace cartesiapp {
+    /**
+     * @brief Buffers the audio written to an STT connection and sends it in frames of a fixed duration.
+     *
+     * Writers append to a byte buffer under a lock. Frames are cut on a strand of the I/O engine, by a handler
+     * posted when a frame completes and by a timer that sends the partial frame left once writes pause, or holds
+     * frames back to real time. Text requests are queued at the stream offset they were made at, so the audio
+     * written before them is sent first. Handlers keep the sender alive, it is owned through a shared pointer.
+     */
+    class STTAudioSender : public std::enable_shared_from_this<STTAudioSender> {
+        public:
+        using Clock = std::chrono::steady_clock;
+        using Strand = boost::asio::strand<boost::asio::io_context::executor_type>;
+        using SendBytesFunction = std::function<bool(const char* data, size_t size)>;
+        using SendTextFunction = std::function<bool(const std::string& text, bool endsSession)>;
+
+        /**
+         * @param options Frame duration, flush timeout and pacing settings.
+         * @param bytesPerSecond Audio bytes per second of stream time, must not be 0.
+         * @param sampleBytes Size of one sample, frames always end on a sample boundary.
+         * @param strand The strand frames are cut and sent on, typically the connection's.
+         * @param sendBytes Queues an audio frame on the connection. Called with the sender's lock held.
+         * @param sendText Queues a text request on the connection. Called with the sender's lock held.
+         */
+        STTAudioSender(const STTAudioFramingOptions& options,
+            uint64_t bytesPerSecond,
+            size_t sampleBytes,
+            Strand strand,
+            SendBytesFunction sendBytes,
+            SendTextFunction sendText) :
+            _options(options),
+            _bytesPerSecond(std::max<uint64_t>(bytesPerSecond, 1)),
+            _strand(std::move(strand)),
+            _timer(_strand),
+            _sendBytes(std::move(sendBytes)),
+            _sendText(std::move(sendText)) {
+            size_t sample = std::max<size_t>(sampleBytes, 1);
+            uint64_t frameBytes = _bytesPerSecond * static_cast<uint64_t>(std::max<long long>(options.frame_duration.count(), 1)) / 1000;
+            _frameBytes = std::max<size_t>(static_cast<size_t>(frameBytes) / sample * sample, sample);
+        }
+
+        STTAudioSender(const STTAudioSender&) = delete;
+        STTAudioSender& operator=(const STTAudioSender&) = delete;
+
+        /**
+         * @brief Appends audio to the current frame.
+         * @return false if the sender stopped, a send failed, or the buffer is full.
+         */
+        bool write(const char* data, size_t size) {
+            std::lock_guard<std::mutex> lock(_mutex);
+            if (_stopping || _failed) {
+                return false;
+            }
+            size_t pending = _buffer.size() - _readPosition;
+            if (pending + size > _options.max_buffered_bytes) {
+                spdlog::warn("STTWebsocketClient: Audio framing buffer full ({} bytes), write refused.", pending);
+                return false;
+            }
+            _buffer.insert(_buffer.end(), data, data + size);
+            _written += size;
+            _lastWrite = Clock::now();
+            ++_pendingWrites;
+            // the strand only needs waking when a frame completes or a flush deadline starts
+            if (pending == 0 || pending + size >= _frameBytes) {
+                schedulePump();
+            }
+            return true;
+        }
+
+        /**
+         * @brief Queues a text request behind the audio written so far, which is sent first, partial frame or not.
+         * @param endsSession Whether it is the done request.
+         */
+        bool sendText(std::string text, bool endsSession) {
+            std::lock_guard<std::mutex> lock(_mutex);
+            if (_stopping || _failed) {
+                return false;
+            }
+            _requests.push_back({ _written, std::move(text), endsSession });
+            schedulePump();
+            return true;
+        }
+
+        /**
+         * @brief Stops framing. Queued text requests and the audio written before the last of them are sent first,
+         * without pacing, so a request the caller was told is queued is never lost; audio written after it is
+         * dropped. Does not wait for the strand, a pending handler finds the sender stopped.
+         */
+        void stop() {
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+                if (_stopping) {
+                    return;
+                }
+                while (!_requests.empty() && !_failed) {
+                    size_t available = availableBeforeRequest();
+                    if (available > 0) {
+                        sendFrame(std::min(available, _frameBytes), Clock::now());
+                    }
+                    else {
+                        sendNextRequest();
+                    }
+                }
+                _stopping = true;
+            }
+            boost::asio::post(_strand, [self = shared_from_this()]() {
+                self->_timer.cancel();
+                });
+        }
+
+        private:
+        struct TextRequest {
+            // stream offset the request was made at
+            uint64_t offset;
+            std::string text;
+            bool endsSession;
+        };
+
+        /**
+         * @brief Posts a pump to the strand unless one is pending. Called with the lock held.
+         */
+        void schedulePump() {
+            if (_pumpScheduled) {
+                return;
+            }
+            _pumpScheduled = true;
+            boost::asio::post(_strand, [self = shared_from_this()]() {
+                self->pump();
+                });
+        }
+
+        /**
+         * @brief Sends what is due, then arms the timer for the next flush deadline or paced frame. Runs on the strand.
+         */
+        void pump() {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _pumpScheduled = false;
+            while (!_stopping && !_failed) {
+                Clock::time_point now = Clock::now();
+                size_t available = availableBeforeRequest();
+                size_t frame = std::min(available, _frameBytes);
+                bool flushDue = !_requests.empty() || now >= _lastWrite + _options.flush_timeout;
+                if (frame == _frameBytes || (frame > 0 && flushDue)) {
+                    if (_options.realtime_pacing && now < _nextSend) {
+                        armTimer(_nextSend);
+                        return;
+                    }
+                    sendFrame(frame, now);
+                    continue;
+                }
+                if (available == 0 && !_requests.empty()) {
+                    sendNextRequest();
+                    continue;
+                }
+                if (frame > 0) {
+                    armTimer(_lastWrite + _options.flush_timeout);
+                }
+                return;
+            }
+        }
+
+        /**
+         * @brief Wakes the pump at the deadline, replacing the previous wait. Runs on the strand with the lock held.
+         */
+        void armTimer(Clock::time_point deadline) {
+            _timer.expires_at(deadline);
+            _timer.async_wait([self = shared_from_this()](const boost::system::error_code& ec) {
+                if (!ec) {
+                    self->pump();
+                }
+                });
+        }
+
+        /**
+         * @brief Unsent audio up to the next text request, which waits for it. Called with the lock held.
+         */
+        size_t availableBeforeRequest() const {
+            size_t pending = _buffer.size() - _readPosition;
+            return _requests.empty() ? pending
+                : static_cast<size_t>(_requests.front().offset - (_written - pending));
+        }
+
+        /**
+         * @brief Sends the oldest text request. Called with the lock held.
+         */
+        void sendNextRequest() {
+            TextRequest request = std::move(_requests.front());
+            _requests.pop_front();
+            if (!_sendText(request.text, request.endsSession) && !_failed) {
+                spdlog::warn("STTWebsocketClient: Failed to send the {} request, further writes are refused.", request.text);
+                _failed = true;
+            }
+        }
+
+        /**
+         * @brief Sends the next `size` bytes. Called with the lock held.
+         */
+        void sendFrame(size_t size, Clock::time_point now) {
+            bool sent = _sendBytes(_buffer.data() + _readPosition, size);
+            _readPosition += size;
+            if (_readPosition == _buffer.size()) {
+                _buffer.clear();
+                _readPosition = 0;
+            }
+            else if (_readPosition >= _buffer.size() / 2) {
+                // keep the unsent bytes at the front once most of the buffer is sent
+                _buffer.erase(_buffer.begin(), _buffer.begin() + _readPosition);
+                _readPosition = 0;
+            }
+            metrics::MetricsRegistry::instance().recordSTTAudioFramed(std::exchange(_pendingWrites, 0));
+            if (_options.realtime_pacing) {
+                // after a pause the clock restarts, the stream does not catch up in a burst
+                _nextSend = std::max(_nextSend, now) + std::chrono::duration_cast<Clock::duration>(
+                    std::chrono::duration<double>(static_cast<double>(size) / static_cast<double>(_bytesPerSecond)));
+            }
+            if (!sent && !_failed) {
+                spdlog::warn("STTWebsocketClient: Failed to send an audio frame, further writes are refused.");
+                _failed = true;
+            }
+        }
+
+        STTAudioFramingOptions _options;
+        uint64_t _bytesPerSecond;
+        size_t _frameBytes = 0;
+        Strand _strand;
+        // only touched on the strand
+        boost::asio::steady_timer _timer;
+        SendBytesFunction _sendBytes;
+        SendTextFunction _sendText;
+
+        // sends happen under the lock, which keeps writes and text requests in stream order; they only queue
+        std::mutex _mutex;
+        // unsent audio starts at _readPosition
+        std::vector<char> _buffer;
+        size_t _readPosition = 0;
+        // number of bytes ever written
+        uint64_t _written = 0;
+        size_t _pendingWrites = 0;
+        Clock::time_point _lastWrite;
+        Clock::time_point _nextSend;
+        std::deque<TextRequest> _requests;
+        bool _pumpScheduled = false;
+        bool _failed = false;
+        bool _stopping = false;
+    };
+}
+
+#endif // CARTESIAPP_STT_AUDIO_SENDER_HPP
@@ -0,0 +1,89 @@
+#ifndef CARTESIAPP_STT_ENDPOINT_DETECTOR_HPP
+#define CARTESIAPP_STT_ENDPOINT_DETECTOR_HPP
+
+#include "streaming_stt.hpp"
+#include "cartesiapp_metrics.hpp"
+#include "audio_windows.hpp"
+
+#include <algorithm>
+#include <mutex>
+
+namespace cartesiapp {
+    /**
+     * @brief Detects the end of utterances in the audio of an STT session.
+     *
+     * Each 10 ms window is classified as speech, silence, or in between by two thresholds. An utterance starts
+     * after min_speech of consecutive speech and ends once trailing_silence of consecutive silence follows it;
+     * windows in between keep an utterance going without starting one.
+     */
+    class STTEndpointDetector {
+        public:
+        STTEndpointDetector(const STTEndpointingOptions& options, codec::SampleFormat format, int sampleRate) :
+            _windows(format, sampleRate),
+            _speechThreshold(AudioWindowCutter::meanSquareOf(options.speech_threshold_dbfs)),
+            _silenceThreshold(AudioWindowCutter::meanSquareOf(std::min(options.silence_threshold_dbfs, options.speech_threshold_dbfs))),
+            _minSpeechBytes(std::max(_windows.bytesOf(options.min_speech), _windows.windowBytes())),
+            _trailingSilenceBytes(std::max(_windows.bytesOf(options.trailing_silence), _windows.windowBytes())) {
+        }
+
+        STTEndpointDetector(const STTEndpointDetector&) = delete;
+        STTEndpointDetector& operator=(const STTEndpointDetector&) = delete;
+
+        /**
+         * @brief Measures audio that was accepted for sending.
+         * @return true if an utterance ended within it.
+         */
+        bool write(const char* data, size_t size) {
+            std::lock_guard<std::mutex> lock(_mutex);
+            bool ended = false;
+            _windows.feed(data, size, [this, &ended](const char* /*window*/, double level) {
+                ended = processWindow(level) || ended;
+                });
+            return ended;
+        }
+
+        private:
+        bool processWindow(double level) {
+            size_t windowBytes = _windows.windowBytes();
+            if (level >= _speechThreshold) {
+                _speech += windowBytes;
+                _silence = 0;
+                _inUtterance = _inUtterance || _speech >= _minSpeechBytes;
+                return false;
+            }
+            if (level >= _silenceThreshold) {
+                // neither speech nor silence, an utterance goes on but speech must be consecutive to start one
+                _speech = 0;
+                _silence = 0;
+                return false;
+            }
+            _speech = 0;
+            if (!_inUtterance) {
+                return false;
+            }
+            _silence += windowBytes;
+            if (_silence < _trailingSilenceBytes) {
+                return false;
+            }
+            _inUtterance = false;
+            _silence = 0;
+            metrics::MetricsRegistry::instance().recordSTTEndpoint();
+            return true;
+        }
+
+        AudioWindowCutter _windows;
+        // mean squares of the threshold levels
+        const double _speechThreshold;
+        const double _silenceThreshold;
+        const size_t _minSpeechBytes;
+        const size_t _trailingSilenceBytes;
+
+        std::mutex _mutex;
+        // consecutive speech and silence, in bytes
+        size_t _speech = 0;
+        size_t _silence = 0;
+        bool _inUtterance = false;
+    };
+}
+
+#endif // CARTESIAPP_STT_ENDPOINT_DETECTOR_HPP
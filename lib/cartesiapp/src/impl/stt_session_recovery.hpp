@@ -0,0 +1,435 @@
+#ifndef CARTESIAPP_STT_SESSION_RECOVERY_HPP
+#define CARTESIAPP_STT_SESSION_RECOVERY_HPP
+
+#include "streaming_stt.hpp"
+#include "cartesiapp_metrics.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <spdlog/spdlog.h>
+
+namespace cartesiapp {
+    /**
+     * @brief Fixed-capacity ring of the most recent bytes of an audio stream, addressed by absolute stream offset.
+     *
+     * Appending beyond the capacity drops the oldest bytes. Not thread-safe.
+     */
+    class AudioReplayBuffer {
+        public:
+        explicit AudioReplayBuffer(size_t capacity) : _data(capacity) {
+        }
+
+        void append(const char* data, size_t size) {
+            if (_data.empty()) {
+                _end += size;
+                _begin = _end;
+                return;
+            }
+            if (size > _data.size()) {
+                // only the tail of an oversized write fits
+                data += size - _data.size();
+                _end += size - _data.size();
+                size = _data.size();
+            }
+            size_t position = static_cast<size_t>(_end % _data.size());
+            size_t first = std::min(size, _data.size() - position);
+            std::copy(data, data + first, _data.begin() + position);
+            std::copy(data + first, data + size, _data.begin());
+            _end += size;
+            _begin = std::max(_begin, _end - std::min<uint64_t>(_end, _data.size()));
+        }
+
+        /**
+         * @brief Discards the bytes before `offset`, they will not be replayed.
+         */
+        void discardUntil(uint64_t offset) {
+            _begin = std::clamp(offset, _begin, _end);
+        }
+
+        /**
+         * @brief Calls `consumer(data, size)` for the buffered bytes from `offset` (at least begin()) to end(),
+         * in at most two contiguous spans.
+         */
+        template <typename Consumer>
+        void forEachSpanFrom(uint64_t offset, Consumer&& consumer) const {
+            forEachSpanBetween(offset, _end, std::forward<Consumer>(consumer));
+        }
+
+        /**
+         * @brief Calls `consumer(data, size)` for the buffered bytes from `from` to `to`, both clamped to the
+         * buffered range, in at most two contiguous spans.
+         */
+        template <typename Consumer>
+        void forEachSpanBetween(uint64_t from, uint64_t to, Consumer&& consumer) const {
+            to = std::clamp(to, _begin, _end);
+            from = std::clamp(from, _begin, to);
+            while (from < to) {
+                size_t position = static_cast<size_t>(from % _data.size());
+                size_t length = static_cast<size_t>(std::min<uint64_t>(to - from, _data.size() - position));
+                consumer(_data.data() + position, length);
+                from += length;
+            }
+        }
+
+        /**
+         * @brief Absolute offset of the oldest byte still buffered.
+         */
+        uint64_t begin() const {
+            return _begin;
+        }
+
+        /**
+         * @brief Absolute offset one past the newest byte, i.e. the number of bytes ever appended.
+         */
+        uint64_t end() const {
+            return _end;
+        }
+
+        private:
+        std::vector<char> _data;
+        uint64_t _begin = 0;
+        uint64_t _end = 0;
+    };
+
+    /**
+     * @brief Keeps an STT session alive across connection drops.
+     *
+     * Written audio goes through a replay buffer. Final transcripts acknowledge the audio they cover, which is
+     * discarded from it. When the connection is lost, a background thread reconnects with exponential backoff,
+     * then replays the unacknowledged audio before new writes go out. Audio written in the meantime is buffered.
+     * Finalize requests are kept at their offset in the stream until a flush_done acknowledges them and replayed
+     * in place, a done request likewise until it reached a live connection, after which the session is ending
+     * and no longer reconnected.
+     *
+     * The server timeline of a new connection starts at the first replayed byte, so word timings of later
+     * transcripts are shifted back onto the timeline of the whole session.
+     */
+    class STTSessionRecovery {
+        public:
+        using ConnectFunction = std::function<bool()>;
+        using SendFunction = std::function<bool(const char* data, size_t size)>;
+        using SendTextFunction = std::function<bool(const std::string& text)>;
+
+        /**
+         * @param options Backoff and replay buffer settings.
+         * @param bytesPerSecond Audio bytes per second of stream time, 0 if unknown, in which case nothing is
+         * acknowledged and the whole buffer is replayed.
+         * @param sampleBytes Size of one sample, replay always starts on a sample boundary.
+         * @param connect Establishes a new connection, called from the recovery thread.
+         * @param send Queues audio bytes on the current connection.
+         * @param sendText Queues a text request on the current connection.
+         * @param onReconnecting Called once the connection is lost, with the reason.
+         * @param onReconnected Called after a new connection is up and the backlog is queued.
+         * @param onGiveUp Called with the last failure once every attempt failed.
+         */
+        STTSessionRecovery(const STTReconnectOptions& options,
+            uint64_t bytesPerSecond,
+            size_t sampleBytes,
+            ConnectFunction connect,
+            SendFunction send,
+            SendTextFunction sendText,
+            std::function<void(const std::string&)> onReconnecting,
+            std::function<void()> onReconnected,
+            std::function<void(const std::string&)> onGiveUp) :
+            _options(options),
+            _bytesPerSecond(bytesPerSecond),
+            _sampleBytes(std::max<size_t>(sampleBytes, 1)),
+            _connect(std::move(connect)),
+            _send(std::move(send)),
+            _sendText(std::move(sendText)),
+            _onReconnecting(std::move(onReconnecting)),
+            _onReconnected(std::move(onReconnected)),
+            _onGiveUp(std::move(onGiveUp)),
+            _buffer(options.replay_buffer_bytes / _sampleBytes * _sampleBytes) {
+            _thread = std::thread([this]() {
+                run();
+                });
+        }
+
+        ~STTSessionRecovery() {
+            stop();
+        }
+
+        /**
+         * @brief Marks the first connection as established, audio is sent from now on.
+         */
+        void connected() {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _live = true;
+        }
+
+        /**
+         * @brief Buffers the audio, and sends it unless the connection is being re-established.
+         * @return false only once recovery gave up or was stopped.
+         */
+        bool write(const char* data, size_t size) {
+            std::lock_guard<std::mutex> lock(_mutex);
+            if (_stopping || _gaveUp) {
+                return false;
+            }
+            _buffer.append(data, size);
+            if (_live && !_send(data, size)) {
+                // the connection dropped under us, the read side reports it and the bytes are replayed
+                _live = false;
+            }
+            return true;
+        }
+
+        /**
+         * @brief Queues a text request behind the audio written before it, and sends it unless the connection is
+         * being re-established. Called under the lock of the framing sender if any, so that it keeps its place.
+         * @param text The request.
+         * @param endsSession Whether it is the done request, after which a lost connection ends the session.
+         * @return false only once recovery gave up or was stopped.
+         */
+        bool sendText(const std::string& text, bool endsSession) {
+            std::lock_guard<std::mutex> lock(_mutex);
+            if (_stopping || _gaveUp) {
+                return false;
+            }
+            PendingText request{ _buffer.end(), text, endsSession };
+            if (_live) {
+                if (_sendText(text)) {
+                    _ending = _ending || endsSession;
+                    if (endsSession) {
+                        return true;
+                    }
+                }
+                else {
+                    _live = false;
+                }
+            }
+            _pendingText.push_back(std::move(request));
+            return true;
+        }
+
+        /**
+         * @brief Acknowledges the oldest finalize request. Called on the I/O thread for each flush_done.
+         */
+        void onFlushDone() {
+            std::lock_guard<std::mutex> lock(_mutex);
+            auto it = std::find_if(_pendingText.begin(), _pendingText.end(), [](const PendingText& request) {
+                return !request.endsSession;
+                });
+            if (it != _pendingText.end()) {
+                _pendingText.erase(it);
+            }
+        }
+
+        /**
+         * @brief Acknowledges the audio covered by a final transcript and moves its word timings onto the
+         * session timeline. Called on the I/O thread before the transcript reaches the listener.
+         */
+        void onTranscript(response::stt::TranscriptionResponse& transcript) {
+            std::lock_guard<std::mutex> lock(_mutex);
+            if (_sessionStartSeconds > 0.0) {
+                for (auto& word : transcript.words) {
+                    word.start += static_cast<float>(_sessionStartSeconds);
+                    word.end += static_cast<float>(_sessionStartSeconds);
+                }
+            }
+            if (!transcript.is_final || _bytesPerSecond == 0) {
+                return;
+            }
+            // final transcripts cover consecutive segments of the connection's audio, each lasting its duration
+            _transcribedSeconds += std::max(transcript.duration, 0.0f);
+            double endSeconds = _sessionStartSeconds + _transcribedSeconds;
+            if (!transcript.words.empty()) {
+                endSeconds = std::max(endSeconds, static_cast<double>(transcript.words.back().end));
+            }
+            uint64_t acknowledged = static_cast<uint64_t>(std::max(endSeconds, 0.0) * static_cast<double>(_bytesPerSecond));
+            _buffer.discardUntil(acknowledged / _sampleBytes * _sampleBytes);
+        }
+
+        /**
+         * @brief Reports a lost connection from the I/O thread, the recovery thread takes over.
+         * @return false if the connection is not re-established: recovery gave up or was stopped, or the done
+         * request was sent and the session is ending.
+         */
+        bool connectionLost(const std::string& reason) {
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+                if (_stopping || _gaveUp || _ending) {
+                    return false;
+                }
+                _live = false;
+                _lost = true;
+                _lostReason = reason;
+            }
+            _wakeup.notify_all();
+            return true;
+        }
+
+        /**
+         * @brief Ends the session without waiting for the recovery thread, from a callback of the connection
+         * when the server closed it normally or sent its done event.
+         */
+        void finish() {
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+                _stopping = true;
+                _live = false;
+            }
+            _wakeup.notify_all();
+        }
+
+        /**
+         * @brief Stops the recovery thread, waiting for a connect attempt in progress.
+         */
+        void stop() {
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+                _stopping = true;
+                _live = false;
+            }
+            _wakeup.notify_all();
+            if (_thread.joinable() && _thread.get_id() != std::this_thread::get_id()) {
+                _thread.join();
+            }
+        }
+
+        private:
+        void run() {
+            std::unique_lock<std::mutex> lock(_mutex);
+            while (true) {
+                _wakeup.wait(lock, [this]() {
+                    return _stopping || _lost;
+                    });
+                if (_stopping) {
+                    return;
+                }
+                std::string reason = _lostReason;
+                // a drop of the next connection raises it again
+                _lost = false;
+                lock.unlock();
+                spdlog::warn("STTWebsocketClient: Connection lost ({}), reconnecting.", reason);
+                if (_onReconnecting) {
+                    _onReconnecting(reason);
+                }
+                bool reconnected = reconnect(lock);
+                if (_stopping) {
+                    return;
+                }
+                if (!reconnected) {
+                    _gaveUp = true;
+                    lock.unlock();
+                    spdlog::error("STTWebsocketClient: Giving up reconnecting after {} attempts.", _options.max_attempts);
+                    if (_onGiveUp) {
+                        _onGiveUp(reason);
+                    }
+                    return;
+                }
+                replayBacklog();
+                lock.unlock();
+                if (_onReconnected) {
+                    _onReconnected();
+                }
+                lock.lock();
+            }
+        }
+
+        /**
+         * @brief Attempts to connect until it succeeds, stop() is called or the attempts run out.
+         * Entered unlocked, returns with the lock held.
+         */
+        bool reconnect(std::unique_lock<std::mutex>& lock) {
+            std::chrono::milliseconds backoff = _options.initial_backoff;
+            for (int attempt = 1; _options.max_attempts == 0 || attempt <= _options.max_attempts; ++attempt) {
+                lock.lock();
+                if (_wakeup.wait_for(lock, backoff, [this]() { return _stopping; })) {
+                    return false;
+                }
+                lock.unlock();
+                if (_connect()) {
+                    lock.lock();
+                    return true;
+                }
+                backoff = std::min(backoff * 2, _options.max_backoff);
+            }
+            lock.lock();
+            return false;
+        }
+
+        /**
+         * @brief Queues the unacknowledged audio on the new connection, with the pending text requests at their
+         * offsets, under the lock so that concurrent writes wait and follow it in order.
+         */
+        void replayBacklog() {
+            uint64_t start = _buffer.begin();
+            _sessionStartSeconds = _bytesPerSecond ? static_cast<double>(start) / static_cast<double>(_bytesPerSecond) : 0.0;
+            _transcribedSeconds = 0.0;
+            bool sent = true;
+            auto sendSpan = [this, &sent](const char* data, size_t size) {
+                sent = sent && _send(data, size);
+                };
+            size_t requests = _pendingText.size();
+            uint64_t offset = start;
+            for (auto it = _pendingText.begin(); it != _pendingText.end();) {
+                _buffer.forEachSpanBetween(offset, it->offset, sendSpan);
+                offset = std::max(offset, it->offset);
+                sent = sent && _sendText(it->text);
+                if (sent && it->endsSession) {
+                    _ending = true;
+                    it = _pendingText.erase(it);
+                }
+                else {
+                    // finalize requests stay until their flush_done arrives
+                    ++it;
+                }
+            }
+            _buffer.forEachSpanFrom(offset, sendSpan);
+            uint64_t replayed = _buffer.end() - start;
+            metrics::MetricsRegistry::instance().recordSTTAudioReplayed(static_cast<size_t>(replayed));
+            spdlog::info("STTWebsocketClient: Reconnected, replayed {} bytes of audio and {} requests.", replayed, requests);
+            _live = sent;
+        }
+
+        /**
+         * @brief A text request waiting for its acknowledgement.
+         */
+        struct PendingText {
+            // stream offset of the audio it follows
+            uint64_t offset;
+            std::string text;
+            bool endsSession;
+        };
+
+        STTReconnectOptions _options;
+        uint64_t _bytesPerSecond;
+        size_t _sampleBytes;
+        ConnectFunction _connect;
+        SendFunction _send;
+        SendTextFunction _sendText;
+        std::function<void(const std::string&)> _onReconnecting;
+        std::function<void()> _onReconnected;
+        std::function<void(const std::string&)> _onGiveUp;
+
+        std::mutex _mutex;
+        std::condition_variable _wakeup;
+        AudioReplayBuffer _buffer;
+        std::deque<PendingText> _pendingText;
+        // stream time at the first byte of the current connection
+        double _sessionStartSeconds = 0.0;
+        // audio covered by the final transcripts of the current connection
+        double _transcribedSeconds = 0.0;
+        bool _live = false;
+        // the done request reached the server
+        bool _ending = false;
+        bool _lost = false;
+        bool _gaveUp = false;
+        bool _stopping = false;
+        std::string _lostReason;
+        std::thread _thread;
+    };
+}
+
+#endif // CARTESIAPP_STT_SESSION_RECOVERY_HPP
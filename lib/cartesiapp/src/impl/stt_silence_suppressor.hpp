@@ -0,0 +1,218 @@
+#ifndef CARTESIAPP_STT_SILENCE_SUPPRESSOR_HPP
+#define CARTESIAPP_STT_SILENCE_SUPPRESSOR_HPP
+
+#include "streaming_stt.hpp"
+#include "cartesiapp_metrics.hpp"
+#include "audio_windows.hpp"
+#include "stt_session_recovery.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <mutex>
+#include <vector>
+
+namespace cartesiapp {
+    /**
+     * @brief Drops the middle of long silences from the audio of an STT session.
+     *
+     * The audio is cut into 10 ms windows whose level is compared with the threshold. Speech and the hangover
+     * after it are forwarded; later silent windows go into a pre-roll ring, whose content is forwarded when
+     * speech resumes and whose overflow is dropped. Each dropped stretch is recorded at the offset of the
+     * forwarded stream it was cut from, which maps server timings back to the written audio.
+     */
+    class STTSilenceSuppressor {
+        public:
+        using SendFunction = std::function<bool(const char* data, size_t size)>;
+
+        /**
+         * @param options Threshold, hangover and pre-roll settings.
+         * @param format Sample format of the audio.
+         * @param sampleRate Samples per second.
+         * @param send Forwards audio downstream, called under the suppressor lock so that writes stay in order.
+         */
+        STTSilenceSuppressor(const STTSilenceSuppressionOptions& options,
+            codec::SampleFormat format,
+            int sampleRate,
+            SendFunction send) :
+            _windows(format, sampleRate),
+            _bytesPerSecond(_windows.bytesPerSecond()),
+            _threshold(AudioWindowCutter::meanSquareOf(options.threshold_dbfs)),
+            _hangoverBytes(_windows.bytesOf(options.hangover)),
+            _send(std::move(send)),
+            _preRoll(_windows.bytesOf(options.pre_roll)) {
+        }
+
+        STTSilenceSuppressor(const STTSilenceSuppressor&) = delete;
+        STTSilenceSuppressor& operator=(const STTSilenceSuppressor&) = delete;
+
+        /**
+         * @brief Classifies the complete windows of the written audio and forwards the ones kept, in one call.
+         * @return false if forwarding failed.
+         */
+        bool write(const char* data, size_t size) {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _output.clear();
+            _windows.feed(data, size, [this](const char* window, double level) {
+                processWindow(window, level);
+                });
+            return forwardOutput();
+        }
+
+        /**
+         * @brief Forwards the partial window held back by the last write, unless it falls into a silence, where it
+         * joins the pre-roll. Called before finalize and done requests.
+         */
+        bool flush() {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _output.clear();
+            const std::vector<char>& partial = _windows.partial();
+            if (!partial.empty()) {
+                if (_hangoverLeft > 0) {
+                    _output.insert(_output.end(), partial.begin(), partial.end());
+                    _hangoverLeft -= std::min(_hangoverLeft, partial.size());
+                }
+                else {
+                    holdSilence(partial.data(), partial.size());
+                }
+                _windows.clearPartial();
+            }
+            return forwardOutput();
+        }
+
+        /**
+         * @brief Moves word timings from the timeline of the forwarded audio onto that of the written audio.
+         *
+         * Final transcripts acknowledge the forwarded audio they cover, the gaps no later timing can fall
+         * before are forgotten.
+         */
+        void restoreTimings(response::stt::TranscriptionResponse& transcript) {
+            std::lock_guard<std::mutex> lock(_mutex);
+            if (transcript.is_final) {
+                // final transcripts cover consecutive segments of the forwarded audio, each lasting its duration
+                _acknowledgedSeconds += std::max(transcript.duration, 0.0f);
+                if (!transcript.words.empty()) {
+                    _acknowledgedSeconds = std::max(_acknowledgedSeconds, static_cast<double>(transcript.words.back().end));
+                }
+            }
+            if (_gaps.empty()) {
+                return;
+            }
+            for (auto& word : transcript.words) {
+                word.start = static_cast<float>(word.start + droppedSecondsBefore(word.start));
+                word.end = static_cast<float>(word.end + droppedSecondsBefore(word.end));
+            }
+            // the last gap at or before the acknowledged audio still maps the timings after it
+            auto after = gapAfter(_acknowledgedSeconds);
+            if (after != _gaps.begin()) {
+                _gaps.erase(_gaps.begin(), std::prev(after));
+            }
+        }
+
+        STTSilenceSuppressionStats stats() const {
+            std::lock_guard<std::mutex> lock(_mutex);
+            STTSilenceSuppressionStats stats;
+            stats.bytes_suppressed = _dropped;
+            stats.seconds_suppressed = static_cast<double>(_dropped) / static_cast<double>(_bytesPerSecond);
+            return stats;
+        }
+
+        private:
+        struct Gap {
+            // offset in the forwarded stream the dropped audio was cut from
+            uint64_t forwardedOffset;
+            // bytes dropped up to and including this gap
+            uint64_t droppedTotal;
+        };
+
+        void processWindow(const char* window, double level) {
+            size_t windowBytes = _windows.windowBytes();
+            if (level >= _threshold) {
+                // speech resumes, its onset is in the pre-roll
+                _preRoll.forEachSpanFrom(_preRoll.begin(), [this](const char* data, size_t size) {
+                    _output.insert(_output.end(), data, data + size);
+                    });
+                _preRoll.discardUntil(_preRoll.end());
+                _output.insert(_output.end(), window, window + windowBytes);
+                _hangoverLeft = _hangoverBytes;
+                return;
+            }
+            if (_hangoverLeft > 0) {
+                _output.insert(_output.end(), window, window + windowBytes);
+                _hangoverLeft -= std::min(_hangoverLeft, windowBytes);
+                return;
+            }
+            holdSilence(window, windowBytes);
+        }
+
+        /**
+         * @brief Appends silence to the pre-roll, dropping what no longer fits.
+         */
+        void holdSilence(const char* data, size_t size) {
+            uint64_t held = _preRoll.end() - _preRoll.begin();
+            _preRoll.append(data, size);
+            size_t bytes = static_cast<size_t>(held + size - (_preRoll.end() - _preRoll.begin()));
+            if (bytes == 0) {
+                return;
+            }
+            _dropped += bytes;
+            // the forwarded stream is cut at the offset where the output of this write will end
+            uint64_t offset = _forwarded + _output.size();
+            if (!_gaps.empty() && _gaps.back().forwardedOffset == offset) {
+                _gaps.back().droppedTotal = _dropped;
+            }
+            else {
+                _gaps.push_back({ offset, _dropped });
+            }
+            metrics::MetricsRegistry::instance().recordSTTSilenceSuppressed(bytes,
+                static_cast<uint64_t>(static_cast<double>(bytes) * 1e9 / static_cast<double>(_bytesPerSecond)));
+        }
+
+        bool forwardOutput() {
+            if (_output.empty()) {
+                return true;
+            }
+            _forwarded += _output.size();
+            return _send(_output.data(), _output.size());
+        }
+
+        /**
+         * @brief Returns the first gap cut after the given time of the forwarded audio.
+         */
+        std::vector<Gap>::const_iterator gapAfter(double forwardedSeconds) const {
+            uint64_t offset = static_cast<uint64_t>(std::max(forwardedSeconds, 0.0) * static_cast<double>(_bytesPerSecond));
+            return std::upper_bound(_gaps.begin(), _gaps.end(), offset, [](uint64_t value, const Gap& gap) {
+                return value < gap.forwardedOffset;
+                });
+        }
+
+        double droppedSecondsBefore(float forwardedSeconds) const {
+            // the last gap at or before the offset
+            auto after = gapAfter(forwardedSeconds);
+            if (after == _gaps.begin()) {
+                return 0.0;
+            }
+            return static_cast<double>(std::prev(after)->droppedTotal) / static_cast<double>(_bytesPerSecond);
+        }
+
+        AudioWindowCutter _windows;
+        const uint64_t _bytesPerSecond;
+        // mean square of the threshold level
+        const double _threshold;
+        const size_t _hangoverBytes;
+        SendFunction _send;
+
+        mutable std::mutex _mutex;
+        AudioReplayBuffer _preRoll;
+        std::vector<char> _output;
+        std::vector<Gap> _gaps;
+        size_t _hangoverLeft = 0;
+        uint64_t _forwarded = 0;
+        uint64_t _dropped = 0;
+        // forwarded audio covered by final transcripts
+        double _acknowledgedSeconds = 0.0;
+    };
+}
+
+#endif // CARTESIAPP_STT_SILENCE_SUPPRESSOR_HPP
@@ -0,0 +1,78 @@
+#ifndef CARTESIAPP_THREAD_CPU_CLOCK_HPP
+#define CARTESIAPP_THREAD_CPU_CLOCK_HPP
+
+#include <cstdint>
+
+#if defined(_WIN32)
+// keep winsock.h and the min/max macros out, they clash with Asio and std::min
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+namespace cartesiapp {
+    /**
+     * @brief CPU time consumed by the calling thread, in nanoseconds.
+     */
+    inline uint64_t threadCpuTimeNs() {
+#if defined(_WIN32)
+        FILETIME creation, exit, kernel, user;
+        if (!GetThreadTimes(GetCurrentThread(), &creation, &exit, &kernel, &user)) {
+            return 0;
+        }
+        auto toTicks = [](const FILETIME& time) {
+            return (static_cast<uint64_t>(time.dwHighDateTime) << 32) | time.dwLowDateTime;
+        };
+        // FILETIME counts 100 ns intervals
+        return (toTicks(kernel) + toTicks(user)) * 100;
+#else
+        timespec now{};
+        if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &now) != 0) {
+            return 0;
+        }
+        return static_cast<uint64_t>(now.tv_sec) * 1000000000ull + static_cast<uint64_t>(now.tv_nsec);
+#endif
+    }
+
+    /**
+     * @brief Charges the CPU time an I/O thread spends between two handlers of recording connections.
+     *
+     * Each handler calls charge() when it starts, accounting everything the thread did since the previous mark
+     * (socket reads, TLS, WebSocket framing, inflate and deflate), and mark() before handing data to user code,
+     * so listener callbacks are left out. The mark is per thread: the TLS and inflate steps of a read run in
+     * intermediate handlers the client does not see, so the time between marks is charged as a whole. On an
+     * engine shared by several connections, that time includes the work done for the others in between, and the
+     * figure is only meaningful for a connection running on a dedicated engine.
+     */
+    class IoCpuAccounting {
+        public:
+        /**
+         * @return The CPU time since the thread's previous mark, 0 on its first call.
+         */
+        static uint64_t charge() {
+            uint64_t now = threadCpuTimeNs();
+            uint64_t& last = lastMark();
+            uint64_t elapsed = last != 0 && now > last ? now - last : 0;
+            last = now;
+            return elapsed;
+        }
+
+        static void mark() {
+            lastMark() = threadCpuTimeNs();
+        }
+
+        private:
+        static uint64_t& lastMark() {
+            thread_local uint64_t mark = 0;
+            return mark;
+        }
+    };
+}
+
+#endif // CARTESIAPP_THREAD_CPU_CLOCK_HPP
@@ -0,0 +1,324 @@
+#ifndef CARTESIAPP_TTS_CONTEXT_MANAGER_IMPL_HPP
+#define CARTESIAPP_TTS_CONTEXT_MANAGER_IMPL_HPP
+
+#include "streaming_tts.hpp"
+#include "cartesiapp_json.hpp"
+#include "flat_string_map.hpp"
+
+#include <algorithm>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <spdlog/spdlog.h>
+
+namespace cartesiapp {
+    /**
+     * @brief Listener registered with the client by TTSContextManager, routing every event to its context.
+     *
+     * All state is guarded by one mutex, taken for a single hash lookup per routed event; requests are handed
+     * to the client's non-blocking send queue under the lock so the requests of a context keep their order.
+     */
+    class TTSContextManagerImpl : public TTSResponseListener {
+        public:
+        using ListenerPtr = std::shared_ptr<TTSResponseListener>;
+
+        TTSContextManagerImpl(TTSWebsocketClient& client, size_t maxConcurrentContexts) :
+            _client(client),
+            _maxConcurrentContexts(maxConcurrentContexts) {
+        }
+
+        bool submit(const request::tts::GenerationRequest& request, ListenerPtr listener) {
+            if (!request.context_id || request.context_id->empty()) {
+                spdlog::error("TTSContextManager::submit: The request has no context ID.");
+                return false;
+            }
+            std::lock_guard<std::mutex> lock(_mutex);
+            if (Context* context = _contexts.find(*request.context_id)) {
+                if (!context->active) {
+                    context->queuedRequests.push_back(request);
+                    return true;
+                }
+                return _client.requestTTS(request);
+            }
+            if (!listener) {
+                spdlog::error("TTSContextManager::submit: Context {} cannot be opened without a listener.", *request.context_id);
+                return false;
+            }
+            if (!hasFreeSlot()) {
+                _contexts.insert(*request.context_id, Context{ std::move(listener), { request }, false });
+                _queue.push_back(*request.context_id);
+                return true;
+            }
+            if (!_client.requestTTS(request)) {
+                return false;
+            }
+            _contexts.insert(*request.context_id, Context{ std::move(listener), {}, true });
+            ++_activeCount;
+            return true;
+        }
+
+        bool cancel(const std::string& contextId) {
+            std::vector<FailedStart> failedStarts;
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+                Context* context = _contexts.find(contextId);
+                if (!context) {
+                    return false;
+                }
+                bool active = context->active;
+                _contexts.erase(contextId);
+                if (!active) {
+                    _queue.erase(std::remove(_queue.begin(), _queue.end(), contextId), _queue.end());
+                    return true;
+                }
+                if (!sendCancel(contextId)) {
+                    spdlog::warn("TTSContextManager::cancel: Could not send the cancellation of context {}.", contextId);
+                }
+                // the events still in flight for the context are dropped, its slot is free right away
+                --_activeCount;
+                startQueued(failedStarts);
+            }
+            reportFailedStarts(failedStarts);
+            return true;
+        }
+
+        size_t activeContexts() const {
+            std::lock_guard<std::mutex> lock(_mutex);
+            return _activeCount;
+        }
+
+        size_t queuedContexts() const {
+            std::lock_guard<std::mutex> lock(_mutex);
+            return _contexts.size() - _activeCount;
+        }
+
+        void onConnected() override {
+            for (auto& listener : listeners(false)) {
+                listener->onConnected();
+            }
+        }
+
+        void onDisconnected(const std::string& reason) override {
+            // neither the open nor the queued contexts can complete on this connection any more
+            for (auto& listener : listeners(true)) {
+                listener->onDisconnected(reason);
+            }
+        }
+
+        void onNetworkError(const std::string& errorMessage) override {
+            for (auto& listener : listeners(true)) {
+                listener->onNetworkError(errorMessage);
+            }
+        }
+
+        void onAudioChunkReceived(const response::tts::AudioChunkResponse& response) override {
+            if (auto listener = listenerOf(contextOf(response.context_id))) {
+                listener->onAudioChunkReceived(response);
+            }
+        }
+
+        void onAudioChunkView(const response::tts::AudioChunkView& chunk) override {
+            if (auto listener = listenerOf(chunk.context_id)) {
+                listener->onAudioChunkView(chunk);
+            }
+        }
+
+        void onWordTimestampsReceived(const response::tts::WordTimestampsResponse& response) override {
+            if (auto listener = listenerOf(contextOf(response.context_id))) {
+                listener->onWordTimestampsReceived(response);
+            }
+        }
+
+        void onPhonemeTimestampsReceived(const response::tts::PhonemeTimestampsResponse& response) override {
+            if (auto listener = listenerOf(contextOf(response.context_id))) {
+                listener->onPhonemeTimestampsReceived(response);
+            }
+        }
+
+        void onLazyWordTimestampsReceived(const response::tts::LazyWordTimestampsResponse& response) override {
+            // routed on a pre-scan so the payload stays undecoded
+            if (auto listener = listenerOf(peekStringField(response.raw(), "\"context_id\""))) {
+                listener->onLazyWordTimestampsReceived(response);
+            }
+        }
+
+        void onLazyPhonemeTimestampsReceived(const response::tts::LazyPhonemeTimestampsResponse& response) override {
+            if (auto listener = listenerOf(peekStringField(response.raw(), "\"context_id\""))) {
+                listener->onLazyPhonemeTimestampsReceived(response);
+            }
+        }
+
+        void onFlushDoneReceived(const response::tts::FlushDoneResponse& response) override {
+            if (auto listener = listenerOf(contextOf(response.context_id))) {
+                listener->onFlushDoneReceived(response);
+            }
+        }
+
+        void onDoneReceived(const response::tts::DoneResponse& response) override {
+            std::vector<FailedStart> failedStarts;
+            if (auto listener = finishContext(contextOf(response.context_id), failedStarts)) {
+                listener->onDoneReceived(response);
+            }
+            reportFailedStarts(failedStarts);
+        }
+
+        void onError(const response::tts::ErrorResponse& response) override {
+            if (!response.context_id) {
+                // not tied to a context, every open one may be affected
+                for (auto& listener : listeners(false)) {
+                    listener->onError(response);
+                }
+            }
+            else {
+                std::vector<FailedStart> failedStarts;
+                if (auto listener = finishContext(*response.context_id, failedStarts)) {
+                    listener->onError(response);
+                }
+                reportFailedStarts(failedStarts);
+            }
+        }
+
+        private:
+        struct Context {
+            ListenerPtr listener;
+            // requests submitted while the context waits for a slot
+            std::vector<request::tts::GenerationRequest> queuedRequests;
+            bool active = false;
+        };
+
+        /**
+         * @brief A queued context whose requests could not be sent when its slot came free.
+         */
+        struct FailedStart {
+            ListenerPtr listener;
+            std::string contextId;
+        };
+
+        static std::string_view contextOf(const std::optional<std::string>& contextId) {
+            return contextId ? std::string_view(*contextId) : std::string_view();
+        }
+
+        bool hasFreeSlot() const {
+            return _maxConcurrentContexts == 0 || _activeCount < _maxConcurrentContexts;
+        }
+
+        ListenerPtr listenerOf(std::string_view contextId) {
+            std::lock_guard<std::mutex> lock(_mutex);
+            Context* context = _contexts.find(contextId);
+            return context && context->active ? context->listener : nullptr;
+        }
+
+        /**
+         * @brief Removes a context that is done or failed and starts the next queued ones in its slot.
+         * @param failedStarts Receives the queued contexts that could not be started.
+         * @return The listener of the context, or nullptr if it is unknown.
+         */
+        ListenerPtr finishContext(std::string_view contextId, std::vector<FailedStart>& failedStarts) {
+            std::lock_guard<std::mutex> lock(_mutex);
+            Context* context = _contexts.find(contextId);
+            if (!context) {
+                return nullptr;
+            }
+            ListenerPtr listener = std::move(context->listener);
+            bool active = context->active;
+            _contexts.erase(contextId);
+            if (active) {
+                --_activeCount;
+                startQueued(failedStarts);
+            }
+            else {
+                _queue.erase(std::remove(_queue.begin(), _queue.end(), contextId), _queue.end());
+            }
+            return listener;
+        }
+
+        bool sendCancel(const std::string& contextId) {
+            request::tts::CancelContextRequest cancelRequest;
+            cancelRequest.context_id = contextId;
+            cancelRequest.cancel = true;
+            return _client.cancelTTSContext(cancelRequest);
+        }
+
+        /**
+         * @brief Sends the requests of queued contexts while slots are free. Called with the lock held.
+         *
+         * A context whose requests cannot all be sent never takes a slot: it is removed, cancelled on the server
+         * if part of it went out, and handed back in `failedStarts` so its listener learns about it.
+         */
+        void startQueued(std::vector<FailedStart>& failedStarts) {
+            while (hasFreeSlot() && !_queue.empty()) {
+                std::string contextId = std::move(_queue.front());
+                _queue.pop_front();
+                Context* context = _contexts.find(contextId);
+                if (!context) {
+                    continue;
+                }
+                size_t sent = 0;
+                while (sent < context->queuedRequests.size() && _client.requestTTS(context->queuedRequests[sent])) {
+                    ++sent;
+                }
+                if (sent < context->queuedRequests.size()) {
+                    spdlog::error("TTSContextManager: Could not send the queued requests of context {}.", contextId);
+                    if (sent > 0) {
+                        sendCancel(contextId);
+                    }
+                    failedStarts.push_back(FailedStart{ std::move(context->listener), contextId });
+                    _contexts.erase(contextId);
+                    continue;
+                }
+                context->active = true;
+                ++_activeCount;
+                context->queuedRequests.clear();
+                context->queuedRequests.shrink_to_fit();
+            }
+        }
+
+        /**
+         * @brief Reports the contexts startQueued() gave up on as errors of their context. Called without the lock.
+         */
+        static void reportFailedStarts(const std::vector<FailedStart>& failedStarts) {
+            for (const auto& failed : failedStarts) {
+                response::tts::ErrorResponse error;
+                error.type = tts_events::ERROR_;
+                error.done = true;
+                error.error = "The queued requests of the context could not be sent.";
+                error.status_code = 0;
+                error.context_id = failed.contextId;
+                failed.listener->onError(error);
+            }
+        }
+
+        /**
+         * @brief Collects the listeners of the open contexts, or of all contexts when they are dropped.
+         */
+        std::vector<ListenerPtr> listeners(bool dropContexts) {
+            std::vector<ListenerPtr> result;
+            std::lock_guard<std::mutex> lock(_mutex);
+            _contexts.forEach([&result, dropContexts](std::string_view, Context& context) {
+                if (context.active || dropContexts) {
+                    result.push_back(context.listener);
+                }
+                });
+            if (dropContexts) {
+                _contexts.clear();
+                _queue.clear();
+                _activeCount = 0;
+            }
+            return result;
+        }
+
+        mutable std::mutex _mutex;
+        TTSWebsocketClient& _client;
+        size_t _maxConcurrentContexts;
+        size_t _activeCount = 0;
+        FlatStringMap<Context> _contexts;
+        std::deque<std::string> _queue;
+    };
+}
+
+#endif // CARTESIAPP_TTS_CONTEXT_MANAGER_IMPL_HPP
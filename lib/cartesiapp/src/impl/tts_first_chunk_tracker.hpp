@@ -0,0 +1,73 @@
+#ifndef CARTESIAPP_TTS_FIRST_CHUNK_TRACKER_HPP
+#define CARTESIAPP_TTS_FIRST_CHUNK_TRACKER_HPP
+
+#include "cartesiapp_metrics.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+namespace cartesiapp {
+    /**
+     * @brief Measures TTS time-to-first-chunk per context and records it into the metrics registry.
+     *
+     * A context starts waiting when its first generation request is sent and stops when its first chunk
+     * arrives; continuations of a context that is already streaming are not timed again. Once no context is
+     * waiting, the chunk path costs a single relaxed atomic load and never takes the lock.
+     */
+    class FirstChunkTracker {
+        public:
+        using Clock = std::chrono::steady_clock;
+
+        void onRequestSent(const std::string& contextId) {
+            std::lock_guard<std::mutex> lock(_mutex);
+            auto inserted = _contexts.emplace(contextId, Clock::now());
+            if (inserted.second) {
+                _waitingCount.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+
+        void onChunkReceived(std::string_view contextId) {
+            if (_waitingCount.load(std::memory_order_relaxed) == 0) {
+                return;
+            }
+            Clock::time_point now = Clock::now();
+            std::lock_guard<std::mutex> lock(_mutex);
+            // only materialized while some context waits for its first chunk
+            auto it = _contexts.find(std::string(contextId));
+            if (it == _contexts.end() || it->second == Clock::time_point{}) {
+                return;
+            }
+            auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(now - it->second).count();
+            metrics::MetricsRegistry::instance().recordTTSTimeToFirstChunk(static_cast<uint64_t>(elapsed));
+            // keep the entry while the context streams so continuations are not timed again
+            it->second = Clock::time_point{};
+            _waitingCount.fetch_sub(1, std::memory_order_relaxed);
+        }
+
+        /**
+         * @brief Forgets a context once it is done, failed, was cancelled or its request could not be sent.
+         */
+        void onContextFinished(const std::string& contextId) {
+            std::lock_guard<std::mutex> lock(_mutex);
+            auto it = _contexts.find(contextId);
+            if (it == _contexts.end()) {
+                return;
+            }
+            if (it->second != Clock::time_point{}) {
+                _waitingCount.fetch_sub(1, std::memory_order_relaxed);
+            }
+            _contexts.erase(it);
+        }
+
+        private:
+        std::mutex _mutex;
+        std::unordered_map<std::string, Clock::time_point> _contexts;
+        std::atomic<size_t> _waitingCount{ 0 };
+    };
+}
+
+#endif // CARTESIAPP_TTS_FIRST_CHUNK_TRACKER_HPP
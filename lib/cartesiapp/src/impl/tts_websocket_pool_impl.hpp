@@ -0,0 +1,178 @@
+#ifndef CARTESIAPP_TTS_WEBSOCKET_POOL_IMPL_HPP
+#define CARTESIAPP_TTS_WEBSOCKET_POOL_IMPL_HPP
+
+#include "tts_websocket_pool.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <spdlog/spdlog.h>
+
+namespace cartesiapp {
+    /**
+     * @brief Idle connections of a TTSWebsocketPool and the thread maintaining them.
+     *
+     * Connecting and disconnecting are slow and happen without the lock held, so acquire() and release() only
+     * ever wait for a vector push or pop.
+     */
+    class TTSWebsocketPoolImpl {
+        public:
+        using Clock = std::chrono::steady_clock;
+        using ClientPtr = std::unique_ptr<TTSWebsocketClient>;
+
+        TTSWebsocketPoolImpl(const std::string& apiKey, const TTSWebsocketPoolOptions& options, const std::string& apiVersion) :
+            _apiKey(apiKey),
+            _apiVersion(apiVersion),
+            _options(options) {
+            _idle.reserve(_options.size);
+            _maintenanceThread = std::thread([this]() {
+                maintain();
+                });
+        }
+
+        ~TTSWebsocketPoolImpl() {
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+                _stopping = true;
+            }
+            _wakeup.notify_all();
+            if (_maintenanceThread.joinable()) {
+                _maintenanceThread.join();
+            }
+        }
+
+        ClientPtr acquire() {
+            std::vector<ClientPtr> dropped;
+            ClientPtr client;
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+                while (!_idle.empty() && !client) {
+                    ClientPtr candidate = std::move(_idle.back());
+                    _idle.pop_back();
+                    if (candidate->isConnectedAndStarted()) {
+                        client = std::move(candidate);
+                    }
+                    else {
+                        dropped.push_back(std::move(candidate));
+                    }
+                }
+                _replenishRequested = true;
+            }
+            _wakeup.notify_all();
+            if (!client) {
+                spdlog::warn("TTSWebsocketPool::acquire: No connection ready, connecting on the calling thread.");
+                client = connect();
+            }
+            return client;
+        }
+
+        void release(ClientPtr client) {
+            if (!client) {
+                return;
+            }
+            client->unregisterTTSListener();
+            if (client->isConnectedAndStarted()) {
+                std::lock_guard<std::mutex> lock(_mutex);
+                if (!_stopping && _idle.size() < _options.size) {
+                    _idle.push_back(std::move(client));
+                    return;
+                }
+            }
+            // disconnected by its destructor, outside the lock
+        }
+
+        size_t idleConnections() const {
+            std::lock_guard<std::mutex> lock(_mutex);
+            return _idle.size();
+        }
+
+        private:
+        ClientPtr connect() const {
+            auto client = std::make_unique<TTSWebsocketClient>(_apiKey, _apiVersion);
+            client->setWebsocketOptions(_options.websocket);
+            client->setListenerDispatchOptions(_options.listener_dispatch);
+            if (_options.io_engine) {
+                client->setIoEngine(_options.io_engine);
+            }
+            if (!client->connectAndStart()) {
+                return nullptr;
+            }
+            return client;
+        }
+
+        /**
+         * @brief Body of the maintenance thread: drops dead sockets, tops the pool up and pings the idle sockets.
+         */
+        void maintain() {
+            std::unique_lock<std::mutex> lock(_mutex);
+            Clock::time_point nextKeepalive = Clock::now() + _options.keepalive_interval;
+            while (!_stopping) {
+                std::vector<ClientPtr> dropped;
+                auto dead = std::stable_partition(_idle.begin(), _idle.end(), [](const ClientPtr& client) {
+                    return client->isConnectedAndStarted();
+                    });
+                std::move(dead, _idle.end(), std::back_inserter(dropped));
+                _idle.erase(dead, _idle.end());
+
+                bool connectFailed = false;
+                while (!_stopping && _idle.size() < _options.size) {
+                    lock.unlock();
+                    dropped.clear();
+                    ClientPtr client = connect();
+                    lock.lock();
+                    if (!client) {
+                        connectFailed = true;
+                        break;
+                    }
+                    if (_idle.size() < _options.size) {
+                        _idle.push_back(std::move(client));
+                    }
+                    else {
+                        // released clients filled the pool in the meantime
+                        dropped.push_back(std::move(client));
+                    }
+                }
+
+                Clock::time_point now = Clock::now();
+                if (now >= nextKeepalive) {
+                    for (auto& client : _idle) {
+                        client->ping();
+                    }
+                    nextKeepalive = now + _options.keepalive_interval;
+                }
+
+                lock.unlock();
+                dropped.clear();
+                lock.lock();
+
+                Clock::time_point wakeAt = connectFailed ? std::min(nextKeepalive, now + _options.retry_interval) : nextKeepalive;
+                _wakeup.wait_until(lock, wakeAt, [this]() {
+                    return _stopping || _replenishRequested;
+                    });
+                _replenishRequested = false;
+            }
+            // disconnect the idle sockets from this thread rather than from the destructor's caller
+            std::vector<ClientPtr> idle = std::move(_idle);
+            lock.unlock();
+        }
+
+        std::string _apiKey;
+        std::string _apiVersion;
+        TTSWebsocketPoolOptions _options;
+        mutable std::mutex _mutex;
+        std::condition_variable _wakeup;
+        std::vector<ClientPtr> _idle;
+        bool _stopping = false;
+        bool _replenishRequested = false;
+        std::thread _maintenanceThread;
+    };
+}
+
+#endif // CARTESIAPP_TTS_WEBSOCKET_POOL_IMPL_HPP
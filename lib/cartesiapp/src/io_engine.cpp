@@ -0,0 +1,81 @@
+#include "io_engine.hpp"
+#include "impl/io_engine_impl.hpp"
+
+#include <algorithm>
+#include <exception>
+
+#include <spdlog/spdlog.h>
+
+cartesiapp::IoEngineImpl::IoEngineImpl(size_t threadCount) :
+    _threadCount(threadCount),
+    _ioContext(static_cast<int>(threadCount)),
+    _workGuard(boost::asio::make_work_guard(_ioContext))
+{
+}
+
+void cartesiapp::IoEngineImpl::start()
+{
+    _threads.reserve(_threadCount);
+    for (size_t i = 0; i < _threadCount; ++i) {
+        _threads.emplace_back([self = shared_from_this()]() {
+            self->run();
+            });
+    }
+}
+
+void cartesiapp::IoEngineImpl::stop()
+{
+    _workGuard.reset();
+    _ioContext.stop();
+    bool fromEngineThread = std::any_of(_threads.begin(), _threads.end(), [](const std::thread& thread) {
+        return thread.get_id() == std::this_thread::get_id();
+        });
+    for (auto& thread : _threads) {
+        if (fromEngineThread) {
+            // the last owner let go of the engine from one of its own callbacks, which is still on the stack
+            thread.detach();
+        }
+        else if (thread.joinable()) {
+            thread.join();
+        }
+    }
+}
+
+void cartesiapp::IoEngineImpl::run()
+{
+    for (;;) {
+        try {
+            _ioContext.run();
+            return;
+        }
+        catch (const std::exception& ex) {
+            // a throwing handler must not take the other connections of the thread down with it
+            spdlog::error("IoEngine: Unhandled exception in I/O thread: {}", ex.what());
+        }
+    }
+}
+
+cartesiapp::IoEngine::IoEngine(size_t threadCount)
+{
+    if (threadCount == 0) {
+        threadCount = std::max(1u, std::thread::hardware_concurrency());
+    }
+    _impl = std::make_shared<IoEngineImpl>(threadCount);
+    _impl->start();
+}
+
+cartesiapp::IoEngine::~IoEngine()
+{
+    _impl->stop();
+}
+
+size_t cartesiapp::IoEngine::threadCount() const
+{
+    return _impl->threadCount();
+}
+
+std::shared_ptr<cartesiapp::IoEngine> cartesiapp::IoEngine::shared()
+{
+    static std::shared_ptr<IoEngine> engine = std::make_shared<IoEngine>();
+    return engine;
+}
@@ -1,7 +1,34 @@
 #include "streaming_stt.hpp"
 #include "impl/cartesiapp_boost_impl.hpp"
+#include "impl/cartesiapp_json.hpp"
+#include "impl/frame_arena.hpp"
+#include "impl/frame_decoder.hpp"
+#include "impl/listener_dispatcher.hpp"
+#include "impl/stt_audio_sender.hpp"
+#include "impl/stt_endpoint_detector.hpp"
+#include "impl/stt_silence_suppressor.hpp"
+#include "impl/stt_session_recovery.hpp"
+#include <algorithm>
 #include <sstream>
 
+namespace {
+    /**
+     * @brief Size of one sample of an STT input encoding, 0 if the encoding is not known.
+     */
+    size_t sampleBytesOf(const std::string& encoding) {
+        if (encoding == "pcm_s16le" || encoding == "pcm_f16le") {
+            return 2;
+        }
+        if (encoding == "pcm_s32le" || encoding == "pcm_f32le") {
+            return 4;
+        }
+        if (encoding == "pcm_mulaw" || encoding == "pcm_alaw") {
+            return 1;
+        }
+        return 0;
+    }
+}
+
 cartesiapp::STTWebsocketClient::STTWebsocketClient(const std::string& apiKey,
     const std::string& model,
     const std::string& language,
@@ -25,6 +52,24 @@ cartesiapp::STTWebsocketClient::STTWebsocketClient(const std::string& apiKey,
 }
 
 cartesiapp::STTWebsocketClient::~STTWebsocketClient() {
+    // the suppressor and the sender write through the recovery and the connection
+    _endpointDetector.reset();
+    _silenceSuppressor.reset();
+    if (_audioSender) {
+        _audioSender->stop();
+        _audioSender.reset();
+    }
+    // no reconnect may race the teardown of the connection
+    if (_recovery) {
+        _recovery->stop();
+    }
+    if (_dispatcher) {
+        // the reader must not wait for room while the implementation awaits it
+        _dispatcher->release();
+    }
+    // the listener is declared after the implementation, stop every reader of it first
+    WebsocketClientImpl::release(std::move(_websocketClientImpl));
+    ListenerDispatcher::destroy(std::move(_dispatcher));
 }
 
 bool cartesiapp::STTWebsocketClient::connectAndStart()
@@ -34,61 +79,222 @@ bool cartesiapp::STTWebsocketClient::connectAndStart()
         return false;
     }
 
-    auto dataReadCallback = [this](const std::string& data) {
-        nlohmann::json jsonData = nlohmann::json::parse(data, nullptr, false);
-        std::string responseType = jsonData.value("type", "");
+    // stopped first, it sends through the recovery and the connection
+    if (_audioSender) {
+        _audioSender->stop();
+        _audioSender.reset();
+    }
+
+    // the recovery of a previous session may still be referenced by the callbacks of its failed connection,
+    // it is released once the new connection has waited for them
+    std::unique_ptr<STTSessionRecovery> previousRecovery = std::move(_recovery);
+    if (previousRecovery) {
+        previousRecovery->stop();
+    }
+    std::unique_ptr<ListenerDispatcher> previousDispatcher = std::move(_dispatcher);
+    std::unique_ptr<STTSilenceSuppressor> previousSuppressor = std::move(_silenceSuppressor);
+    _endpointDetector.reset();
+
+    if (_reconnectOptions.enabled) {
+        size_t sampleBytes = sampleBytesOf(_encoding);
+        if (sampleBytes == 0) {
+            spdlog::warn("STTWebsocketClient: Unknown encoding {}, the whole replay buffer is replayed on reconnect.", _encoding);
+        }
+        WebsocketClientImpl* websocket = _websocketClientImpl.get();
+        _recovery = std::make_unique<STTSessionRecovery>(
+            /* options = */ _reconnectOptions,
+            /* bytesPerSecond = */ static_cast<uint64_t>(sampleBytes) * static_cast<uint64_t>(std::max(_sampleRate, 0)),
+            /* sampleBytes = */ sampleBytes,
+            /* connect = */ [websocket]() {
+                return websocket->reconnect();
+            },
+            /* send = */ [websocket](const char* data, size_t size) {
+                return websocket->sendBytes(data, size);
+            },
+            /* sendText = */ [websocket](const std::string& text) {
+                return websocket->sendText(text);
+            },
+            /* onReconnecting = */ [this](const std::string& reason) {
+                notifyListener([this, reason]() {
+                    if (auto listener = _sttListener.lock()) {
+                        listener->onReconnecting(reason);
+                    }
+                    });
+            },
+            /* onReconnected = */ [this]() {
+                notifyListener([this]() {
+                    if (auto listener = _sttListener.lock()) {
+                        listener->onReconnected();
+                    }
+                    });
+            },
+            /* onGiveUp = */ [this](const std::string& reason) {
+                notifyListener([this, reason]() {
+                    if (auto listener = _sttListener.lock()) {
+                        listener->onNetworkError(reason);
+                    }
+                    });
+            });
+    }
+    STTSessionRecovery* recovery = _recovery.get();
+
+    if (_silenceOptions.enabled) {
+        codec::SampleFormat format;
+        if (!codec::sampleFormatOf(_encoding, format) || _sampleRate <= 0) {
+            spdlog::warn("STTWebsocketClient: Silence suppression does not support encoding {}, audio is sent in full.", _encoding);
+        }
+        else {
+            _silenceSuppressor = std::make_unique<STTSilenceSuppressor>(
+                /* options = */ _silenceOptions,
+                /* format = */ format,
+                /* sampleRate = */ _sampleRate,
+                /* send = */ [this](const char* data, size_t size) {
+                    return sendAudio(data, size);
+                });
+        }
+    }
+    STTSilenceSuppressor* silenceSuppressor = _silenceSuppressor.get();
+
+    if (_endpointingOptions.enabled) {
+        codec::SampleFormat format;
+        if (!codec::sampleFormatOf(_encoding, format) || _sampleRate <= 0) {
+            spdlog::warn("STTWebsocketClient: Endpointing does not support encoding {}, utterances are ended by the server.", _encoding);
+        }
+        else {
+            _endpointDetector = std::make_unique<STTEndpointDetector>(_endpointingOptions, format, _sampleRate);
+        }
+    }
+
+    // one decoder per connection, only ever used from the reception thread
+    auto frameDecoder = std::make_shared<FrameDecoder>();
+    auto frameArena = std::make_shared<FrameArena>(_memoryResource ? _memoryResource : std::pmr::get_default_resource());
+
+    auto dataReadCallback = [this, frameDecoder, frameArena, recovery, silenceSuppressor](std::string_view data) {
+        // route on a pre-scan of the type field, then parse the frame exactly once
+        std::string_view responseType = peekEventType(data);
+        if (responseType != stt_events::TRANSCRIPTION && responseType != stt_events::DONE
+            && responseType != stt_events::FLUSH_DONE && responseType != stt_events::ERROR_) {
+            spdlog::warn("STTWebsocketClient: Unknown response type received: {}", responseType);
+            return;
+        }
         if (responseType == stt_events::TRANSCRIPTION) {
-            response::stt::TranscriptionResponse transcriptionResponse = response::stt::TranscriptionResponse::fromJson(data);
+            // transcripts are the high-rate frames, they go through the dedicated decoder
+            // declared first so it resets the arena after the response allocated from it is gone
+            FrameArena::ResetGuard resetArena(*frameArena);
+            response::stt::TranscriptionResponse transcriptionResponse(frameArena->resource());
+            try {
+                frameDecoder->decodeTranscription(data, transcriptionResponse);
+            }
+            catch (const nlohmann::json::parse_error&) {
+                spdlog::warn("STTWebsocketClient: Malformed response received: {}", data);
+                return;
+            }
+            if (recovery) {
+                recovery->onTranscript(transcriptionResponse);
+            }
+            // after the recovery, which acknowledges audio on the timeline of what was sent
+            if (silenceSuppressor) {
+                silenceSuppressor->restoreTimings(transcriptionResponse);
+            }
             if (auto listener = _sttListener.lock())
             {
                 listener->onTranscriptionReceived(transcriptionResponse);
             }
+            return;
+        }
+        nlohmann::json jsonData = nlohmann::json::parse(data, nullptr, false);
+        if (jsonData.is_discarded()) {
+            spdlog::warn("STTWebsocketClient: Malformed response received: {}", data);
+            return;
         }
-        else if (responseType == stt_events::DONE) {
-            response::stt::DoneResponse doneResponse = response::stt::DoneResponse::fromJson(data);
+        if (responseType == stt_events::DONE) {
+            auto doneResponse = jsonData.get<response::stt::DoneResponse>();
+            if (recovery) {
+                // the session is over, the close that follows is not a drop
+                recovery->finish();
+            }
             if (auto listener = _sttListener.lock())
             {
                 listener->onDoneReceived(doneResponse);
             }
         }
         else if (responseType == stt_events::FLUSH_DONE) {
-            response::stt::FlushDoneResponse flushDoneResponse = response::stt::FlushDoneResponse::fromJson(data);
+            auto flushDoneResponse = jsonData.get<response::stt::FlushDoneResponse>();
+            if (recovery) {
+                recovery->onFlushDone();
+            }
             if (auto listener = _sttListener.lock())
             {
                 listener->onFlushDoneReceived(flushDoneResponse);
             }
         }
-        else if (responseType == stt_events::ERROR_) {
-            response::stt::ErrorResponse errorResponse = response::stt::ErrorResponse::fromJson(data);
+        else {
+            auto errorResponse = jsonData.get<response::stt::ErrorResponse>();
+            // streaming STT errors carry no status code
+            metrics::MetricsRegistry::instance().recordError(0);
             if (auto listener = _sttListener.lock())
             {
                 listener->onError(errorResponse);
             }
         }
-        else {
-            spdlog::warn("STTWebsocketClient: Unknown response type received: {}", responseType);
-        };
         };
 
+    std::function<void(std::string_view)> readCallback = dataReadCallback;
+    if (_dispatchOptions.enabled) {
+        _dispatcher = std::make_unique<ListenerDispatcher>(
+            /* options = */ _dispatchOptions,
+            /* frameHandler = */ dataReadCallback,
+            /* batchHandler = */ nullptr,
+            /* coalesceKey = */ nullptr,
+            /* droppable = */ [](std::string_view frame) {
+                // final transcripts carry the text and acknowledge the audio, only interim ones may go
+                return peekEventType(frame) == stt_events::TRANSCRIPTION
+                    && peekBoolField(frame, "\"is_final\"") == false;
+            },
+            /* errorHandler = */ [this](const std::string& errorMessage) {
+                if (auto listener = _sttListener.lock()) {
+                    listener->onNetworkError(errorMessage);
+                }
+            });
+        ListenerDispatcher* dispatcher = _dispatcher.get();
+        readCallback = [dispatcher](std::string_view data) {
+            dispatcher->pushFrame(data);
+            };
+    }
+
     auto onConnectedCallback = [this]() {
-        if (auto listener = _sttListener.lock())
-        {
-            listener->onConnected();
-        }
+        notifyListener([this]() {
+            if (auto listener = _sttListener.lock())
+            {
+                listener->onConnected();
+            }
+            });
         };
 
-    auto onDisconnectedCallback = [this](const std::string& reason) {
-        if (auto listener = _sttListener.lock())
-        {
-            listener->onDisconnected(reason);
+    auto onDisconnectedCallback = [this, recovery](const std::string& reason) {
+        if (recovery) {
+            // closed by disconnect() or normally by the server, either way the session ended
+            recovery->finish();
         }
+        notifyListener([this, reason]() {
+            if (auto listener = _sttListener.lock())
+            {
+                listener->onDisconnected(reason);
+            }
+            });
         };
 
-    auto onNetworkErrorCallback = [this](const std::string& errorMessage) {
-        if (auto listener = _sttListener.lock())
-        {
-            listener->onNetworkError(errorMessage);
+    auto onNetworkErrorCallback = [this, recovery](const std::string& errorMessage) {
+        if (recovery && recovery->connectionLost(errorMessage)) {
+            // reported to the listener only if reconnecting fails
+            return;
         }
+        notifyListener([this, errorMessage]() {
+            if (auto listener = _sttListener.lock())
+            {
+                listener->onNetworkError(errorMessage);
+            }
+            });
         };
 
     std::map<std::string, std::string> headers;
@@ -102,18 +308,64 @@ bool cartesiapp::STTWebsocketClient::connectAndStart()
 
     std::string queryParams = queryParamsStream.str();
 
-    return _websocketClientImpl->connectWebsocketAndStartThread(
-        /* dataReadCallback = */ dataReadCallback,
+    bool connected = _websocketClientImpl->connectWebsocketAndStartThread(
+        /* dataReadCallback = */ readCallback,
         /* onConnectedCallback = */ onConnectedCallback,
         /* onDisconnectedCallback = */ onDisconnectedCallback,
         /* onNetworkErrorCallback = */ onNetworkErrorCallback,
         /* headers = */ headers,
         /* queryParams = */ queryParams
     );
+    // may be the dispatcher running this call, e.g. a listener reconnecting
+    ListenerDispatcher::destroy(std::move(previousDispatcher));
+    if (recovery) {
+        if (connected) {
+            recovery->connected();
+        }
+        else {
+            _recovery.reset();
+        }
+    }
+    if (!connected) {
+        _silenceSuppressor.reset();
+        _endpointDetector.reset();
+    }
+    if (connected && _framingOptions.enabled) {
+        size_t sampleBytes = sampleBytesOf(_encoding);
+        if (sampleBytes == 0 || _sampleRate <= 0) {
+            spdlog::warn("STTWebsocketClient: Unknown byte rate of encoding {}, audio is sent as written.", _encoding);
+        }
+        else {
+            WebsocketClientImpl* websocket = _websocketClientImpl.get();
+            _audioSender = std::make_shared<STTAudioSender>(
+                /* options = */ _framingOptions,
+                /* bytesPerSecond = */ static_cast<uint64_t>(sampleBytes) * static_cast<uint64_t>(_sampleRate),
+                /* sampleBytes = */ sampleBytes,
+                /* strand = */ websocket->strand(),
+                /* sendBytes = */ [websocket, recovery](const char* data, size_t size) {
+                    return recovery ? recovery->write(data, size) : websocket->sendBytes(data, size);
+                },
+                /* sendText = */ [websocket, recovery](const std::string& text, bool endsSession) {
+                    // kept for replay while the connection is being re-established, only fails once recovery gave up
+                    return recovery ? recovery->sendText(text, endsSession) : websocket->sendText(text);
+                });
+        }
+    }
+    return connected;
 }
 
 void cartesiapp::STTWebsocketClient::disconnect()
 {
+    if (_audioSender) {
+        _audioSender->stop();
+    }
+    if (_recovery) {
+        _recovery->stop();
+    }
+    if (_dispatcher) {
+        // the reader must not wait for room while the listener is disconnecting
+        _dispatcher->release();
+    }
     _websocketClientImpl->disconnectAndStop();
 }
 
@@ -122,18 +374,120 @@ bool cartesiapp::STTWebsocketClient::isConnectedAndStarted() const
     return _websocketClientImpl->isConnectedAndStarted();
 }
 
+std::chrono::nanoseconds cartesiapp::STTWebsocketClient::pingRoundTripTime() const
+{
+    return std::chrono::nanoseconds(_websocketClientImpl->lastPingRttNs());
+}
+
+void cartesiapp::STTWebsocketClient::setWebsocketOptions(const WebsocketOptions& options)
+{
+    _websocketClientImpl->setOptions(options);
+}
+
+void cartesiapp::STTWebsocketClient::setMemoryResource(std::pmr::memory_resource* resource)
+{
+    _memoryResource = resource;
+}
+
+void cartesiapp::STTWebsocketClient::setRequestTimingsCallback(RequestTimingsCallback callback)
+{
+    _websocketClientImpl->setRequestTimingsCallback(std::move(callback));
+}
+
+void cartesiapp::STTWebsocketClient::setIoEngine(std::shared_ptr<IoEngine> engine)
+{
+    _websocketClientImpl->setIoEngine(std::move(engine));
+}
+
+void cartesiapp::STTWebsocketClient::setReconnectOptions(const STTReconnectOptions& options)
+{
+    _reconnectOptions = options;
+}
+
+void cartesiapp::STTWebsocketClient::setListenerDispatchOptions(const ListenerDispatchOptions& options)
+{
+    _dispatchOptions = options;
+}
+
+void cartesiapp::STTWebsocketClient::setAudioFramingOptions(const STTAudioFramingOptions& options)
+{
+    _framingOptions = options;
+}
+
+void cartesiapp::STTWebsocketClient::setSilenceSuppressionOptions(const STTSilenceSuppressionOptions& options)
+{
+    _silenceOptions = options;
+}
+
+cartesiapp::STTSilenceSuppressionStats cartesiapp::STTWebsocketClient::silenceSuppressionStats() const
+{
+    return _silenceSuppressor ? _silenceSuppressor->stats() : STTSilenceSuppressionStats();
+}
+
+void cartesiapp::STTWebsocketClient::setEndpointingOptions(const STTEndpointingOptions& options)
+{
+    _endpointingOptions = options;
+}
+
+void cartesiapp::STTWebsocketClient::notifyListener(std::function<void()> call)
+{
+    // connection events keep their order relative to the frames queued before them
+    if (_dispatcher) {
+        _dispatcher->pushCall(std::move(call));
+        return;
+    }
+    call();
+}
+
 bool cartesiapp::STTWebsocketClient::sendDoneRequest() const
 {
+    if (_silenceSuppressor) {
+        _silenceSuppressor->flush();
+    }
+    if (_audioSender) {
+        return _audioSender->sendText("done", true);
+    }
+    if (_recovery) {
+        // replayed after the backlog if the connection is being re-established
+        return _recovery->sendText("done", true);
+    }
     return _websocketClientImpl->sendText("done");
 }
 
 bool cartesiapp::STTWebsocketClient::sendFinalizeRequest() const
 {
+    if (_silenceSuppressor) {
+        _silenceSuppressor->flush();
+    }
+    if (_audioSender) {
+        return _audioSender->sendText("finalize", false);
+    }
+    if (_recovery) {
+        return _recovery->sendText("finalize", false);
+    }
     return _websocketClientImpl->sendText("finalize");
 }
 
 bool cartesiapp::STTWebsocketClient::writeAudioBytes(const char* data, size_t size) const
 {
+    bool written = _silenceSuppressor ? _silenceSuppressor->write(data, size) : sendAudio(data, size);
+    // measured on the written audio, suppression may drop part of the trailing silence; refused audio is not
+    // part of the stream and must not move the detector
+    bool utteranceEnded = written && _endpointDetector && _endpointDetector->write(data, size);
+    if (utteranceEnded && !sendFinalizeRequest()) {
+        spdlog::warn("STTWebsocketClient: Failed to finalize the utterance ended by local endpointing.");
+    }
+    return written;
+}
+
+bool cartesiapp::STTWebsocketClient::sendAudio(const char* data, size_t size) const
+{
+    if (_audioSender) {
+        return _audioSender->write(data, size);
+    }
+    if (_recovery) {
+        return _recovery->write(data, size);
+    }
     return _websocketClientImpl->sendBytes(data, size);
 }
 
@@ -146,3 +500,11 @@ void cartesiapp::STTWebsocketClient::unregisterSTTListener()
 {
     _sttListener.reset();
 }
+
+void cartesiapp::STTResponseListener::onReconnecting(const std::string& /*reason*/)
+{
+}
+
+void cartesiapp::STTResponseListener::onReconnected()
+{
+}
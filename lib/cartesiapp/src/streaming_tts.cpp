@@ -1,6 +1,11 @@
 #include "streaming_tts.hpp"
 #include <nlohmann/json.hpp>
 #include "impl/cartesiapp_boost_impl.hpp"
+#include "impl/cartesiapp_json.hpp"
+#include "impl/frame_arena.hpp"
+#include "impl/frame_decoder.hpp"
+#include "impl/listener_dispatcher.hpp"
+#include "impl/tts_first_chunk_tracker.hpp"
 
 
 cartesiapp::TTSWebsocketClient::TTSWebsocketClient(const std::string& apiKey, const std::string& apiVersion) : _apiKey(apiKey), _apiVersion(apiVersion)
@@ -10,11 +15,18 @@ cartesiapp::TTSWebsocketClient::TTSWebsocketClient(const std::string& apiKey, co
         /* apiVersion = */apiVersion,
         /* verifyCertificates = */false,
         /* endpoint = */cartesiapp::request::constants::ENDPOINT_TTS_WEBSOCKET);
+    _firstChunkTracker = std::make_unique<FirstChunkTracker>();
 }
 
 cartesiapp::TTSWebsocketClient::~TTSWebsocketClient()
 {
-    
+    if (_dispatcher) {
+        // the reader must not wait for room while the implementation awaits it
+        _dispatcher->release();
+    }
+    // the listener state is declared after the implementation, stop every reader of it first
+    WebsocketClientImpl::release(std::move(_websocketClientImpl));
+    ListenerDispatcher::destroy(std::move(_dispatcher));
 }
 
 bool cartesiapp::TTSWebsocketClient::connectAndStart()
@@ -24,51 +36,197 @@ bool cartesiapp::TTSWebsocketClient::connectAndStart()
         return false;
     }
 
-    auto dataReceptionCallback = [this](const std::string& data) {
-        auto listener = _ttsListener.lock();
-        if (listener) {
-            nlohmann::json jsonData = nlohmann::json::parse(data);
-            std::string responseType = jsonData.value("type", "");
-            if (responseType == tts_events::AUDIO_CHUNK) {
-                listener->onAudioChunkReceived(std::move(cartesiapp::response::tts::AudioChunkResponse::fromJson(data)));
+    // one decoder per connection, only ever used from the reception thread
+    auto frameDecoder = std::make_shared<FrameDecoder>();
+    auto frameArena = std::make_shared<FrameArena>(_memoryResource ? _memoryResource : std::pmr::get_default_resource());
+
+    // the dispatcher of a previous session is released once the new connection has waited for its reads
+    std::unique_ptr<ListenerDispatcher> previousDispatcher = std::move(_dispatcher);
+
+    auto dataReceptionCallback = [this, frameDecoder, frameArena, lazyTimestamps = _lazyTimestamps, timestampIndex = _timestampIndex](std::string_view data) {
+        auto listener = currentListener();
+        if (!listener && !timestampIndex) {
+            return;
+        }
+        // route on a pre-scan of the type field, then parse the frame exactly once
+        std::string_view responseType = peekEventType(data);
+        if (responseType == tts_events::AUDIO_CHUNK) {
+            if (listener) {
+                auto chunk = frameDecoder->decodeAudioChunkView(data);
+                _firstChunkTracker->onChunkReceived(chunk.context_id);
+                metrics::MetricsRegistry::instance().recordTTSChunk(chunk.size);
+                listener->onAudioChunkView(chunk);
+            }
+        }
+        else if (responseType == tts_events::WORD_TIMESTAMPS) {
+            FrameArena::ResetGuard resetArena(*frameArena);
+            if (lazyTimestamps) {
+                response::tts::LazyWordTimestampsResponse timestamps(data, frameArena->resource());
+                if (timestampIndex) {
+                    timestampIndex->addWords(timestamps.get());
+                }
+                if (listener) {
+                    listener->onLazyWordTimestampsReceived(timestamps);
+                }
+            }
+            else {
+                response::tts::WordTimestampsResponse timestamps(frameArena->resource());
+                nlohmann::json::parse(data).get_to(timestamps);
+                if (timestampIndex) {
+                    timestampIndex->addWords(timestamps);
+                }
+                if (listener) {
+                    listener->onWordTimestampsReceived(timestamps);
+                }
+            }
+        }
+        else if (responseType == tts_events::PHONEME_TIMESTAMPS) {
+            FrameArena::ResetGuard resetArena(*frameArena);
+            if (lazyTimestamps) {
+                response::tts::LazyPhonemeTimestampsResponse timestamps(data, frameArena->resource());
+                if (timestampIndex) {
+                    timestampIndex->addPhonemes(timestamps.get());
+                }
+                if (listener) {
+                    listener->onLazyPhonemeTimestampsReceived(timestamps);
+                }
             }
-            else if (responseType == tts_events::WORD_TIMESTAMPS) {
-                listener->onWordTimestampsReceived(std::move(cartesiapp::response::tts::WordTimestampsResponse::fromJson(data)));
+            else {
+                response::tts::PhonemeTimestampsResponse timestamps(frameArena->resource());
+                nlohmann::json::parse(data).get_to(timestamps);
+                if (timestampIndex) {
+                    timestampIndex->addPhonemes(timestamps);
+                }
+                if (listener) {
+                    listener->onPhonemeTimestampsReceived(timestamps);
+                }
             }
-            else if (responseType == tts_events::PHONEME_TIMESTAMPS) {
-                listener->onPhonemeTimestampsReceived(std::move(cartesiapp::response::tts::PhonemeTimestampsResponse::fromJson(data)));
+        }
+        else if (responseType == tts_events::DONE) {
+            auto done = nlohmann::json::parse(data).get<cartesiapp::response::tts::DoneResponse>();
+            if (timestampIndex) {
+                timestampIndex->finishContext(done.context_id.value_or(""));
             }
-            else if (responseType == tts_events::FLUSH_DONE) {
-                listener->onFlushDoneReceived(std::move(cartesiapp::response::tts::FlushDoneResponse::fromJson(data)));
+            if (listener) {
+                _firstChunkTracker->onContextFinished(done.context_id.value_or(""));
+                listener->onDoneReceived(done);
             }
-            else if (responseType == tts_events::DONE) {
-                listener->onDoneReceived(std::move(cartesiapp::response::tts::DoneResponse::fromJson(data)));
+        }
+        else if (responseType == tts_events::ERROR_) {
+            auto error = nlohmann::json::parse(data).get<cartesiapp::response::tts::ErrorResponse>();
+            if (timestampIndex) {
+                timestampIndex->finishContext(error.context_id.value_or(""));
             }
-            else if (responseType == tts_events::ERROR_) {
-                listener->onError(std::move(cartesiapp::response::tts::ErrorResponse::fromJson(data)));
+            if (listener) {
+                _firstChunkTracker->onContextFinished(error.context_id.value_or(""));
+                metrics::MetricsRegistry::instance().recordError(error.status_code);
+                listener->onError(error);
             }
         }
+        else if (listener && responseType == tts_events::FLUSH_DONE) {
+            listener->onFlushDoneReceived(nlohmann::json::parse(data).get<cartesiapp::response::tts::FlushDoneResponse>());
+        }
         };
 
-    auto connectionEstablishedCallback = [this]() {
-        auto listener = _ttsListener.lock();
+    auto notifyNetworkError = [this](const std::string& errorMessage) {
+        auto listener = currentListener();
         if (listener) {
-            listener->onConnected();
+            listener->onNetworkError(errorMessage);
         }
         };
 
-    auto disconnectionCallback = [this](const std::string& message) {
-        auto listener = _ttsListener.lock();
-        if (listener) {
-            listener->onDisconnected(message);
+    std::function<void(std::string_view)> dataReadCallback = dataReceptionCallback;
+    if (_dispatchOptions.enabled) {
+        // merged chunks are delivered from this buffer, reused by every batch
+        auto coalescedAudio = std::make_shared<std::vector<std::byte>>();
+        auto chunkBatchCallback = [this, frameDecoder, coalescedAudio](const std::vector<std::string>& frames) {
+            auto listener = currentListener();
+            if (!listener) {
+                return;
+            }
+            response::tts::AudioChunkView merged;
+            std::string contextId;
+            coalescedAudio->clear();
+            for (const auto& frame : frames) {
+                auto chunk = frameDecoder->decodeAudioChunkView(frame);
+                _firstChunkTracker->onChunkReceived(chunk.context_id);
+                metrics::MetricsRegistry::instance().recordTTSChunk(chunk.size);
+                coalescedAudio->insert(coalescedAudio->end(), chunk.data, chunk.data + chunk.size);
+                if (contextId.empty()) {
+                    contextId.assign(chunk.context_id);
+                }
+                // the newest chunk tells where the context stands
+                merged.done = chunk.done;
+                merged.status_code = chunk.status_code;
+                merged.step_time = chunk.step_time;
+            }
+            merged.data = coalescedAudio->data();
+            merged.size = coalescedAudio->size();
+            merged.context_id = contextId;
+            listener->onAudioChunkView(merged);
+            };
+        auto chunkContextKey = [](std::string_view frame) -> std::optional<std::string_view> {
+            if (peekEventType(frame) != tts_events::AUDIO_CHUNK) {
+                return std::nullopt;
+            }
+            return peekStringField(frame, "\"context_id\"");
+            };
+        auto chunkDroppable = [](std::string_view frame) {
+            // done, error and flush_done release the context and timestamps feed the index, only audio may go
+            return peekEventType(frame) == tts_events::AUDIO_CHUNK;
+            };
+        _dispatcher = std::make_unique<ListenerDispatcher>(
+            /* options = */ _dispatchOptions,
+            /* frameHandler = */ dataReceptionCallback,
+            /* batchHandler = */ chunkBatchCallback,
+            /* coalesceKey = */ chunkContextKey,
+            /* droppable = */ chunkDroppable,
+            /* errorHandler = */ notifyNetworkError);
+    }
+    ListenerDispatcher* dispatcher = _dispatcher.get();
+    if (dispatcher) {
+        dataReadCallback = [dispatcher](std::string_view data) {
+            dispatcher->pushFrame(data);
+            };
+    }
+
+    // connection events keep their order relative to the frames queued before them
+    auto connectionEstablishedCallback = [this, dispatcher]() {
+        auto notify = [this]() {
+            auto listener = currentListener();
+            if (listener) {
+                listener->onConnected();
+            }
+            };
+        if (dispatcher) {
+            dispatcher->pushCall(notify);
+            return;
         }
+        notify();
         };
 
-    auto networkErrorCallback = [this](const std::string& errorMessage) {
-        auto listener = _ttsListener.lock();
-        if (listener) {
-            listener->onNetworkError(errorMessage);
+    auto disconnectionCallback = [this, dispatcher](const std::string& message) {
+        auto notify = [this, message]() {
+            auto listener = currentListener();
+            if (listener) {
+                listener->onDisconnected(message);
+            }
+            };
+        if (dispatcher) {
+            dispatcher->pushCall(notify);
+            return;
         }
+        notify();
+        };
+
+    auto networkErrorCallback = [dispatcher, notifyNetworkError](const std::string& errorMessage) {
+        if (dispatcher) {
+            dispatcher->pushCall([notifyNetworkError, errorMessage]() {
+                notifyNetworkError(errorMessage);
+                });
+            return;
+        }
+        notifyNetworkError(errorMessage);
         };
 
     std::map<std::string, std::string> headers;
@@ -79,14 +237,26 @@ bool cartesiapp::TTSWebsocketClient::connectAndStart()
 
     std::string queryParams = queryParamsStream.str();
 
-    return _websocketClientImpl->connectWebsocketAndStartThread(
-        /* dataReadCallback = */ dataReceptionCallback,
+    bool connected = _websocketClientImpl->connectWebsocketAndStartThread(
+        /* dataReadCallback = */ dataReadCallback,
         /* onConnectedCallback = */ connectionEstablishedCallback,
         /* onDisconnectedCallback = */ disconnectionCallback,
         /* onNetworkErrorCallback = */ networkErrorCallback,
         /* headers = */ headers,
         /* queryParams = */ queryParams
     );
+    // may be the dispatcher running this call, e.g. a listener reconnecting
+    ListenerDispatcher::destroy(std::move(previousDispatcher));
+    return connected;
+}
+
+void cartesiapp::TTSWebsocketClient::disconnect()
+{
+    if (_dispatcher) {
+        // the reader must not wait for room while the listener is disconnecting
+        _dispatcher->release();
+    }
+    _websocketClientImpl->disconnectAndStop();
 }
 
 bool cartesiapp::TTSWebsocketClient::isConnectedAndStarted() const
@@ -94,22 +264,112 @@ bool cartesiapp::TTSWebsocketClient::isConnectedAndStarted() const
     return _websocketClientImpl->isConnectedAndStarted();
 }
 
+void cartesiapp::TTSWebsocketClient::setWebsocketOptions(const WebsocketOptions& options)
+{
+    _websocketClientImpl->setOptions(options);
+}
+
+void cartesiapp::TTSWebsocketClient::setMemoryResource(std::pmr::memory_resource* resource)
+{
+    _memoryResource = resource;
+}
+
+void cartesiapp::TTSWebsocketClient::setLazyTimestamps(bool enabled)
+{
+    _lazyTimestamps = enabled;
+}
+
+void cartesiapp::TTSWebsocketClient::setTimestampIndex(std::shared_ptr<TimestampIndex> index)
+{
+    _timestampIndex = std::move(index);
+}
+
+void cartesiapp::TTSWebsocketClient::setListenerDispatchOptions(const ListenerDispatchOptions& options)
+{
+    _dispatchOptions = options;
+}
+
+void cartesiapp::TTSWebsocketClient::setRequestTimingsCallback(RequestTimingsCallback callback)
+{
+    _websocketClientImpl->setRequestTimingsCallback(std::move(callback));
+}
+
+void cartesiapp::TTSWebsocketClient::setIoEngine(std::shared_ptr<IoEngine> engine)
+{
+    _websocketClientImpl->setIoEngine(std::move(engine));
+}
+
 bool cartesiapp::TTSWebsocketClient::requestTTS(const request::tts::GenerationRequest& request) const
 {
-    return _websocketClientImpl->sendText(request.toJson());
+    std::string contextId = request.context_id.value_or("");
+    // start the clock before sending, the first chunk may arrive before sendText returns
+    _firstChunkTracker->onRequestSent(contextId);
+    bool sent = _websocketClientImpl->sendText(request.toJson());
+    if (!sent) {
+        _firstChunkTracker->onContextFinished(contextId);
+    }
+    return sent;
+}
+
+bool cartesiapp::TTSWebsocketClient::requestTTS(request::tts::PreparedGenerationRequest& request,
+    const std::string& transcript,
+    const std::string& contextId,
+    bool continue_,
+    bool flush) const
+{
+    _firstChunkTracker->onRequestSent(contextId);
+    bool sent = _websocketClientImpl->sendText(request.serialize(transcript, contextId, continue_, flush));
+    if (!sent) {
+        _firstChunkTracker->onContextFinished(contextId);
+    }
+    return sent;
+}
+
+bool cartesiapp::TTSWebsocketClient::ping() const
+{
+    return _websocketClientImpl->sendPing();
+}
+
+std::chrono::nanoseconds cartesiapp::TTSWebsocketClient::pingRoundTripTime() const
+{
+    return std::chrono::nanoseconds(_websocketClientImpl->lastPingRttNs());
 }
 
 bool cartesiapp::TTSWebsocketClient::cancelTTSContext(const request::tts::CancelContextRequest& request) const
 {
+    _firstChunkTracker->onContextFinished(request.context_id);
     return _websocketClientImpl->sendText(request.toJson());
 }
 
 void cartesiapp::TTSWebsocketClient::registerTTSListener(std::weak_ptr<TTSResponseListener> listener)
 {
+    std::lock_guard<std::mutex> lock(_listenerMutex);
     _ttsListener = listener;
 }
 
 void cartesiapp::TTSWebsocketClient::unregisterTTSListener()
 {
+    std::lock_guard<std::mutex> lock(_listenerMutex);
     _ttsListener.reset();
 }
+
+std::shared_ptr<cartesiapp::TTSResponseListener> cartesiapp::TTSWebsocketClient::currentListener() const
+{
+    std::lock_guard<std::mutex> lock(_listenerMutex);
+    return _ttsListener.lock();
+}
+
+void cartesiapp::TTSResponseListener::onAudioChunkView(const response::tts::AudioChunkView& chunk)
+{
+    onAudioChunkReceived(chunk.toResponse());
+}
+
+void cartesiapp::TTSResponseListener::onLazyWordTimestampsReceived(const response::tts::LazyWordTimestampsResponse& response)
+{
+    onWordTimestampsReceived(response.get());
+}
+
+void cartesiapp::TTSResponseListener::onLazyPhonemeTimestampsReceived(const response::tts::LazyPhonemeTimestampsResponse& response)
+{
+    onPhonemeTimestampsReceived(response.get());
+}
@@ -0,0 +1,182 @@
+#include "timestamp_index.hpp"
+
+#include <algorithm>
+#include <mutex>
+
+cartesiapp::TimestampIndex::TimestampIndex(size_t maxFinishedContexts) :
+    _maxFinishedContexts(maxFinishedContexts)
+{
+}
+
+void cartesiapp::TimestampIndex::Track::append(uint32_t symbol, float start, float end)
+{
+    if (starts.empty() || start >= starts.back()) {
+        starts.push_back(start);
+        ends.push_back(end);
+        maxEnds.push_back(maxEnds.empty() ? end : std::max(maxEnds.back(), end));
+        symbols.push_back(symbol);
+        return;
+    }
+    // out of order events are rare, keep the arrays sorted so lookups stay binary searches
+    size_t position = std::upper_bound(starts.begin(), starts.end(), start) - starts.begin();
+    starts.insert(starts.begin() + position, start);
+    ends.insert(ends.begin() + position, end);
+    symbols.insert(symbols.begin() + position, symbol);
+    maxEnds.insert(maxEnds.begin() + position, end);
+    for (size_t i = position; i < maxEnds.size(); ++i) {
+        maxEnds[i] = i == 0 ? ends[i] : std::max(maxEnds[i - 1], ends[i]);
+    }
+}
+
+std::optional<size_t> cartesiapp::TimestampIndex::Track::find(float time) const
+{
+    size_t position = std::upper_bound(starts.begin(), starts.end(), time) - starts.begin();
+    // the latest start usually covers the time, otherwise an earlier and longer entry may
+    for (; position > 0 && maxEnds[position - 1] > time; --position) {
+        if (ends[position - 1] > time) {
+            return position - 1;
+        }
+    }
+    return std::nullopt;
+}
+
+void cartesiapp::TimestampIndex::addWords(const response::tts::WordTimestampsResponse& response)
+{
+    std::unique_lock<std::shared_mutex> lock(_mutex);
+    Track& track = _timelines[response.context_id.value_or("")].words;
+    for (const auto& timestamps : response.word_timestamps) {
+        size_t count = std::min({ timestamps.words.size(), timestamps.start.size(), timestamps.end.size() });
+        for (size_t i = 0; i < count; ++i) {
+            track.append(intern(timestamps.words[i]),
+                static_cast<float>(timestamps.start[i]),
+                static_cast<float>(timestamps.end[i]));
+        }
+    }
+}
+
+void cartesiapp::TimestampIndex::addPhonemes(const response::tts::PhonemeTimestampsResponse& response)
+{
+    std::unique_lock<std::shared_mutex> lock(_mutex);
+    Track& track = _timelines[response.context_id.value_or("")].phonemes;
+    const auto& timestamps = response.phoneme_timestamps;
+    size_t count = std::min({ timestamps.phonemes.size(), timestamps.start.size(), timestamps.end.size() });
+    for (size_t i = 0; i < count; ++i) {
+        track.append(intern(timestamps.phonemes[i]),
+            static_cast<float>(timestamps.start[i]),
+            static_cast<float>(timestamps.end[i]));
+    }
+}
+
+std::optional<cartesiapp::TimestampIndex::Entry> cartesiapp::TimestampIndex::wordAt(const std::string& contextId, float time) const
+{
+    return lookup(contextId, &Timeline::words, time);
+}
+
+std::optional<cartesiapp::TimestampIndex::Entry> cartesiapp::TimestampIndex::phonemeAt(const std::string& contextId, float time) const
+{
+    return lookup(contextId, &Timeline::phonemes, time);
+}
+
+size_t cartesiapp::TimestampIndex::wordsInRange(const std::string& contextId, float from, float to, std::vector<Entry>& out) const
+{
+    return collect(contextId, &Timeline::words, from, to, out);
+}
+
+size_t cartesiapp::TimestampIndex::phonemesInRange(const std::string& contextId, float from, float to, std::vector<Entry>& out) const
+{
+    return collect(contextId, &Timeline::phonemes, from, to, out);
+}
+
+void cartesiapp::TimestampIndex::finishContext(const std::string& contextId)
+{
+    std::unique_lock<std::shared_mutex> lock(_mutex);
+    if (_timelines.find(contextId) == _timelines.end()) {
+        return;
+    }
+    auto it = std::find(_finished.begin(), _finished.end(), contextId);
+    if (it != _finished.end()) {
+        _finished.erase(it);
+    }
+    _finished.push_back(contextId);
+    while (_finished.size() > _maxFinishedContexts) {
+        _timelines.erase(_finished.front());
+        _finished.pop_front();
+    }
+}
+
+void cartesiapp::TimestampIndex::clearContext(const std::string& contextId)
+{
+    std::unique_lock<std::shared_mutex> lock(_mutex);
+    _timelines.erase(contextId);
+    auto it = std::find(_finished.begin(), _finished.end(), contextId);
+    if (it != _finished.end()) {
+        _finished.erase(it);
+    }
+}
+
+void cartesiapp::TimestampIndex::clear()
+{
+    std::unique_lock<std::shared_mutex> lock(_mutex);
+    _timelines.clear();
+    _finished.clear();
+    _symbolIds.clear();
+    _symbols.clear();
+}
+
+uint32_t cartesiapp::TimestampIndex::intern(const std::string& text)
+{
+    auto it = _symbolIds.find(text);
+    if (it != _symbolIds.end()) {
+        return it->second;
+    }
+    uint32_t id = static_cast<uint32_t>(_symbols.size());
+    _symbols.push_back(text);
+    _symbolIds.emplace(_symbols.back(), id);
+    return id;
+}
+
+cartesiapp::TimestampIndex::Entry cartesiapp::TimestampIndex::entryAt(const Track& track, size_t index) const
+{
+    return Entry{ _symbols[track.symbols[index]], track.starts[index], track.ends[index] };
+}
+
+std::optional<cartesiapp::TimestampIndex::Entry> cartesiapp::TimestampIndex::lookup(const std::string& contextId,
+    Track Timeline::* track,
+    float time) const
+{
+    std::shared_lock<std::shared_mutex> lock(_mutex);
+    auto it = _timelines.find(contextId);
+    if (it == _timelines.end()) {
+        return std::nullopt;
+    }
+    const Track& timeline = it->second.*track;
+    auto index = timeline.find(time);
+    if (!index) {
+        return std::nullopt;
+    }
+    return entryAt(timeline, *index);
+}
+
+size_t cartesiapp::TimestampIndex::collect(const std::string& contextId,
+    Track Timeline::* track,
+    float from,
+    float to,
+    std::vector<Entry>& out) const
+{
+    std::shared_lock<std::shared_mutex> lock(_mutex);
+    auto it = _timelines.find(contextId);
+    if (it == _timelines.end()) {
+        return 0;
+    }
+    const Track& timeline = it->second.*track;
+    // the running maximum of ends is sorted, every entry before the first one exceeding from ends before the range
+    size_t first = std::upper_bound(timeline.maxEnds.begin(), timeline.maxEnds.end(), from) - timeline.maxEnds.begin();
+    size_t count = 0;
+    for (size_t i = first; i < timeline.starts.size() && timeline.starts[i] < to; ++i) {
+        if (timeline.ends[i] > from) {
+            out.push_back(entryAt(timeline, i));
+            ++count;
+        }
+    }
+    return count;
+}
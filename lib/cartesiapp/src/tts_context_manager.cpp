@@ -0,0 +1,34 @@
+#include "tts_context_manager.hpp"
+#include "impl/tts_context_manager_impl.hpp"
+
+cartesiapp::TTSContextManager::TTSContextManager(TTSWebsocketClient& client, size_t maxConcurrentContexts) :
+    _impl(std::make_shared<TTSContextManagerImpl>(client, maxConcurrentContexts))
+{
+    client.registerTTSListener(_impl);
+}
+
+cartesiapp::TTSContextManager::~TTSContextManager()
+{
+    // the client only holds a weak reference to the router, events arriving from now on are dropped
+}
+
+bool cartesiapp::TTSContextManager::submit(const request::tts::GenerationRequest& request,
+    std::shared_ptr<TTSResponseListener> listener)
+{
+    return _impl->submit(request, std::move(listener));
+}
+
+bool cartesiapp::TTSContextManager::cancel(const std::string& contextId)
+{
+    return _impl->cancel(contextId);
+}
+
+size_t cartesiapp::TTSContextManager::activeContexts() const
+{
+    return _impl->activeContexts();
+}
+
+size_t cartesiapp::TTSContextManager::queuedContexts() const
+{
+    return _impl->queuedContexts();
+}
@@ -0,0 +1,28 @@
+#include "tts_websocket_pool.hpp"
+#include "impl/tts_websocket_pool_impl.hpp"
+
+cartesiapp::TTSWebsocketPool::TTSWebsocketPool(const std::string& apiKey,
+    const TTSWebsocketPoolOptions& options,
+    const std::string& apiVersion) :
+    _impl(std::make_unique<TTSWebsocketPoolImpl>(apiKey, options, apiVersion))
+{
+}
+
+cartesiapp::TTSWebsocketPool::~TTSWebsocketPool()
+{
+}
+
+std::unique_ptr<cartesiapp::TTSWebsocketClient> cartesiapp::TTSWebsocketPool::acquire()
+{
+    return _impl->acquire();
+}
+
+void cartesiapp::TTSWebsocketPool::release(std::unique_ptr<TTSWebsocketClient> client)
+{
+    _impl->release(std::move(client));
+}
+
+size_t cartesiapp::TTSWebsocketPool::idleConnections() const
+{
+    return _impl->idleConnections();
+}
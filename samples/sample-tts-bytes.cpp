@@ -6,6 +6,7 @@
  * - List and filter available voices
  * - Configure TTS request with emotions and output formats
  * - Generate audio as bytes and save to file
+ * - Inspect the per-request timing breakdown
  */
 
 #include <cartesiapp/cartesiapp.hpp>
@@ -90,6 +91,23 @@ int main(int ac, char** av) {
 
     cartesiapp::Cartesia client(apiKey, apiVersion);
 
+    // Log where the time of each REST call went
+    client.setRequestTimingsCallback([](const cartesiapp::RequestTimings& timings) {
+        auto ms = [](auto from, auto to) {
+            return std::chrono::duration<double, std::milli>(to - from).count();
+            };
+        spdlog::info("{}: dns {:.1f} ms, connect {:.1f} ms, tls {:.1f} ms, upload {:.1f} ms, server {:.1f} ms, download {:.1f} ms, sent {} B, received {} B",
+            timings.endpoint,
+            ms(timings.start, timings.dns_resolved),
+            ms(timings.dns_resolved, timings.tcp_connected),
+            ms(timings.tcp_connected, timings.tls_handshake_done),
+            ms(timings.tls_handshake_done, timings.request_sent),
+            ms(timings.request_sent, timings.first_byte_received),
+            ms(timings.first_byte_received, timings.completed),
+            timings.bytes_sent,
+            timings.bytes_received);
+        });
+
     // Retrieve and display API info
     cartesiapp::response::ApiInfo apiInfo = client.getApiInfo();
     spdlog::info("API Version: {}, Status OK: {}", apiInfo.version, apiInfo.ok);
@@ -0,0 +1,212 @@
+/**
+ * @file local_server.hpp
+ * @brief Loopback TLS WebSocket server answering the streaming clients under test
+ */
+
+#ifndef CARTESIAPP_TESTS_LOCAL_SERVER_HPP
+#define CARTESIAPP_TESTS_LOCAL_SERVER_HPP
+
+#include "cartesiapp_request.hpp"
+#include "websocket_options.hpp"
+
+#include <atomic>
+#include <cstdlib>
+#include <list>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+#include <nlohmann/json.hpp>
+
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/asio/ssl.hpp>
+#include <boost/beast/core.hpp>
+#include <boost/beast/http.hpp>
+#include <boost/beast/websocket.hpp>
+#include <boost/beast/websocket/ssl.hpp>
+
+#include <openssl/evp.h>
+#include <openssl/ec.h>
+#include <openssl/x509.h>
+
+namespace cartesiapp::test {
+    /**
+     * @brief Runs one blocking session per connection on 127.0.0.1 and an ephemeral port.
+     *
+     * TTS: a generation request is answered by chunks and a done frame for its context, one chunk unless the
+     * transcript is "chunks=N". With "close" as transcript, the server then drops the TCP connection without
+     * a close frame.
+     *
+     * STT: "finalize" is answered by a flush_done frame, "done" by a done frame and a normal close.
+     */
+    class LocalServer {
+        public:
+        LocalServer() :
+            _sslContext(boost::asio::ssl::context::tls_server),
+            _acceptor(_ioContext, Tcp::endpoint(boost::asio::ip::make_address("127.0.0.1"), 0)) {
+            useSelfSignedCertificate();
+            _port = _acceptor.local_endpoint().port();
+            _acceptThread = std::thread([this]() {
+                acceptLoop();
+                });
+        }
+
+        ~LocalServer() {
+            _stopping.store(true);
+            // wakes up the blocking accept with a throwaway connection
+            try {
+                boost::asio::io_context ioContext;
+                Tcp::socket socket(ioContext);
+                socket.connect(Tcp::endpoint(boost::asio::ip::make_address("127.0.0.1"), _port));
+            }
+            catch (const std::exception&) {
+            }
+            _acceptThread.join();
+            for (auto& session : _sessions) {
+                session.join();
+            }
+        }
+
+        LocalServer(const LocalServer&) = delete;
+        LocalServer& operator=(const LocalServer&) = delete;
+
+        /**
+         * @brief Returns the options pointing a client at this server.
+         */
+        WebsocketOptions options() const {
+            WebsocketOptions options;
+            options.host = "127.0.0.1";
+            options.port = std::to_string(_port);
+            return options;
+        }
+
+        private:
+        using Tcp = boost::asio::ip::tcp;
+        using ServerWebsocket = boost::beast::websocket::stream<boost::asio::ssl::stream<Tcp::socket>>;
+
+        /**
+         * @brief Installs a freshly generated self-signed P-256 certificate, the clients do not verify it.
+         */
+        void useSelfSignedCertificate() {
+            EVP_PKEY* key = nullptr;
+            EVP_PKEY_CTX* keyContext = EVP_PKEY_CTX_new_id(EVP_PKEY_EC, nullptr);
+            if (!keyContext
+                || EVP_PKEY_keygen_init(keyContext) <= 0
+                || EVP_PKEY_CTX_set_ec_paramgen_curve_nid(keyContext, NID_X9_62_prime256v1) <= 0
+                || EVP_PKEY_keygen(keyContext, &key) <= 0) {
+                EVP_PKEY_CTX_free(keyContext);
+                throw std::runtime_error("Failed to generate the test server key");
+            }
+            EVP_PKEY_CTX_free(keyContext);
+
+            X509* certificate = X509_new();
+            ASN1_INTEGER_set(X509_get_serialNumber(certificate), 1);
+            X509_gmtime_adj(X509_getm_notBefore(certificate), 0);
+            X509_gmtime_adj(X509_getm_notAfter(certificate), 24 * 3600);
+            X509_set_pubkey(certificate, key);
+            X509_NAME* name = X509_get_subject_name(certificate);
+            X509_NAME_add_entry_by_txt(name, "CN", MBSTRING_ASC, reinterpret_cast<const unsigned char*>("localhost"), -1, -1, 0);
+            X509_set_issuer_name(certificate, name);
+            X509_sign(certificate, key, EVP_sha256());
+
+            SSL_CTX_use_certificate(_sslContext.native_handle(), certificate);
+            SSL_CTX_use_PrivateKey(_sslContext.native_handle(), key);
+            X509_free(certificate);
+            EVP_PKEY_free(key);
+        }
+
+        void acceptLoop() {
+            while (!_stopping.load()) {
+                Tcp::socket socket(_ioContext);
+                boost::beast::error_code ec;
+                _acceptor.accept(socket, ec);
+                if (ec || _stopping.load()) {
+                    break;
+                }
+                _sessions.emplace_back([this, s = std::move(socket)]() mutable {
+                    runSession(std::move(s));
+                    });
+            }
+        }
+
+        void runSession(Tcp::socket socket) {
+            boost::beast::error_code ec;
+            ServerWebsocket ws(std::move(socket), _sslContext);
+            ws.next_layer().handshake(boost::asio::ssl::stream_base::server, ec);
+            if (ec) {
+                return;
+            }
+            boost::beast::flat_buffer buffer;
+            boost::beast::http::request<boost::beast::http::string_body> upgradeRequest;
+            boost::beast::http::read(ws.next_layer(), buffer, upgradeRequest, ec);
+            if (ec) {
+                return;
+            }
+            ws.accept(upgradeRequest, ec);
+            if (ec) {
+                return;
+            }
+            bool isSTT = std::string(upgradeRequest.target()).rfind(request::constants::ENDPOINT_STT_WEBSOCKET, 0) == 0;
+
+            ws.text(true);
+            while (true) {
+                boost::beast::flat_buffer frame;
+                ws.read(frame, ec);
+                if (ec) {
+                    return;
+                }
+                std::string message = boost::beast::buffers_to_string(frame.data());
+                bool ok = isSTT ? handleSTTMessage(ws, message) : handleTTSMessage(ws, message);
+                if (!ok) {
+                    return;
+                }
+            }
+        }
+
+        static bool handleTTSMessage(ServerWebsocket& ws, const std::string& message) {
+            nlohmann::json request = nlohmann::json::parse(message, nullptr, false);
+            if (request.is_discarded() || !request.contains("transcript")) {
+                return true;
+            }
+            std::string transcript = request["transcript"];
+            std::string contextId = request.value("context_id", "");
+            int chunks = transcript.rfind("chunks=", 0) == 0 ? std::atoi(transcript.c_str() + 7) : 1;
+            std::string chunk = "{\"type\":\"chunk\",\"data\":\"AAAA\",\"done\":false,\"status_code\":206,"
+                "\"step_time\":0.5,\"context_id\":\"" + contextId + "\"}";
+            boost::beast::error_code ec;
+            for (int i = 0; i < chunks && !ec; ++i) {
+                ws.write(boost::asio::buffer(chunk), ec);
+            }
+            ws.write(boost::asio::buffer("{\"type\":\"done\",\"done\":true,\"status_code\":200,\"context_id\":\"" + contextId + "\"}"), ec);
+            if (transcript == "close") {
+                boost::beast::get_lowest_layer(ws).close(ec);
+                return false;
+            }
+            return !ec;
+        }
+
+        static bool handleSTTMessage(ServerWebsocket& ws, const std::string& message) {
+            boost::beast::error_code ec;
+            if (message == "finalize") {
+                ws.write(boost::asio::buffer(std::string("{\"type\":\"flush_done\",\"request_id\":\"test\"}")), ec);
+            }
+            else if (message == "done") {
+                ws.write(boost::asio::buffer(std::string("{\"type\":\"done\",\"request_id\":\"test\"}")), ec);
+                ws.close(boost::beast::websocket::close_code::normal, ec);
+                return false;
+            }
+            return !ec;
+        }
+
+        boost::asio::io_context _ioContext;
+        boost::asio::ssl::context _sslContext;
+        Tcp::acceptor _acceptor;
+        unsigned short _port = 0;
+        std::atomic_bool _stopping{ false };
+        std::thread _acceptThread;
+        // only touched by the accept thread until it is joined
+        std::list<std::thread> _sessions;
+    };
+}
+
+#endif // CARTESIAPP_TESTS_LOCAL_SERVER_HPP
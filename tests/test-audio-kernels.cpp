@@ -0,0 +1,241 @@
+/**
+ * @file test-audio-kernels.cpp
+ * @brief The base64 and audio energy kernels selected for this CPU against scalar references
+ */
+
+#include "impl/audio_energy.hpp"
+#include "impl/base64_decoder.hpp"
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace {
+    const std::string BASE64_ALPHABET = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+    std::string encodeBase64(const std::string& bytes, bool padded) {
+        std::string out;
+        size_t i = 0;
+        for (; i + 2 < bytes.size(); i += 3) {
+            uint32_t n = (uint32_t(uint8_t(bytes[i])) << 16) | (uint32_t(uint8_t(bytes[i + 1])) << 8) | uint8_t(bytes[i + 2]);
+            out += BASE64_ALPHABET[(n >> 18) & 63];
+            out += BASE64_ALPHABET[(n >> 12) & 63];
+            out += BASE64_ALPHABET[(n >> 6) & 63];
+            out += BASE64_ALPHABET[n & 63];
+        }
+        size_t rest = bytes.size() - i;
+        if (rest > 0) {
+            uint32_t n = uint32_t(uint8_t(bytes[i])) << 16;
+            if (rest == 2) {
+                n |= uint32_t(uint8_t(bytes[i + 1])) << 8;
+            }
+            out += BASE64_ALPHABET[(n >> 18) & 63];
+            out += BASE64_ALPHABET[(n >> 12) & 63];
+            if (rest == 2) {
+                out += BASE64_ALPHABET[(n >> 6) & 63];
+            }
+            if (padded) {
+                out.append(3 - rest, '=');
+            }
+        }
+        return out;
+    }
+
+    /**
+     * @brief Bit by bit decoder, the reference the kernels must match.
+     */
+    bool decodeBase64Scalar(const std::string& encoded, std::string& out) {
+        out.clear();
+        uint32_t bits = 0;
+        int count = 0;
+        size_t length = encoded.size();
+        while (length > 0 && encoded[length - 1] == '=') {
+            --length;
+        }
+        if (length % 4 == 1) {
+            return false;
+        }
+        for (size_t i = 0; i < length; ++i) {
+            size_t value = BASE64_ALPHABET.find(encoded[i]);
+            if (value == std::string::npos) {
+                return false;
+            }
+            bits = (bits << 6) | static_cast<uint32_t>(value);
+            count += 6;
+            if (count >= 8) {
+                count -= 8;
+                out += static_cast<char>((bits >> count) & 0xFF);
+            }
+        }
+        return true;
+    }
+
+    std::string randomBytes(std::mt19937& random, size_t size) {
+        std::uniform_int_distribution<int> byte(0, 255);
+        std::string bytes(size, '\0');
+        for (auto& c : bytes) {
+            c = static_cast<char>(byte(random));
+        }
+        return bytes;
+    }
+
+    double meanSquareS16Scalar(const std::vector<int16_t>& samples) {
+        uint64_t sum = 0;
+        for (int16_t sample : samples) {
+            sum += static_cast<uint64_t>(static_cast<int64_t>(sample) * sample);
+        }
+        return static_cast<double>(sum) / (32768.0 * 32768.0) / static_cast<double>(samples.size());
+    }
+
+    double meanSquareF32Scalar(const std::vector<float>& samples) {
+        double sum = 0.0;
+        for (float sample : samples) {
+            sum += static_cast<double>(sample) * sample;
+        }
+        return sum / static_cast<double>(samples.size());
+    }
+
+    /**
+     * @brief G.711 expansion as specified, independent of the squares table of the library.
+     */
+    int16_t expandMulaw(uint8_t code) {
+        code = static_cast<uint8_t>(~code);
+        int exponent = (code >> 4) & 0x07;
+        int magnitude = ((((code & 0x0F) << 3) + 0x84) << exponent) - 0x84;
+        return static_cast<int16_t>((code & 0x80) ? -magnitude : magnitude);
+    }
+
+    int16_t expandAlaw(uint8_t code) {
+        code ^= 0x55;
+        int exponent = (code >> 4) & 0x07;
+        int magnitude = (code & 0x0F) << 4;
+        magnitude = exponent == 0 ? magnitude + 8 : (magnitude + 0x108) << (exponent - 1);
+        return static_cast<int16_t>((code & 0x80) ? magnitude : -magnitude);
+    }
+}
+
+TEST(Base64Kernel, MatchesScalarForAllLengthsAndPadding)
+{
+    std::mt19937 random(42);
+    // covers empty input, the scalar tail alone and several whole blocks of every kernel width
+    for (size_t size = 0; size <= 200; ++size) {
+        std::string bytes = randomBytes(random, size);
+        for (bool padded : { true, false }) {
+            std::string encoded = encodeBase64(bytes, padded);
+            std::string expected;
+            ASSERT_TRUE(decodeBase64Scalar(encoded, expected));
+            ASSERT_EQ(expected, bytes);
+
+            std::string decoded;
+            ASSERT_TRUE(cartesiapp::codec::decodeBase64(encoded, decoded)) << "size " << size;
+            EXPECT_EQ(decoded, expected) << "size " << size << " with the " << cartesiapp::codec::base64KernelName() << " kernel";
+            EXPECT_EQ(cartesiapp::codec::base64DecodedSize(encoded), bytes.size());
+        }
+    }
+}
+
+TEST(Base64Kernel, WritesNoFurtherThanTheDecodedSize)
+{
+    std::mt19937 random(7);
+    std::string bytes = randomBytes(random, 97);
+    std::string encoded = encodeBase64(bytes, false);
+    std::vector<char> out(bytes.size() + 64, '\x5A');
+    ASSERT_TRUE(cartesiapp::codec::decodeBase64(encoded, out.data()));
+    EXPECT_EQ(std::string(out.data(), bytes.size()), bytes);
+    for (size_t i = bytes.size(); i < out.size(); ++i) {
+        ASSERT_EQ(out[i], '\x5A') << "byte " << i << " written past the output";
+    }
+}
+
+TEST(Base64Kernel, RejectsWhatTheScalarRejects)
+{
+    std::mt19937 random(3);
+    std::string encoded = encodeBase64(randomBytes(random, 120), true);
+    std::string decoded;
+    // an invalid character in a whole block, in the tail, and an impossible length
+    for (size_t position : { size_t(5), size_t(70), encoded.size() - 3 }) {
+        std::string corrupted = encoded;
+        corrupted[position] = '*';
+        std::string expected;
+        EXPECT_FALSE(decodeBase64Scalar(corrupted, expected));
+        EXPECT_FALSE(cartesiapp::codec::decodeBase64(corrupted, decoded)) << "invalid character at " << position;
+        EXPECT_TRUE(decoded.empty());
+    }
+    EXPECT_FALSE(cartesiapp::codec::decodeBase64(encoded.substr(0, 41), decoded));
+}
+
+TEST(AudioEnergyKernel, S16MatchesScalarIncludingFullScale)
+{
+    std::mt19937 random(11);
+    std::uniform_int_distribution<int> sample(-32768, 32767);
+    for (size_t count = 1; count <= 300; count += 7) {
+        std::vector<int16_t> samples(count);
+        for (auto& value : samples) {
+            value = static_cast<int16_t>(sample(random));
+        }
+        // the most negative sample squares to 2^30, a pair of them overflows a signed 32-bit lane
+        samples[0] = -32768;
+        samples[count / 2] = -32768;
+        double measured = cartesiapp::codec::meanSquare(cartesiapp::codec::SampleFormat::PCM_S16LE,
+            reinterpret_cast<const char*>(samples.data()), samples.size());
+        // integer sums, the kernel must be exact
+        EXPECT_EQ(measured, meanSquareS16Scalar(samples)) << count << " samples with the "
+            << cartesiapp::codec::audioEnergyKernelName() << " kernel";
+    }
+}
+
+TEST(AudioEnergyKernel, S16AcceptsUnalignedInput)
+{
+    std::vector<int16_t> samples(64, 1000);
+    std::vector<char> bytes(samples.size() * 2 + 1);
+    std::memcpy(bytes.data() + 1, samples.data(), samples.size() * 2);
+    double measured = cartesiapp::codec::meanSquare(cartesiapp::codec::SampleFormat::PCM_S16LE, bytes.data() + 1, samples.size());
+    EXPECT_EQ(measured, meanSquareS16Scalar(samples));
+}
+
+TEST(AudioEnergyKernel, F32MatchesScalar)
+{
+    std::mt19937 random(13);
+    std::uniform_real_distribution<float> sample(-1.0f, 1.0f);
+    for (size_t count = 1; count <= 300; count += 5) {
+        std::vector<float> samples(count);
+        for (auto& value : samples) {
+            value = sample(random);
+        }
+        double measured = cartesiapp::codec::meanSquare(cartesiapp::codec::SampleFormat::PCM_F32LE,
+            reinterpret_cast<const char*>(samples.data()), samples.size());
+        // summed in a different order
+        double expected = meanSquareF32Scalar(samples);
+        EXPECT_NEAR(measured, expected, expected * 1e-12) << count << " samples";
+    }
+}
+
+TEST(AudioEnergyKernel, G711MatchesExpandedSamples)
+{
+    std::vector<uint8_t> codes(256);
+    for (int code = 0; code < 256; ++code) {
+        codes[code] = static_cast<uint8_t>(code);
+    }
+    std::vector<int16_t> mulaw;
+    std::vector<int16_t> alaw;
+    for (uint8_t code : codes) {
+        mulaw.push_back(expandMulaw(code));
+        alaw.push_back(expandAlaw(code));
+    }
+    const char* data = reinterpret_cast<const char*>(codes.data());
+    EXPECT_EQ(cartesiapp::codec::meanSquare(cartesiapp::codec::SampleFormat::PCM_MULAW, data, codes.size()), meanSquareS16Scalar(mulaw));
+    EXPECT_EQ(cartesiapp::codec::meanSquare(cartesiapp::codec::SampleFormat::PCM_ALAW, data, codes.size()), meanSquareS16Scalar(alaw));
+}
+
+TEST(AudioEnergyKernel, SilenceMeasuresZero)
+{
+    std::vector<int16_t> silence(480, 0);
+    EXPECT_EQ(cartesiapp::codec::meanSquare(cartesiapp::codec::SampleFormat::PCM_S16LE,
+        reinterpret_cast<const char*>(silence.data()), silence.size()), 0.0);
+    EXPECT_EQ(cartesiapp::codec::meanSquare(cartesiapp::codec::SampleFormat::PCM_S16LE, nullptr, 0), 0.0);
+}
@@ -0,0 +1,103 @@
+/**
+ * @file test-endpoint-detector.cpp
+ * @brief Utterance start and end decisions of the endpoint detector, window by window
+ */
+
+#include "impl/stt_endpoint_detector.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace {
+    // 16 samples of pcm_s16le per 10 ms window
+    constexpr int SAMPLE_RATE = 1600;
+    constexpr size_t WINDOW_SAMPLES = 16;
+
+    // about -6 dBFS, -45 dBFS and digital silence
+    constexpr int16_t SPEECH = 16384;
+    constexpr int16_t BETWEEN = 180;
+    constexpr int16_t SILENCE = 0;
+
+    class EndpointDetectorTest : public ::testing::Test {
+        protected:
+        EndpointDetectorTest() :
+            _detector(options(), cartesiapp::codec::SampleFormat::PCM_S16LE, SAMPLE_RATE) {
+        }
+
+        static cartesiapp::STTEndpointingOptions options() {
+            cartesiapp::STTEndpointingOptions options;
+            options.enabled = true;
+            options.speech_threshold_dbfs = -40.0f;
+            options.silence_threshold_dbfs = -50.0f;
+            options.min_speech = std::chrono::milliseconds(30);
+            options.trailing_silence = std::chrono::milliseconds(50);
+            return options;
+        }
+
+        /**
+         * @brief Writes whole windows at one level, returns whether an utterance ended within them.
+         */
+        bool write(int16_t amplitude, size_t windows) {
+            std::vector<int16_t> samples(windows * WINDOW_SAMPLES, amplitude);
+            return _detector.write(reinterpret_cast<const char*>(samples.data()), samples.size() * sizeof(int16_t));
+        }
+
+        cartesiapp::STTEndpointDetector _detector;
+    };
+}
+
+TEST_F(EndpointDetectorTest, SilenceAloneEndsNothing)
+{
+    EXPECT_FALSE(write(SILENCE, 100));
+    EXPECT_FALSE(write(BETWEEN, 10));
+    EXPECT_FALSE(write(SILENCE, 100));
+}
+
+TEST_F(EndpointDetectorTest, EndsAnUtteranceOnceAfterTrailingSilence)
+{
+    EXPECT_FALSE(write(SPEECH, 3));
+    EXPECT_FALSE(write(SILENCE, 4));
+    EXPECT_TRUE(write(SILENCE, 1));
+    // the utterance is over, more silence does not end it again
+    EXPECT_FALSE(write(SILENCE, 20));
+
+    EXPECT_FALSE(write(SPEECH, 5));
+    EXPECT_TRUE(write(SILENCE, 5));
+}
+
+TEST_F(EndpointDetectorTest, StartsAnUtteranceOnlyAfterConsecutiveSpeech)
+{
+    // a click shorter than min_speech
+    EXPECT_FALSE(write(SPEECH, 2));
+    EXPECT_FALSE(write(SILENCE, 10));
+    // a window in between breaks the run of speech
+    EXPECT_FALSE(write(SPEECH, 2));
+    EXPECT_FALSE(write(BETWEEN, 1));
+    EXPECT_FALSE(write(SPEECH, 2));
+    EXPECT_FALSE(write(SILENCE, 10));
+}
+
+TEST_F(EndpointDetectorTest, WindowsInBetweenContinueAnUtteranceAndRestartTheSilence)
+{
+    EXPECT_FALSE(write(SPEECH, 3));
+    EXPECT_FALSE(write(BETWEEN, 20));
+    EXPECT_FALSE(write(SILENCE, 4));
+    EXPECT_FALSE(write(BETWEEN, 1));
+    EXPECT_FALSE(write(SILENCE, 4));
+    EXPECT_TRUE(write(SILENCE, 1));
+}
+
+TEST_F(EndpointDetectorTest, EndsOnTheByteThatCompletesTheLastWindow)
+{
+    std::vector<int16_t> samples(3 * WINDOW_SAMPLES, SPEECH);
+    samples.resize(8 * WINDOW_SAMPLES, SILENCE);
+    const char* bytes = reinterpret_cast<const char*>(samples.data());
+    size_t size = samples.size() * sizeof(int16_t);
+    for (size_t i = 0; i + 1 < size; ++i) {
+        ASSERT_FALSE(_detector.write(bytes + i, 1)) << "ended at byte " << i;
+    }
+    EXPECT_TRUE(_detector.write(bytes + size - 1, 1));
+}
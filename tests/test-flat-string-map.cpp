@@ -0,0 +1,116 @@
+/**
+ * @file test-flat-string-map.cpp
+ * @brief Lookups of the flat string map across inserts and backward-shift erases
+ */
+
+#include "impl/flat_string_map.hpp"
+
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace {
+    /**
+     * @brief Checks that the map holds exactly the entries of the reference.
+     */
+    void expectSameEntries(cartesiapp::FlatStringMap<int>& map, const std::unordered_map<std::string, int>& reference,
+        const std::vector<std::string>& keys) {
+        ASSERT_EQ(map.size(), reference.size());
+        for (const auto& key : keys) {
+            auto expected = reference.find(key);
+            int* value = map.find(key);
+            if (expected == reference.end()) {
+                EXPECT_EQ(value, nullptr) << "erased key " << key << " still found";
+            }
+            else {
+                ASSERT_NE(value, nullptr) << "key " << key << " lost";
+                EXPECT_EQ(*value, expected->second);
+            }
+        }
+        size_t visited = 0;
+        map.forEach([&](std::string_view key, int value) {
+            auto expected = reference.find(std::string(key));
+            ASSERT_NE(expected, reference.end());
+            EXPECT_EQ(value, expected->second);
+            ++visited;
+            });
+        EXPECT_EQ(visited, reference.size());
+    }
+}
+
+TEST(FlatStringMap, InsertsFindsAndReplaces)
+{
+    cartesiapp::FlatStringMap<int> map;
+    EXPECT_TRUE(map.empty());
+    EXPECT_EQ(map.find("missing"), nullptr);
+    EXPECT_FALSE(map.erase("missing"));
+
+    map.insert("context-1", 1);
+    map.insert("context-2", 2);
+    map.insert("context-1", 10);
+    EXPECT_EQ(map.size(), 2u);
+    ASSERT_NE(map.find("context-1"), nullptr);
+    EXPECT_EQ(*map.find("context-1"), 10);
+    EXPECT_EQ(*map.find(std::string_view("context-2")), 2);
+
+    map.clear();
+    EXPECT_TRUE(map.empty());
+    EXPECT_EQ(map.find("context-1"), nullptr);
+}
+
+TEST(FlatStringMap, EveryEraseKeepsTheRestReachable)
+{
+    // small enough to stay in one slot array, so erases shift entries within crowded probe runs
+    std::vector<std::string> keys;
+    for (int i = 0; i < 7; ++i) {
+        keys.push_back("ctx-" + std::to_string(i));
+    }
+    for (size_t first = 0; first < keys.size(); ++first) {
+        cartesiapp::FlatStringMap<int> map;
+        std::unordered_map<std::string, int> reference;
+        for (size_t i = 0; i < keys.size(); ++i) {
+            map.insert(keys[i], static_cast<int>(i));
+            reference[keys[i]] = static_cast<int>(i);
+        }
+        // erase starting at every position, wrapping around the key list
+        for (size_t n = 0; n < keys.size(); ++n) {
+            const std::string& key = keys[(first + n) % keys.size()];
+            ASSERT_TRUE(map.erase(key));
+            reference.erase(key);
+            expectSameEntries(map, reference, keys);
+            EXPECT_FALSE(map.erase(key));
+        }
+        EXPECT_TRUE(map.empty());
+    }
+}
+
+TEST(FlatStringMap, MatchesUnorderedMapAcrossRandomInsertsAndErases)
+{
+    std::mt19937 random(2024);
+    std::vector<std::string> keys;
+    for (int i = 0; i < 300; ++i) {
+        keys.push_back("context-" + std::to_string(i));
+    }
+    std::uniform_int_distribution<size_t> pick(0, keys.size() - 1);
+    std::uniform_int_distribution<int> action(0, 2);
+
+    cartesiapp::FlatStringMap<int> map;
+    std::unordered_map<std::string, int> reference;
+    for (int step = 0; step < 20000; ++step) {
+        const std::string& key = keys[pick(random)];
+        if (action(random) == 0) {
+            EXPECT_EQ(map.erase(key), reference.erase(key) == 1);
+        }
+        else {
+            map.insert(key, step);
+            reference[key] = step;
+        }
+        if (step % 500 == 0) {
+            expectSameEntries(map, reference, keys);
+        }
+    }
+    expectSameEntries(map, reference, keys);
+}
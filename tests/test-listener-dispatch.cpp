@@ -0,0 +1,237 @@
+/**
+ * @file test-listener-dispatch.cpp
+ * @brief Streaming clients destroyed by their own listener while its callbacks are dispatched
+ */
+
+#include "local_server.hpp"
+
+#include "streaming_stt.hpp"
+#include "streaming_tts.hpp"
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include <gtest/gtest.h>
+
+namespace {
+    /**
+     * @brief Executor running the dispatch tasks on one application thread, joined on destruction.
+     */
+    class WorkerExecutor {
+        public:
+        WorkerExecutor() :
+            _thread([this]() {
+                run();
+            }) {
+        }
+
+        ~WorkerExecutor() {
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+                _stopping = true;
+            }
+            _wakeUp.notify_one();
+            _thread.join();
+        }
+
+        void post(std::function<void()> task) {
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+                _tasks.push_back(std::move(task));
+            }
+            _wakeUp.notify_one();
+        }
+
+        private:
+        void run() {
+            std::unique_lock<std::mutex> lock(_mutex);
+            while (true) {
+                _wakeUp.wait(lock, [this]() {
+                    return _stopping || !_tasks.empty();
+                    });
+                if (_tasks.empty()) {
+                    return;
+                }
+                auto task = std::move(_tasks.front());
+                _tasks.pop_front();
+                lock.unlock();
+                task();
+                lock.lock();
+            }
+        }
+
+        std::mutex _mutex;
+        std::condition_variable _wakeUp;
+        std::deque<std::function<void()>> _tasks;
+        bool _stopping = false;
+        std::thread _thread;
+    };
+
+    /**
+     * @brief Destroys its client from the first audio chunk, while more frames are still on their way.
+     */
+    class DestroyingTTSListener : public cartesiapp::TTSResponseListener {
+        public:
+        explicit DestroyingTTSListener(std::unique_ptr<cartesiapp::TTSWebsocketClient>& client) : _client(client) {
+        }
+
+        std::future<void> destroyed() {
+            return _destroyed.get_future();
+        }
+
+        /**
+         * @brief Called once the request call returned, the client must not be destroyed while it is in use.
+         */
+        void requestSent() {
+            _requestSent.set_value();
+        }
+
+        void onConnected() override {
+        }
+        void onDisconnected(const std::string&) override {
+        }
+        void onNetworkError(const std::string&) override {
+        }
+        void onAudioChunkView(const cartesiapp::response::tts::AudioChunkView&) override {
+            if (!_client) {
+                return;
+            }
+            _requestSent.get_future().wait();
+            // lets the reader fill the queue behind this chunk
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+            _client.reset();
+            _destroyed.set_value();
+        }
+        void onAudioChunkReceived(const cartesiapp::response::tts::AudioChunkResponse&) override {
+        }
+        void onDoneReceived(const cartesiapp::response::tts::DoneResponse&) override {
+        }
+        void onWordTimestampsReceived(const cartesiapp::response::tts::WordTimestampsResponse&) override {
+        }
+        void onPhonemeTimestampsReceived(const cartesiapp::response::tts::PhonemeTimestampsResponse&) override {
+        }
+        void onFlushDoneReceived(const cartesiapp::response::tts::FlushDoneResponse&) override {
+        }
+        void onError(const cartesiapp::response::tts::ErrorResponse&) override {
+        }
+
+        private:
+        // only touched by the dispatcher until destroyed() is ready
+        std::unique_ptr<cartesiapp::TTSWebsocketClient>& _client;
+        std::promise<void> _destroyed;
+        std::promise<void> _requestSent;
+    };
+
+    /**
+     * @brief Destroys its client from the flush_done answering a finalize request.
+     */
+    class DestroyingSTTListener : public cartesiapp::STTResponseListener {
+        public:
+        explicit DestroyingSTTListener(std::unique_ptr<cartesiapp::STTWebsocketClient>& client) : _client(client) {
+        }
+
+        std::future<void> destroyed() {
+            return _destroyed.get_future();
+        }
+
+        /**
+         * @brief Called once the request call returned, the client must not be destroyed while it is in use.
+         */
+        void requestSent() {
+            _requestSent.set_value();
+        }
+
+        void onConnected() override {
+        }
+        void onDisconnected(const std::string&) override {
+        }
+        void onNetworkError(const std::string&) override {
+        }
+        void onTranscriptionReceived(const cartesiapp::response::stt::TranscriptionResponse&) override {
+        }
+        void onDoneReceived(const cartesiapp::response::stt::DoneResponse&) override {
+        }
+        void onFlushDoneReceived(const cartesiapp::response::stt::FlushDoneResponse&) override {
+            _requestSent.get_future().wait();
+            _client.reset();
+            _destroyed.set_value();
+        }
+        void onError(const cartesiapp::response::stt::ErrorResponse&) override {
+        }
+
+        private:
+        std::unique_ptr<cartesiapp::STTWebsocketClient>& _client;
+        std::promise<void> _destroyed;
+        std::promise<void> _requestSent;
+    };
+
+    cartesiapp::ListenerDispatchOptions blockingDispatch() {
+        cartesiapp::ListenerDispatchOptions options;
+        options.enabled = true;
+        options.queue_capacity = 2;
+        options.overflow_policy = cartesiapp::DispatchOverflowPolicy::BLOCK;
+        return options;
+    }
+
+    /**
+     * @brief Requests a stream of chunks and waits for the listener to destroy the client from the first one.
+     */
+    void destroyTTSClientFromChunk(const cartesiapp::test::LocalServer& server, const cartesiapp::ListenerDispatchOptions& dispatch) {
+        auto client = std::make_unique<cartesiapp::TTSWebsocketClient>("test-api-key");
+        auto listener = std::make_shared<DestroyingTTSListener>(client);
+        auto destroyed = listener->destroyed();
+        client->setWebsocketOptions(server.options());
+        client->setListenerDispatchOptions(dispatch);
+        client->registerTTSListener(listener);
+        ASSERT_TRUE(client->connectAndStart());
+
+        cartesiapp::request::tts::GenerationRequest request;
+        request.context_id = "context";
+        request.transcript = "chunks=50";
+        ASSERT_TRUE(client->requestTTS(request));
+        listener->requestSent();
+        ASSERT_EQ(destroyed.wait_for(std::chrono::seconds(10)), std::future_status::ready);
+        EXPECT_EQ(client, nullptr);
+    }
+}
+
+TEST(ListenerDispatch, TTSClientDestroyedFromItsDispatcherThread)
+{
+    cartesiapp::test::LocalServer server;
+    destroyTTSClientFromChunk(server, blockingDispatch());
+}
+
+TEST(ListenerDispatch, TTSClientDestroyedFromItsExecutor)
+{
+    cartesiapp::test::LocalServer server;
+    WorkerExecutor executor;
+    auto dispatch = blockingDispatch();
+    dispatch.executor = [&executor](std::function<void()> task) {
+        executor.post(std::move(task));
+        };
+    destroyTTSClientFromChunk(server, dispatch);
+}
+
+TEST(ListenerDispatch, STTClientDestroyedFromItsDispatcherThread)
+{
+    cartesiapp::test::LocalServer server;
+    auto client = std::make_unique<cartesiapp::STTWebsocketClient>("test-api-key", "ink-whisper", "en", "pcm_s16le", 16000, 0.0f);
+    auto listener = std::make_shared<DestroyingSTTListener>(client);
+    auto destroyed = listener->destroyed();
+    client->setWebsocketOptions(server.options());
+    client->setListenerDispatchOptions(blockingDispatch());
+    client->registerSTTListener(listener);
+    ASSERT_TRUE(client->connectAndStart());
+
+    ASSERT_TRUE(client->sendFinalizeRequest());
+    listener->requestSent();
+    ASSERT_EQ(destroyed.wait_for(std::chrono::seconds(10)), std::future_status::ready);
+    EXPECT_EQ(client, nullptr);
+}
@@ -0,0 +1,169 @@
+/**
+ * @file test-queues.cpp
+ * @brief The MPSC outbound queue of a connection and the SPSC ring of the event queues
+ */
+
+#include "impl/mpsc_queue.hpp"
+#include "event_queue.hpp"
+
+#include <chrono>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+TEST(MpscQueue, KeepsFifoOrder)
+{
+    cartesiapp::MpscQueue<std::string> queue;
+    EXPECT_EQ(queue.front(), nullptr);
+    queue.push("a");
+    queue.push("b");
+    queue.push("c");
+    ASSERT_NE(queue.front(), nullptr);
+    EXPECT_EQ(*queue.front(), "a");
+
+    std::string item;
+    ASSERT_TRUE(queue.pop(item));
+    EXPECT_EQ(item, "a");
+    ASSERT_TRUE(queue.pop());
+    ASSERT_TRUE(queue.pop(item));
+    EXPECT_EQ(item, "c");
+    EXPECT_FALSE(queue.pop(item));
+    EXPECT_EQ(queue.front(), nullptr);
+}
+
+TEST(MpscQueue, DeliversEveryItemOfConcurrentProducersInTheirOrder)
+{
+    constexpr int PRODUCERS = 4;
+    constexpr int ITEMS = 10000;
+    cartesiapp::MpscQueue<std::pair<int, int>> queue;
+    std::vector<std::thread> producers;
+    for (int producer = 0; producer < PRODUCERS; ++producer) {
+        producers.emplace_back([&queue, producer]() {
+            for (int i = 0; i < ITEMS; ++i) {
+                queue.push({ producer, i });
+            }
+            });
+    }
+
+    std::vector<int> next(PRODUCERS, 0);
+    int received = 0;
+    while (received < PRODUCERS * ITEMS) {
+        std::pair<int, int> item;
+        if (!queue.pop(item)) {
+            // a push in progress is not ready yet
+            std::this_thread::yield();
+            continue;
+        }
+        ASSERT_EQ(item.second, next[item.first]) << "producer " << item.first << " out of order";
+        ++next[item.first];
+        ++received;
+    }
+    for (auto& producer : producers) {
+        producer.join();
+    }
+    std::pair<int, int> item;
+    EXPECT_FALSE(queue.pop(item));
+}
+
+TEST(EventRing, RoundsTheCapacityUpAndDropsWhenFull)
+{
+    cartesiapp::EventRing<int> ring(5);
+    EXPECT_EQ(ring.capacity(), 8u);
+    for (int i = 0; i < 8; ++i) {
+        EXPECT_TRUE(ring.tryPush([i](int& slot) { slot = i; }));
+    }
+    EXPECT_FALSE(ring.tryPush([](int& slot) { slot = 99; }));
+    EXPECT_EQ(ring.droppedEvents(), 1u);
+    EXPECT_EQ(ring.size(), 8u);
+
+    int event = -1;
+    for (int i = 0; i < 8; ++i) {
+        ASSERT_TRUE(ring.tryPop(event));
+        EXPECT_EQ(event, i);
+    }
+    EXPECT_FALSE(ring.tryPop(event));
+}
+
+TEST(EventRing, KeepsReservedSlotsForReservedEvents)
+{
+    cartesiapp::EventRing<int> ring(4, 4);
+    EXPECT_EQ(ring.capacity(), 8u);
+    int pushed = 0;
+    while (ring.tryPush([pushed](int& slot) { slot = pushed; })) {
+        ++pushed;
+    }
+    // ordinary events leave the reserved slots free
+    EXPECT_EQ(pushed, 4);
+    for (int i = 0; i < 4; ++i) {
+        EXPECT_TRUE(ring.tryPush([i](int& slot) { slot = 100 + i; }, true));
+    }
+    EXPECT_FALSE(ring.tryPush([](int& slot) { slot = 200; }, true));
+    EXPECT_EQ(ring.droppedEvents(), 2u);
+
+    std::vector<int> events;
+    ring.drain([&events](int& event) {
+        events.push_back(event);
+        });
+    EXPECT_EQ(events, (std::vector<int>{ 0, 1, 2, 3, 100, 101, 102, 103 }));
+}
+
+TEST(EventRing, WrapsAroundAndReusesSlots)
+{
+    cartesiapp::EventRing<std::string> ring(4);
+    for (int round = 0; round < 10; ++round) {
+        std::vector<std::string> expected;
+        for (int i = 0; i < 4; ++i) {
+            expected.push_back(std::to_string(round * 4 + i));
+            ASSERT_TRUE(ring.tryPush([round, &expected](std::string& slot) {
+                // the slot still holds the event it carried a lap ago
+                EXPECT_EQ(slot.empty(), round == 0);
+                slot = expected.back();
+                }));
+        }
+        // copied out, not moved, so the slots keep their events
+        std::vector<std::string> events;
+        auto copy = [&events](std::string& event) {
+            events.push_back(event);
+            };
+        EXPECT_EQ(ring.drain(copy, 3), 3u);
+        EXPECT_EQ(ring.drain(copy), 1u);
+        EXPECT_EQ(events, expected);
+        EXPECT_EQ(ring.size(), 0u);
+    }
+}
+
+TEST(EventRing, DrainCountsAThrowingEventAsConsumed)
+{
+    cartesiapp::EventRing<int> ring(4);
+    for (int i = 0; i < 3; ++i) {
+        ring.tryPush([i](int& slot) { slot = i; });
+    }
+    EXPECT_THROW(ring.drain([](int& event) {
+        if (event == 1) {
+            throw std::runtime_error("listener failed");
+        }
+        }), std::runtime_error);
+    int event = -1;
+    ASSERT_TRUE(ring.tryPop(event));
+    EXPECT_EQ(event, 2);
+}
+
+TEST(EventRing, PopForWaitsForTheProducer)
+{
+    cartesiapp::EventRing<int> ring(4);
+    int event = -1;
+    EXPECT_FALSE(ring.popFor(event, std::chrono::milliseconds(1)));
+
+    std::thread producer([&ring]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        ring.tryPush([](int& slot) { slot = 42; });
+        });
+    EXPECT_TRUE(ring.popFor(event, std::chrono::seconds(10)));
+    EXPECT_EQ(event, 42);
+    producer.join();
+}
@@ -0,0 +1,204 @@
+/**
+ * @file test-replay-buffer.cpp
+ * @brief The audio replay buffer, and acknowledgement and replay by the STT session recovery
+ */
+
+#include "impl/stt_session_recovery.hpp"
+
+#include <chrono>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace {
+    std::string spansOf(const cartesiapp::AudioReplayBuffer& buffer, uint64_t from, uint64_t to) {
+        std::string bytes;
+        buffer.forEachSpanBetween(from, to, [&bytes](const char* data, size_t size) {
+            bytes.append(data, size);
+            });
+        return bytes;
+    }
+
+    cartesiapp::response::stt::TranscriptionResponse finalTranscript(float duration, std::vector<std::pair<float, float>> words = {}) {
+        cartesiapp::response::stt::TranscriptionResponse transcript;
+        transcript.type = "transcript";
+        transcript.is_final = true;
+        transcript.duration = duration;
+        for (const auto& word : words) {
+            transcript.words.push_back({ "word", word.first, word.second });
+        }
+        return transcript;
+    }
+
+    /**
+     * @brief Records what a recovery sends, in order, and lets the test decide when a reconnect succeeds.
+     */
+    class FakeConnection {
+        public:
+        bool send(const char* data, size_t size) {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _log.push_back("audio:" + std::string(data, size));
+            return true;
+        }
+
+        bool sendText(const std::string& text) {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _log.push_back("text:" + text);
+            return true;
+        }
+
+        /**
+         * @brief Returns what was sent since the last call.
+         */
+        std::vector<std::string> takeLog() {
+            std::lock_guard<std::mutex> lock(_mutex);
+            std::vector<std::string> log;
+            log.swap(_log);
+            return log;
+        }
+
+        private:
+        std::mutex _mutex;
+        std::vector<std::string> _log;
+    };
+
+    class RecoveryTest : public ::testing::Test {
+        protected:
+        void SetUp() override {
+            cartesiapp::STTReconnectOptions options;
+            options.enabled = true;
+            options.initial_backoff = std::chrono::milliseconds(1);
+            options.replay_buffer_bytes = 64;
+            // 64 one-byte samples per second, a byte lasts 1/64 s which floats hold exactly
+            _recovery = std::make_unique<cartesiapp::STTSessionRecovery>(options, 64, 1,
+                [this]() {
+                    return _connectResult.get();
+                },
+                [this](const char* data, size_t size) {
+                    return _connection.send(data, size);
+                },
+                [this](const std::string& text) {
+                    return _connection.sendText(text);
+                },
+                nullptr,
+                [this]() {
+                    _reconnected.set_value();
+                },
+                nullptr);
+            _recovery->connected();
+        }
+
+        /**
+         * @brief Drops the connection, runs `whileDown` before the reconnect succeeds, and waits for the replay.
+         */
+        template <typename Function>
+        void dropAndReconnect(Function&& whileDown) {
+            std::promise<bool> allowConnect;
+            _connectResult = allowConnect.get_future().share();
+            _reconnected = std::promise<void>();
+            std::future<void> reconnected = _reconnected.get_future();
+            ASSERT_TRUE(_recovery->connectionLost("dropped"));
+            whileDown();
+            allowConnect.set_value(true);
+            ASSERT_EQ(reconnected.wait_for(std::chrono::seconds(10)), std::future_status::ready);
+        }
+
+        FakeConnection _connection;
+        // read by the recovery thread once connectionLost() woke it
+        std::shared_future<bool> _connectResult;
+        std::promise<void> _reconnected;
+        std::unique_ptr<cartesiapp::STTSessionRecovery> _recovery;
+    };
+}
+
+TEST(AudioReplayBuffer, WrapsAndDropsTheOldestBytesOnceFull)
+{
+    cartesiapp::AudioReplayBuffer buffer(8);
+    buffer.append("abcdef", 6);
+    buffer.append("ghij", 4);
+    EXPECT_EQ(buffer.begin(), 2u);
+    EXPECT_EQ(buffer.end(), 10u);
+    EXPECT_EQ(spansOf(buffer, 0, 100), "cdefghij");
+
+    // larger than the capacity, only the newest bytes are kept
+    buffer.append("0123456789AB", 12);
+    EXPECT_EQ(buffer.begin(), 14u);
+    EXPECT_EQ(buffer.end(), 22u);
+    EXPECT_EQ(spansOf(buffer, 0, 22), "456789AB");
+}
+
+TEST(AudioReplayBuffer, DiscardsAcknowledgedBytesAndReplaysRanges)
+{
+    cartesiapp::AudioReplayBuffer buffer(16);
+    buffer.append("0123456789", 10);
+    buffer.discardUntil(4);
+    EXPECT_EQ(buffer.begin(), 4u);
+    EXPECT_EQ(spansOf(buffer, 0, 7), "456");
+    EXPECT_EQ(spansOf(buffer, 6, 100), "6789");
+    // acknowledgements never move backwards or past the end
+    buffer.discardUntil(2);
+    EXPECT_EQ(buffer.begin(), 4u);
+    buffer.discardUntil(50);
+    EXPECT_EQ(buffer.begin(), 10u);
+    EXPECT_EQ(spansOf(buffer, 0, 100), "");
+
+    buffer.append("abcdefghijkl", 12);
+    // the range crosses the end of the ring
+    EXPECT_EQ(spansOf(buffer, 12, 22), "cdefghijkl");
+}
+
+TEST_F(RecoveryTest, ReplaysUnacknowledgedAudioWithPendingFinalizeInPlace)
+{
+    EXPECT_TRUE(_recovery->write("0123456789", 10));
+    // covers the first 4 bytes
+    auto transcript = finalTranscript(0.0625f);
+    _recovery->onTranscript(transcript);
+    EXPECT_TRUE(_recovery->sendText("finalize", false));
+    EXPECT_TRUE(_recovery->write("abc", 3));
+    EXPECT_EQ(_connection.takeLog(), (std::vector<std::string>{ "audio:0123456789", "text:finalize", "audio:abc" }));
+
+    dropAndReconnect([this]() {
+        // buffered while the connection is down, sent with the backlog
+        EXPECT_TRUE(_recovery->write("XY", 2));
+        });
+    EXPECT_EQ(_connection.takeLog(), (std::vector<std::string>{ "audio:456789", "text:finalize", "audio:abcXY" }));
+
+    // the new connection starts at byte 4, its timings move 4 bytes later, and it acknowledges byte 4
+    auto shifted = finalTranscript(0.015625f, { { 0.0f, 0.015625f } });
+    _recovery->onTranscript(shifted);
+    ASSERT_EQ(shifted.words.size(), 1u);
+    EXPECT_EQ(shifted.words[0].start, 0.0625f);
+    EXPECT_EQ(shifted.words[0].end, 0.078125f);
+
+    // flush_done acknowledges the finalize, it is not replayed again
+    _recovery->onFlushDone();
+    dropAndReconnect([]() {
+        });
+    EXPECT_EQ(_connection.takeLog(), (std::vector<std::string>{ "audio:56789abcXY" }));
+}
+
+TEST_F(RecoveryTest, EndsTheSessionOnceDoneReachedTheConnection)
+{
+    EXPECT_TRUE(_recovery->write("0123", 4));
+    EXPECT_TRUE(_recovery->sendText("done", true));
+    EXPECT_EQ(_connection.takeLog(), (std::vector<std::string>{ "audio:0123", "text:done" }));
+    // the server closes after done, that is not a drop to recover from
+    EXPECT_FALSE(_recovery->connectionLost("closed"));
+}
+
+TEST_F(RecoveryTest, DoneWrittenDuringAnOutageIsReplayedAfterTheAudio)
+{
+    EXPECT_TRUE(_recovery->write("0123", 4));
+    _connection.takeLog();
+    dropAndReconnect([this]() {
+        EXPECT_TRUE(_recovery->write("45", 2));
+        EXPECT_TRUE(_recovery->sendText("done", true));
+        });
+    EXPECT_EQ(_connection.takeLog(), (std::vector<std::string>{ "audio:012345", "text:done" }));
+    EXPECT_FALSE(_recovery->connectionLost("closed"));
+}
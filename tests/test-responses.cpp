@@ -0,0 +1,76 @@
+/**
+ * @file test-responses.cpp
+ * @brief Decoding of public responses through fromJson and the std::vector compatibility accessor
+ */
+
+#include <cartesiapp/cartesiapp_response.hpp>
+#include "impl/frame_decoder.hpp"
+
+#include <memory_resource>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include <nlohmann/json.hpp>
+
+TEST(Responses, ToStdVectorCopiesOutOfTheMemoryResource)
+{
+    std::pmr::monotonic_buffer_resource arena;
+    cartesiapp::response::stt::TranscriptionResponse transcript(&arena);
+    transcript.words.push_back({ "hello", 0.0f, 0.5f });
+    transcript.words.push_back({ "world", 0.5f, 1.0f });
+    EXPECT_EQ(transcript.words.get_allocator().resource(), &arena);
+
+    std::vector<cartesiapp::response::stt::WordTiming> words = cartesiapp::response::toStdVector(transcript.words);
+    ASSERT_EQ(words.size(), 2u);
+    EXPECT_EQ(words[0].word, "hello");
+    EXPECT_EQ(words[1].word, "world");
+    EXPECT_EQ(words[1].end, 1.0f);
+}
+
+TEST(Responses, TranscriptWithoutWordsHasNone)
+{
+    auto transcript = cartesiapp::response::stt::TranscriptionResponse::fromJson(
+        R"({"type":"transcript","text":"hel","duration":0.5,"is_final":false,"request_id":"r"})");
+    EXPECT_EQ(transcript.text, "hel");
+    EXPECT_FALSE(transcript.is_final);
+    EXPECT_TRUE(transcript.words.empty());
+
+    transcript = cartesiapp::response::stt::TranscriptionResponse::fromJson(
+        R"({"type":"transcript","text":"hel","duration":0.5,"is_final":false,"request_id":"r","words":null})");
+    EXPECT_TRUE(transcript.words.empty());
+
+    transcript = cartesiapp::response::stt::TranscriptionResponse::fromJson(
+        R"({"type":"transcript","text":"hello","duration":0.5,"is_final":true,"request_id":"r","words":[{"word":"hello","start":0.0,"end":0.5}]})");
+    ASSERT_EQ(transcript.words.size(), 1u);
+    EXPECT_EQ(transcript.words[0].word, "hello");
+}
+
+TEST(Responses, TranscriptStillRequiresItsScalarFields)
+{
+    EXPECT_THROW(cartesiapp::response::stt::TranscriptionResponse::fromJson(
+        R"({"type":"transcript","duration":0.5,"is_final":false,"request_id":"r"})"), nlohmann::json::exception);
+}
+
+TEST(Responses, FrameDecoderAcceptsTranscriptsWithoutWords)
+{
+    cartesiapp::FrameDecoder decoder;
+    cartesiapp::response::stt::TranscriptionResponse transcript;
+    decoder.decodeTranscription(R"({"type":"transcript","text":"a b","duration":1.0,"is_final":true,"request_id":"r","words":[{"word":"a","start":0.0,"end":0.5}]})", transcript);
+    ASSERT_EQ(transcript.words.size(), 1u);
+    // a reused response loses the words of the previous frame
+    decoder.decodeTranscription(R"({"type":"transcript","text":"c","duration":0.2,"is_final":false,"request_id":"r"})", transcript);
+    EXPECT_EQ(transcript.text, "c");
+    EXPECT_TRUE(transcript.words.empty());
+}
+
+TEST(Responses, WordTimestampsWithoutListsAreEmpty)
+{
+    auto timestamps = cartesiapp::response::tts::WordTimestampsResponse::fromJson(
+        R"({"type":"timestamps","done":false,"status_code":206,"context_id":"ctx"})");
+    EXPECT_EQ(timestamps.context_id, "ctx");
+    EXPECT_TRUE(timestamps.word_timestamps.empty());
+
+    auto page = cartesiapp::response::VoiceListPage::fromJson(R"({"has_more":false})");
+    EXPECT_TRUE(page.voices.empty());
+}
@@ -0,0 +1,136 @@
+/**
+ * @file test-silence-suppressor.cpp
+ * @brief What the silence suppressor forwards and how it restores word timings onto the written audio
+ */
+
+#include "impl/stt_silence_suppressor.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace {
+    // 16 samples of pcm_s16le per 10 ms window, 32 bytes, 3200 bytes per second
+    constexpr int SAMPLE_RATE = 1600;
+
+    std::vector<char> audioOf(int16_t amplitude, std::chrono::milliseconds duration) {
+        std::vector<int16_t> samples(static_cast<size_t>(SAMPLE_RATE * duration.count() / 1000), amplitude);
+        const char* bytes = reinterpret_cast<const char*>(samples.data());
+        return std::vector<char>(bytes, bytes + samples.size() * sizeof(int16_t));
+    }
+
+    class SilenceSuppressorTest : public ::testing::Test {
+        protected:
+        SilenceSuppressorTest() :
+            _suppressor(options(), cartesiapp::codec::SampleFormat::PCM_S16LE, SAMPLE_RATE,
+                [this](const char* /*data*/, size_t size) {
+                    _forwarded += size;
+                    return true;
+                }) {
+        }
+
+        static cartesiapp::STTSilenceSuppressionOptions options() {
+            cartesiapp::STTSilenceSuppressionOptions options;
+            options.enabled = true;
+            options.hangover = std::chrono::milliseconds(30);
+            options.pre_roll = std::chrono::milliseconds(20);
+            return options;
+        }
+
+        void write(int16_t amplitude, std::chrono::milliseconds duration) {
+            auto audio = audioOf(amplitude, duration);
+            ASSERT_TRUE(_suppressor.write(audio.data(), audio.size()));
+        }
+
+        /**
+         * @brief Restores a transcript holding one word at the given forwarded timings, returns the restored ones.
+         */
+        std::pair<float, float> restore(float start, float end, bool isFinal = false, float duration = 0.0f) {
+            cartesiapp::response::stt::TranscriptionResponse transcript;
+            transcript.type = "transcript";
+            transcript.is_final = isFinal;
+            transcript.duration = duration;
+            transcript.words.push_back({ "word", start, end });
+            _suppressor.restoreTimings(transcript);
+            return { transcript.words[0].start, transcript.words[0].end };
+        }
+
+        static constexpr int16_t SPEECH = 16384;
+        static constexpr int16_t SILENCE = 0;
+
+        size_t _forwarded = 0;
+        cartesiapp::STTSilenceSuppressor _suppressor;
+    };
+}
+
+TEST_F(SilenceSuppressorTest, ForwardsShortSilencesInFull)
+{
+    write(SPEECH, std::chrono::milliseconds(100));
+    // no longer than hangover plus pre-roll
+    write(SILENCE, std::chrono::milliseconds(50));
+    write(SPEECH, std::chrono::milliseconds(100));
+    EXPECT_EQ(_forwarded, 800u);
+    EXPECT_EQ(_suppressor.stats().bytes_suppressed, 0u);
+
+    auto word = restore(0.15f, 0.2f);
+    EXPECT_EQ(word.first, 0.15f);
+    EXPECT_EQ(word.second, 0.2f);
+}
+
+TEST_F(SilenceSuppressorTest, MovesTimingsAfterADroppedSilence)
+{
+    write(SPEECH, std::chrono::milliseconds(100));
+    write(SILENCE, std::chrono::milliseconds(500));
+    write(SPEECH, std::chrono::milliseconds(100));
+    // 30 ms of hangover and 20 ms of pre-roll are kept, the other 450 ms are dropped
+    EXPECT_EQ(_forwarded, 320u + 96u + 64u + 320u);
+    auto stats = _suppressor.stats();
+    EXPECT_EQ(stats.bytes_suppressed, 1440u);
+    EXPECT_DOUBLE_EQ(stats.seconds_suppressed, 0.45);
+
+    // before the cut, timings stay
+    auto word = restore(0.0f, 0.1f);
+    EXPECT_EQ(word.first, 0.0f);
+    EXPECT_EQ(word.second, 0.1f);
+    // the second utterance starts 150 ms into the forwarded audio and 600 ms into the written one
+    word = restore(0.15f, 0.2f);
+    EXPECT_NEAR(word.first, 0.6f, 1e-5);
+    EXPECT_NEAR(word.second, 0.65f, 1e-5);
+}
+
+TEST_F(SilenceSuppressorTest, KeepsRestoringAfterAcknowledgedGapsArePruned)
+{
+    for (int utterance = 0; utterance < 3; ++utterance) {
+        write(SPEECH, std::chrono::milliseconds(100));
+        if (utterance < 2) {
+            write(SILENCE, std::chrono::milliseconds(500));
+        }
+    }
+    EXPECT_EQ(_suppressor.stats().bytes_suppressed, 2880u);
+
+    // acknowledges the forwarded audio up to the third utterance, which forgets the first gap
+    auto word = restore(0.15f, 0.2f, true, 0.3f);
+    EXPECT_NEAR(word.first, 0.6f, 1e-5);
+    EXPECT_NEAR(word.second, 0.65f, 1e-5);
+    // the third utterance starts 300 ms into the forwarded audio, after 900 ms were dropped in both gaps
+    word = restore(0.3f, 0.35f);
+    EXPECT_NEAR(word.first, 1.2f, 1e-5);
+    EXPECT_NEAR(word.second, 1.25f, 1e-5);
+    word = restore(0.35f, 0.4f, true, 0.1f);
+    EXPECT_NEAR(word.first, 1.25f, 1e-5);
+    EXPECT_NEAR(word.second, 1.3f, 1e-5);
+}
+
+TEST_F(SilenceSuppressorTest, FlushForwardsThePartialWindowOfSpeech)
+{
+    auto audio = audioOf(SPEECH, std::chrono::milliseconds(100));
+    // a window and a half
+    ASSERT_TRUE(_suppressor.write(audio.data(), 48));
+    EXPECT_EQ(_forwarded, 32u);
+    ASSERT_TRUE(_suppressor.flush());
+    EXPECT_EQ(_forwarded, 48u);
+}
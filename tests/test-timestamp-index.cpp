@@ -0,0 +1,138 @@
+/**
+ * @file test-timestamp-index.cpp
+ * @brief Point and range queries of the timestamp index over overlapping timings
+ */
+
+#include <cartesiapp/timestamp_index.hpp>
+
+#include <optional>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace {
+    struct Timing {
+        std::string text;
+        float start;
+        float end;
+    };
+
+    cartesiapp::response::tts::WordTimestampsResponse wordsOf(const std::string& contextId, const std::vector<Timing>& timings) {
+        cartesiapp::response::tts::WordTimestampsResponse response;
+        response.context_id = contextId;
+        cartesiapp::response::tts::WordTimestampsResponse::WordTimestamps timestamps;
+        for (const auto& timing : timings) {
+            timestamps.words.push_back(timing.text);
+            timestamps.start.push_back(timing.start);
+            timestamps.end.push_back(timing.end);
+        }
+        response.word_timestamps.push_back(std::move(timestamps));
+        return response;
+    }
+
+    /**
+     * @brief The latest starting timing covering the time, by a linear scan.
+     */
+    std::optional<Timing> timingAt(const std::vector<Timing>& timings, float time) {
+        std::optional<Timing> found;
+        for (const auto& timing : timings) {
+            if (timing.start <= time && time < timing.end && (!found || timing.start >= found->start)) {
+                found = timing;
+            }
+        }
+        return found;
+    }
+}
+
+TEST(TimestampIndex, FindsALongEarlierWordUnderShortLaterOnes)
+{
+    cartesiapp::TimestampIndex index;
+    index.addWords(wordsOf("ctx", { { "long", 0.0f, 10.0f }, { "a", 1.0f, 1.5f }, { "b", 2.0f, 2.5f } }));
+
+    auto word = index.wordAt("ctx", 1.25f);
+    ASSERT_TRUE(word);
+    EXPECT_EQ(word->text, "a");
+    // the latest start no longer covers the time, the long word still does
+    word = index.wordAt("ctx", 3.0f);
+    ASSERT_TRUE(word);
+    EXPECT_EQ(word->text, "long");
+    EXPECT_FALSE(index.wordAt("ctx", 10.0f));
+    EXPECT_FALSE(index.wordAt("other", 1.0f));
+
+    std::vector<cartesiapp::TimestampIndex::Entry> entries;
+    EXPECT_EQ(index.wordsInRange("ctx", 2.75f, 4.0f, entries), 1u);
+    ASSERT_EQ(entries.size(), 1u);
+    EXPECT_EQ(entries[0].text, "long");
+}
+
+TEST(TimestampIndex, MatchesLinearScanOverRandomOverlappingTimings)
+{
+    std::mt19937 random(99);
+    // quarter seconds are exact in float, so the reference compares the same values
+    std::uniform_int_distribution<int> quarter(0, 400);
+    std::uniform_int_distribution<int> length(1, 40);
+    std::vector<Timing> timings;
+    cartesiapp::TimestampIndex index;
+    for (int batch = 0; batch < 20; ++batch) {
+        std::vector<Timing> events;
+        for (int i = 0; i < 10; ++i) {
+            // starts are not sorted across batches, some arrive out of order
+            float start = static_cast<float>(quarter(random)) / 4.0f;
+            float end = start + static_cast<float>(length(random)) / 4.0f;
+            events.push_back({ "w" + std::to_string(timings.size() + events.size()), start, end });
+        }
+        index.addWords(wordsOf("ctx", events));
+        timings.insert(timings.end(), events.begin(), events.end());
+    }
+
+    for (int step = 0; step <= 440 * 2; ++step) {
+        float time = static_cast<float>(step) / 8.0f;
+        auto expected = timingAt(timings, time);
+        auto word = index.wordAt("ctx", time);
+        ASSERT_EQ(word.has_value(), expected.has_value()) << "at " << time;
+        if (word) {
+            // ties between equal starts may resolve to either entry
+            EXPECT_EQ(word->start, expected->start) << "at " << time;
+            EXPECT_TRUE(word->start <= time && time < word->end);
+        }
+    }
+
+    for (int step = 0; step < 200; ++step) {
+        float from = static_cast<float>(quarter(random)) / 4.0f;
+        float to = from + static_cast<float>(length(random)) / 4.0f;
+        size_t expected = 0;
+        for (const auto& timing : timings) {
+            expected += timing.start < to && timing.end > from ? 1 : 0;
+        }
+        std::vector<cartesiapp::TimestampIndex::Entry> entries;
+        ASSERT_EQ(index.wordsInRange("ctx", from, to, entries), expected) << "range [" << from << ", " << to << ")";
+        for (size_t i = 1; i < entries.size(); ++i) {
+            EXPECT_LE(entries[i - 1].start, entries[i].start);
+        }
+    }
+}
+
+TEST(TimestampIndex, EvictsTheOldestFinishedContexts)
+{
+    cartesiapp::TimestampIndex index(2);
+    for (int i = 0; i < 4; ++i) {
+        index.addWords(wordsOf("ctx-" + std::to_string(i), { { "word", 0.0f, 1.0f } }));
+    }
+    index.finishContext("ctx-0");
+    index.finishContext("ctx-1");
+    EXPECT_TRUE(index.wordAt("ctx-0", 0.5f));
+    index.finishContext("ctx-2");
+    EXPECT_FALSE(index.wordAt("ctx-0", 0.5f));
+    EXPECT_TRUE(index.wordAt("ctx-1", 0.5f));
+    EXPECT_TRUE(index.wordAt("ctx-2", 0.5f));
+    // unfinished contexts are never evicted
+    EXPECT_TRUE(index.wordAt("ctx-3", 0.5f));
+
+    // a cleared context no longer counts against the bound
+    index.clearContext("ctx-1");
+    index.finishContext("ctx-3");
+    EXPECT_TRUE(index.wordAt("ctx-2", 0.5f));
+    EXPECT_TRUE(index.wordAt("ctx-3", 0.5f));
+}
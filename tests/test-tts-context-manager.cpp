@@ -0,0 +1,133 @@
+/**
+ * @file test-tts-context-manager.cpp
+ * @brief Slot accounting of the TTS context manager when a queued context cannot be started
+ */
+
+#include "local_server.hpp"
+
+#include "tts_context_manager.hpp"
+
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace {
+    /**
+     * @brief Executor holding the dispatch tasks until run() is called, and running them inline from then on.
+     */
+    class HeldExecutor {
+        public:
+        void post(std::function<void()> task) {
+            std::unique_lock<std::mutex> lock(_mutex);
+            if (!_running) {
+                _tasks.push_back(std::move(task));
+                return;
+            }
+            lock.unlock();
+            task();
+        }
+
+        void run() {
+            std::vector<std::function<void()>> tasks;
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+                _running = true;
+                tasks.swap(_tasks);
+            }
+            for (auto& task : tasks) {
+                task();
+            }
+        }
+
+        private:
+        std::mutex _mutex;
+        std::vector<std::function<void()>> _tasks;
+        bool _running = false;
+    };
+
+    class RecordingListener : public cartesiapp::TTSResponseListener {
+        public:
+        void onConnected() override {
+        }
+        void onDisconnected(const std::string&) override {
+            ++disconnects;
+        }
+        void onNetworkError(const std::string&) override {
+            ++networkErrors;
+        }
+        void onAudioChunkReceived(const cartesiapp::response::tts::AudioChunkResponse&) override {
+        }
+        void onDoneReceived(const cartesiapp::response::tts::DoneResponse&) override {
+            ++dones;
+        }
+        void onWordTimestampsReceived(const cartesiapp::response::tts::WordTimestampsResponse&) override {
+        }
+        void onPhonemeTimestampsReceived(const cartesiapp::response::tts::PhonemeTimestampsResponse&) override {
+        }
+        void onFlushDoneReceived(const cartesiapp::response::tts::FlushDoneResponse&) override {
+        }
+        void onError(const cartesiapp::response::tts::ErrorResponse& response) override {
+            errors.push_back(response);
+        }
+
+        // only touched from the dispatch tasks the test runs itself
+        int disconnects = 0;
+        int networkErrors = 0;
+        int dones = 0;
+        std::vector<cartesiapp::response::tts::ErrorResponse> errors;
+    };
+
+    cartesiapp::request::tts::GenerationRequest requestOf(const std::string& contextId, const std::string& transcript) {
+        cartesiapp::request::tts::GenerationRequest request;
+        request.context_id = contextId;
+        request.transcript = transcript;
+        return request;
+    }
+}
+
+TEST(TTSContextManager, DropsAndReportsAQueuedContextThatCouldNotBeSent)
+{
+    cartesiapp::test::LocalServer server;
+    auto executor = std::make_shared<HeldExecutor>();
+    cartesiapp::TTSWebsocketClient client("test-api-key");
+    client.setWebsocketOptions(server.options());
+    cartesiapp::ListenerDispatchOptions dispatch;
+    dispatch.enabled = true;
+    dispatch.executor = [executor](std::function<void()> task) {
+        executor->post(std::move(task));
+        };
+    client.setListenerDispatchOptions(dispatch);
+    cartesiapp::TTSContextManager manager(client, 1);
+    ASSERT_TRUE(client.connectAndStart());
+
+    auto first = std::make_shared<RecordingListener>();
+    auto second = std::make_shared<RecordingListener>();
+    // the server answers the first context and drops the connection, the second waits for its slot
+    ASSERT_TRUE(manager.submit(requestOf("first", "close"), first));
+    ASSERT_TRUE(manager.submit(requestOf("second", "hello"), second));
+    EXPECT_EQ(manager.activeContexts(), 1u);
+    EXPECT_EQ(manager.queuedContexts(), 1u);
+
+    // the done of the first context is only delivered once the second can no longer be sent
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    while (client.isConnectedAndStarted() && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    ASSERT_FALSE(client.isConnectedAndStarted());
+    executor->run();
+
+    EXPECT_EQ(first->dones, 1);
+    ASSERT_EQ(second->errors.size(), 1u);
+    EXPECT_TRUE(second->errors[0].done);
+    EXPECT_EQ(second->errors[0].context_id, std::optional<std::string>("second"));
+    // the second context was dropped, the connection loss no longer reaches it
+    EXPECT_EQ(second->networkErrors, 0);
+    EXPECT_EQ(manager.activeContexts(), 0u);
+    EXPECT_EQ(manager.queuedContexts(), 0u);
+}